@@ -5,11 +5,16 @@
  */
 
 
+#include <RBDyn/BatchAlgorithms.h>
 #include <RBDyn/Body.h>
+#include <RBDyn/CoM.h>
+#include <RBDyn/Jacobian.h>
 #include <RBDyn/Joint.h>
 #include <RBDyn/MultiBodyConfig.h>
 #include <RBDyn/MultiBodyGraph.h>
 
+#include <algorithm>
+
 namespace rbd
 {
 
@@ -72,4 +77,162 @@ void mbcv_set_item(std::vector<MultiBodyConfig> & v, unsigned int idx, const Mul
   v[idx] = mbc;
 }
 
+/*
+ * Flat buffers exchange of the MultiBodyConfig fields, used by the numpy
+ * accessors. They don't allocate and don't use any python object so they
+ * are called without the GIL.
+ */
+
+std::size_t param_size(const std::vector<std::vector<double>> & q)
+{
+  std::size_t size = 0;
+  for(const std::vector<double> & qi : q)
+  {
+    size += qi.size();
+  }
+  return size;
+}
+
+void param_to_array(const std::vector<std::vector<double>> & q, double * out)
+{
+  for(const std::vector<double> & qi : q)
+  {
+    out = std::copy(qi.begin(), qi.end(), out);
+  }
+}
+
+void array_to_param(const double * in, std::vector<std::vector<double>> & q)
+{
+  for(std::vector<double> & qi : q)
+  {
+    std::copy(in, in + qi.size(), qi.begin());
+    in += qi.size();
+  }
+}
+
+double * ptransform_rotation_data(std::vector<sva::PTransformd> & v)
+{
+  return v.empty() ? nullptr : v[0].rotation().data();
+}
+
+double * ptransform_translation_data(std::vector<sva::PTransformd> & v)
+{
+  return v.empty() ? nullptr : v[0].translation().data();
+}
+
+/// Write the N homogeneous matrices [E^T r; 0 1] in a row major N x 4 x 4 buffer.
+void ptransform_to_homogeneous(const std::vector<sva::PTransformd> & v, double * out)
+{
+  for(const sva::PTransformd & X : v)
+  {
+    Eigen::Map<Eigen::Matrix<double, 4, 4, Eigen::RowMajor>> T(out);
+    T.topLeftCorner<3, 3>() = X.rotation().transpose();
+    T.topRightCorner<3, 1>() = X.translation();
+    T.row(3) << 0., 0., 0., 1.;
+    out += 16;
+  }
+}
+
+/*
+ * Compute a jacobian and return the buffer of the result that is stored in
+ * the algorithm object (column major).
+ */
+
+const double * jacobian_data(Jacobian & jac, const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  return jac.sJacobian(mb, mbc).data();
+}
+
+const double * body_jacobian_data(Jacobian & jac, const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  return jac.sBodyJacobian(mb, mbc).data();
+}
+
+const double * com_jacobian_data(CoMJacobian & jac, const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  return jac.sJacobian(mb, mbc).data();
+}
+
+/**
+ * Map a C-contiguous (T, size) array of samples on the (size x T) matrix
+ * used by BatchAlgorithms.
+ */
+Eigen::Map<const Eigen::MatrixXd> samples(const double * data, Eigen::Index size, Eigen::Index T)
+{
+  return Eigen::Map<const Eigen::MatrixXd>(data, size, T);
+}
+
+Eigen::Map<Eigen::MatrixXd> samples(double * data, Eigen::Index size, Eigen::Index T)
+{
+  return Eigen::Map<Eigen::MatrixXd>(data, size, T);
+}
+
+void batch_forward_kinematics(BatchAlgorithms & batch,
+                              const MultiBody & mb,
+                              Eigen::Index T,
+                              const double * q,
+                              Eigen::Index qSize,
+                              double * bodyPosW,
+                              Eigen::Index bodyPosWSize)
+{
+  batch.sForwardKinematics(mb, samples(q, qSize, T), samples(bodyPosW, bodyPosWSize, T));
+}
+
+void batch_forward_velocity(BatchAlgorithms & batch,
+                            const MultiBody & mb,
+                            Eigen::Index T,
+                            const double * q,
+                            Eigen::Index qSize,
+                            const double * alpha,
+                            Eigen::Index alphaSize,
+                            double * bodyVelW,
+                            Eigen::Index bodyVelWSize)
+{
+  batch.sForwardVelocity(mb, samples(q, qSize, T), samples(alpha, alphaSize, T), samples(bodyVelW, bodyVelWSize, T));
+}
+
+void batch_inverse_dynamics(BatchAlgorithms & batch,
+                            const MultiBody & mb,
+                            Eigen::Index T,
+                            const double * q,
+                            Eigen::Index qSize,
+                            const double * alpha,
+                            Eigen::Index alphaSize,
+                            const double * alphaD,
+                            Eigen::Index alphaDSize,
+                            double * torque,
+                            Eigen::Index torqueSize)
+{
+  batch.sInverseDynamics(mb, samples(q, qSize, T), samples(alpha, alphaSize, T), samples(alphaD, alphaDSize, T),
+                         samples(torque, torqueSize, T));
+}
+
+void batch_forward_dynamics(BatchAlgorithms & batch,
+                            const MultiBody & mb,
+                            Eigen::Index T,
+                            const double * q,
+                            Eigen::Index qSize,
+                            const double * alpha,
+                            Eigen::Index alphaSize,
+                            const double * torque,
+                            Eigen::Index torqueSize,
+                            double * alphaD,
+                            Eigen::Index alphaDSize)
+{
+  batch.sForwardDynamics(mb, samples(q, qSize, T), samples(alpha, alphaSize, T), samples(torque, torqueSize, T),
+                         samples(alphaD, alphaDSize, T));
+}
+
+void batch_jacobian(BatchAlgorithms & batch,
+                    const MultiBody & mb,
+                    const Jacobian & jac,
+                    Eigen::Index T,
+                    const double * q,
+                    Eigen::Index qSize,
+                    double * jacobians,
+                    Eigen::Index jacobiansSize)
+{
+  batch.sJacobian(mb, jac, samples(q, qSize, T), samples(jacobians, jacobiansSize, T));
+}
+
 }
@@ -74,9 +74,11 @@ cdef extern from "<RBDyn/MultiBody.h>" namespace "rbd":
 
     void sBodies(const vector[Body]&) except +#RuntimeError
     void sBody(int, const Body &) except +#OutOfRangeo
+    void sBodyInertia(int, const RBInertiad &) except +#OutOfRange
 
     vector[Joint] joints() const
     Joint sJoint(int) except +#Out of range
+    void sJointAxis(int, const Vector3d &) except +#OutOfRange, DomainError
 
     vector[int] predecessors() const
     int sPredecessor(int) except +#OutOfRange
@@ -196,16 +198,16 @@ cdef extern from "<RBDyn/Jacobian.h>" namespace "rbd":
     MotionVecd sBodyNormalAcceleration(const MultiBody&, const MultiBodyConfig&, const vector[MotionVecd]&) except +
 
 cdef extern from "<RBDyn/FK.h>" namespace "rbd":
-  void sForwardKinematics(const MultiBody&, MultiBodyConfig&) except +
+  void sForwardKinematics(const MultiBody&, MultiBodyConfig&) nogil except +
 
 cdef extern from "<RBDyn/FV.h>" namespace "rbd":
-  void sForwardVelocity(const MultiBody&, MultiBodyConfig&) except +
+  void sForwardVelocity(const MultiBody&, MultiBodyConfig&) nogil except +
 
 cdef extern from "<RBDyn/FA.h>" namespace "rbd":
-  void sForwardAcceleration(const MultiBody&, MultiBodyConfig&, const MotionVecd&) except +
+  void sForwardAcceleration(const MultiBody&, MultiBodyConfig&, const MotionVecd&) nogil except +
 
 cdef extern from "<RBDyn/EulerIntegration.h>" namespace "rbd":
-  void sEulerIntegration(const MultiBody&, MultiBodyConfig&, double) except +
+  void sEulerIntegration(const MultiBody&, MultiBodyConfig&, double) nogil except +
 
 cdef extern from "<RBDyn/ID.h>" namespace "rbd":
   cdef cppclass InverseDynamics:
@@ -213,8 +215,8 @@ cdef extern from "<RBDyn/ID.h>" namespace "rbd":
     InverseDynamics(const InverseDynamics &)
     InverseDynamics(const MultiBody &)
 
-    void sInverseDynamics(const MultiBody&, MultiBodyConfig&) except +
-    void sInverseDynamicsNoInertia(const MultiBody&, MultiBodyConfig&) except +
+    void sInverseDynamics(const MultiBody&, MultiBodyConfig&) nogil except +
+    void sInverseDynamicsNoInertia(const MultiBody&, MultiBodyConfig&) nogil except +
     vector[ForceVecd] f() const
 
 cdef extern from "<RBDyn/FD.h>" namespace "rbd":
@@ -223,14 +225,22 @@ cdef extern from "<RBDyn/FD.h>" namespace "rbd":
     ForwardDynamics(const ForwardDynamics&)
     ForwardDynamics(const MultiBody&)
 
-    void sForwardDynamics(const MultiBody&, MultiBodyConfig&) except +
-    void sComputeH(const MultiBody&, const MultiBodyConfig&) except +
-    void sComputeC(const MultiBody&, const MultiBodyConfig&) except +
+    void sForwardDynamics(const MultiBody&, MultiBodyConfig&) nogil except +
+    void sComputeH(const MultiBody&, const MultiBodyConfig&) nogil except +
+    void sComputeC(const MultiBody&, const MultiBodyConfig&) nogil except +
 
     MatrixXd H() const
     VectorXd C() const
     vector[RBInertiad] inertiaSubTree() const
 
+cdef extern from "<RBDyn/BatchAlgorithms.h>" namespace "rbd":
+  cdef cppclass BatchAlgorithms:
+    BatchAlgorithms(const MultiBody&, int)
+
+    int nrThreads() const
+    Vector3d gravity_
+    int chunk_size_
+
 cdef extern from "<RBDyn/Coriolis.h>" namespace "rbd":
   cdef cppclass Coriolis:
     Coriolis(const MultiBody&)
@@ -3,6 +3,7 @@
 #
 
 from c_rbdyn cimport *
+from sva.c_sva cimport PTransformd
 from libcpp.string cimport string
 from libcpp.vector cimport vector
 from libcpp cimport bool
@@ -20,3 +21,24 @@ cdef extern from "rbdyn_wrapper.hpp" namespace "rbd":
   void dvv_set_item(vector[vector[double]] & v, unsigned int idx, const
       vector[double] & value)
   void mbcv_set_item(vector[MultiBodyConfig]&, unsigned int, const MultiBodyConfig&)
+  size_t param_size(const vector[vector[double]] &)
+  void param_to_array(const vector[vector[double]] &, double *) nogil
+  void array_to_param(const double *, vector[vector[double]] &) nogil
+  double * ptransform_rotation_data(vector[PTransformd] &)
+  double * ptransform_translation_data(vector[PTransformd] &)
+  void ptransform_to_homogeneous(const vector[PTransformd] &, double *) nogil
+  const double * jacobian_data(Jacobian &, const MultiBody &, const MultiBodyConfig &) nogil except +
+  const double * body_jacobian_data(Jacobian &, const MultiBody &, const MultiBodyConfig &) nogil except +
+  const double * com_jacobian_data(CoMJacobian &, const MultiBody &, const MultiBodyConfig &) nogil except +
+  void batch_forward_kinematics(BatchAlgorithms &, const MultiBody &, Py_ssize_t,
+      const double *, Py_ssize_t, double *, Py_ssize_t) nogil except +
+  void batch_forward_velocity(BatchAlgorithms &, const MultiBody &, Py_ssize_t,
+      const double *, Py_ssize_t, const double *, Py_ssize_t, double *, Py_ssize_t) nogil except +
+  void batch_inverse_dynamics(BatchAlgorithms &, const MultiBody &, Py_ssize_t,
+      const double *, Py_ssize_t, const double *, Py_ssize_t, const double *, Py_ssize_t,
+      double *, Py_ssize_t) nogil except +
+  void batch_forward_dynamics(BatchAlgorithms &, const MultiBody &, Py_ssize_t,
+      const double *, Py_ssize_t, const double *, Py_ssize_t, const double *, Py_ssize_t,
+      double *, Py_ssize_t) nogil except +
+  void batch_jacobian(BatchAlgorithms &, const MultiBody &, const Jacobian &, Py_ssize_t,
+      const double *, Py_ssize_t, double *, Py_ssize_t) nogil except +
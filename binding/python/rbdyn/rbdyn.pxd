@@ -57,6 +57,8 @@ cdef MultiBodyGraph MultiBodyGraphFromC(const c_rbdyn.MultiBodyGraph &, cppbool
 cdef class MultiBodyConfig(object):
   cdef c_rbdyn.MultiBodyConfig * impl
   cdef cppbool __own_impl
+  # alive numpy views of bodyPosW
+  cdef object __bodyPosWViews
 
 cdef MultiBodyConfig MultiBodyConfigFromC(const c_rbdyn.MultiBodyConfig&, cppbool copy=?)
 
@@ -78,6 +80,9 @@ cdef class ForwardDynamics(object):
 cdef class Coriolis(object):
   cdef c_rbdyn.Coriolis * impl
 
+cdef class BatchAlgorithms(object):
+  cdef c_rbdyn.BatchAlgorithms * impl
+
 cdef class CoMJacobianDummy(object):
   cdef c_rbdyn.CoMJacobianDummy impl
 
@@ -12,11 +12,110 @@ cimport sva.sva as sva
 cimport eigen.eigen as eigen
 
 from cython.operator cimport dereference as deref
+from cpython.buffer cimport PyBUF_WRITABLE
 from libcpp.map cimport map as cppmap
 from libcpp.string cimport string
 from libcpp.vector cimport vector
 from libcpp cimport bool as cppbool
 
+import numpy
+import weakref
+
+cdef class ArrayView(object):
+  # Export a C++ buffer through the buffer protocol, numpy.asarray(view)
+  # aliases the buffer and keeps the view, and so the owner, alive.
+  # The buffer is invalidated if the owner resizes it.
+  cdef object owner
+  cdef object __weakref__
+  cdef double * data
+  cdef cppbool readonly
+  cdef int ndim
+  cdef Py_ssize_t shape[3]
+  cdef Py_ssize_t strides[3]
+  def __getbuffer__(self, Py_buffer * buffer, int flags):
+    cdef Py_ssize_t size = sizeof(double)
+    cdef int i
+    if self.readonly and (flags & PyBUF_WRITABLE):
+      raise BufferError("read-only buffer")
+    for i in range(self.ndim):
+      size *= self.shape[i]
+    buffer.buf = self.data
+    buffer.obj = self
+    buffer.len = size
+    buffer.readonly = self.readonly
+    buffer.itemsize = sizeof(double)
+    buffer.format = b'd'
+    buffer.ndim = self.ndim
+    buffer.shape = self.shape
+    buffer.strides = self.strides
+    buffer.suboffsets = NULL
+    buffer.internal = NULL
+  def __releasebuffer__(self, Py_buffer * buffer):
+    pass
+
+cdef object ArrayFromC(owner, double * data, cppbool readonly, shape, strides, views = None):
+  # views (a weakref.WeakSet) tracks the alive views of data
+  cdef ArrayView view = ArrayView()
+  cdef int i
+  view.owner = owner
+  view.data = data
+  view.readonly = readonly
+  view.ndim = len(shape)
+  for i in range(view.ndim):
+    view.shape[i] = shape[i]
+    view.strides[i] = strides[i]
+  if views is not None:
+    views.add(view)
+  return numpy.asarray(view)
+
+cdef object ParamToArray(vector[vector[double]] & q, out):
+  cdef size_t size = c_rbdyn_private.param_size(q)
+  cdef double[::1] res
+  if out is None:
+    out = numpy.empty(size)
+  res = out
+  if <size_t>res.shape[0] != size:
+    raise ValueError("out size mismatch: expected {} gived {}".format(size, res.shape[0]))
+  if size > 0:
+    with nogil:
+      c_rbdyn_private.param_to_array(q, &res[0])
+  return out
+
+cdef object ArrayToParam(a, vector[vector[double]] & q):
+  cdef size_t size = c_rbdyn_private.param_size(q)
+  cdef const double[::1] values = numpy.ascontiguousarray(a, dtype = numpy.float64)
+  if <size_t>values.shape[0] != size:
+    raise ValueError("array size mismatch: expected {} gived {}".format(size, values.shape[0]))
+  if size > 0:
+    with nogil:
+      c_rbdyn_private.array_to_param(&values[0], q)
+
+# samples of BatchAlgorithms are given as C-contiguous (T, size) arrays
+cdef const double[:, ::1] SamplesArray(a, Py_ssize_t T, name):
+  cdef const double[:, ::1] res = numpy.ascontiguousarray(a, dtype = numpy.float64)
+  if T >= 0 and res.shape[0] != T:
+    raise ValueError("{} samples mismatch: expected {} gived {}".format(name, T, res.shape[0]))
+  return res
+
+cdef const double * SamplesData(const double[:, ::1] a):
+  if a.shape[0] == 0 or a.shape[1] == 0:
+    return NULL
+  return &a[0, 0]
+
+cdef object SamplesOutput(out, shape):
+  if out is None:
+    return numpy.empty(shape)
+  if numpy.shape(out) != shape:
+    raise ValueError("out shape mismatch: expected {} gived {}".format(shape, numpy.shape(out)))
+  if out.dtype != numpy.float64 or not out.flags.c_contiguous:
+    raise ValueError("out must be a C-contiguous float64 array")
+  return out
+
+cdef double * OutputData(double[::1] a):
+  if a.shape[0] == 0:
+    return NULL
+  return &a[0]
+
 cdef class DoubleVectorWrapper(object):
   def __dealloc__(self):
     if self.__own_impl:
@@ -367,6 +466,8 @@ cdef class MultiBody(object):
       return BodyFromC(self.impl.sBody(i))
     else:
       self.impl.sBody(i, b.impl)
+  def bodyInertia(self, int i, sva.RBInertiad inertia):
+    self.impl.sBodyInertia(i, deref(inertia.impl))
   def joints(self):
     ret = []
     cdef vector[c_rbdyn.Joint] joints = self.impl.joints()
@@ -375,6 +476,8 @@ cdef class MultiBody(object):
     return ret
   def joint(self, int i):
     return JointFromC(self.impl.sJoint(i))
+  def jointAxis(self, int i, eigen.Vector3d axis):
+    self.impl.sJointAxis(i, axis.impl)
   def predecessors(self):
     return self.impl.predecessors()
   def predecessor(self, int i):
@@ -582,6 +685,7 @@ cdef class MultiBodyConfig(object):
     self.impl = new c_rbdyn.MultiBodyConfig(deref(other.impl))
   def __cinit__(self, *args, skip_alloc = False):
     self.__own_impl = True
+    self.__bodyPosWViews = weakref.WeakSet()
     if len(args) == 0:
       if not skip_alloc:
         self.impl = new c_rbdyn.MultiBodyConfig()
@@ -653,7 +757,17 @@ cdef class MultiBodyConfig(object):
         ret.append(sva.PTransformdFromC(pt))
       return ret
     def __set__(self, value):
-      self.impl.bodyPosW = deref(sva.PTransformdVector(value).v)
+      cdef sva.PTransformdVector v = sva.PTransformdVector(value)
+      cdef size_t i
+      # assigned element by element when the size is the same, so the
+      # bodyPosWRotation and bodyPosWTranslation views stay valid
+      if deref(v.v).size() == self.impl.bodyPosW.size():
+        for i in range(self.impl.bodyPosW.size()):
+          self.impl.bodyPosW[i] = deref(v.v)[i]
+      elif len(self.__bodyPosWViews) > 0:
+        raise RuntimeError("bodyPosW can't be resized while bodyPosWRotation or bodyPosWTranslation views are alive")
+      else:
+        self.impl.bodyPosW = deref(v.v)
   property parentToSon:
     def __get__(self):
       ret = []
@@ -691,6 +805,51 @@ cdef class MultiBodyConfig(object):
       return eigen.Vector3dFromC(self.impl.gravity)
     def __set__(self, eigen.Vector3d v):
       self.impl.gravity = v.impl
+  # numpy accessors, q, alpha and alphaD are stored by joint so the flat
+  # arrays (paramToVector layout) are copies, out avoids the allocation
+  def qArray(self, out = None):
+    return ParamToArray(self.impl.q, out)
+  def setQArray(self, q):
+    ArrayToParam(q, self.impl.q)
+  def alphaArray(self, out = None):
+    return ParamToArray(self.impl.alpha, out)
+  def setAlphaArray(self, alpha):
+    ArrayToParam(alpha, self.impl.alpha)
+  def alphaDArray(self, out = None):
+    return ParamToArray(self.impl.alphaD, out)
+  def setAlphaDArray(self, alphaD):
+    ArrayToParam(alphaD, self.impl.alphaD)
+  # bodyPosWRotation and bodyPosWTranslation alias bodyPosW and keep this
+  # object alive, the bodyPosW setter can't resize it while they are alive.
+  # A MultiBodyConfig that doesn't own its storage (element of a
+  # MultiBodyConfigVector or of a C++ object) can't keep it alive, a copy is
+  # returned instead.
+  # The views are still invalidated by a C++ code that resize bodyPosW.
+  # N x 3 x 3 view of the bodyPosW rotations (sva convention, world to body)
+  def bodyPosWRotation(self):
+    ret = ArrayFromC(self, c_rbdyn_private.ptransform_rotation_data(self.impl.bodyPosW), False,
+                     (self.impl.bodyPosW.size(), 3, 3),
+                     (sizeof(c_sva.PTransformd), sizeof(double), 3 * sizeof(double)), self.__bodyPosWViews)
+    return ret if self.__own_impl else ret.copy()
+  # N x 3 view of the bodyPosW translations (bodies origin in world frame)
+  def bodyPosWTranslation(self):
+    ret = ArrayFromC(self, c_rbdyn_private.ptransform_translation_data(self.impl.bodyPosW), False,
+                     (self.impl.bodyPosW.size(), 3),
+                     (sizeof(c_sva.PTransformd), sizeof(double)), self.__bodyPosWViews)
+    return ret if self.__own_impl else ret.copy()
+  # N x 4 x 4 homogeneous poses of the bodies in world frame (copy)
+  def bodyPosWHomogeneous(self, out = None):
+    cdef size_t size = self.impl.bodyPosW.size()
+    cdef double[:, :, ::1] res
+    if out is None:
+      out = numpy.empty((size, 4, 4))
+    res = out
+    if <size_t>res.shape[0] != size or res.shape[1] != 4 or res.shape[2] != 4:
+      raise ValueError("out shape mismatch: expected ({}, 4, 4) gived {}".format(size, numpy.shape(out)))
+    if size > 0:
+      with nogil:
+        c_rbdyn_private.ptransform_to_homogeneous(self.impl.bodyPosW, &res[0, 0, 0])
+    return out
 
 cdef MultiBodyConfig MultiBodyConfigFromC(const c_rbdyn.MultiBodyConfig& mbc, cppbool copy = True):
   cdef MultiBodyConfig ret = MultiBodyConfig(skip_alloc = True)
@@ -830,6 +989,17 @@ cdef class Jacobian(object):
     return eigen.MatrixXdFromC(self.impl.sBodyJacobian(deref(mb.impl), deref(mbc.impl)))
   def bodyJacobianDot(self, MultiBody mb, MultiBodyConfig mbc):
     return eigen.MatrixXdFromC(self.impl.sBodyJacobianDot(deref(mb.impl), deref(mbc.impl)))
+  # read-only 6 x dof numpy view of the result, overwritten by the next call
+  def jacobianArray(self, MultiBody mb, MultiBodyConfig mbc):
+    cdef const double * data
+    with nogil:
+      data = c_rbdyn_private.jacobian_data(self.impl, deref(mb.impl), deref(mbc.impl))
+    return ArrayFromC(self, <double*>data, True, (6, self.impl.dof()), (sizeof(double), 6 * sizeof(double)))
+  def bodyJacobianArray(self, MultiBody mb, MultiBodyConfig mbc):
+    cdef const double * data
+    with nogil:
+      data = c_rbdyn_private.body_jacobian_data(self.impl, deref(mb.impl), deref(mbc.impl))
+    return ArrayFromC(self, <double*>data, True, (6, self.impl.dof()), (sizeof(double), 6 * sizeof(double)))
   def vectorJacobian(self, MultiBody mb, MultiBodyConfig mbc, eigen.Vector3d v):
     return eigen.MatrixXdFromC(self.impl.sVectorJacobian(deref(mb.impl), deref(mbc.impl), v.impl))
   def vectorBodyJacobian(self, MultiBody mb, MultiBodyConfig mbc, eigen.Vector3d v):
@@ -881,16 +1051,20 @@ cdef class Jacobian(object):
       return sva.MotionVecdFromC(self.impl.sBodyNormalAcceleration(deref(mb.impl), deref(mbc.impl), sva.MotionVecdVector(normalAccB).v))
 
 def forwardKinematics(MultiBody mb, MultiBodyConfig mbc):
-  c_rbdyn.sForwardKinematics(deref(mb.impl), deref(mbc.impl))
+  with nogil:
+    c_rbdyn.sForwardKinematics(deref(mb.impl), deref(mbc.impl))
 
 def forwardVelocity(MultiBody mb, MultiBodyConfig mbc):
-  c_rbdyn.sForwardVelocity(deref(mb.impl), deref(mbc.impl))
+  with nogil:
+    c_rbdyn.sForwardVelocity(deref(mb.impl), deref(mbc.impl))
 
 def forwardAcceleration(MultiBody mb, MultiBodyConfig mbc, sva.MotionVecd A_0 = sva.MotionVecd(eigen.Vector6d.Zero())):
-  c_rbdyn.sForwardAcceleration(deref(mb.impl), deref(mbc.impl), deref(A_0.impl))
+  with nogil:
+    c_rbdyn.sForwardAcceleration(deref(mb.impl), deref(mbc.impl), deref(A_0.impl))
 
 def eulerIntegration(MultiBody mb, MultiBodyConfig mbc, double step):
-  c_rbdyn.sEulerIntegration(deref(mb.impl), deref(mbc.impl), step)
+  with nogil:
+    c_rbdyn.sEulerIntegration(deref(mb.impl), deref(mbc.impl), step)
 
 cdef class InverseDynamics(object):
   def __copyctor__(self, InverseDynamics other):
@@ -908,9 +1082,11 @@ cdef class InverseDynamics(object):
     else:
       raise TypeError("Invalid arguments passed to InverseDynamics ctor")
   def inverseDynamics(self, MultiBody mb, MultiBodyConfig mbc):
-    self.impl.sInverseDynamics(deref(mb.impl), deref(mbc.impl))
+    with nogil:
+      self.impl.sInverseDynamics(deref(mb.impl), deref(mbc.impl))
   def inverseDynamicsNoInertia(self, MultiBody mb, MultiBodyConfig mbc):
-    self.impl.sInverseDynamicsNoInertia(deref(mb.impl), deref(mbc.impl))
+    with nogil:
+      self.impl.sInverseDynamicsNoInertia(deref(mb.impl), deref(mbc.impl))
   def f(self):
     cdef vector[c_sva.ForceVecd] fvv = self.impl.f()
     ret = []
@@ -935,13 +1111,16 @@ cdef class ForwardDynamics(object):
       raise TypeError("Invalid arguments passed to ForwardDynamics ctor")
 
   def forwardDynamics(self, MultiBody mb, MultiBodyConfig mbc):
-    self.impl.sForwardDynamics(deref(mb.impl), deref(mbc.impl))
+    with nogil:
+      self.impl.sForwardDynamics(deref(mb.impl), deref(mbc.impl))
 
   def computeH(self, MultiBody mb, MultiBodyConfig mbc):
-    self.impl.sComputeH(deref(mb.impl), deref(mbc.impl))
+    with nogil:
+      self.impl.sComputeH(deref(mb.impl), deref(mbc.impl))
 
   def computeC(self, MultiBody mb, MultiBodyConfig mbc):
-    self.impl.sComputeC(deref(mb.impl), deref(mbc.impl))
+    with nogil:
+      self.impl.sComputeC(deref(mb.impl), deref(mbc.impl))
 
   def H(self):
     return eigen.MatrixXdFromC(self.impl.H())
@@ -964,6 +1143,105 @@ cdef class Coriolis(object):
   def coriolis(self, MultiBody mb, MultiBodyConfig mbc):
     return eigen.MatrixXdFromC(self.impl.coriolis(deref(mb.impl), deref(mbc.impl)))
 
+# algorithms over the (T, nrParams) and (T, nrDof) arrays of a trajectory,
+# the GIL is released and the samples are dispatched on nrThreads workers,
+# so an instance must not be shared between Python threads (use one per thread)
+cdef class BatchAlgorithms(object):
+  def __dealloc__(self):
+    del self.impl
+  def __cinit__(self, MultiBody mb, int nrThreads = 0):
+    self.impl = new c_rbdyn.BatchAlgorithms(deref(mb.impl), nrThreads)
+  def nrThreads(self):
+    return self.impl.nrThreads()
+  property gravity:
+    def __get__(self):
+      return eigen.Vector3dFromC(self.impl.gravity_)
+    def __set__(self, eigen.Vector3d v):
+      self.impl.gravity_ = v.impl
+  property chunkSize:
+    def __get__(self):
+      return self.impl.chunk_size_
+    def __set__(self, int v):
+      self.impl.chunk_size_ = v
+  # return the (T, nrBodies, 4, 4) homogeneous matrices of bodyPosW
+  def forwardKinematics(self, MultiBody mb, q, out = None):
+    cdef const double[:, ::1] q_ = SamplesArray(q, -1, "q")
+    cdef Py_ssize_t T = q_.shape[0]
+    out = SamplesOutput(out, (T, mb.impl.nrBodies(), 4, 4))
+    cdef Py_ssize_t resSize = 16 * mb.impl.nrBodies()
+    cdef double[::1] res = out.reshape(-1)
+    cdef const double * qData = SamplesData(q_)
+    cdef double * resData = OutputData(res)
+    with nogil:
+      c_rbdyn_private.batch_forward_kinematics(deref(self.impl), deref(mb.impl), T,
+                                               qData, q_.shape[1], resData, resSize)
+    return out
+  # return the (T, nrBodies, 6) bodyVelW (angular then linear)
+  def forwardVelocity(self, MultiBody mb, q, alpha, out = None):
+    cdef const double[:, ::1] q_ = SamplesArray(q, -1, "q")
+    cdef Py_ssize_t T = q_.shape[0]
+    cdef const double[:, ::1] alpha_ = SamplesArray(alpha, T, "alpha")
+    out = SamplesOutput(out, (T, mb.impl.nrBodies(), 6))
+    cdef Py_ssize_t resSize = 6 * mb.impl.nrBodies()
+    cdef double[::1] res = out.reshape(-1)
+    cdef const double * qData = SamplesData(q_)
+    cdef const double * alphaData = SamplesData(alpha_)
+    cdef double * resData = OutputData(res)
+    with nogil:
+      c_rbdyn_private.batch_forward_velocity(deref(self.impl), deref(mb.impl), T,
+                                             qData, q_.shape[1], alphaData, alpha_.shape[1],
+                                             resData, resSize)
+    return out
+  # return the (T, nrDof) joint torques
+  def inverseDynamics(self, MultiBody mb, q, alpha, alphaD, out = None):
+    cdef const double[:, ::1] q_ = SamplesArray(q, -1, "q")
+    cdef Py_ssize_t T = q_.shape[0]
+    cdef const double[:, ::1] alpha_ = SamplesArray(alpha, T, "alpha")
+    cdef const double[:, ::1] alphaD_ = SamplesArray(alphaD, T, "alphaD")
+    out = SamplesOutput(out, (T, mb.impl.nrDof()))
+    cdef Py_ssize_t resSize = mb.impl.nrDof()
+    cdef double[::1] res = out.reshape(-1)
+    cdef const double * qData = SamplesData(q_)
+    cdef const double * alphaData = SamplesData(alpha_)
+    cdef const double * alphaDData = SamplesData(alphaD_)
+    cdef double * resData = OutputData(res)
+    with nogil:
+      c_rbdyn_private.batch_inverse_dynamics(deref(self.impl), deref(mb.impl), T,
+                                             qData, q_.shape[1], alphaData, alpha_.shape[1],
+                                             alphaDData, alphaD_.shape[1], resData, resSize)
+    return out
+  # return the (T, nrDof) generalized accelerations
+  def forwardDynamics(self, MultiBody mb, q, alpha, torque, out = None):
+    cdef const double[:, ::1] q_ = SamplesArray(q, -1, "q")
+    cdef Py_ssize_t T = q_.shape[0]
+    cdef const double[:, ::1] alpha_ = SamplesArray(alpha, T, "alpha")
+    cdef const double[:, ::1] torque_ = SamplesArray(torque, T, "torque")
+    out = SamplesOutput(out, (T, mb.impl.nrDof()))
+    cdef Py_ssize_t resSize = mb.impl.nrDof()
+    cdef double[::1] res = out.reshape(-1)
+    cdef const double * qData = SamplesData(q_)
+    cdef const double * alphaData = SamplesData(alpha_)
+    cdef const double * torqueData = SamplesData(torque_)
+    cdef double * resData = OutputData(res)
+    with nogil:
+      c_rbdyn_private.batch_forward_dynamics(deref(self.impl), deref(mb.impl), T,
+                                             qData, q_.shape[1], alphaData, alpha_.shape[1],
+                                             torqueData, torque_.shape[1], resData, resSize)
+    return out
+  # return the (T, 6, jac.dof()) jacobians in world frame
+  def jacobian(self, MultiBody mb, Jacobian jac, q, out = None):
+    cdef const double[:, ::1] q_ = SamplesArray(q, -1, "q")
+    cdef Py_ssize_t T = q_.shape[0]
+    out = SamplesOutput(out, (T, 6, jac.impl.dof()))
+    cdef Py_ssize_t resSize = 6 * jac.impl.dof()
+    cdef double[::1] res = out.reshape(-1)
+    cdef const double * qData = SamplesData(q_)
+    cdef double * resData = OutputData(res)
+    with nogil:
+      c_rbdyn_private.batch_jacobian(deref(self.impl), deref(mb.impl), jac.impl, T,
+                                     qData, q_.shape[1], resData, resSize)
+    return out
+
 def computeCoM(MultiBody mb, MultiBodyConfig mbc):
   return eigen.Vector3dFromC(c_rbdyn.sComputeCoM(deref(mb.impl), deref(mbc.impl)))
 
@@ -1022,6 +1300,12 @@ cdef class CoMJacobian(object):
     return eigen.MatrixXdFromC(self.impl.sJacobian(deref(mb.impl), deref(mbc.impl)))
   def jacobianDot(self, MultiBody mb, MultiBodyConfig mbc):
     return eigen.MatrixXdFromC(self.impl.sJacobianDot(deref(mb.impl), deref(mbc.impl)))
+  # read-only 3 x nrDof numpy view of the result, overwritten by the next call
+  def jacobianArray(self, MultiBody mb, MultiBodyConfig mbc):
+    cdef const double * data
+    with nogil:
+      data = c_rbdyn_private.com_jacobian_data(self.impl, deref(mb.impl), deref(mbc.impl))
+    return ArrayFromC(self, <double*>data, True, (3, mb.impl.nrDof()), (sizeof(double), 3 * sizeof(double)))
   def updateInertialParameters(self, MultiBody mb):
     self.impl.sUpdateInertialParameters(deref(mb.impl))
   def weight(self, MultiBody mb = None, w = None):
@@ -0,0 +1,170 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+#
+
+import unittest
+
+import numpy
+
+import eigen as e3
+import sva
+import rbdyn as rbd
+
+class TestRBDynNumpy(unittest.TestCase):
+  def setUp(self):
+    I = sva.RBInertiad(1., e3.Vector3d(0.1, 0.2, 0.), e3.Matrix3d.Identity())
+    bodies = [rbd.Body(I, 'body%s' % i) for i in range(4)]
+    joints = [rbd.Joint(rbd.Joint.Free, True, 'jFree'),
+              rbd.Joint(rbd.Joint.Rev, e3.Vector3d.UnitX(), True, 'jR'),
+              rbd.Joint(rbd.Joint.Prism, e3.Vector3d.UnitY(), True, 'jP'),
+              rbd.Joint(rbd.Joint.Spherical, True, 'jS')]
+    self.mb = rbd.MultiBody(bodies, joints,
+                            list(range(-1, 3)), list(range(0, 4)), list(range(-1, 3)),
+                            [sva.PTransformd(e3.Vector3d(0., i, 0.)) for i in range(4)])
+    self.mbc = rbd.MultiBodyConfig(self.mb)
+    self.mbc.zero(self.mb)
+    self.q = numpy.array([1., 0., 0., 0., 0.1, 0.2, 0.3, 0.4, 0.5,
+                          numpy.cos(0.3), numpy.sin(0.3), 0., 0.])
+
+  def test_param(self):
+    mb, mbc = self.mb, self.mbc
+    self.assertEqual(mbc.qArray().shape, (mb.nrParams(),))
+    self.assertEqual(mbc.alphaArray().shape, (mb.nrDof(),))
+
+    mbc.setQArray(self.q)
+    self.assertEqual(list(rbd.paramToVector(mb, mbc.q)), self.q.tolist())
+    out = numpy.zeros(mb.nrParams())
+    self.assertIs(mbc.qArray(out), out)
+    self.assertEqual(out.tolist(), self.q.tolist())
+
+    alpha = numpy.arange(mb.nrDof(), dtype = float)
+    mbc.setAlphaArray(alpha.tolist())
+    self.assertEqual(mbc.alphaArray().tolist(), alpha.tolist())
+    self.assertEqual(list(rbd.dofToVector(mb, mbc.alpha)), alpha.tolist())
+
+    self.assertRaises(ValueError, mbc.setQArray, numpy.zeros(mb.nrParams() + 1))
+    self.assertRaises(ValueError, mbc.alphaDArray, numpy.zeros(mb.nrDof() - 1))
+
+  def test_bodyPosW(self):
+    mb, mbc = self.mb, self.mbc
+    mbc.setQArray(self.q)
+    rbd.forwardKinematics(mb, mbc)
+
+    rot = mbc.bodyPosWRotation()
+    trans = mbc.bodyPosWTranslation()
+    self.assertEqual(rot.shape, (mb.nrBodies(), 3, 3))
+    self.assertEqual(trans.shape, (mb.nrBodies(), 3))
+    for i, X in enumerate(mbc.bodyPosW):
+      self.assertEqual(trans[i].tolist(), list(X.translation()))
+      for r in range(3):
+        for c in range(3):
+          self.assertEqual(rot[i, r, c], X.rotation().coeff(r, c))
+
+    H = mbc.bodyPosWHomogeneous()
+    self.assertTrue(numpy.array_equal(H[:, :3, :3], rot.transpose(0, 2, 1)))
+    self.assertTrue(numpy.array_equal(H[:, :3, 3], trans))
+    self.assertTrue(numpy.array_equal(H[:, 3], numpy.tile([0., 0., 0., 1.], (mb.nrBodies(), 1))))
+
+    # the views alias the MultiBodyConfig and keep it alive
+    self.q[4] = 2.
+    mbc.setQArray(self.q)
+    rbd.forwardKinematics(mb, mbc)
+    self.assertEqual(trans[0, 0], 2.)
+    trans[1, 2] = 42.
+    self.assertEqual(mbc.bodyPosW[1].translation().z(), 42.)
+    del self.mbc, mbc
+    self.assertEqual(trans[1, 2], 42.)
+
+  def test_bodyPosW_lifetime(self):
+    mb, mbc = self.mb, self.mbc
+    rbd.forwardKinematics(mb, mbc)
+    trans = mbc.bodyPosWTranslation()
+
+    # same size assignment keep the storage of the views
+    mbc.bodyPosW = [sva.PTransformd(e3.Vector3d(1., 2., 3.))] * mb.nrBodies()
+    self.assertEqual(trans[3].tolist(), [1., 2., 3.])
+    # resize is rejected while a view is alive
+    self.assertRaises(RuntimeError, setattr, mbc, 'bodyPosW', [sva.PTransformd.Identity()])
+    del trans
+    mbc.bodyPosW = [sva.PTransformd.Identity()]
+    self.assertEqual(mbc.bodyPosWTranslation().shape, (1, 3))
+
+    # an element of a MultiBodyConfigVector doesn't own its storage, a copy is returned
+    mbc = rbd.MultiBodyConfig(mb)
+    mbc.zero(mb)
+    rbd.forwardKinematics(mb, mbc)
+    mbcv = rbd.MultiBodyConfigVector([mbc])
+    trans = mbcv[0].bodyPosWTranslation()
+    trans[1, 2] = 42.
+    self.assertNotEqual(mbcv[0].bodyPosW[1].translation().z(), 42.)
+    del mbcv
+    self.assertEqual(trans[1, 2], 42.)
+
+  def test_jacobian(self):
+    mb, mbc = self.mb, self.mbc
+    mbc.setQArray(self.q)
+    rbd.forwardKinematics(mb, mbc)
+
+    jac = rbd.Jacobian(mb, 'body3', e3.Vector3d(0.1, 0.2, 0.3))
+    J = jac.jacobianArray(mb, mbc)
+    self.assertEqual(J.shape, (6, jac.dof()))
+    self.assertFalse(J.flags.writeable)
+    jacRef = jac.jacobian(mb, mbc)
+    for r in range(6):
+      for c in range(jac.dof()):
+        self.assertEqual(J[r, c], jacRef.coeff(r, c))
+
+    # the next computation overwrites the same buffer
+    bodyJ = jac.bodyJacobianArray(mb, mbc)
+    self.assertTrue(numpy.shares_memory(J, bodyJ))
+
+    comJac = rbd.CoMJacobian(mb)
+    comJ = comJac.jacobianArray(mb, mbc)
+    self.assertEqual(comJ.shape, (3, mb.nrDof()))
+    comJRef = comJac.jacobian(mb, mbc)
+    for r in range(3):
+      for c in range(mb.nrDof()):
+        self.assertEqual(comJ[r, c], comJRef.coeff(r, c))
+
+  def test_batch(self):
+    mb, mbc = self.mb, self.mbc
+    T = 20
+    q = numpy.tile(self.q, (T, 1))
+    q[:, 4] = numpy.linspace(-1., 1., T)
+    alpha = numpy.random.random((T, mb.nrDof()))
+    alphaD = numpy.random.random((T, mb.nrDof()))
+    jac = rbd.Jacobian(mb, 'body3', e3.Vector3d(0.1, 0.2, 0.3))
+    idyn = rbd.InverseDynamics(mb)
+
+    batch = rbd.BatchAlgorithms(mb, 2)
+    self.assertEqual(batch.nrThreads(), 2)
+    H = batch.forwardKinematics(mb, q)
+    V = batch.forwardVelocity(mb, q, alpha)
+    torque = batch.inverseDynamics(mb, q, alpha, alphaD)
+    J = batch.jacobian(mb, jac, q)
+    self.assertEqual(H.shape, (T, mb.nrBodies(), 4, 4))
+    self.assertEqual(V.shape, (T, mb.nrBodies(), 6))
+    self.assertEqual(torque.shape, (T, mb.nrDof()))
+    self.assertEqual(J.shape, (T, 6, jac.dof()))
+    self.assertTrue(numpy.allclose(batch.forwardDynamics(mb, q, alpha, torque), alphaD))
+
+    # each sample match the per configuration functions
+    for s in (0, T // 2, T - 1):
+      mbc.setQArray(q[s])
+      mbc.setAlphaArray(alpha[s])
+      mbc.setAlphaDArray(alphaD[s])
+      rbd.forwardKinematics(mb, mbc)
+      rbd.forwardVelocity(mb, mbc)
+      idyn.inverseDynamics(mb, mbc)
+      self.assertTrue(numpy.allclose(H[s], mbc.bodyPosWHomogeneous()))
+      self.assertTrue(numpy.allclose(torque[s], list(rbd.dofToVector(mb, mbc.jointTorque))))
+      self.assertTrue(numpy.allclose(J[s], jac.jacobianArray(mb, mbc)))
+      for i, v in enumerate(mbc.bodyVelW):
+        self.assertTrue(numpy.allclose(V[s, i], list(v.vector())))
+
+    out = numpy.empty((T, mb.nrDof()))
+    self.assertIs(batch.inverseDynamics(mb, q, alpha, alphaD, out), out)
+    self.assertRaises(ValueError, batch.inverseDynamics, mb, q, alpha[1:], alphaD)
+    self.assertRaises(ValueError, batch.inverseDynamics, mb, q[:, 1:], alpha, alphaD)
+    self.assertRaises(ValueError, batch.inverseDynamics, mb, q, alpha, alphaD, out.T)
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// associated header
+#include "RBDyn/BatchAlgorithms.h"
+
+// includes
+// std
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// RBDyn
+#include "RBDyn/FK.h"
+#include "RBDyn/FV.h"
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/Parallel.h"
+
+namespace rbd
+{
+
+namespace
+{
+
+typedef Eigen::Matrix<double, 4, 4, Eigen::RowMajor> RowMatrix4d;
+typedef Eigen::Matrix<double, 6, Eigen::Dynamic, Eigen::RowMajor> RowMatrix6Xd;
+
+void checkSize(const Eigen::Ref<const Eigen::MatrixXd> & m,
+               Eigen::Index rows,
+               Eigen::Index cols,
+               const std::string & name)
+{
+  if(m.rows() != rows || m.cols() != cols)
+  {
+    std::ostringstream str;
+    str << name << " size mismatch: expected (" << rows << ", " << cols << ") gived (" << m.rows() << ", " << m.cols()
+        << ")";
+    throw std::domain_error(str.str());
+  }
+}
+
+} // namespace
+
+BatchAlgorithms::BatchAlgorithms(const MultiBody & mb, int nrThreads)
+: gravity_(0., 9.81, 0.), chunk_size_(16), nrBodies_(mb.nrBodies()), nrParams_(mb.nrParams()), nrDof_(mb.nrDof())
+{
+  MultiBodyConfig mbc(mb);
+  mbc.zero(mb);
+
+  nrThreads = resolveNrThreads(nrThreads);
+  workspaces_.reserve(static_cast<std::size_t>(nrThreads));
+  for(int i = 0; i < nrThreads; ++i)
+  {
+    workspaces_.push_back({mbc, InverseDynamics(mb), ForwardDynamics(mb), Jacobian()});
+  }
+}
+
+void BatchAlgorithms::forwardKinematics(const MultiBody & mb,
+                                        const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                        Eigen::Ref<Eigen::MatrixXd> bodyPosW)
+{
+  parallelFor(static_cast<int>(q.cols()), nrThreads(), chunk_size_, [&](int thread, int begin, int end) {
+    MultiBodyConfig & mbc = workspaces_[static_cast<std::size_t>(thread)].mbc;
+    for(int s = begin; s < end; ++s)
+    {
+      vectorToParam(q.col(s), mbc.q);
+      rbd::forwardKinematics(mb, mbc);
+
+      double * out = bodyPosW.col(s).data();
+      for(std::size_t i = 0; i < mbc.bodyPosW.size(); ++i, out += 16)
+      {
+        const sva::PTransformd & X = mbc.bodyPosW[i];
+        Eigen::Map<RowMatrix4d> H(out);
+        H.topLeftCorner<3, 3>() = X.rotation().transpose();
+        H.topRightCorner<3, 1>() = X.translation();
+        H.row(3) << 0., 0., 0., 1.;
+      }
+    }
+  });
+}
+
+void BatchAlgorithms::forwardVelocity(const MultiBody & mb,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                                      Eigen::Ref<Eigen::MatrixXd> bodyVelW)
+{
+  parallelFor(static_cast<int>(q.cols()), nrThreads(), chunk_size_, [&](int thread, int begin, int end) {
+    MultiBodyConfig & mbc = workspaces_[static_cast<std::size_t>(thread)].mbc;
+    for(int s = begin; s < end; ++s)
+    {
+      vectorToParam(q.col(s), mbc.q);
+      vectorToParam(alpha.col(s), mbc.alpha);
+      rbd::forwardKinematics(mb, mbc);
+      rbd::forwardVelocity(mb, mbc);
+
+      for(std::size_t i = 0; i < mbc.bodyVelW.size(); ++i)
+      {
+        bodyVelW.col(s).segment<6>(static_cast<Eigen::Index>(6 * i)) = mbc.bodyVelW[i].vector();
+      }
+    }
+  });
+}
+
+void BatchAlgorithms::inverseDynamics(const MultiBody & mb,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & alphaD,
+                                      Eigen::Ref<Eigen::MatrixXd> torque)
+{
+  for(Workspace & ws : workspaces_)
+  {
+    ws.mbc.gravity = gravity_;
+    ws.mbc.stamps.forceChanged();
+  }
+
+  parallelFor(static_cast<int>(q.cols()), nrThreads(), chunk_size_, [&](int thread, int begin, int end) {
+    Workspace & ws = workspaces_[static_cast<std::size_t>(thread)];
+    for(int s = begin; s < end; ++s)
+    {
+      vectorToParam(q.col(s), ws.mbc.q);
+      vectorToParam(alpha.col(s), ws.mbc.alpha);
+      vectorToParam(alphaD.col(s), ws.mbc.alphaD);
+      rbd::forwardKinematics(mb, ws.mbc);
+      rbd::forwardVelocity(mb, ws.mbc);
+      ws.id.inverseDynamics(mb, ws.mbc);
+      paramToVector(ws.mbc.jointTorque, torque.col(s));
+    }
+  });
+}
+
+void BatchAlgorithms::forwardDynamics(const MultiBody & mb,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                                      Eigen::Ref<Eigen::MatrixXd> alphaD)
+{
+  for(Workspace & ws : workspaces_)
+  {
+    ws.mbc.gravity = gravity_;
+    ws.mbc.stamps.forceChanged();
+  }
+
+  parallelFor(static_cast<int>(q.cols()), nrThreads(), chunk_size_, [&](int thread, int begin, int end) {
+    Workspace & ws = workspaces_[static_cast<std::size_t>(thread)];
+    for(int s = begin; s < end; ++s)
+    {
+      vectorToParam(q.col(s), ws.mbc.q);
+      vectorToParam(alpha.col(s), ws.mbc.alpha);
+      vectorToParam(torque.col(s), ws.mbc.jointTorque);
+      rbd::forwardKinematics(mb, ws.mbc);
+      rbd::forwardVelocity(mb, ws.mbc);
+      ws.fd.forwardDynamics(mb, ws.mbc);
+      paramToVector(ws.mbc.alphaD, alphaD.col(s));
+    }
+  });
+}
+
+void BatchAlgorithms::jacobian(const MultiBody & mb,
+                               const Jacobian & jac,
+                               const Eigen::Ref<const Eigen::MatrixXd> & q,
+                               Eigen::Ref<Eigen::MatrixXd> jacobians)
+{
+  for(Workspace & ws : workspaces_)
+  {
+    ws.jac = jac;
+  }
+
+  parallelFor(static_cast<int>(q.cols()), nrThreads(), chunk_size_, [&](int thread, int begin, int end) {
+    Workspace & ws = workspaces_[static_cast<std::size_t>(thread)];
+    for(int s = begin; s < end; ++s)
+    {
+      vectorToParam(q.col(s), ws.mbc.q);
+      rbd::forwardKinematics(mb, ws.mbc);
+      Eigen::Map<RowMatrix6Xd>(jacobians.col(s).data(), 6, ws.jac.dof()) = ws.jac.jacobian(mb, ws.mbc);
+    }
+  });
+}
+
+void BatchAlgorithms::sForwardKinematics(const MultiBody & mb,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                         Eigen::Ref<Eigen::MatrixXd> bodyPosW)
+{
+  checkMatchMultiBody(mb);
+  checkSize(q, mb.nrParams(), q.cols(), "q");
+  checkSize(bodyPosW, 16 * mb.nrBodies(), q.cols(), "bodyPosW");
+
+  forwardKinematics(mb, q, bodyPosW);
+}
+
+void BatchAlgorithms::sForwardVelocity(const MultiBody & mb,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                                       Eigen::Ref<Eigen::MatrixXd> bodyVelW)
+{
+  checkMatchMultiBody(mb);
+  checkSize(q, mb.nrParams(), q.cols(), "q");
+  checkSize(alpha, mb.nrDof(), q.cols(), "alpha");
+  checkSize(bodyVelW, 6 * mb.nrBodies(), q.cols(), "bodyVelW");
+
+  forwardVelocity(mb, q, alpha, bodyVelW);
+}
+
+void BatchAlgorithms::sInverseDynamics(const MultiBody & mb,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & alphaD,
+                                       Eigen::Ref<Eigen::MatrixXd> torque)
+{
+  checkMatchMultiBody(mb);
+  checkSize(q, mb.nrParams(), q.cols(), "q");
+  checkSize(alpha, mb.nrDof(), q.cols(), "alpha");
+  checkSize(alphaD, mb.nrDof(), q.cols(), "alphaD");
+  checkSize(torque, mb.nrDof(), q.cols(), "torque");
+
+  inverseDynamics(mb, q, alpha, alphaD, torque);
+}
+
+void BatchAlgorithms::sForwardDynamics(const MultiBody & mb,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                                       Eigen::Ref<Eigen::MatrixXd> alphaD)
+{
+  checkMatchMultiBody(mb);
+  checkSize(q, mb.nrParams(), q.cols(), "q");
+  checkSize(alpha, mb.nrDof(), q.cols(), "alpha");
+  checkSize(torque, mb.nrDof(), q.cols(), "torque");
+  checkSize(alphaD, mb.nrDof(), q.cols(), "alphaD");
+
+  forwardDynamics(mb, q, alpha, torque, alphaD);
+}
+
+void BatchAlgorithms::sJacobian(const MultiBody & mb,
+                                const Jacobian & jac,
+                                const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                Eigen::Ref<Eigen::MatrixXd> jacobians)
+{
+  checkMatchMultiBody(mb);
+  checkSize(q, mb.nrParams(), q.cols(), "q");
+  checkSize(jacobians, 6 * jac.dof(), q.cols(), "jacobians");
+  const std::vector<int> & path = jac.jointsPath();
+  if(path.empty() || *std::max_element(path.begin(), path.end()) >= static_cast<int>(mb.nrJoints()))
+  {
+    throw std::domain_error("jointsPath mismatch MultiBody");
+  }
+
+  jacobian(mb, jac, q, jacobians);
+}
+
+void BatchAlgorithms::checkMatchMultiBody(const MultiBody & mb) const
+{
+  if(mb.nrBodies() != nrBodies_ || mb.nrParams() != nrParams_ || mb.nrDof() != nrDof_)
+  {
+    std::ostringstream str;
+    str << "MultiBody mismatch: expected (nrBodies, nrParams, nrDof) (" << nrBodies_ << ", " << nrParams_ << ", "
+        << nrDof_ << ") gived (" << mb.nrBodies() << ", " << mb.nrParams() << ", " << mb.nrDof() << ")";
+    throw std::domain_error(str.str());
+  }
+}
+
+} // namespace rbd
@@ -12,84 +12,23 @@
 namespace rbd
 {
 
+template Eigen::Vector3d computeCoM<double>(const MultiBody & mb, const MultiBodyConfigT<double> & mbc);
+template Eigen::Vector3d computeCoMVelocity<double>(const MultiBody & mb, const MultiBodyConfigT<double> & mbc);
+template Eigen::Vector3d computeCoMAcceleration<double>(const MultiBody & mb, const MultiBodyConfigT<double> & mbc);
+
 Eigen::Vector3d computeCoM(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
-  using namespace Eigen;
-
-  const std::vector<Body> & bodies = mb.bodies();
-
-  Vector3d com = Vector3d::Zero();
-  double totalMass = 0.;
-
-  for(int i = 0; i < mb.nrBodies(); ++i)
-  {
-    double mass = bodies[i].inertia().mass();
-
-    totalMass += mass;
-    sva::PTransformd scaledBobyPosW(mbc.bodyPosW[i].rotation(), mass * mbc.bodyPosW[i].translation());
-    com += (sva::PTransformd(bodies[i].inertia().momentum()) * scaledBobyPosW).translation();
-  }
-
-  assert(totalMass > 0 && "Invalid multibody. Totalmass must be strictly positive");
-  return com / totalMass;
+  return computeCoM<double>(mb, mbc);
 }
 
 Eigen::Vector3d computeCoMVelocity(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
-  using namespace Eigen;
-
-  const std::vector<Body> & bodies = mb.bodies();
-
-  Vector3d comV = Vector3d::Zero();
-  double totalMass = 0.;
-
-  for(int i = 0; i < mb.nrBodies(); ++i)
-  {
-    double mass = bodies[i].inertia().mass();
-    totalMass += mass;
-
-    // Velocity at CoM : com_T_b·V_b
-    // Velocity at CoM world frame : 0_R_b·com_T_b·V_b
-    sva::PTransformd X_0_i(mbc.bodyPosW[i].rotation().transpose(), bodies[i].inertia().momentum());
-    sva::MotionVecd scaledBodyVelB(mbc.bodyVelB[i].angular(), mass * mbc.bodyVelB[i].linear());
-    comV += (X_0_i * scaledBodyVelB).linear();
-  }
-
-  assert(totalMass > 0 && "Invalid multibody. Totalmass must be strictly positive");
-  return comV / totalMass;
+  return computeCoMVelocity<double>(mb, mbc);
 }
 
 Eigen::Vector3d computeCoMAcceleration(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
-  using namespace Eigen;
-
-  const std::vector<Body> & bodies = mb.bodies();
-
-  Vector3d comA = Vector3d::Zero();
-  double totalMass = 0.;
-
-  for(int i = 0; i < mb.nrBodies(); ++i)
-  {
-    double mass = bodies[i].inertia().mass();
-
-    totalMass += mass;
-
-    // Acceleration at CoM : com_T_b·A_b
-    // Acceleration at CoM world frame :
-    //    0_R_b·com_T_b·A_b + 0_R_b_d·com_T_b·V_b
-    // O_R_b_d : (Angvel_W)_b x 0_R_b
-    sva::PTransformd X_0_iscaled(mbc.bodyPosW[i].rotation().transpose(), bodies[i].inertia().momentum());
-    sva::MotionVecd angvel_W(mbc.bodyVelW[i].angular(), Eigen::Vector3d::Zero());
-
-    sva::MotionVecd scaledBodyAccB(mbc.bodyAccB[i].angular(), mass * mbc.bodyAccB[i].linear());
-    sva::MotionVecd scaledBodyVelB(mbc.bodyVelB[i].angular(), mass * mbc.bodyVelB[i].linear());
-
-    comA += (X_0_iscaled * scaledBodyAccB).linear();
-    comA += (angvel_W.cross(X_0_iscaled * scaledBodyVelB)).linear();
-  }
-
-  assert(totalMass > 0 && "Invalid multibody. Totalmass must be strictly positive");
-  return comA / totalMass;
+  return computeCoMAcceleration<double>(mb, mbc);
 }
 
 Eigen::Vector3d sComputeCoM(const MultiBody & mb, const MultiBodyConfig & mbc)
@@ -248,6 +187,12 @@ void CoMJacobian::updateInertialParameters(const MultiBody & mb)
 {
   double mass = 0.;
 
+  // the bodies coefficients change, invalidate the cached jacobians
+  jacPositionStamp_ = 0;
+  jacDotPositionStamp_ = 0;
+  jacDotVelocityStamp_ = 0;
+  inertiaStamp_ = mb.inertiaStamp();
+
   for(int i = 0; i < mb.nrBodies(); ++i)
   {
     mass += mb.body(i).inertia().mass();
@@ -277,7 +222,11 @@ void CoMJacobian::weight(const MultiBody & mb, std::vector<double> w)
 
 const Eigen::MatrixXd & CoMJacobian::jacobian(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
-  const std::vector<Joint> & joints = mb.joints();
+  checkInertialParameters(mb);
+  // jac_ may not match the configuration of the last updateJacobian call anymore
+  jacPositionStamp_ = 0;
+
+  const std::vector<JointData> & joints = mb.jointsData();
 
   jac_.setZero();
 
@@ -297,13 +246,13 @@ const Eigen::MatrixXd & CoMJacobian::jacobian(const MultiBody & mb, const MultiB
     for(int b : subBodies)
     {
       sva::PTransformd X_i_com = bodiesCoMWorld_[b] * X_i_0;
-      for(int dof = 0; dof < joints[i].dof(); ++dof)
+      for(int dof = 0; dof < joints[i].dof; ++dof)
       {
         jac_.col(curJ + dof).noalias() +=
             (X_i_com.linearMul(sva::MotionVecd(mbc.motionSubspace[i].col(dof)))) * bodiesCoeff_[b];
       }
     }
-    curJ += joints[i].dof();
+    curJ += joints[i].dof;
   }
 
   return jac_;
@@ -311,7 +260,11 @@ const Eigen::MatrixXd & CoMJacobian::jacobian(const MultiBody & mb, const MultiB
 
 const Eigen::MatrixXd & CoMJacobian::jacobianDot(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
-  const std::vector<Joint> & joints = mb.joints();
+  checkInertialParameters(mb);
+  // jacDot_ may not match the configuration of the last updateJacobianDot call anymore
+  jacDotPositionStamp_ = 0;
+
+  const std::vector<JointData> & joints = mb.jointsData();
 
   jacDot_.setZero();
 
@@ -337,7 +290,7 @@ const Eigen::MatrixXd & CoMJacobian::jacobianDot(const MultiBody & mb, const Mul
       sva::MotionVecd E_Vb(mbc.bodyVelW[b].angular(), Eigen::Vector3d::Zero());
       sva::MotionVecd X_Vcom_i_com = X_i_com * mbc.bodyVelB[i] - bodiesCoMVelB_[b];
 
-      for(int dof = 0; dof < joints[i].dof(); ++dof)
+      for(int dof = 0; dof < joints[i].dof; ++dof)
       {
         sva::MotionVecd S_ij(mbc.motionSubspace[i].col(dof));
 
@@ -349,12 +302,37 @@ const Eigen::MatrixXd & CoMJacobian::jacobianDot(const MultiBody & mb, const Mul
             * bodiesCoeff_[b];
       }
     }
-    curJ += joints[i].dof();
+    curJ += joints[i].dof;
   }
 
   return jacDot_;
 }
 
+const Eigen::MatrixXd & CoMJacobian::updateJacobian(const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  // the inertia refresh invalidate the cached jacobians
+  checkInertialParameters(mb);
+  if(!ConfigStamps::same(jacPositionStamp_, mbc.stamps.position))
+  {
+    jacobian(mb, mbc);
+    jacPositionStamp_ = mbc.stamps.position;
+  }
+  return jac_;
+}
+
+const Eigen::MatrixXd & CoMJacobian::updateJacobianDot(const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  checkInertialParameters(mb);
+  if(!ConfigStamps::same(jacDotPositionStamp_, mbc.stamps.position)
+     || !ConfigStamps::same(jacDotVelocityStamp_, mbc.stamps.velocity))
+  {
+    jacobianDot(mb, mbc);
+    jacDotPositionStamp_ = mbc.stamps.position;
+    jacDotVelocityStamp_ = mbc.stamps.velocity;
+  }
+  return jacDot_;
+}
+
 Eigen::Vector3d CoMJacobian::velocity(const MultiBody & mb, const MultiBodyConfig & mbc) const
 {
   Eigen::Vector3d comV = Eigen::Vector3d::Zero();
@@ -373,6 +351,7 @@ Eigen::Vector3d CoMJacobian::velocity(const MultiBody & mb, const MultiBodyConfi
 
 Eigen::Vector3d CoMJacobian::normalAcceleration(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
+  checkInertialParameters(mb);
   const std::vector<int> & pred = mb.predecessors();
   const std::vector<int> & succ = mb.successors();
 
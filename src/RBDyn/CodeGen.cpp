@@ -0,0 +1,853 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// associated header
+#include "RBDyn/CodeGen.h"
+
+// includes
+// std
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+// RBDyn
+#include "RBDyn/MultiBody.h"
+
+namespace rbd
+{
+
+namespace
+{
+
+typedef std::vector<std::pair<double, std::string>> Terms;
+
+/// Double literal that round trip and is always parsed as a double.
+std::string num(double v)
+{
+  std::ostringstream str;
+  str.imbue(std::locale::classic());
+  str << std::setprecision(17) << v;
+  std::string res = str.str();
+  if(res.find_first_of(".en") == std::string::npos)
+  {
+    res += ".";
+  }
+  return res;
+}
+
+/// Linear combination of symbols, the null coefficients are folded.
+/// An empty symbol is the constant term.
+std::string lin(const Terms & terms)
+{
+  std::string res;
+  for(const auto & t : terms)
+  {
+    if(t.first == 0.)
+    {
+      continue;
+    }
+    const double a = std::abs(t.first);
+    std::string term;
+    if(t.second.empty())
+    {
+      term = num(a);
+    }
+    else if(a == 1.)
+    {
+      term = t.second;
+    }
+    else
+    {
+      term = num(a) + " * " + t.second;
+    }
+
+    if(res.empty())
+    {
+      res = t.first < 0. ? "-" + term : term;
+    }
+    else
+    {
+      res += (t.first < 0. ? " - " : " + ") + term;
+    }
+  }
+  return res.empty() ? "0." : res;
+}
+
+std::string index(const std::string & var, int i)
+{
+  return var + "(" + std::to_string(i) + ")";
+}
+
+std::string vec3(const Eigen::Vector3d & v)
+{
+  if(v.isZero(0.))
+  {
+    return "Eigen::Vector3d::Zero()";
+  }
+  return "Eigen::Vector3d(" + num(v.x()) + ", " + num(v.y()) + ", " + num(v.z()) + ")";
+}
+
+std::string mat3(const Eigen::Matrix3d & m)
+{
+  if(m.isIdentity(0.))
+  {
+    return "Eigen::Matrix3d::Identity()";
+  }
+  std::string res = "(Eigen::Matrix3d() << ";
+  for(int r = 0; r < 3; ++r)
+  {
+    for(int c = 0; c < 3; ++c)
+    {
+      res += num(m(r, c)) + (r == 2 && c == 2 ? "" : ", ");
+    }
+  }
+  return res + ").finished()";
+}
+
+/// Constant motion vector of the column dof of S.
+std::string motionCol(const Eigen::MatrixXd & S, int dof)
+{
+  return "sva::MotionVecd(" + vec3(S.col(dof).head<3>()) + ", " + vec3(S.col(dof).tail<3>()) + ")";
+}
+
+/// Motion vector S*var.segment(pos, S.cols()).
+std::string motion(const Eigen::MatrixXd & S, const std::string & var, int pos)
+{
+  std::string comp[6];
+  for(int r = 0; r < 6; ++r)
+  {
+    Terms terms;
+    for(int dof = 0; dof < S.cols(); ++dof)
+    {
+      terms.emplace_back(S(r, dof), index(var, pos + dof));
+    }
+    comp[r] = lin(terms);
+  }
+  return "sva::MotionVecd(Eigen::Vector3d(" + comp[0] + ", " + comp[1] + ", " + comp[2] + "), Eigen::Vector3d("
+         + comp[3] + ", " + comp[4] + ", " + comp[5] + "))";
+}
+
+/// S.col(dof)^T f for a force vector variable f.
+std::string project(const Eigen::MatrixXd & S, int dof, const std::string & f)
+{
+  static const char * comp[6] = {".couple().x()", ".couple().y()", ".couple().z()",
+                                 ".force().x()",  ".force().y()",  ".force().z()"};
+  Terms terms;
+  for(int r = 0; r < 6; ++r)
+  {
+    terms.emplace_back(S(r, dof), f + comp[r]);
+  }
+  return lin(terms);
+}
+
+/// Constant 6 x dof matrix.
+std::string matS(const Eigen::MatrixXd & S)
+{
+  std::string type = "Eigen::Matrix<double, 6, " + std::to_string(S.cols()) + ">";
+  std::string res = "(" + type + "() << ";
+  for(int r = 0; r < 6; ++r)
+  {
+    for(int c = 0; c < S.cols(); ++c)
+    {
+      res += num(S(r, c)) + (r == 5 && c == S.cols() - 1 ? "" : ", ");
+    }
+  }
+  return res + ").finished()";
+}
+
+std::string sign(const std::string & v)
+{
+  return "((" + v + " > 0.) - (" + v + " < 0.))";
+}
+
+/// Joint friction torque of the dof at pos.
+std::string frictionTorque(const Joint & j, int pos)
+{
+  const std::string alpha = index("alpha", pos);
+  return lin({{j.damping(), alpha}, {j.friction(), sign(alpha)}});
+}
+
+bool validNameSpace(const std::string & ns)
+{
+  std::size_t start = 0;
+  while(true)
+  {
+    std::size_t end = ns.find("::", start);
+    std::string id = ns.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    if(id.empty() || std::isdigit(static_cast<unsigned char>(id[0])))
+    {
+      return false;
+    }
+    for(char c : id)
+    {
+      if(!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+      {
+        return false;
+      }
+    }
+    if(end == std::string::npos)
+    {
+      return true;
+    }
+    start = end + 2;
+  }
+}
+
+std::vector<std::string> splitNameSpace(const std::string & ns)
+{
+  std::vector<std::string> res;
+  std::size_t start = 0;
+  std::size_t end;
+  while((end = ns.find("::", start)) != std::string::npos)
+  {
+    res.push_back(ns.substr(start, end - start));
+    start = end + 2;
+  }
+  res.push_back(ns.substr(start));
+  return res;
+}
+
+std::string jointTypeName(Joint::Type type)
+{
+  switch(type)
+  {
+    case Joint::Rev:
+      return "Rev";
+    case Joint::Prism:
+      return "Prism";
+    case Joint::Spherical:
+      return "Spherical";
+    case Joint::Planar:
+      return "Planar";
+    case Joint::Cylindrical:
+      return "Cylindrical";
+    case Joint::Free:
+      return "Free";
+    case Joint::Fixed:
+    default:
+      return "Fixed";
+  }
+}
+
+/// Code generator state shared by the generated functions.
+class Generator
+{
+public:
+  Generator(const MultiBody & mb, std::ostream & out)
+  : mb_(mb), out_(out), pred_(mb.predecessors()), hasChild_(static_cast<std::size_t>(mb.nrBodies()), false)
+  {
+    for(int p : pred_)
+    {
+      if(p != -1)
+      {
+        hasChild_[static_cast<std::size_t>(p)] = true;
+      }
+    }
+  }
+
+  void constants()
+  {
+    out_ << "namespace detail\n{\n\n";
+    out_ << "// body inertias\n";
+    for(int i = 0; i < mb_.nrBodies(); ++i)
+    {
+      const sva::RBInertiad & I = mb_.body(i).inertia();
+      out_ << "const sva::RBInertiad I_" << i << "(" << num(I.mass()) << ", " << vec3(I.momentum()) << ", "
+           << mat3(I.inertia()) << ");\n";
+    }
+    out_ << "\n// joint motion subspaces\n";
+    for(int i = 0; i < mb_.nrBodies(); ++i)
+    {
+      const Joint & j = mb_.joint(i);
+      if(j.dof() != 0)
+      {
+        out_ << "const Eigen::Matrix<double, 6, " << j.dof() << "> S_" << i << " = " << matS(j.motionSubspace())
+             << ";\n";
+      }
+    }
+    out_ << "\n} // namespace detail\n\n";
+  }
+
+  void forwardKinematics()
+  {
+    out_ << "/// Compute parentToSon and bodyPosW (@see rbd::forwardKinematics).\n";
+    out_ << "inline void forwardKinematics(const VectorQ & q, Kinematics & kin)\n{\n";
+    if(mb_.nrParams() == 0)
+    {
+      out_ << "  static_cast<void>(q);\n";
+    }
+    for(int i = 0; i < mb_.nrBodies(); ++i)
+    {
+      parentToSon(i);
+      if(pred_[i] == -1)
+      {
+        out_ << "  kin.bodyPosW[" << i << "] = kin.parentToSon[" << i << "];\n";
+      }
+      else
+      {
+        out_ << "  kin.bodyPosW[" << i << "] = kin.parentToSon[" << i << "] * kin.bodyPosW[" << pred_[i] << "];\n";
+      }
+    }
+    out_ << "}\n\n";
+  }
+
+  void forwardVelocity()
+  {
+    out_ << "/**\n * Compute bodyVelB (@see rbd::forwardVelocity).\n";
+    out_ << " * parentToSon must have been computed by forwardKinematics.\n */\n";
+    out_ << "inline void forwardVelocity(const VectorV & alpha, Kinematics & kin)\n{\n";
+    if(mb_.nrDof() == 0)
+    {
+      out_ << "  static_cast<void>(alpha);\n";
+    }
+    for(int i = 0; i < mb_.nrBodies(); ++i)
+    {
+      const Joint & j = mb_.joint(i);
+      const int pos = mb_.jointPosInDof(i);
+      out_ << "  kin.bodyVelB[" << i << "] = ";
+      if(pred_[i] == -1)
+      {
+        out_ << (j.dof() != 0 ? motion(j.motionSubspace(), "alpha", pos) : "sva::MotionVecd::Zero()");
+      }
+      else
+      {
+        out_ << "kin.parentToSon[" << i << "] * kin.bodyVelB[" << pred_[i] << "]";
+        if(j.dof() != 0)
+        {
+          out_ << "\n                     + " << motion(j.motionSubspace(), "alpha", pos);
+        }
+      }
+      out_ << ";\n";
+    }
+    out_ << "}\n\n";
+  }
+
+  void jacobian(int body)
+  {
+    std::vector<int> path;
+    for(int i = body; i != -1; i = pred_[i])
+    {
+      path.insert(path.begin(), i);
+    }
+
+    out_ << "template<>\ninline void jacobian<" << body << ">(const Kinematics & kin, MatrixJ & jac)\n{\n";
+    out_ << "  // " << mb_.body(body).name() << "\n";
+    out_ << "  jac.setZero();\n";
+    out_ << "  const sva::PTransformd X_0_N(kin.bodyPosW[" << body << "].translation());\n";
+    for(int i : path)
+    {
+      const Joint & j = mb_.joint(i);
+      if(j.dof() == 0)
+      {
+        continue;
+      }
+      out_ << "  {\n";
+      out_ << "    const sva::PTransformd X_i_N = X_0_N * kin.bodyPosW[" << i << "].inv();\n";
+      for(int dof = 0; dof < j.dof(); ++dof)
+      {
+        out_ << "    jac.col(" << mb_.jointPosInDof(i) + dof << ") = (X_i_N * " << motionCol(j.motionSubspace(), dof)
+             << ").vector();\n";
+      }
+      out_ << "  }\n";
+    }
+    out_ << "}\n\n";
+  }
+
+  void inverseDynamics()
+  {
+    out_ << "/**\n * Recursive Newton-Euler algorithm (@see rbd::InverseDynamics::inverseDynamics).\n";
+    out_ << " * kin must have been computed by forwardKinematics and forwardVelocity.\n";
+    out_ << " * @param gravity Gravity acceleration (@see rbd::MultiBodyConfig::gravity).\n */\n";
+    out_ << "inline void inverseDynamics(const Kinematics & kin,\n"
+            "                            const VectorV & alpha,\n"
+            "                            const VectorV & alphaD,\n"
+            "                            const Eigen::Vector3d & gravity,\n"
+            "                            VectorV & torque)\n{\n";
+    if(mb_.nrDof() == 0)
+    {
+      out_ << "  static_cast<void>(alpha);\n  static_cast<void>(alphaD);\n  static_cast<void>(torque);\n";
+    }
+    out_ << "  const sva::MotionVecd a_g(Eigen::Vector3d::Zero(), gravity);\n\n";
+    for(int i = 0; i < mb_.nrBodies(); ++i)
+    {
+      const Joint & j = mb_.joint(i);
+      const int pos = mb_.jointPosInDof(i);
+      out_ << "  const sva::MotionVecd a_" << i << " = kin.parentToSon[" << i << "] * "
+           << (pred_[i] == -1 ? std::string("a_g") : "a_" + std::to_string(pred_[i]));
+      if(j.dof() != 0)
+      {
+        out_ << "\n    + " << motion(j.motionSubspace(), "alphaD", pos) << "\n    + kin.bodyVelB[" << i
+             << "].cross(" << motion(j.motionSubspace(), "alpha", pos) << ")";
+      }
+      out_ << ";\n";
+      out_ << "  sva::ForceVecd f_" << i << " = detail::I_" << i << " * a_" << i << " + kin.bodyVelB[" << i
+           << "].crossDual(detail::I_" << i << " * kin.bodyVelB[" << i << "]);\n";
+    }
+    out_ << "\n";
+    for(int i = mb_.nrBodies() - 1; i >= 0; --i)
+    {
+      const Joint & j = mb_.joint(i);
+      const int pos = mb_.jointPosInDof(i);
+      const std::string f = "f_" + std::to_string(i);
+      for(int dof = 0; dof < j.dof(); ++dof)
+      {
+        Terms actuator;
+        actuator.emplace_back(j.armature(), index("alphaD", pos + dof));
+        out_ << "  torque(" << pos + dof << ") = " << project(j.motionSubspace(), dof, f);
+        if(j.armature() != 0.)
+        {
+          out_ << " + " << lin(actuator);
+        }
+        if(j.damping() != 0. || j.friction() != 0.)
+        {
+          out_ << " + " << frictionTorque(j, pos + dof);
+        }
+        out_ << ";\n";
+      }
+      if(pred_[i] != -1)
+      {
+        out_ << "  f_" << pred_[i] << " = f_" << pred_[i] << " + kin.parentToSon[" << i << "].transMul(" << f
+             << ");\n";
+      }
+    }
+    out_ << "}\n\n";
+  }
+
+  void massMatrix()
+  {
+    out_ << "/**\n * Composite rigid body algorithm (@see rbd::ForwardDynamics::computeH).\n";
+    out_ << " * kin must have been computed by forwardKinematics.\n */\n";
+    out_ << "inline void massMatrix(const Kinematics & kin, MatrixH & H)\n{\n";
+    out_ << "  H.setZero();\n";
+    for(int i = 0; i < mb_.nrBodies(); ++i)
+    {
+      if(hasChild_[static_cast<std::size_t>(i)] || mb_.joint(i).dof() != 0)
+      {
+        out_ << "  sva::RBInertiad Ic_" << i << " = detail::I_" << i << ";\n";
+      }
+    }
+    out_ << "\n";
+    for(int i = mb_.nrBodies() - 1; i >= 0; --i)
+    {
+      const Joint & ji = mb_.joint(i);
+      const int posI = mb_.jointPosInDof(i);
+      if(pred_[i] != -1 && (hasChild_[static_cast<std::size_t>(i)] || ji.dof() != 0))
+      {
+        out_ << "  Ic_" << pred_[i] << " += kin.parentToSon[" << i << "].transMul(Ic_" << i << ");\n";
+      }
+      if(ji.dof() == 0)
+      {
+        continue;
+      }
+
+      out_ << "  {\n";
+      for(int dof = 0; dof < ji.dof(); ++dof)
+      {
+        out_ << "    sva::ForceVecd F_" << dof << " = Ic_" << i << " * " << motionCol(ji.motionSubspace(), dof)
+             << ";\n";
+      }
+      for(int r = 0; r < ji.dof(); ++r)
+      {
+        for(int c = 0; c < ji.dof(); ++c)
+        {
+          out_ << "    H(" << posI + r << ", " << posI + c
+               << ") = " << project(ji.motionSubspace(), r, "F_" + std::to_string(c));
+          if(r == c && ji.armature() != 0.)
+          {
+            out_ << " + " << num(ji.armature());
+          }
+          out_ << ";\n";
+        }
+      }
+
+      for(int j = i; pred_[j] != -1; j = pred_[j])
+      {
+        for(int dof = 0; dof < ji.dof(); ++dof)
+        {
+          out_ << "    F_" << dof << " = kin.parentToSon[" << j << "].transMul(F_" << dof << ");\n";
+        }
+        const Joint & jp = mb_.joint(pred_[j]);
+        const int posP = mb_.jointPosInDof(pred_[j]);
+        for(int r = 0; r < ji.dof(); ++r)
+        {
+          for(int c = 0; c < jp.dof(); ++c)
+          {
+            out_ << "    H(" << posI + r << ", " << posP + c
+                 << ") = " << project(jp.motionSubspace(), c, "F_" + std::to_string(r)) << ";\n";
+            out_ << "    H(" << posP + c << ", " << posI + r << ") = H(" << posI + r << ", " << posP + c << ");\n";
+          }
+        }
+      }
+      out_ << "  }\n";
+    }
+    out_ << "}\n\n";
+  }
+
+  void forwardDynamics()
+  {
+    out_ << "/**\n * Articulated body algorithm (@see rbd::ForwardDynamics::forwardDynamics).\n";
+    out_ << " * kin must have been computed by forwardKinematics and forwardVelocity.\n";
+    out_ << " * @param gravity Gravity acceleration (@see rbd::MultiBodyConfig::gravity).\n */\n";
+    out_ << "inline void forwardDynamics(const Kinematics & kin,\n"
+            "                            const VectorV & alpha,\n"
+            "                            const VectorV & torque,\n"
+            "                            const Eigen::Vector3d & gravity,\n"
+            "                            VectorV & alphaD)\n{\n";
+    if(mb_.nrDof() == 0)
+    {
+      out_ << "  static_cast<void>(alpha);\n  static_cast<void>(torque);\n  static_cast<void>(alphaD);\n";
+    }
+    out_ << "  typedef Eigen::Matrix<double, 6, 6> Matrix6;\n";
+    out_ << "  typedef Eigen::Matrix<double, 6, 1> Vector6;\n";
+    out_ << "  const sva::MotionVecd a_g(Eigen::Vector3d::Zero(), gravity);\n\n";
+
+    out_ << "  // articulated inertias and bias forces\n";
+    for(int i = 0; i < mb_.nrBodies(); ++i)
+    {
+      const Joint & j = mb_.joint(i);
+      out_ << "  Matrix6 IA_" << i << " = detail::I_" << i << ".matrix();\n";
+      out_ << "  Vector6 pA_" << i << " = kin.bodyVelB[" << i << "].crossDual(detail::I_" << i << " * kin.bodyVelB["
+           << i << "]).vector();\n";
+      if(j.dof() != 0)
+      {
+        out_ << "  const sva::MotionVecd c_" << i << " = kin.bodyVelB[" << i << "].cross("
+             << motion(j.motionSubspace(), "alpha", mb_.jointPosInDof(i)) << ");\n";
+      }
+    }
+
+    out_ << "\n";
+    for(int i = mb_.nrBodies() - 1; i >= 0; --i)
+    {
+      const Joint & j = mb_.joint(i);
+      const int pos = mb_.jointPosInDof(i);
+      const std::string id = std::to_string(i);
+      const std::string dof = std::to_string(j.dof());
+      if(j.dof() != 0)
+      {
+        const std::string vecD = "Eigen::Matrix<double, " + dof + ", 1>";
+        const std::string matD = "Eigen::Matrix<double, " + dof + ", " + dof + ">";
+        out_ << "  const Eigen::Matrix<double, 6, " << dof << "> U_" << id << " = IA_" << id << " * detail::S_" << id
+             << ";\n";
+        out_ << "  " << matD << " D_" << id << " = detail::S_" << id << ".transpose() * U_" << id << ";\n";
+        if(j.armature() != 0.)
+        {
+          out_ << "  D_" << id << ".diagonal().array() += " << num(j.armature()) << ";\n";
+        }
+        out_ << "  const " << matD << " Dinv_" << id << " = D_" << id << ".inverse();\n";
+        out_ << "  const " << vecD << " u_" << id << " = torque.segment<" << dof << ">(" << pos << ") - detail::S_"
+             << id << ".transpose() * pA_" << id;
+        if(j.damping() != 0. || j.friction() != 0.)
+        {
+          out_ << "\n    - (" << vecD << "() << ";
+          for(int d = 0; d < j.dof(); ++d)
+          {
+            out_ << frictionTorque(j, pos + d) << (d + 1 == j.dof() ? "" : ", ");
+          }
+          out_ << ").finished()";
+        }
+        out_ << ";\n";
+      }
+
+      if(pred_[i] != -1)
+      {
+        const std::string p = std::to_string(pred_[i]);
+        out_ << "  {\n";
+        out_ << "    const Matrix6 X = kin.parentToSon[" << id << "].matrix();\n";
+        if(j.dof() != 0)
+        {
+          out_ << "    const Matrix6 Ia = IA_" << id << " - U_" << id << " * Dinv_" << id << " * U_" << id
+               << ".transpose();\n";
+          out_ << "    const Vector6 pa = pA_" << id << " + Ia * c_" << id << ".vector() + U_" << id << " * (Dinv_"
+               << id << " * u_" << id << ");\n";
+          out_ << "    IA_" << p << ".noalias() += X.transpose() * Ia * X;\n";
+          out_ << "    pA_" << p << ".noalias() += X.transpose() * pa;\n";
+        }
+        else
+        {
+          out_ << "    IA_" << p << ".noalias() += X.transpose() * IA_" << id << " * X;\n";
+          out_ << "    pA_" << p << ".noalias() += X.transpose() * pA_" << id << ";\n";
+        }
+        out_ << "  }\n";
+      }
+    }
+
+    out_ << "\n";
+    for(int i = 0; i < mb_.nrBodies(); ++i)
+    {
+      const Joint & j = mb_.joint(i);
+      const int pos = mb_.jointPosInDof(i);
+      const std::string id = std::to_string(i);
+      const bool child = hasChild_[static_cast<std::size_t>(i)];
+      if(j.dof() == 0 && !child)
+      {
+        continue;
+      }
+      out_ << "  const sva::MotionVecd ap_" << id << " = kin.parentToSon[" << id << "] * "
+           << (pred_[i] == -1 ? std::string("a_g") : "a_" + std::to_string(pred_[i]));
+      if(j.dof() != 0)
+      {
+        out_ << " + c_" << id;
+      }
+      out_ << ";\n";
+      if(j.dof() != 0)
+      {
+        out_ << "  alphaD.segment<" << j.dof() << ">(" << pos << ") = Dinv_" << id << " * (u_" << id << " - U_" << id
+             << ".transpose() * ap_" << id << ".vector());\n";
+      }
+      if(child)
+      {
+        out_ << "  const sva::MotionVecd a_" << id << " = ap_" << id;
+        if(j.dof() != 0)
+        {
+          out_ << " + " << motion(j.motionSubspace(), "alphaD", pos);
+        }
+        out_ << ";\n";
+      }
+    }
+    out_ << "}\n\n";
+  }
+
+private:
+  void parentToSon(int i)
+  {
+    const Joint & j = mb_.joint(i);
+    const sva::PTransformd & Xt = mb_.transform(i);
+    const Eigen::MatrixXd & S = j.motionSubspace();
+    const int pos = mb_.jointPosInParam(i);
+    const std::string X = "  kin.parentToSon[" + std::to_string(i) + "]";
+    const std::string dir = j.direction() == 1. ? "" : "-";
+    const bool XtIdentity = Xt.rotation().isIdentity(0.) && Xt.translation().isZero(0.);
+
+    out_ << "  // " << j.name() << " (" << jointTypeName(j.type()) << ")\n";
+    switch(j.type())
+    {
+      case Joint::Rev:
+      {
+        // AngleAxis(-q, a) = a a^T + (I - a a^T) cos(q) - [a]x sin(q)
+        const Eigen::Vector3d a = S.col(0).head<3>();
+        const Eigen::Matrix3d A = (a * a.transpose()) * Xt.rotation();
+        const Eigen::Matrix3d B = (Eigen::Matrix3d::Identity() - a * a.transpose()) * Xt.rotation();
+        const Eigen::Matrix3d C = -sva::vector3ToCrossMatrix(a) * Xt.rotation();
+        out_ << "  {\n";
+        out_ << "    const double c = std::cos(" << index("q", pos) << ");\n";
+        out_ << "    const double s = std::sin(" << index("q", pos) << ");\n";
+        out_ << "  " << X << " = sva::PTransformd((Eigen::Matrix3d() << ";
+        for(int r = 0; r < 3; ++r)
+        {
+          for(int c = 0; c < 3; ++c)
+          {
+            out_ << lin({{A(r, c), ""}, {B(r, c), "c"}, {C(r, c), "s"}}) << (r == 2 && c == 2 ? "" : ", ");
+          }
+        }
+        out_ << ").finished(),\n                                          " << vec3(Xt.translation()) << ");\n";
+        out_ << "  }\n";
+        break;
+      }
+      case Joint::Prism:
+      {
+        const Eigen::Vector3d a = Xt.rotation().transpose() * S.col(0).tail<3>();
+        const std::string q = index("q", pos);
+        out_ << X << " = sva::PTransformd(" << mat3(Xt.rotation()) << ", Eigen::Vector3d("
+             << lin({{Xt.translation().x(), ""}, {a.x(), q}}) << ", " << lin({{Xt.translation().y(), ""}, {a.y(), q}})
+             << ", " << lin({{Xt.translation().z(), ""}, {a.z(), q}}) << "));\n";
+        break;
+      }
+      case Joint::Fixed:
+        out_ << X << " = sva::PTransformd(" << mat3(Xt.rotation()) << ", " << vec3(Xt.translation()) << ");\n";
+        break;
+      default:
+      {
+        out_ << "  {\n";
+        switch(j.type())
+        {
+          case Joint::Spherical:
+            out_ << "    const sva::PTransformd X_j(Eigen::Quaterniond(" << index("q", pos) << ", " << dir
+                 << index("q", pos + 1) << ", " << dir << index("q", pos + 2) << ", " << dir << index("q", pos + 3)
+                 << ").inverse());\n";
+            break;
+          case Joint::Planar:
+            out_ << "    const Eigen::Matrix3d rot = sva::RotZ(" << index("q", pos) << ");\n";
+            out_ << "    const sva::PTransformd X_j = sva::PTransformd(rot, rot.transpose() * Eigen::Vector3d("
+                 << index("q", pos + 1) << ", " << index("q", pos + 2) << ", 0.))" << (dir.empty() ? "" : ".inv()")
+                 << ";\n";
+            break;
+          case Joint::Cylindrical:
+            out_ << "    const sva::PTransformd X_j(Eigen::AngleAxisd(-" << index("q", pos) << ", "
+                 << vec3(S.col(0).head<3>()) << ").matrix(),\n";
+            out_ << "                               " << vec3(S.col(1).tail<3>()) << " * " << index("q", pos + 1)
+                 << ");\n";
+            break;
+          case Joint::Free:
+          default:
+            // same expression than rbd::QuatToE
+            out_ << "    const double p0 = " << index("q", pos) << ", p1 = " << index("q", pos + 1)
+                 << ", p2 = " << index("q", pos + 2) << ", p3 = " << index("q", pos + 3) << ";\n";
+            out_ << "    const Eigen::Matrix3d rot = 2. * (Eigen::Matrix3d() <<\n"
+                    "      p0 * p0 + p1 * p1 - 0.5, p1 * p2 + p0 * p3, p1 * p3 - p0 * p2,\n"
+                    "      p1 * p2 - p0 * p3, p0 * p0 + p2 * p2 - 0.5, p2 * p3 + p0 * p1,\n"
+                    "      p1 * p3 + p0 * p2, p2 * p3 - p0 * p1, p0 * p0 + p3 * p3 - 0.5).finished();\n";
+            out_ << "    const sva::PTransformd X_j = sva::PTransformd(rot, Eigen::Vector3d(" << index("q", pos + 4)
+                 << ", " << index("q", pos + 5) << ", " << index("q", pos + 6) << "))"
+                 << (dir.empty() ? "" : ".inv()") << ";\n";
+            break;
+        }
+        if(XtIdentity)
+        {
+          out_ << "  " << X << " = X_j;\n";
+        }
+        else
+        {
+          out_ << "  " << X << " = X_j * sva::PTransformd(" << mat3(Xt.rotation()) << ", " << vec3(Xt.translation())
+               << ");\n";
+        }
+        out_ << "  }\n";
+        break;
+      }
+    }
+  }
+
+private:
+  const MultiBody & mb_;
+  std::ostream & out_;
+  const std::vector<int> & pred_;
+  std::vector<bool> hasChild_;
+};
+
+} // namespace
+
+std::string generateCode(const MultiBody & mb,
+                         const std::string & nameSpace,
+                         const std::vector<std::string> & jacobianBodies)
+{
+  if(!validNameSpace(nameSpace))
+  {
+    std::ostringstream str;
+    str << "Invalid namespace: " << nameSpace;
+    throw std::domain_error(str.str());
+  }
+
+  std::vector<int> jacBodies;
+  for(const std::string & name : jacobianBodies)
+  {
+    if(mb.bodyIndexByName().count(name) == 0)
+    {
+      std::ostringstream str;
+      str << "Body " << name << " is not in the MultiBody";
+      throw std::domain_error(str.str());
+    }
+    jacBodies.push_back(mb.bodyIndexByName(name));
+  }
+
+  std::ostringstream out;
+  out.imbue(std::locale::classic());
+  Generator gen(mb, out);
+
+  out << "/*\n * Generated by rbd::generateCode, do not edit.\n *\n";
+  out << " * index: body, joint (type), param position, dof position\n";
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    out << " * " << i << ": " << mb.body(i).name() << ", " << mb.joint(i).name() << " ("
+        << jointTypeName(mb.joint(i).type()) << "), " << mb.jointPosInParam(i) << ", " << mb.jointPosInDof(i) << "\n";
+  }
+  out << " */\n\n";
+  out << "#pragma once\n\n";
+  out << "// includes\n// std\n#include <array>\n#include <cmath>\n\n";
+  out << "// Eigen\n#include <Eigen/LU>\n\n";
+  out << "// SpaceVecAlg\n#include <SpaceVecAlg/SpaceVecAlg>\n\n";
+
+  const std::vector<std::string> nss = splitNameSpace(nameSpace);
+  for(const std::string & ns : nss)
+  {
+    out << "namespace " << ns << "\n{\n";
+  }
+  out << "\n";
+
+  out << "constexpr int nrBodies = " << mb.nrBodies() << ";\n";
+  out << "constexpr int nrParams = " << mb.nrParams() << ";\n";
+  out << "constexpr int nrDof = " << mb.nrDof() << ";\n\n";
+  out << "typedef Eigen::Matrix<double, nrParams, 1> VectorQ;\n";
+  out << "typedef Eigen::Matrix<double, nrDof, 1> VectorV;\n";
+  out << "typedef Eigen::Matrix<double, nrDof, nrDof> MatrixH;\n";
+  out << "typedef Eigen::Matrix<double, 6, nrDof> MatrixJ;\n\n";
+
+  out << "/// Kinematic state, same meaning than the MultiBodyConfig members of the same name.\n";
+  out << "struct Kinematics\n{\n";
+  out << "  std::array<sva::PTransformd, nrBodies> parentToSon;\n";
+  out << "  std::array<sva::PTransformd, nrBodies> bodyPosW;\n";
+  out << "  std::array<sva::MotionVecd, nrBodies> bodyVelB;\n";
+  out << "};\n\n";
+
+  gen.constants();
+  gen.forwardKinematics();
+  gen.forwardVelocity();
+
+  out << "/**\n * Jacobian of the Body origin (@see rbd::Jacobian::jacobian).\n";
+  out << " * Only the bodies given to the generator are specialized.\n */\n";
+  out << "template<int Body>\nvoid jacobian(const Kinematics & kin, MatrixJ & jac);\n\n";
+  for(int b : jacBodies)
+  {
+    gen.jacobian(b);
+  }
+  out << "/**\n * Jacobian of the Body origin selected at runtime.\n";
+  out << " * @return False if the jacobian of body has not been generated.\n */\n";
+  out << "inline bool jacobian(int body, const Kinematics & kin, MatrixJ & jac)\n{\n";
+  out << "  switch(body)\n  {\n";
+  for(int b : jacBodies)
+  {
+    out << "    case " << b << ":\n      jacobian<" << b << ">(kin, jac);\n      return true;\n";
+  }
+  out << "    default:\n      static_cast<void>(kin);\n      static_cast<void>(jac);\n      return false;\n  }\n}\n\n";
+
+  gen.inverseDynamics();
+  gen.massMatrix();
+  gen.forwardDynamics();
+
+  out << "/// Model functions as static members, to write code templated on the model.\n";
+  out << "struct Model\n{\n";
+  out << "  enum\n  {\n";
+  out << "    nrBodies = " << mb.nrBodies() << ",\n";
+  out << "    nrParams = " << mb.nrParams() << ",\n";
+  out << "    nrDof = " << mb.nrDof() << "\n";
+  out << "  };\n";
+  out << "  typedef " << nameSpace << "::VectorQ VectorQ;\n";
+  out << "  typedef " << nameSpace << "::VectorV VectorV;\n";
+  out << "  typedef " << nameSpace << "::MatrixH MatrixH;\n";
+  out << "  typedef " << nameSpace << "::MatrixJ MatrixJ;\n";
+  out << "  typedef " << nameSpace << "::Kinematics Kinematics;\n\n";
+  out << "  static void forwardKinematics(const VectorQ & q, Kinematics & kin)\n  {\n";
+  out << "    " << nameSpace << "::forwardKinematics(q, kin);\n  }\n\n";
+  out << "  static void forwardVelocity(const VectorV & alpha, Kinematics & kin)\n  {\n";
+  out << "    " << nameSpace << "::forwardVelocity(alpha, kin);\n  }\n\n";
+  out << "  template<int Body>\n  static void jacobian(const Kinematics & kin, MatrixJ & jac)\n  {\n";
+  out << "    " << nameSpace << "::jacobian<Body>(kin, jac);\n  }\n\n";
+  out << "  static bool jacobian(int body, const Kinematics & kin, MatrixJ & jac)\n  {\n";
+  out << "    return " << nameSpace << "::jacobian(body, kin, jac);\n  }\n\n";
+  out << "  static void inverseDynamics(const Kinematics & kin,\n"
+         "                              const VectorV & alpha,\n"
+         "                              const VectorV & alphaD,\n"
+         "                              const Eigen::Vector3d & gravity,\n"
+         "                              VectorV & torque)\n  {\n";
+  out << "    " << nameSpace << "::inverseDynamics(kin, alpha, alphaD, gravity, torque);\n  }\n\n";
+  out << "  static void massMatrix(const Kinematics & kin, MatrixH & H)\n  {\n";
+  out << "    " << nameSpace << "::massMatrix(kin, H);\n  }\n\n";
+  out << "  static void forwardDynamics(const Kinematics & kin,\n"
+         "                              const VectorV & alpha,\n"
+         "                              const VectorV & torque,\n"
+         "                              const Eigen::Vector3d & gravity,\n"
+         "                              VectorV & alphaD)\n  {\n";
+  out << "    " << nameSpace << "::forwardDynamics(kin, alpha, torque, gravity, alphaD);\n  }\n";
+  out << "};\n\n";
+
+  for(auto it = nss.rbegin(); it != nss.rend(); ++it)
+  {
+    out << "} // namespace " << *it << "\n";
+  }
+  return out.str();
+}
+
+} // namespace rbd
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// associated header
+#include "RBDyn/CompiledMultiBody.h"
+
+// includes
+// std
+#include <sstream>
+#include <stdexcept>
+
+// RBDyn
+#include "RBDyn/MultiBodyConfig.h"
+
+namespace rbd
+{
+
+namespace
+{
+
+template<typename T>
+void checkSizes(const std::vector<std::vector<T>> & vec, const std::vector<int> & sizes, const std::string & name)
+{
+  if(vec.size() != sizes.size())
+  {
+    std::ostringstream str;
+    str << name << " size mismatch: expected " << sizes.size() << " gived " << vec.size();
+    throw std::domain_error(str.str());
+  }
+
+  for(std::size_t i = 0; i < vec.size(); ++i)
+  {
+    if(static_cast<int>(vec[i].size()) != sizes[i])
+    {
+      std::ostringstream str;
+      str << name << "[" << i << "] size mismatch: expected " << sizes[i] << " gived " << vec[i].size();
+      throw std::domain_error(str.str());
+    }
+  }
+}
+
+} // namespace
+
+CompiledMultiBody::CompiledMultiBody(const MultiBody & mb)
+: frames_(static_cast<std::size_t>(mb.nrBodies())), originalParams_(static_cast<std::size_t>(mb.nrJoints())),
+  originalDof_(static_cast<std::size_t>(mb.nrJoints()))
+{
+  std::vector<Body> bodies;
+  std::vector<sva::RBInertiad> inertias;
+  std::vector<Joint> joints;
+  std::vector<int> pred, succ, parent;
+  std::vector<sva::PTransformd> Xt;
+
+  // joint i move body i and a parent index is always lower than its children index,
+  // so the owner of the parent body is always known
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    const Joint & joint = mb.joint(i);
+    const int p = mb.parent(i);
+    Frame & f = frames_[i];
+    f.name = mb.body(i).name();
+    frameNameToInd_[f.name] = i;
+    originalParams_[i] = joint.params();
+    originalDof_[i] = joint.dof();
+
+    if(joint.type() == Joint::Fixed && p != -1)
+    {
+      const Frame & pf = frames_[p];
+      f.body = pf.body;
+      f.X_b_f = mb.transform(i) * pf.X_b_f;
+      inertias[f.body] = inertias[f.body] + f.X_b_f.transMul(mb.body(i).inertia());
+    }
+    else
+    {
+      f.body = static_cast<int>(bodies.size());
+      f.X_b_f = sva::PTransformd::Identity();
+
+      bodies.push_back(mb.body(i));
+      inertias.push_back(mb.body(i).inertia());
+      joints.push_back(joint);
+      pred.push_back(p == -1 ? -1 : frames_[p].body);
+      succ.push_back(f.body);
+      parent.push_back(p == -1 ? -1 : frames_[p].body);
+      Xt.push_back(p == -1 ? mb.transform(i) : mb.transform(i) * frames_[p].X_b_f);
+      jointsIndex_.push_back(i);
+    }
+  }
+
+  for(std::size_t i = 0; i < bodies.size(); ++i)
+  {
+    bodies[i] = Body(inertias[i], bodies[i].name());
+  }
+
+  mb_ = MultiBody(std::move(bodies), std::move(joints), std::move(pred), std::move(succ), std::move(parent),
+                  std::move(Xt));
+
+  for(const OperationalFrame & of : mb.frames())
+  {
+    const Frame & f = frames_[of.body];
+    mb_.addFrame(of.name, f.body, of.X_b_f * f.X_b_f);
+  }
+}
+
+sva::PTransformd CompiledMultiBody::framePosW(const MultiBodyConfig & mbc, int num) const
+{
+  const Frame & f = frames_[num];
+  return f.X_b_f * mbc.bodyPosW[f.body];
+}
+
+sva::MotionVecd CompiledMultiBody::frameVelB(const MultiBodyConfig & mbc, int num) const
+{
+  const Frame & f = frames_[num];
+  return f.X_b_f * mbc.bodyVelB[f.body];
+}
+
+void CompiledMultiBody::toCompiled(const MultiBodyConfig & from, MultiBodyConfig & to) const
+{
+  for(std::size_t i = 0; i < jointsIndex_.size(); ++i)
+  {
+    to.q[i] = from.q[jointsIndex_[i]];
+    to.alpha[i] = from.alpha[jointsIndex_[i]];
+    to.alphaD[i] = from.alphaD[jointsIndex_[i]];
+  }
+
+  // forces are in world coordinate, the forces of a folded body are directly
+  // added to its compiled body
+  for(sva::ForceVecd & f : to.force)
+  {
+    f = sva::ForceVecd(Eigen::Vector6d::Zero());
+  }
+  for(std::size_t i = 0; i < frames_.size(); ++i)
+  {
+    to.force[frames_[i].body] = to.force[frames_[i].body] + from.force[i];
+  }
+
+  to.gravity = from.gravity;
+}
+
+void CompiledMultiBody::fromCompiled(const MultiBodyConfig & from, MultiBodyConfig & to) const
+{
+  for(std::size_t i = 0; i < jointsIndex_.size(); ++i)
+  {
+    to.q[jointsIndex_[i]] = from.q[i];
+    to.alpha[jointsIndex_[i]] = from.alpha[i];
+    to.alphaD[jointsIndex_[i]] = from.alphaD[i];
+    to.jointTorque[jointsIndex_[i]] = from.jointTorque[i];
+  }
+}
+
+sva::PTransformd CompiledMultiBody::sFramePosW(const MultiBodyConfig & mbc, int num) const
+{
+  checkFrameIndex(num);
+  checkMatchBodyPos(mb_, mbc);
+
+  return framePosW(mbc, num);
+}
+
+sva::MotionVecd CompiledMultiBody::sFrameVelB(const MultiBodyConfig & mbc, int num) const
+{
+  checkFrameIndex(num);
+  checkMatchBodyVel(mb_, mbc);
+
+  return frameVelB(mbc, num);
+}
+
+void CompiledMultiBody::sToCompiled(const MultiBodyConfig & from, MultiBodyConfig & to) const
+{
+  checkMatchOriginal(from);
+  if(from.force.size() != frames_.size())
+  {
+    std::ostringstream str;
+    str << "force size mismatch: expected " << frames_.size() << " gived " << from.force.size();
+    throw std::domain_error(str.str());
+  }
+  checkMatchQ(mb_, to);
+  checkMatchAlpha(mb_, to);
+  checkMatchAlphaD(mb_, to);
+  checkMatchForce(mb_, to);
+
+  toCompiled(from, to);
+}
+
+void CompiledMultiBody::sFromCompiled(const MultiBodyConfig & from, MultiBodyConfig & to) const
+{
+  checkMatchQ(mb_, from);
+  checkMatchAlpha(mb_, from);
+  checkMatchAlphaD(mb_, from);
+  checkMatchJointTorque(mb_, from);
+  checkMatchOriginal(to);
+  checkSizes(to.jointTorque, originalDof_, "jointTorque");
+
+  fromCompiled(from, to);
+}
+
+void CompiledMultiBody::checkFrameIndex(int num) const
+{
+  if(num < 0 || num >= static_cast<int>(frames_.size()))
+  {
+    std::ostringstream str;
+    str << "frame index out of range: expected [0, " << frames_.size() << ") gived " << num;
+    throw std::domain_error(str.str());
+  }
+}
+
+void CompiledMultiBody::checkMatchOriginal(const MultiBodyConfig & mbc) const
+{
+  checkSizes(mbc.q, originalParams_, "q");
+  checkSizes(mbc.alpha, originalDof_, "alpha");
+  checkSizes(mbc.alphaD, originalDof_, "alphaD");
+}
+
+} // namespace rbd
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// associated header
+#include "RBDyn/ComputationGraph.h"
+
+// includes
+// std
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+// RBDyn
+#include "RBDyn/FA.h"
+#include "RBDyn/FK.h"
+#include "RBDyn/FV.h"
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/MultiBodyConfig.h"
+
+namespace rbd
+{
+
+namespace
+{
+
+/**
+ * Inputs of a quantity, all the quantities read mb.
+ * Position, Velocity and Acceleration are the mbc stamps of the forward
+ * kinematics, velocity and acceleration results.
+ * Q, Alpha and AlphaD are written directly by the callers without changing
+ * a stamp, they are compared with a copy taken at the last evaluation.
+ * Force and gravity are written the same way, the quantities that read them
+ * are always evaluated.
+ */
+enum Input
+{
+  Position = 1,
+  Velocity = 2,
+  Acceleration = 4,
+  Q = 8,
+  Alpha = 16,
+  AlphaD = 32,
+  Force = 64
+};
+
+int inputs(ComputationGraph::Quantity q)
+{
+  static const std::array<int, ComputationGraph::NrQuantities> in = {{
+      Position | Q, // Kinematics
+      Position | Velocity | Alpha, // Velocity
+      Position | Velocity | Acceleration | AlphaD, // Acceleration
+      Position, // CoM
+      Position | Velocity, // CoMVelocity
+      Position, // CoMJacobian
+      Position | Velocity, // CoMJacobianDot
+      Position, // CentroidalMomentumMatrix
+      Position | Velocity, // CentroidalMomentumMatrixDot
+      Position, // InertiaMatrix
+      Position | Velocity | Force, // NonLinearEffects
+      Position, // Jacobians
+      Position | Velocity // JacobianDots
+  }};
+  return in[static_cast<std::size_t>(q)];
+}
+
+} // namespace
+
+constexpr int ComputationGraph::NrQuantities;
+
+ComputationGraph::ComputationGraph(const MultiBody & mb)
+: nrDof_(mb.nrDof()), comJac_(mb), cmm_(mb), fd_(mb)
+{
+}
+
+void ComputationGraph::require(Quantity q)
+{
+  required_[index(q)] = true;
+  for(Quantity p : prerequisites(q))
+  {
+    require(p);
+  }
+}
+
+const std::vector<ComputationGraph::Quantity> & ComputationGraph::prerequisites(Quantity q)
+{
+  static const std::array<std::vector<Quantity>, NrQuantities> prereq = {{
+      {}, // Kinematics
+      {Quantity::Kinematics}, // Velocity
+      {Quantity::Velocity}, // Acceleration
+      {Quantity::Kinematics}, // CoM
+      {Quantity::Velocity}, // CoMVelocity
+      {Quantity::Kinematics}, // CoMJacobian
+      {Quantity::Velocity}, // CoMJacobianDot
+      {Quantity::CoM}, // CentroidalMomentumMatrix
+      {Quantity::CoM, Quantity::CoMVelocity}, // CentroidalMomentumMatrixDot
+      {Quantity::Kinematics}, // InertiaMatrix
+      {Quantity::Velocity}, // NonLinearEffects
+      {Quantity::Kinematics}, // Jacobians
+      {Quantity::Velocity} // JacobianDots
+  }};
+  return prereq[index(q)];
+}
+
+int ComputationGraph::addJacobian(const MultiBody & mb, const std::string & bodyName, const Eigen::Vector3d & point)
+{
+  jacObjs_.emplace_back(mb, bodyName, point);
+  jacs_.emplace_back(6, jacObjs_.back().dof());
+  jacDots_.emplace_back(6, jacObjs_.back().dof());
+  // the new jacobian must be computed at the next compute
+  modelStamps_[index(Quantity::Jacobians)] = 0;
+  modelStamps_[index(Quantity::JacobianDots)] = 0;
+  return static_cast<int>(jacObjs_.size()) - 1;
+}
+
+void ComputationGraph::compute(const MultiBody & mb, MultiBodyConfig & mbc)
+{
+  // the quantities are declared in a topological order
+  for(int i = 0; i < NrQuantities; ++i)
+  {
+    if(required_[i] && !upToDate(mb, mbc, i))
+    {
+      auto start = std::chrono::steady_clock::now();
+      evaluate(mb, mbc, static_cast<Quantity>(i));
+      durations_[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      ++nrEvaluations_[i];
+      // taken after the evaluation since Kinematics, Velocity and
+      // Acceleration change the stamps of their results
+      modelStamps_[i] = mb.stamp();
+      stamps_[i] = mbc.stamps;
+      const int in = inputs(static_cast<Quantity>(i));
+      if(in & Q)
+      {
+        q_ = mbc.q;
+      }
+      if(in & Alpha)
+      {
+        alpha_ = mbc.alpha;
+      }
+      if(in & AlphaD)
+      {
+        alphaD_ = mbc.alphaD;
+      }
+    }
+  }
+}
+
+bool ComputationGraph::upToDate(const MultiBody & mb, const MultiBodyConfig & mbc, int i) const
+{
+  const int in = inputs(static_cast<Quantity>(i));
+  const ConfigStamps & last = stamps_[i];
+  return !(in & Force) && ConfigStamps::same(modelStamps_[i], mb.stamp())
+         && (!(in & Position) || ConfigStamps::same(last.position, mbc.stamps.position))
+         && (!(in & Velocity) || ConfigStamps::same(last.velocity, mbc.stamps.velocity))
+         && (!(in & Acceleration) || ConfigStamps::same(last.acceleration, mbc.stamps.acceleration))
+         && (!(in & Q) || mbc.q == q_) && (!(in & Alpha) || mbc.alpha == alpha_)
+         && (!(in & AlphaD) || mbc.alphaD == alphaD_);
+}
+
+void ComputationGraph::evaluate(const MultiBody & mb, MultiBodyConfig & mbc, Quantity q)
+{
+  switch(q)
+  {
+    case Quantity::Kinematics:
+      forwardKinematics(mb, mbc);
+      break;
+    case Quantity::Velocity:
+      forwardVelocity(mb, mbc);
+      break;
+    case Quantity::Acceleration:
+      forwardAcceleration(mb, mbc);
+      break;
+    case Quantity::CoM:
+      com_ = computeCoM(mb, mbc);
+      break;
+    case Quantity::CoMVelocity:
+      comVel_ = computeCoMVelocity(mb, mbc);
+      break;
+    case Quantity::CoMJacobian:
+      comJac_.jacobian(mb, mbc);
+      break;
+    case Quantity::CoMJacobianDot:
+      comJac_.jacobianDot(mb, mbc);
+      break;
+    case Quantity::CentroidalMomentumMatrix:
+      // computed with its time derivative in one pass if both are required
+      if(!required(Quantity::CentroidalMomentumMatrixDot))
+      {
+        cmm_.computeMatrix(mb, mbc, com_);
+      }
+      break;
+    case Quantity::CentroidalMomentumMatrixDot:
+      if(required(Quantity::CentroidalMomentumMatrix))
+      {
+        cmm_.computeMatrixAndMatrixDot(mb, mbc, com_, comVel_);
+      }
+      else
+      {
+        cmm_.computeMatrixDot(mb, mbc, com_, comVel_);
+      }
+      break;
+    case Quantity::InertiaMatrix:
+      fd_.computeH(mb, mbc);
+      break;
+    case Quantity::NonLinearEffects:
+      fd_.computeC(mb, mbc);
+      break;
+    case Quantity::Jacobians:
+      for(std::size_t i = 0; i < jacObjs_.size(); ++i)
+      {
+        jacs_[i] = jacObjs_[i].jacobian(mb, mbc);
+      }
+      break;
+    case Quantity::JacobianDots:
+      for(std::size_t i = 0; i < jacObjs_.size(); ++i)
+      {
+        jacDots_[i] = jacObjs_[i].jacobianDot(mb, mbc);
+      }
+      break;
+  }
+}
+
+int ComputationGraph::sAddJacobian(const MultiBody & mb, const std::string & bodyName, const Eigen::Vector3d & point)
+{
+  checkMatchMultiBody(mb);
+  return addJacobian(mb, bodyName, point);
+}
+
+void ComputationGraph::sCompute(const MultiBody & mb, MultiBodyConfig & mbc)
+{
+  checkMatchMultiBody(mb);
+  checkMatchQ(mb, mbc);
+  checkMatchAlpha(mb, mbc);
+  if(required(Quantity::Acceleration))
+  {
+    checkMatchAlphaD(mb, mbc);
+  }
+  checkMatchForce(mb, mbc);
+
+  compute(mb, mbc);
+}
+
+void ComputationGraph::checkMatchMultiBody(const MultiBody & mb) const
+{
+  if(nrDof_ != mb.nrDof())
+  {
+    std::ostringstream str;
+    str << "number of dof mismatch: expected " << nrDof_ << " gived " << mb.nrDof();
+    throw std::domain_error(str.str());
+  }
+}
+
+} // namespace rbd
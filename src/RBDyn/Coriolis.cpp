@@ -7,7 +7,21 @@
 namespace rbd
 {
 
-Coriolis::Coriolis(const rbd::MultiBody & mb) : coriolis_(mb.nrDof(), mb.nrDof()), res_(0, 0)
+Coriolis::Coriolis(const rbd::MultiBody & mb) : coriolis_(mb.nrDof(), mb.nrDof()), res_(0, 0), inertiaStamp_(0)
+{
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    jacs_.push_back(rbd::Jacobian(mb, mb.body(i).name()));
+    compactPaths_.push_back(jacs_.back().compactPath(mb));
+    if(jacs_.back().dof() > res_.rows())
+    {
+      res_.resize(jacs_.back().dof(), jacs_.back().dof());
+    }
+  }
+  updateCoM(mb);
+}
+
+void Coriolis::updateCoM(const rbd::MultiBody & mb)
 {
   Eigen::Vector3d com;
   double mass;
@@ -22,13 +36,9 @@ Coriolis::Coriolis(const rbd::MultiBody & mb) : coriolis_(mb.nrDof(), mb.nrDof()
     {
       com.setZero();
     }
-    jacs_.push_back(rbd::Jacobian(mb, mb.body(i).name(), com));
-    compactPaths_.push_back(jacs_.back().compactPath(mb));
-    if(jacs_.back().dof() > res_.rows())
-    {
-      res_.resize(jacs_.back().dof(), jacs_.back().dof());
-    }
+    jacs_[i].point(com);
   }
+  inertiaStamp_ = mb.inertiaStamp();
 }
 
 const Eigen::MatrixXd & Coriolis::coriolis(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
@@ -38,6 +48,11 @@ const Eigen::MatrixXd & Coriolis::coriolis(const rbd::MultiBody & mb, const rbd:
 
   Eigen::Matrix3d inertia;
 
+  if(!ConfigStamps::same(inertiaStamp_, mb.inertiaStamp()))
+  {
+    updateCoM(mb);
+  }
+
   coriolis_.setZero();
 
   for(int i = 0; i < mb.nrBodies(); ++i)
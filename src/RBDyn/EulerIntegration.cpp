@@ -130,6 +130,8 @@ void eulerIntegration(const MultiBody & mb, MultiBodyConfig & mbc, double step)
       mbc.alpha[i][j] += mbc.alphaD[i][j] * step;
     }
   }
+  mbc.stamps.positionChanged();
+  mbc.stamps.velocityChanged();
 }
 
 void sEulerIntegration(const MultiBody & mb, MultiBodyConfig & mbc, double step)
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// associated header
+#include "RBDyn/FloatKinematics.h"
+
+// includes
+// std
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+// RBDyn
+#include "RBDyn/Jacobian.h"
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/MultiBodyConfig.h"
+
+namespace rbd
+{
+
+namespace
+{
+
+typedef FloatKinematics::Transform Transform;
+
+/// res = A*B, res must not alias A or B.
+inline void compose(const Transform & A, const Transform & B, Transform & res)
+{
+  for(int k = 0; k < 3; ++k)
+  {
+    res.row(k) = A(k, 0) * B.row(0) + A(k, 1) * B.row(1) + A(k, 2) * B.row(2);
+    res(k, 3) += A(k, 3);
+  }
+}
+
+/// Rotation of angle q around the unit axis a (Rodrigues formula).
+inline void rotation(const Eigen::Vector3f & a, float q, Transform & res)
+{
+  const float c = std::cos(q);
+  const float s = std::sin(q);
+  const float t = 1.f - c;
+
+  res << t * a.x() * a.x() + c, t * a.x() * a.y() - s * a.z(), t * a.x() * a.z() + s * a.y(), 0.f,
+      t * a.x() * a.y() + s * a.z(), t * a.y() * a.y() + c, t * a.y() * a.z() - s * a.x(), 0.f,
+      t * a.x() * a.z() - s * a.y(), t * a.y() * a.z() + s * a.x(), t * a.z() * a.z() + c, 0.f;
+}
+
+} // namespace
+
+FloatKinematics::FloatKinematics(const MultiBody & mb)
+: type_(static_cast<std::size_t>(mb.nrJoints())), axis_(static_cast<std::size_t>(mb.nrJoints())),
+  S_(static_cast<std::size_t>(mb.nrJoints())), paramPos_(mb.jointsPosInParam()),
+  Xt_(static_cast<std::size_t>(mb.nrJoints())), q_(static_cast<std::size_t>(mb.nrJoints())),
+  bodyPosW_(static_cast<std::size_t>(mb.nrBodies())), qf_(mb.nrParams())
+{
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    type_[i] = mb.joint(i).type();
+    q_[i].resize(static_cast<std::size_t>(mb.joint(i).params()));
+  }
+  for(Transform & X : bodyPosW_)
+  {
+    X.setZero();
+    X.leftCols<3>().setIdentity();
+  }
+  updateGeometry(mb);
+}
+
+void FloatKinematics::updateGeometry(const MultiBody & mb)
+{
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    const Joint & joint = mb.joint(i);
+    if(type_[i] == Joint::Rev)
+    {
+      axis_[i] = joint.motionSubspace().col(0).head<3>().cast<float>();
+    }
+    else if(type_[i] == Joint::Prism)
+    {
+      axis_[i] = joint.motionSubspace().col(0).tail<3>().cast<float>();
+    }
+    else
+    {
+      axis_[i].setZero();
+    }
+    S_[i] = joint.motionSubspace().cast<float>();
+    Xt_[i] = fromPTransform(mb.transform(i));
+  }
+  geometryStamp_ = mb.geometryStamp();
+}
+
+void FloatKinematics::forwardKinematics(const MultiBody & mb, const Eigen::Ref<const Eigen::VectorXf> & q)
+{
+  if(!ConfigStamps::same(geometryStamp_, mb.geometryStamp()))
+  {
+    updateGeometry(mb);
+  }
+
+  const std::vector<int> & pred = mb.predecessors();
+  const std::vector<int> & succ = mb.successors();
+
+  Transform Xj, Xpts;
+  for(std::size_t i = 0; i < type_.size(); ++i)
+  {
+    const float * qi = q.data() + paramPos_[i];
+    const Transform & Xt = Xt_[i];
+    switch(type_[i])
+    {
+      case Joint::Rev:
+        rotation(axis_[i], qi[0], Xj);
+        compose(Xt, Xj, Xpts);
+        break;
+      case Joint::Prism:
+        Xpts = Xt;
+        Xpts.col(3) += Xt.leftCols<3>() * (axis_[i] * qi[0]);
+        break;
+      case Joint::Fixed:
+        Xpts = Xt;
+        break;
+      default:
+      {
+        q_[i].assign(qi, qi + q_[i].size());
+        sva::PTransform<float> X = mb.joint(static_cast<int>(i)).pose(q_[i]);
+        Xj.leftCols<3>() = X.rotation().transpose();
+        Xj.col(3) = X.translation();
+        compose(Xt, Xj, Xpts);
+        break;
+      }
+    }
+
+    if(pred[i] != -1)
+    {
+      compose(bodyPosW_[pred[i]], Xpts, bodyPosW_[succ[i]]);
+    }
+    else
+    {
+      bodyPosW_[succ[i]] = Xpts;
+    }
+  }
+}
+
+void FloatKinematics::forwardKinematics(const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  for(std::size_t i = 0; i < mbc.q.size(); ++i)
+  {
+    for(std::size_t j = 0; j < mbc.q[i].size(); ++j)
+    {
+      qf_[paramPos_[i] + static_cast<int>(j)] = static_cast<float>(mbc.q[i][j]);
+    }
+  }
+  forwardKinematics(mb, qf_);
+}
+
+void FloatKinematics::jacobian(const MultiBody & /* mb */,
+                               const Jacobian & jac,
+                               Eigen::Matrix<float, 6, Eigen::Dynamic> & res) const
+{
+  const std::vector<int> & path = jac.jointsPath();
+  const Transform & X_0_N = bodyPosW_[path.back()];
+  const Eigen::Vector3f p = X_0_N.leftCols<3>() * jac.point().cast<float>() + X_0_N.col(3);
+
+  res.resize(6, jac.dof());
+  int curJ = 0;
+  for(int i : path)
+  {
+    const Transform & X_0_i = bodyPosW_[i];
+    const Eigen::Vector3f r = p - X_0_i.col(3);
+    const Eigen::Matrix<float, 6, Eigen::Dynamic> & S = S_[i];
+    for(int dof = 0; dof < S.cols(); ++dof, ++curJ)
+    {
+      const Eigen::Vector3f w = X_0_i.leftCols<3>() * S.col(dof).head<3>();
+      res.col(curJ).head<3>() = w;
+      res.col(curJ).tail<3>() = X_0_i.leftCols<3>() * S.col(dof).tail<3>() + w.cross(r);
+    }
+  }
+}
+
+sva::PTransformd FloatKinematics::toPTransform(const Transform & X)
+{
+  return sva::PTransformd(X.leftCols<3>().transpose().cast<double>(), X.col(3).cast<double>());
+}
+
+FloatKinematics::Transform FloatKinematics::fromPTransform(const sva::PTransformd & X)
+{
+  Transform res;
+  res.leftCols<3>() = X.rotation().transpose().cast<float>();
+  res.col(3) = X.translation().cast<float>();
+  return res;
+}
+
+void FloatKinematics::sForwardKinematics(const MultiBody & mb, const Eigen::Ref<const Eigen::VectorXf> & q)
+{
+  checkMatchMultiBody(mb);
+  if(q.size() != mb.nrParams())
+  {
+    std::ostringstream str;
+    str << "q size mismatch: expected " << mb.nrParams() << " gived " << q.size();
+    throw std::domain_error(str.str());
+  }
+
+  forwardKinematics(mb, q);
+}
+
+void FloatKinematics::sForwardKinematics(const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  checkMatchMultiBody(mb);
+  checkMatchQ(mb, mbc);
+
+  forwardKinematics(mb, mbc);
+}
+
+void FloatKinematics::sJacobian(const MultiBody & mb,
+                                const Jacobian & jac,
+                                Eigen::Matrix<float, 6, Eigen::Dynamic> & res) const
+{
+  checkMatchMultiBody(mb);
+  for(int i : jac.jointsPath())
+  {
+    if(i < 0 || i >= mb.nrJoints())
+    {
+      std::ostringstream str;
+      str << "jac joint index out of range: expected [0, " << mb.nrJoints() << ") gived " << i;
+      throw std::domain_error(str.str());
+    }
+  }
+
+  jacobian(mb, jac, res);
+}
+
+void FloatKinematics::checkMatchMultiBody(const MultiBody & mb) const
+{
+  if(static_cast<int>(type_.size()) != mb.nrJoints())
+  {
+    std::ostringstream str;
+    str << "number of joints mismatch: expected " << type_.size() << " gived " << mb.nrJoints();
+    throw std::domain_error(str.str());
+  }
+  if(qf_.size() != mb.nrParams())
+  {
+    std::ostringstream str;
+    str << "number of parameters mismatch: expected " << qf_.size() << " gived " << mb.nrParams();
+    throw std::domain_error(str.str());
+  }
+}
+
+} // namespace rbd
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// associated header
+#include "RBDyn/FrameKinematics.h"
+
+// includes
+// std
+#include <sstream>
+#include <stdexcept>
+
+// RBDyn
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/MultiBodyConfig.h"
+
+namespace rbd
+{
+
+FrameKinematics::FrameKinematics(const MultiBody & mb)
+: cached_(static_cast<std::size_t>(mb.nrFrames()), 0), posW_(static_cast<std::size_t>(mb.nrFrames())),
+  velB_(static_cast<std::size_t>(mb.nrFrames())), velW_(static_cast<std::size_t>(mb.nrFrames())),
+  jac_(static_cast<std::size_t>(mb.nrFrames())), bodyJac_(static_cast<std::size_t>(mb.nrFrames())),
+  jacObj_(static_cast<std::size_t>(mb.nrFrames()))
+{
+}
+
+void FrameKinematics::reset()
+{
+  invalidate(PosW | VelB | VelW | Jac | BodyJac);
+}
+
+void FrameKinematics::update(const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  unsigned char flags = 0;
+  if(!ConfigStamps::same(modelStamp_, mb.geometryStamp()) || !ConfigStamps::same(positionStamp_, mbc.stamps.position))
+  {
+    flags |= PosW | VelW | Jac | BodyJac;
+  }
+  if(!ConfigStamps::same(velocityStamp_, mbc.stamps.velocity))
+  {
+    flags |= VelB | VelW;
+  }
+
+  if(flags != 0)
+  {
+    invalidate(flags);
+    modelStamp_ = mb.geometryStamp();
+    positionStamp_ = mbc.stamps.position;
+    velocityStamp_ = mbc.stamps.velocity;
+  }
+}
+
+void FrameKinematics::invalidate(unsigned char flags)
+{
+  for(unsigned char & c : cached_)
+  {
+    c &= static_cast<unsigned char>(~flags);
+  }
+}
+
+const sva::PTransformd & FrameKinematics::framePosW(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  update(mb, mbc);
+  if(!cached(num, PosW))
+  {
+    const OperationalFrame & f = mb.frame(num);
+    posW_[num] = f.X_b_f * mbc.bodyPosW[f.body];
+    cached_[num] |= PosW;
+  }
+  return posW_[num];
+}
+
+const sva::MotionVecd & FrameKinematics::frameVelB(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  update(mb, mbc);
+  if(!cached(num, VelB))
+  {
+    const OperationalFrame & f = mb.frame(num);
+    velB_[num] = f.X_b_f * mbc.bodyVelB[f.body];
+    cached_[num] |= VelB;
+  }
+  return velB_[num];
+}
+
+const sva::MotionVecd & FrameKinematics::frameVelW(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  update(mb, mbc);
+  if(!cached(num, VelW))
+  {
+    const OperationalFrame & f = mb.frame(num);
+    // equivalent of E_b_0*X_b_f
+    sva::PTransformd X_f_w(mbc.bodyPosW[f.body].rotation().transpose(), f.X_b_f.translation());
+    velW_[num] = X_f_w * mbc.bodyVelB[f.body];
+    cached_[num] |= VelW;
+  }
+  return velW_[num];
+}
+
+const Eigen::MatrixXd & FrameKinematics::jacobian(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  update(mb, mbc);
+  if(!cached(num, Jac))
+  {
+    jac_[num] = jacobianObject(mb, num).jacobian(mb, mbc);
+    cached_[num] |= Jac;
+  }
+  return jac_[num];
+}
+
+const Eigen::MatrixXd & FrameKinematics::bodyJacobian(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  update(mb, mbc);
+  if(!cached(num, BodyJac))
+  {
+    const sva::PTransformd & X_0_f = framePosW(mb, mbc, num);
+    bodyJac_[num] = jacobianObject(mb, num).jacobian(mb, mbc, X_0_f);
+    cached_[num] |= BodyJac;
+  }
+  return bodyJac_[num];
+}
+
+const Jacobian & FrameKinematics::frameJacobian(const MultiBody & mb, int num)
+{
+  return jacobianObject(mb, num);
+}
+
+Jacobian & FrameKinematics::jacobianObject(const MultiBody & mb, int num)
+{
+  if(!cached(num, JacObject))
+  {
+    const OperationalFrame & f = mb.frame(num);
+    jacObj_[num] = Jacobian(mb, mb.body(f.body).name(), f.X_b_f.translation());
+    cached_[num] |= JacObject;
+  }
+  return jacObj_[num];
+}
+
+const sva::PTransformd & FrameKinematics::sFramePosW(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  checkMatch(mb, num);
+  checkMatchBodyPos(mb, mbc);
+
+  return framePosW(mb, mbc, num);
+}
+
+const sva::MotionVecd & FrameKinematics::sFrameVelB(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  checkMatch(mb, num);
+  checkMatchBodyVel(mb, mbc);
+
+  return frameVelB(mb, mbc, num);
+}
+
+const sva::MotionVecd & FrameKinematics::sFrameVelW(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  checkMatch(mb, num);
+  checkMatchBodyPos(mb, mbc);
+  checkMatchBodyVel(mb, mbc);
+
+  return frameVelW(mb, mbc, num);
+}
+
+const Eigen::MatrixXd & FrameKinematics::sJacobian(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  checkMatch(mb, num);
+  checkMatchBodyPos(mb, mbc);
+  checkMatchMotionSubspace(mb, mbc);
+
+  return jacobian(mb, mbc, num);
+}
+
+const Eigen::MatrixXd & FrameKinematics::sBodyJacobian(const MultiBody & mb, const MultiBodyConfig & mbc, int num)
+{
+  checkMatch(mb, num);
+  checkMatchBodyPos(mb, mbc);
+  checkMatchMotionSubspace(mb, mbc);
+
+  return bodyJacobian(mb, mbc, num);
+}
+
+void FrameKinematics::checkMatch(const MultiBody & mb, int num) const
+{
+  if(static_cast<int>(cached_.size()) != mb.nrFrames())
+  {
+    std::ostringstream str;
+    str << "number of frames mismatch: expected " << cached_.size() << " gived " << mb.nrFrames();
+    throw std::domain_error(str.str());
+  }
+
+  if(num < 0 || num >= mb.nrFrames())
+  {
+    std::ostringstream str;
+    str << "frame index out of range: expected [0, " << mb.nrFrames() << ") gived " << num;
+    throw std::domain_error(str.str());
+  }
+}
+
+} // namespace rbd
@@ -6,9 +6,22 @@
 #include "RBDyn/IDIM.h"
 
 // includes
+// std
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+// Eigen
+#include <Eigen/QR>
+
 // RBDyn
+#include "RBDyn/FA.h"
+#include "RBDyn/FK.h"
+#include "RBDyn/FV.h"
 #include "RBDyn/MultiBody.h"
 #include "RBDyn/MultiBodyConfig.h"
+#include "RBDyn/Parallel.h"
 
 namespace rbd
 {
@@ -64,9 +77,19 @@ Eigen::VectorXd multiBodyToInertialVector(const rbd::MultiBody & mb)
   return vec;
 }
 
-IDIM::IDIM(const rbd::MultiBody & mb) : Y_(Eigen::MatrixXd::Zero(mb.nrDof(), mb.nrBodies() * 10)) {}
+namespace
+{
 
-void IDIM::computeY(const MultiBody & mb, const MultiBodyConfig & mbc)
+/**
+ * Compute the regressor of the spatial force of each body and project it
+ * on the body joint and on all its ancestors joints.
+ * @param keep Functor bool(int i) that return false for the bodies to skip.
+ * @param write Functor void(int i, int j, bodyFPhi) that receive the
+ * regressor of body i spatial force expressed in the frame of body j
+ * (j == i or j ancestor of i) with joints[j].dof() != 0.
+ */
+template<typename Keep, typename Write>
+void computeBodyRegressors(const MultiBody & mb, const MultiBodyConfig & mbc, Keep keep, Write write)
 {
   const std::vector<Body> & bodies = mb.bodies();
   const std::vector<Joint> & joints = mb.joints();
@@ -75,6 +98,11 @@ void IDIM::computeY(const MultiBody & mb, const MultiBodyConfig & mbc)
   Eigen::Matrix<double, 6, 10> bodyFPhi;
   for(int i = static_cast<int>(bodies.size()) - 1; i >= 0; --i)
   {
+    if(!keep(i))
+    {
+      continue;
+    }
+
     const sva::MotionVecd & vb_i = mbc.bodyVelB[i];
     Eigen::Matrix<double, 6, 10> vb_i_Phi(IMPhi(vb_i));
 
@@ -87,9 +115,7 @@ void IDIM::computeY(const MultiBody & mb, const MultiBodyConfig & mbc)
       bodyFPhi.col(c).noalias() += (vb_i.crossDual(sva::ForceVecd(vb_i_Phi.col(c)))).vector();
     }
 
-    int iDofPos = mb.jointPosInDof(i);
-
-    Y_.block(iDofPos, i * 10, joints[i].dof(), 10).noalias() = mbc.motionSubspace[i].transpose() * bodyFPhi;
+    write(i, i, bodyFPhi);
 
     int j = i;
     while(pred[j] != -1)
@@ -104,15 +130,29 @@ void IDIM::computeY(const MultiBody & mb, const MultiBodyConfig & mbc)
       }
       j = pred[j];
 
-      int jDofPos = mb.jointPosInDof(j);
       if(joints[j].dof() != 0)
       {
-        Y_.block(jDofPos, i * 10, joints[j].dof(), 10).noalias() = mbc.motionSubspace[j].transpose() * bodyFPhi;
+        write(i, j, bodyFPhi);
       }
     }
   }
 }
 
+} // namespace
+
+IDIM::IDIM(const rbd::MultiBody & mb) : Y_(Eigen::MatrixXd::Zero(mb.nrDof(), mb.nrBodies() * 10)) {}
+
+void IDIM::computeY(const MultiBody & mb, const MultiBodyConfig & mbc)
+{
+  const std::vector<Joint> & joints = mb.joints();
+
+  computeBodyRegressors(mb, mbc, [](int) { return true; },
+                        [&](int i, int j, const Eigen::Matrix<double, 6, 10> & bodyFPhi) {
+                          Y_.block(mb.jointPosInDof(j), i * 10, joints[j].dof(), 10).noalias() =
+                              mbc.motionSubspace[j].transpose() * bodyFPhi;
+                        });
+}
+
 void IDIM::sComputeY(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
   checkMatchParentToSon(mb, mbc);
@@ -123,4 +163,728 @@ void IDIM::sComputeY(const MultiBody & mb, const MultiBodyConfig & mbc)
   computeY(mb, mbc);
 }
 
+/**
+ *													CompactIDIM
+ */
+
+CompactIDIM::CompactIDIM(const rbd::MultiBody & mb)
+: nrDof_(mb.nrDof()), bodyY_(static_cast<std::size_t>(mb.nrBodies())),
+  bodyBlocks_(static_cast<std::size_t>(mb.nrBodies())), jointRows_(static_cast<std::size_t>(mb.nrBodies())),
+  commonRows_(Eigen::MatrixXi::Zero(mb.nrBodies(), mb.nrBodies()))
+{
+  const std::vector<int> & pred = mb.predecessors();
+  std::vector<std::vector<int>> paths(static_cast<std::size_t>(mb.nrBodies()));
+
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    // joints with dof from the root to the body
+    std::vector<int> & path = paths[static_cast<std::size_t>(i)];
+    for(int j = i; j != -1; j = pred[j])
+    {
+      if(mb.joint(j).dof() != 0)
+      {
+        path.insert(path.begin(), j);
+      }
+    }
+
+    int rows = 0;
+    Blocks & blocks = bodyBlocks_[static_cast<std::size_t>(i)];
+    std::vector<int> & jointRows = jointRows_[static_cast<std::size_t>(i)];
+    for(int j : path)
+    {
+      const int start = mb.jointPosInDof(j);
+      const int dof = mb.joint(j).dof();
+      if(!blocks.empty() && blocks.back().startDof + blocks.back().length == start)
+      {
+        blocks.back().length += dof;
+      }
+      else
+      {
+        blocks.emplace_back(start, rows, dof);
+      }
+      jointRows.insert(jointRows.begin(), rows);
+      rows += dof;
+    }
+    bodyY_[static_cast<std::size_t>(i)].setZero(rows, 10);
+
+    // paths are ordered from the root so the shared rows are a common prefix
+    for(int k = 0; k <= i; ++k)
+    {
+      const std::vector<int> & pathK = paths[static_cast<std::size_t>(k)];
+      int common = 0;
+      for(std::size_t p = 0; p < std::min(path.size(), pathK.size()) && path[p] == pathK[p]; ++p)
+      {
+        common += mb.joint(path[p]).dof();
+      }
+      commonRows_(i, k) = common;
+    }
+  }
+}
+
+void CompactIDIM::computeY(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
+{
+  const std::vector<Joint> & joints = mb.joints();
+
+  int pathIndex = 0;
+  computeBodyRegressors(mb, mbc, [](int) { return true; },
+                        [&](int i, int j, const Eigen::Matrix<double, 6, 10> & bodyFPhi) {
+                          if(i == j)
+                          {
+                            pathIndex = 0;
+                          }
+                          if(joints[j].dof() != 0)
+                          {
+                            const std::size_t bi = static_cast<std::size_t>(i);
+                            const int row = jointRows_[bi][static_cast<std::size_t>(pathIndex++)];
+                            bodyY_[bi].middleRows(row, joints[j].dof()).noalias() =
+                                mbc.motionSubspace[j].transpose() * bodyFPhi;
+                          }
+                        });
+}
+
+Eigen::VectorXd CompactIDIM::YTtorque(const Eigen::Ref<const Eigen::VectorXd> & torque) const
+{
+  Eigen::VectorXd res(Eigen::VectorXd::Zero(static_cast<Eigen::Index>(bodyY_.size() * 10)));
+  addYTtorque(torque, res);
+  return res;
+}
+
+Eigen::VectorXd CompactIDIM::Yphi(const Eigen::Ref<const Eigen::VectorXd> & phi) const
+{
+  Eigen::VectorXd res(Eigen::VectorXd::Zero(nrDof_));
+  for(std::size_t i = 0; i < bodyY_.size(); ++i)
+  {
+    const auto phi_i = phi.segment<10>(static_cast<Eigen::Index>(i * 10));
+    for(const Block & b : bodyBlocks_[i])
+    {
+      res.segment(b.startDof, b.length).noalias() += bodyY_[i].middleRows(b.startJac, b.length) * phi_i;
+    }
+  }
+  return res;
+}
+
+Eigen::MatrixXd CompactIDIM::YTY() const
+{
+  const Eigen::Index nrParams = static_cast<Eigen::Index>(bodyY_.size() * 10);
+  Eigen::MatrixXd res(Eigen::MatrixXd::Zero(nrParams, nrParams));
+  addYTY(res);
+  return res.selfadjointView<Eigen::Lower>();
+}
+
+void CompactIDIM::addYTtorque(const Eigen::Ref<const Eigen::VectorXd> & torque,
+                              Eigen::Ref<Eigen::VectorXd> result) const
+{
+  for(std::size_t i = 0; i < bodyY_.size(); ++i)
+  {
+    auto res_i = result.segment<10>(static_cast<Eigen::Index>(i * 10));
+    for(const Block & b : bodyBlocks_[i])
+    {
+      res_i.noalias() += bodyY_[i].middleRows(b.startJac, b.length).transpose() * torque.segment(b.startDof, b.length);
+    }
+  }
+}
+
+void CompactIDIM::addYTY(Eigen::Ref<Eigen::MatrixXd> result) const
+{
+  for(std::size_t i = 0; i < bodyY_.size(); ++i)
+  {
+    const Eigen::Index ii = static_cast<Eigen::Index>(i * 10);
+    result.block<10, 10>(ii, ii).selfadjointView<Eigen::Lower>().rankUpdate(bodyY_[i].transpose());
+    for(std::size_t k = 0; k < i; ++k)
+    {
+      const int common = commonRows_(static_cast<Eigen::Index>(i), static_cast<Eigen::Index>(k));
+      if(common != 0)
+      {
+        result.block<10, 10>(ii, static_cast<Eigen::Index>(k * 10)).noalias() +=
+            bodyY_[i].topRows(common).transpose() * bodyY_[k].topRows(common);
+      }
+    }
+  }
+}
+
+Eigen::MatrixXd CompactIDIM::denseY() const
+{
+  Eigen::MatrixXd res(Eigen::MatrixXd::Zero(nrDof_, static_cast<Eigen::Index>(bodyY_.size() * 10)));
+  for(std::size_t i = 0; i < bodyY_.size(); ++i)
+  {
+    for(const Block & b : bodyBlocks_[i])
+    {
+      res.block(b.startDof, static_cast<Eigen::Index>(i * 10), b.length, 10) =
+          bodyY_[i].middleRows(b.startJac, b.length);
+    }
+  }
+  return res;
+}
+
+void CompactIDIM::sComputeY(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
+{
+  checkMatchParentToSon(mb, mbc);
+  checkMatchBodyVel(mb, mbc);
+  checkMatchMotionSubspace(mb, mbc);
+  checkMatchBodyAcc(mb, mbc);
+
+  computeY(mb, mbc);
+}
+
+/**
+ *													IDIMBase
+ */
+
+IDIMBase::IDIMBase(const rbd::MultiBody & mb,
+                   int nrSamples,
+                   double tolerance,
+                   const Eigen::Vector3d & gravity,
+                   unsigned int seed)
+: bodyColumns_(static_cast<std::size_t>(mb.nrBodies()))
+{
+  const int nrParams = mb.nrBodies() * 10;
+  if(mb.nrDof() == 0)
+  {
+    for(int c = 0; c < nrParams; ++c)
+    {
+      dependentColumns_.push_back(c);
+    }
+    beta_.resize(0, nrParams);
+    Yb_.resize(0, 0);
+    return;
+  }
+  if(nrSamples <= 0)
+  {
+    nrSamples = (2 * nrParams + mb.nrDof() - 1) / mb.nrDof();
+  }
+
+  // stack the Y matrix of random samples
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(-1., 1.);
+  auto random = [&gen, &dist](Eigen::VectorXd & v, double scale) {
+    for(Eigen::Index k = 0; k < v.size(); ++k)
+    {
+      v(k) = scale * dist(gen);
+    }
+  };
+
+  MultiBodyConfig mbc(mb);
+  mbc.zero(mb);
+  IDIM idim(mb);
+  const sva::MotionVecd A_0(Eigen::Vector3d::Zero(), gravity);
+  Eigen::VectorXd q(mb.nrParams()), alpha(mb.nrDof()), alphaD(mb.nrDof());
+  Eigen::MatrixXd Ys(nrSamples * mb.nrDof(), nrParams);
+  for(int s = 0; s < nrSamples; ++s)
+  {
+    random(q, 3.14);
+    random(alpha, 1.);
+    random(alphaD, 1.);
+    vectorToParam(q, mbc.q);
+    vectorToParam(alpha, mbc.alpha);
+    vectorToParam(alphaD, mbc.alphaD);
+    for(int i = 0; i < mb.nrJoints(); ++i)
+    {
+      if(mb.joint(i).type() == Joint::Spherical || mb.joint(i).type() == Joint::Free)
+      {
+        Eigen::Map<Eigen::Vector4d> quat(mbc.q[i].data());
+        quat.normalize();
+      }
+    }
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+    forwardAcceleration(mb, mbc, A_0);
+    idim.computeY(mb, mbc);
+    Ys.middleRows(s * mb.nrDof(), mb.nrDof()) = idim.Y();
+  }
+
+  Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(Ys);
+  qr.setThreshold(tolerance);
+  const int rank = static_cast<int>(qr.rank());
+  const Eigen::VectorXi & perm = qr.colsPermutation().indices();
+
+  // Y_ind*beta = Y_dep with Y_ind = Q*R11 and Y_dep = Q*R12
+  Eigen::MatrixXd R = qr.matrixR().topRows(rank).triangularView<Eigen::Upper>();
+  Eigen::MatrixXd beta = R.leftCols(rank).triangularView<Eigen::Upper>().solve(R.rightCols(nrParams - rank));
+
+  // sort the columns to keep the natural parameters order
+  std::vector<int> indOrder(static_cast<std::size_t>(rank)), depOrder(static_cast<std::size_t>(nrParams - rank));
+  for(int k = 0; k < rank; ++k)
+  {
+    indOrder[static_cast<std::size_t>(k)] = k;
+  }
+  for(int k = 0; k < nrParams - rank; ++k)
+  {
+    depOrder[static_cast<std::size_t>(k)] = k;
+  }
+  std::sort(indOrder.begin(), indOrder.end(), [&perm](int a, int b) { return perm(a) < perm(b); });
+  std::sort(depOrder.begin(), depOrder.end(),
+            [&perm, rank](int a, int b) { return perm(rank + a) < perm(rank + b); });
+
+  beta_.resize(rank, nrParams - rank);
+  for(int r = 0; r < rank; ++r)
+  {
+    independentColumns_.push_back(perm(indOrder[static_cast<std::size_t>(r)]));
+    for(int c = 0; c < nrParams - rank; ++c)
+    {
+      beta_(r, c) = beta(indOrder[static_cast<std::size_t>(r)], depOrder[static_cast<std::size_t>(c)]);
+    }
+  }
+  for(int c = 0; c < nrParams - rank; ++c)
+  {
+    dependentColumns_.push_back(perm(rank + depOrder[static_cast<std::size_t>(c)]));
+  }
+
+  for(int k = 0; k < rank; ++k)
+  {
+    int col = independentColumns_[static_cast<std::size_t>(k)];
+    bodyColumns_[static_cast<std::size_t>(col / 10)].emplace_back(col % 10, k);
+  }
+  Yb_.setZero(mb.nrDof(), rank);
+}
+
+void IDIMBase::computeYBase(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
+{
+  const std::vector<Joint> & joints = mb.joints();
+
+  computeBodyRegressors(mb, mbc, [this](int i) { return !bodyColumns_[static_cast<std::size_t>(i)].empty(); },
+                        [&](int i, int j, const Eigen::Matrix<double, 6, 10> & bodyFPhi) {
+                          const int jDofPos = mb.jointPosInDof(j);
+                          for(const std::pair<int, int> & c : bodyColumns_[static_cast<std::size_t>(i)])
+                          {
+                            Yb_.block(jDofPos, c.second, joints[j].dof(), 1).noalias() =
+                                mbc.motionSubspace[j].transpose() * bodyFPhi.col(c.first);
+                          }
+                        });
+}
+
+Eigen::VectorXd IDIMBase::baseParameters(const Eigen::VectorXd & phi) const
+{
+  Eigen::VectorXd phiB(independentColumns_.size());
+  for(std::size_t k = 0; k < independentColumns_.size(); ++k)
+  {
+    phiB(static_cast<Eigen::Index>(k)) = phi(independentColumns_[k]);
+  }
+  for(std::size_t k = 0; k < dependentColumns_.size(); ++k)
+  {
+    phiB.noalias() += beta_.col(static_cast<Eigen::Index>(k)) * phi(dependentColumns_[k]);
+  }
+  return phiB;
+}
+
+void IDIMBase::sComputeYBase(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
+{
+  checkMatchParentToSon(mb, mbc);
+  checkMatchBodyVel(mb, mbc);
+  checkMatchMotionSubspace(mb, mbc);
+  checkMatchBodyAcc(mb, mbc);
+  if(static_cast<int>(bodyColumns_.size()) != mb.nrBodies() || Yb_.rows() != mb.nrDof())
+  {
+    std::ostringstream str;
+    str << "MultiBody mismatch: expected " << bodyColumns_.size() << " bodies and " << Yb_.rows() << " dof gived "
+        << mb.nrBodies() << " bodies and " << mb.nrDof() << " dof";
+    throw std::domain_error(str.str());
+  }
+
+  computeYBase(mb, mbc);
+}
+
+Eigen::VectorXd IDIMBase::sBaseParameters(const Eigen::VectorXd & phi) const
+{
+  const std::size_t nrParams = independentColumns_.size() + dependentColumns_.size();
+  if(static_cast<std::size_t>(phi.size()) != nrParams)
+  {
+    std::ostringstream str;
+    str << "Vector size mismatch: expected size is " << nrParams << " gived is " << phi.size();
+    throw std::domain_error(str.str());
+  }
+  return baseParameters(phi);
+}
+
+/**
+ *													IDIMEstimator
+ */
+
+IDIMEstimator::IDIMEstimator(const rbd::MultiBody & mb, double forgettingFactor)
+: idim_(mb), YTY_(Eigen::MatrixXd::Zero(mb.nrBodies() * 10, mb.nrBodies() * 10)),
+  YTtorque_(Eigen::VectorXd::Zero(mb.nrBodies() * 10)), torque_(mb.nrDof()), torqueTtorque_(0.), nrSamples_(0),
+  forgettingFactor_(forgettingFactor)
+{
+}
+
+void IDIMEstimator::reset()
+{
+  YTY_.setZero();
+  YTtorque_.setZero();
+  torqueTtorque_ = 0.;
+  nrSamples_ = 0;
+}
+
+void IDIMEstimator::addSample(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
+{
+  idim_.computeY(mb, mbc);
+  paramToVector(mbc.jointTorque, torque_);
+  accumulate(idim_, torque_);
+}
+
+void IDIMEstimator::addSample(const Eigen::Ref<const Eigen::MatrixXd> & Y,
+                              const Eigen::Ref<const Eigen::VectorXd> & torque)
+{
+  accumulate(Y, torque);
+}
+
+void IDIMEstimator::addTrajectory(const rbd::MultiBody & mb,
+                                  const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                  const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                                  const Eigen::Ref<const Eigen::MatrixXd> & alphaD,
+                                  const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                                  const Eigen::Vector3d & gravity,
+                                  int nrThreads)
+{
+  const int nrS = static_cast<int>(q.cols());
+  if(nrS == 0)
+  {
+    return;
+  }
+
+  // a few chunks by thread to balance the load, each chunk having its own
+  // accumulator to be able to merge them in the trajectory order
+  nrThreads = resolveNrThreads(nrThreads);
+  const int nrChunks = std::min(nrS, 4 * nrThreads);
+  const int chunkSize = (nrS + nrChunks - 1) / nrChunks;
+
+  MultiBodyConfig mbc(mb);
+  mbc.zero(mb);
+  mbc.gravity = gravity;
+  std::vector<MultiBodyConfig> mbcs(static_cast<std::size_t>(nrThreads), mbc);
+  std::vector<IDIMEstimator> chunks((nrS + chunkSize - 1) / chunkSize, IDIMEstimator(mb, forgettingFactor_));
+  const sva::MotionVecd A_0(Eigen::Vector3d::Zero(), gravity);
+
+  parallelFor(nrS, nrThreads, chunkSize, [&](int thread, int begin, int end) {
+    MultiBodyConfig & tmbc = mbcs[static_cast<std::size_t>(thread)];
+    IDIMEstimator & est = chunks[static_cast<std::size_t>(begin / chunkSize)];
+    for(int s = begin; s < end; ++s)
+    {
+      vectorToParam(q.col(s), tmbc.q);
+      vectorToParam(alpha.col(s), tmbc.alpha);
+      vectorToParam(alphaD.col(s), tmbc.alphaD);
+      forwardKinematics(mb, tmbc);
+      forwardVelocity(mb, tmbc);
+      forwardAcceleration(mb, tmbc, A_0);
+
+      est.idim_.computeY(mb, tmbc);
+      est.accumulate(est.idim_, torque.col(s));
+    }
+  });
+
+  for(const IDIMEstimator & est : chunks)
+  {
+    merge(est);
+  }
+}
+
+void IDIMEstimator::merge(const IDIMEstimator & other)
+{
+  if(forgettingFactor_ != 1.)
+  {
+    const double decay = std::pow(forgettingFactor_, static_cast<double>(other.nrSamples_));
+    YTY_.triangularView<Eigen::Lower>() *= decay;
+    YTtorque_ *= decay;
+    torqueTtorque_ *= decay;
+  }
+  YTY_.triangularView<Eigen::Lower>() += other.YTY_;
+  YTtorque_ += other.YTtorque_;
+  torqueTtorque_ += other.torqueTtorque_;
+  nrSamples_ += other.nrSamples_;
+}
+
+Eigen::VectorXd IDIMEstimator::solve(double regularization, const Eigen::VectorXd & prior) const
+{
+  Eigen::MatrixXd A(YTY());
+  A.diagonal().array() += regularization;
+  return A.ldlt().solve(YTtorque_ + regularization * prior);
+}
+
+Eigen::VectorXd IDIMEstimator::solve() const
+{
+  return Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd>(YTY()).solve(YTtorque_);
+}
+
+void IDIMEstimator::sAddSample(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
+{
+  checkMatchParentToSon(mb, mbc);
+  checkMatchBodyVel(mb, mbc);
+  checkMatchMotionSubspace(mb, mbc);
+  checkMatchBodyAcc(mb, mbc);
+  checkMatchJointTorque(mb, mbc);
+  if(mb.nrBodies() * 10 != YTtorque_.size())
+  {
+    std::ostringstream str;
+    str << "Number of parameters mismatch: expected " << YTtorque_.size() << " gived " << mb.nrBodies() * 10;
+    throw std::domain_error(str.str());
+  }
+
+  addSample(mb, mbc);
+}
+
+void IDIMEstimator::sAddTrajectory(const rbd::MultiBody & mb,
+                                   const Eigen::Ref<const Eigen::MatrixXd> & q,
+                                   const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                                   const Eigen::Ref<const Eigen::MatrixXd> & alphaD,
+                                   const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                                   const Eigen::Vector3d & gravity,
+                                   int nrThreads)
+{
+  auto check = [&q](const Eigen::Ref<const Eigen::MatrixXd> & m, Eigen::Index rows, const std::string & name) {
+    if(m.rows() != rows || m.cols() != q.cols())
+    {
+      std::ostringstream str;
+      str << name << " size mismatch: expected (" << rows << ", " << q.cols() << ") gived (" << m.rows() << ", "
+          << m.cols() << ")";
+      throw std::domain_error(str.str());
+    }
+  };
+  check(q, mb.nrParams(), "q");
+  check(alpha, mb.nrDof(), "alpha");
+  check(alphaD, mb.nrDof(), "alphaD");
+  check(torque, mb.nrDof(), "torque");
+  if(mb.nrBodies() * 10 != YTtorque_.size())
+  {
+    std::ostringstream str;
+    str << "Number of parameters mismatch: expected " << YTtorque_.size() << " gived " << mb.nrBodies() * 10;
+    throw std::domain_error(str.str());
+  }
+
+  addTrajectory(mb, q, alpha, alphaD, torque, gravity, nrThreads);
+}
+
+void IDIMEstimator::sMerge(const IDIMEstimator & other)
+{
+  if(other.YTtorque_.size() != YTtorque_.size())
+  {
+    std::ostringstream str;
+    str << "Number of parameters mismatch: expected " << YTtorque_.size() << " gived " << other.YTtorque_.size();
+    throw std::domain_error(str.str());
+  }
+  if(other.forgettingFactor_ != forgettingFactor_)
+  {
+    std::ostringstream str;
+    str << "Forgetting factor mismatch: expected " << forgettingFactor_ << " gived " << other.forgettingFactor_;
+    throw std::domain_error(str.str());
+  }
+
+  merge(other);
+}
+
+void IDIMEstimator::accumulate(const Eigen::Ref<const Eigen::MatrixXd> & Y,
+                               const Eigen::Ref<const Eigen::VectorXd> & torque)
+{
+  decay();
+  YTY_.selfadjointView<Eigen::Lower>().rankUpdate(Y.transpose());
+  YTtorque_.noalias() += Y.transpose() * torque;
+  torqueTtorque_ += torque.squaredNorm();
+  ++nrSamples_;
+}
+
+void IDIMEstimator::accumulate(const CompactIDIM & Y, const Eigen::Ref<const Eigen::VectorXd> & torque)
+{
+  decay();
+  Y.addYTY(YTY_);
+  Y.addYTtorque(torque, YTtorque_);
+  torqueTtorque_ += torque.squaredNorm();
+  ++nrSamples_;
+}
+
+void IDIMEstimator::decay()
+{
+  if(forgettingFactor_ != 1.)
+  {
+    YTY_.triangularView<Eigen::Lower>() *= forgettingFactor_;
+    YTtorque_ *= forgettingFactor_;
+    torqueTtorque_ *= forgettingFactor_;
+  }
+}
+
+/**
+ *													EnergyIDIM
+ */
+
+EnergyIDIM::EnergyIDIM(const rbd::MultiBody & mb, bool actuator) : power_(0.)
+{
+  if(actuator)
+  {
+    for(int i = 0; i < mb.nrJoints(); ++i)
+    {
+      if(mb.joint(i).dof() != 0)
+      {
+        actuatedJoints_.push_back(i);
+      }
+    }
+  }
+  const int nrParams = mb.nrBodies() * 10 + static_cast<int>(actuatedJoints_.size()) * 3;
+  energy_.setZero(nrParams);
+  dissipation_.setZero(nrParams);
+}
+
+void EnergyIDIM::computeEnergy(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
+{
+  power_ = 0.;
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    const sva::MotionVecd & vb_i = mbc.bodyVelB[i];
+    const sva::PTransformd & X_0_i = mbc.bodyPosW[i];
+    auto e_i = energy_.segment<10>(i * 10);
+
+    // kinetic energy 1/2 v^T I v = 1/2 v^T IMPhi(v) phi
+    e_i.noalias() = 0.5 * IMPhi(vb_i).transpose() * vb_i.vector();
+    // potential energy g^T (m p + E^T h)
+    e_i(0) += mbc.gravity.dot(X_0_i.translation());
+    e_i.segment<3>(1) += X_0_i.rotation() * mbc.gravity;
+
+    for(int dof = 0; dof < mb.joint(i).dof(); ++dof)
+    {
+      power_ += mbc.jointTorque[i][dof] * mbc.alpha[i][dof];
+    }
+  }
+
+  const int nrJ = static_cast<int>(actuatedJoints_.size());
+  const int start = mb.nrBodies() * 10;
+  for(int k = 0; k < nrJ; ++k)
+  {
+    const std::vector<double> & alpha = mbc.alpha[actuatedJoints_[static_cast<std::size_t>(k)]];
+    double alphaSq = 0.;
+    double alphaAbs = 0.;
+    for(double a : alpha)
+    {
+      alphaSq += a * a;
+      alphaAbs += std::abs(a);
+    }
+    energy_(start + k) = 0.5 * alphaSq;
+    dissipation_(start + nrJ + k) = alphaSq;
+    dissipation_(start + 2 * nrJ + k) = alphaAbs;
+  }
+}
+
+void EnergyIDIM::computeY(const rbd::MultiBody & mb,
+                          const Eigen::Ref<const Eigen::MatrixXd> & q,
+                          const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                          const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                          double dt,
+                          int window,
+                          const Eigen::Vector3d & gravity,
+                          int nrThreads)
+{
+  const int nrS = static_cast<int>(q.cols());
+  const int nrWindows = nrS > 0 ? (nrS - 1) / window : 0;
+  Y_.resize(0, 0);
+  work_.resize(0);
+
+  MultiBodyConfig mbc(mb);
+  mbc.zero(mb);
+  mbc.gravity = gravity;
+  nrThreads = resolveNrThreads(nrThreads);
+  std::vector<MultiBodyConfig> mbcs(static_cast<std::size_t>(nrThreads), mbc);
+  std::vector<EnergyIDIM> eidims(static_cast<std::size_t>(nrThreads), *this);
+
+  Y_.setZero(nrWindows, energy_.size());
+  work_.setZero(nrWindows);
+
+  // each window recompute its first sample, so windows are independent
+  parallelFor(nrWindows, nrThreads, 1, [&](int thread, int begin, int end) {
+    MultiBodyConfig & tmbc = mbcs[static_cast<std::size_t>(thread)];
+    EnergyIDIM & eidim = eidims[static_cast<std::size_t>(thread)];
+    for(int w = begin; w < end; ++w)
+    {
+      auto row = Y_.row(w);
+      double & work = work_(w);
+      for(int s = w * window; s <= (w + 1) * window; ++s)
+      {
+        vectorToParam(q.col(s), tmbc.q);
+        vectorToParam(alpha.col(s), tmbc.alpha);
+        vectorToParam(torque.col(s), tmbc.jointTorque);
+        forwardKinematics(mb, tmbc);
+        forwardVelocity(mb, tmbc);
+        eidim.computeEnergy(mb, tmbc);
+
+        const double weight = (s == w * window || s == (w + 1) * window) ? 0.5 * dt : dt;
+        row.noalias() += weight * eidim.dissipation_.transpose();
+        work += weight * eidim.power_;
+        if(s == w * window)
+        {
+          row.noalias() -= eidim.energy_.transpose();
+        }
+        else if(s == (w + 1) * window)
+        {
+          row.noalias() += eidim.energy_.transpose();
+        }
+      }
+    }
+  });
+}
+
+Eigen::VectorXd EnergyIDIM::parameters(const rbd::MultiBody & mb) const
+{
+  Eigen::VectorXd phi(energy_.size());
+  phi.head(mb.nrBodies() * 10) = multiBodyToInertialVector(mb);
+  const int nrJ = static_cast<int>(actuatedJoints_.size());
+  const int start = mb.nrBodies() * 10;
+  for(int k = 0; k < nrJ; ++k)
+  {
+    const Joint & j = mb.joint(actuatedJoints_[static_cast<std::size_t>(k)]);
+    phi(start + k) = j.armature();
+    phi(start + nrJ + k) = j.damping();
+    phi(start + 2 * nrJ + k) = j.friction();
+  }
+  return phi;
+}
+
+void EnergyIDIM::sComputeEnergy(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc)
+{
+  checkMatchBodyPos(mb, mbc);
+  checkMatchBodyVel(mb, mbc);
+  checkMatchAlpha(mb, mbc);
+  checkMatchJointTorque(mb, mbc);
+  if(mb.nrBodies() * 10 + static_cast<int>(actuatedJoints_.size()) * 3 != energy_.size())
+  {
+    std::ostringstream str;
+    str << "Number of parameters mismatch: expected " << energy_.size() << " gived "
+        << mb.nrBodies() * 10 + static_cast<int>(actuatedJoints_.size()) * 3;
+    throw std::domain_error(str.str());
+  }
+
+  computeEnergy(mb, mbc);
+}
+
+void EnergyIDIM::sComputeY(const rbd::MultiBody & mb,
+                           const Eigen::Ref<const Eigen::MatrixXd> & q,
+                           const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                           const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                           double dt,
+                           int window,
+                           const Eigen::Vector3d & gravity,
+                           int nrThreads)
+{
+  auto check = [&q](const Eigen::Ref<const Eigen::MatrixXd> & m, Eigen::Index rows, const std::string & name) {
+    if(m.rows() != rows || m.cols() != q.cols())
+    {
+      std::ostringstream str;
+      str << name << " size mismatch: expected (" << rows << ", " << q.cols() << ") gived (" << m.rows() << ", "
+          << m.cols() << ")";
+      throw std::domain_error(str.str());
+    }
+  };
+  check(q, mb.nrParams(), "q");
+  check(alpha, mb.nrDof(), "alpha");
+  check(torque, mb.nrDof(), "torque");
+  if(window <= 0)
+  {
+    std::ostringstream str;
+    str << "window must be strictly positive: gived " << window;
+    throw std::domain_error(str.str());
+  }
+  if(mb.nrBodies() * 10 + static_cast<int>(actuatedJoints_.size()) * 3 != energy_.size())
+  {
+    std::ostringstream str;
+    str << "Number of parameters mismatch: expected " << energy_.size() << " gived "
+        << mb.nrBodies() * 10 + static_cast<int>(actuatedJoints_.size()) * 3;
+    throw std::domain_error(str.str());
+  }
+
+  computeY(mb, q, alpha, torque, dt, window, gravity, nrThreads);
+}
+
 } // namespace rbd
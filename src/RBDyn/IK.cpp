@@ -6,11 +6,15 @@
 #include "RBDyn/IK.h"
 
 // includes
+// std
+#include <algorithm>
+
 // RBDyn
 #include "RBDyn/FK.h"
 #include "RBDyn/FV.h"
 #include "RBDyn/MultiBody.h"
 #include "RBDyn/MultiBodyConfig.h"
+#include "RBDyn/Parallel.h"
 
 // SpaceVecAlg
 #include <SpaceVecAlg/SpaceVecAlg>
@@ -35,7 +39,9 @@ struct CwiseRoundOp
 
 InverseKinematics::InverseKinematics(const MultiBody & mb, int ef_index)
 : max_iterations_(ik::MAX_ITERATIONS), lambda_(ik::LAMBDA), threshold_(ik::THRESHOLD), almost_zero_(ik::ALMOST_ZERO),
-  ef_index_(ef_index), jac_(mb, mb.body(ef_index).name()), svd_()
+  ef_index_(ef_index), jac_(mb, mb.body(ef_index).name()),
+  svd_(6, jac_.dof(), Eigen::ComputeThinU | Eigen::ComputeThinV), jacMat_(6, jac_.dof()), res_(jac_.dof()),
+  svdTmp_(std::min(6, jac_.dof())), iterations_(0)
 {
 }
 
@@ -47,20 +53,23 @@ bool InverseKinematics::inverseKinematics(const MultiBody & mb,
   bool converged = false;
   int dof = 0;
   rbd::forwardKinematics(mb, mbc);
-  Eigen::MatrixXd jacMat;
   Eigen::Vector6d v = Eigen::Vector6d::Ones();
   Eigen::Vector3d rotErr;
-  Eigen::VectorXd res = Eigen::VectorXd::Zero(3);
   while(!converged && iter < max_iterations_)
   {
-    jacMat = jac_.jacobian(mb, mbc);
     // non-strict zeros in jacobian can be a problem...
-    jacMat = jacMat.unaryExpr(CwiseRoundOp(-almost_zero_, almost_zero_));
-    svd_.compute(jacMat, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    jacMat_ = jac_.jacobian(mb, mbc).unaryExpr(CwiseRoundOp(-almost_zero_, almost_zero_));
+    svd_.compute(jacMat_, Eigen::ComputeThinU | Eigen::ComputeThinV);
     rotErr = sva::rotationError(mbc.bodyPosW[ef_index_].rotation(), ef_target.rotation());
     v << rotErr, ef_target.translation() - mbc.bodyPosW[ef_index_].translation();
     converged = v.norm() < threshold_;
-    res = svd_.solve(v);
+
+    // same computation than svd_.solve(v) without its temporary
+    const Eigen::Index rank = svd_.rank();
+    auto tmp = svdTmp_.head(rank);
+    tmp.noalias() = svd_.matrixU().leftCols(rank).adjoint() * v;
+    tmp.array() /= svd_.singularValues().head(rank).array();
+    res_.noalias() = svd_.matrixV().leftCols(rank) * tmp;
 
     dof = 0;
     for(auto index : jac_.jointsPath())
@@ -68,7 +77,7 @@ bool InverseKinematics::inverseKinematics(const MultiBody & mb,
       std::vector<double> & qi = mbc.q[index];
       for(auto & qv : qi)
       {
-        qv += lambda_ * res[dof];
+        qv += lambda_ * res_[dof];
         ++dof;
       }
     }
@@ -77,6 +86,7 @@ bool InverseKinematics::inverseKinematics(const MultiBody & mb,
     rbd::forwardVelocity(mb, mbc);
     iter++;
   }
+  iterations_ = iter;
   return converged;
 }
 
@@ -92,4 +102,90 @@ bool InverseKinematics::sInverseKinematics(const MultiBody & mb,
   return inverseKinematics(mb, mbc, ef_target);
 }
 
+/**
+ *													BatchInverseKinematics
+ */
+
+BatchInverseKinematics::BatchInverseKinematics(const MultiBody & mb, int ef_index, int nrThreads)
+: max_iterations_(ik::MAX_ITERATIONS), lambda_(ik::LAMBDA), threshold_(ik::THRESHOLD), almost_zero_(ik::ALMOST_ZERO),
+  chunk_size_(64), nrBodies_(mb.nrBodies()), nrParams_(mb.nrParams()), nrDof_(mb.nrDof())
+{
+  MultiBodyConfig mbc(mb);
+  mbc.zero(mb);
+  forwardKinematics(mb, mbc);
+  forwardVelocity(mb, mbc);
+
+  nrThreads = resolveNrThreads(nrThreads);
+  workspaces_.reserve(static_cast<std::size_t>(nrThreads));
+  for(int i = 0; i < nrThreads; ++i)
+  {
+    workspaces_.push_back({mbc, InverseKinematics(mb, ef_index)});
+  }
+}
+
+int BatchInverseKinematics::inverseKinematics(const MultiBody & mb,
+                                              const std::vector<sva::PTransformd> & targets,
+                                              const Eigen::Ref<const Eigen::MatrixXd> & seeds)
+{
+  const int nrProblems = static_cast<int>(targets.size());
+  const bool singleSeed = seeds.cols() == 1;
+
+  q_.resize(mb.nrParams(), nrProblems);
+  converged_.resize(nrProblems);
+  iterations_.resize(nrProblems);
+
+  for(Workspace & ws : workspaces_)
+  {
+    ws.ik.max_iterations_ = max_iterations_;
+    ws.ik.lambda_ = lambda_;
+    ws.ik.threshold_ = threshold_;
+    ws.ik.almost_zero_ = almost_zero_;
+  }
+
+  parallelFor(nrProblems, nrThreads(), chunk_size_, [&](int thread, int begin, int end) {
+    Workspace & ws = workspaces_[static_cast<std::size_t>(thread)];
+    for(int i = begin; i < end; ++i)
+    {
+      vectorToParam(seeds.col(singleSeed ? 0 : i), ws.mbc.q);
+      converged_(i) = ws.ik.inverseKinematics(mb, ws.mbc, targets[static_cast<std::size_t>(i)]);
+      iterations_(i) = ws.ik.iterations();
+      paramToVector(ws.mbc.q, q_.col(i));
+    }
+  });
+
+  return static_cast<int>(converged_.count());
+}
+
+int BatchInverseKinematics::sInverseKinematics(const MultiBody & mb,
+                                               const std::vector<sva::PTransformd> & targets,
+                                               const Eigen::Ref<const Eigen::MatrixXd> & seeds)
+{
+  checkMatchMultiBody(mb);
+  if(seeds.rows() != mb.nrParams())
+  {
+    std::ostringstream str;
+    str << "seeds rows mismatch: expected " << mb.nrParams() << " gived " << seeds.rows();
+    throw std::domain_error(str.str());
+  }
+  if(seeds.cols() != 1 && seeds.cols() != static_cast<Eigen::Index>(targets.size()))
+  {
+    std::ostringstream str;
+    str << "seeds cols mismatch: expected 1 or " << targets.size() << " gived " << seeds.cols();
+    throw std::domain_error(str.str());
+  }
+
+  return inverseKinematics(mb, targets, seeds);
+}
+
+void BatchInverseKinematics::checkMatchMultiBody(const MultiBody & mb) const
+{
+  if(mb.nrBodies() != nrBodies_ || mb.nrParams() != nrParams_ || mb.nrDof() != nrDof_)
+  {
+    std::ostringstream str;
+    str << "MultiBody mismatch: expected (nrBodies, nrParams, nrDof) (" << nrBodies_ << ", " << nrParams_ << ", "
+        << nrDof_ << ") gived (" << mb.nrBodies() << ", " << mb.nrParams() << ", " << mb.nrDof() << ")";
+    throw std::domain_error(str.str());
+  }
+}
+
 } // namespace rbd
@@ -64,43 +64,12 @@ MultiBody Jacobian::subMultiBody(const MultiBody & mb) const
                    std::move(Xt));
 }
 
-/// private implementation of the Jacobian computation
-/// We use the Transform template allow Eigen3 to
-/// remove the Matrix3d from the computation.
-template<typename Transform>
-static inline const Eigen::MatrixXd & jacobian_(const MultiBody & mb,
-                                                const MultiBodyConfig & mbc,
-                                                const Transform & Trans_0_p,
-                                                const std::vector<int> & jointsPath,
-                                                Eigen::MatrixXd & jac)
-{
-  const std::vector<Joint> & joints = mb.joints();
-  int curJ = 0;
-
-  sva::PTransformd X_0_p(Trans_0_p);
-
-  for(std::size_t index = 0; index < jointsPath.size(); ++index)
-  {
-    int i = jointsPath[index];
-
-    sva::PTransformd X_i_N = X_0_p * mbc.bodyPosW[i].inv();
-
-    for(int dof = 0; dof < joints[i].dof(); ++dof)
-    {
-      jac.col(curJ + dof).noalias() = (X_i_N * (sva::MotionVecd(mbc.motionSubspace[i].col(dof)))).vector();
-    }
-
-    curJ += joints[i].dof();
-  }
-
-  return jac;
-}
-
 const Eigen::MatrixXd & Jacobian::jacobian(const MultiBody & mb,
                                            const MultiBodyConfig & mbc,
                                            const sva::PTransformd & X_0_p)
 {
-  return jacobian_(mb, mbc, X_0_p, jointsPath_, jac_);
+  detail::jacobian(mb, mbc, X_0_p, jointsPath_, jac_);
+  return jac_;
 }
 
 const Eigen::MatrixXd & Jacobian::jacobian(const MultiBody & mb, const MultiBodyConfig & mbc)
@@ -109,7 +78,8 @@ const Eigen::MatrixXd & Jacobian::jacobian(const MultiBody & mb, const MultiBody
 
   // the transformation must be read {}^0E_p {}^pT_N {}^NX_0
   Eigen::Vector3d T_0_Np((point_ * mbc.bodyPosW[N]).translation());
-  return jacobian_(mb, mbc, T_0_Np, jointsPath_, jac_);
+  detail::jacobian(mb, mbc, T_0_Np, jointsPath_, jac_);
+  return jac_;
 }
 
 const Eigen::MatrixXd & Jacobian::bodyJacobian(const MultiBody & mb, const MultiBodyConfig & mbc)
@@ -117,14 +87,15 @@ const Eigen::MatrixXd & Jacobian::bodyJacobian(const MultiBody & mb, const Multi
   int N = jointsPath_.back();
 
   sva::PTransformd X_0_Np = point_ * mbc.bodyPosW[N];
-  return jacobian_(mb, mbc, X_0_Np, jointsPath_, jac_);
+  detail::jacobian(mb, mbc, X_0_Np, jointsPath_, jac_);
+  return jac_;
 }
 
 const Eigen::MatrixXd & Jacobian::vectorJacobian(const MultiBody & mb,
                                                  const MultiBodyConfig & mbc,
                                                  const Eigen::Vector3d & vector)
 {
-  const std::vector<Joint> & joints = mb.joints();
+  const std::vector<JointData> & joints = mb.jointsData();
 
   int curJ = 0;
   int N = jointsPath_.back();
@@ -145,12 +116,12 @@ const Eigen::MatrixXd & Jacobian::vectorJacobian(const MultiBody & mb,
     // Iteration : {}^{Nv}X_i S_i - {}^NX_i S_i
     //             ({}^{Nv}T_i - {}^NT_i) S_i
     //             {}^0E_i(T) (({}^{N}T_i - {}^{Nv}T_i) \times W_i)
-    for(int dof = 0; dof < joints[i].dof(); ++dof)
+    for(int dof = 0; dof < joints[i].dof; ++dof)
     {
       jac_.col(curJ + dof).tail<3>().noalias() = E_i_0 * (diff.cross(mbc.motionSubspace[i].col(dof).head<3>()));
     }
 
-    curJ += joints[i].dof();
+    curJ += joints[i].dof;
   }
 
   return jac_;
@@ -160,7 +131,7 @@ const Eigen::MatrixXd & Jacobian::vectorBodyJacobian(const MultiBody & mb,
                                                      const MultiBodyConfig & mbc,
                                                      const Eigen::Vector3d & vector)
 {
-  const std::vector<Joint> & joints = mb.joints();
+  const std::vector<JointData> & joints = mb.jointsData();
 
   int curJ = 0;
   int N = jointsPath_.back();
@@ -179,13 +150,13 @@ const Eigen::MatrixXd & Jacobian::vectorBodyJacobian(const MultiBody & mb,
     // Iteration : {}^{Nv}X_i S_i - {}^NX_i S_i
     //             ({}^{Nv}T_i - {}^NT_i) S_i
     //             {}^NE_i(T) (({}^{N}T_i - {}^{Nv}T_i) \times W_i)
-    for(int dof = 0; dof < joints[i].dof(); ++dof)
+    for(int dof = 0; dof < joints[i].dof; ++dof)
     {
       jac_.col(curJ + dof).tail<3>().noalias() =
           X_i_N.rotation() * (diff.cross(mbc.motionSubspace[i].col(dof).head<3>()));
     }
 
-    curJ += joints[i].dof();
+    curJ += joints[i].dof;
   }
 
   return jac_;
@@ -193,7 +164,7 @@ const Eigen::MatrixXd & Jacobian::vectorBodyJacobian(const MultiBody & mb,
 
 const Eigen::MatrixXd & Jacobian::jacobianDot(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
-  const std::vector<Joint> & joints = mb.joints();
+  const std::vector<JointData> & joints = mb.jointsData();
 
   int curJ = 0;
   int N = jointsPath_.back();
@@ -214,7 +185,7 @@ const Eigen::MatrixXd & Jacobian::jacobianDot(const MultiBody & mb, const MultiB
     // speed of X_i_N in Np coordinate
     sva::MotionVecd X_VNp_i_Np = X_i_Np * mbc.bodyVelB[i] - X_VNp;
 
-    for(int j = 0; j < joints[i].dof(); ++j)
+    for(int j = 0; j < joints[i].dof; ++j)
     {
       sva::MotionVecd S_ij(mbc.motionSubspace[i].col(j));
 
@@ -233,7 +204,7 @@ const Eigen::MatrixXd & Jacobian::jacobianDot(const MultiBody & mb, const MultiB
 
 const Eigen::MatrixXd & Jacobian::bodyJacobianDot(const MultiBody & mb, const MultiBodyConfig & mbc)
 {
-  const std::vector<Joint> & joints = mb.joints();
+  const std::vector<JointData> & joints = mb.jointsData();
 
   int curJ = 0;
   int N = jointsPath_.back();
@@ -250,7 +221,7 @@ const Eigen::MatrixXd & Jacobian::bodyJacobianDot(const MultiBody & mb, const Mu
     // speed of X_i_N in Np coordinate
     sva::MotionVecd X_VNp_i_Np = X_i_Np * mbc.bodyVelB[i] - X_VNp;
 
-    for(int j = 0; j < joints[i].dof(); ++j)
+    for(int j = 0; j < joints[i].dof; ++j)
     {
       sva::MotionVecd S_ij(mbc.motionSubspace[i].col(j));
 
@@ -6,6 +6,13 @@
 #include "RBDyn/MultiBody.h"
 
 // includes
+// std
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <sstream>
+
 // RBDyn
 #include "RBDyn/Body.h"
 #include "RBDyn/Joint.h"
@@ -13,7 +20,13 @@
 namespace rbd
 {
 
-MultiBody::MultiBody() : nrParams_(0), nrDof_(0) {}
+std::uint64_t nextStamp()
+{
+  static std::atomic<std::uint64_t> stamp(0);
+  return ++stamp;
+}
+
+MultiBody::MultiBody() : nrParams_(0), nrDof_(0), stamp_(0), inertiaStamp_(0), geometryStamp_(0) {}
 
 MultiBody::MultiBody(std::vector<Body> bodies,
                      std::vector<Joint> joints,
@@ -23,7 +36,7 @@ MultiBody::MultiBody(std::vector<Body> bodies,
                      std::vector<sva::PTransformd> Xto)
 : bodies_(std::move(bodies)), joints_(std::move(joints)), pred_(std::move(pred)), succ_(std::move(succ)),
   parent_(std::move(parent)), Xt_(std::move(Xto)), jointPosInParam_(joints_.size()), jointPosInDof_(joints_.size()),
-  nrParams_(0), nrDof_(0)
+  nrParams_(0), nrDof_(0), stamp_(0), inertiaStamp_(0), geometryStamp_(0)
 {
   for(int i = 0; i < static_cast<int>(bodies_.size()); ++i)
   {
@@ -36,6 +49,225 @@ MultiBody::MultiBody(std::vector<Body> bodies,
     nrParams_ += joints_[i].params();
     nrDof_ += joints_[i].dof();
   }
+
+  updateJointsData();
+}
+
+void MultiBody::updateJointsData()
+{
+  jointsData_.resize(joints_.size());
+  S_.resize(6, nrDof_);
+  for(std::size_t i = 0; i < joints_.size(); ++i)
+  {
+    const Joint & j = joints_[i];
+    JointData & jd = jointsData_[i];
+    jd.Xt = Xt_[i];
+    jd.inertia = bodies_[succ_[i]].inertia();
+    jd.type = j.type();
+    jd.direction = j.direction();
+    jd.params = j.params();
+    jd.dof = j.dof();
+    jd.posInParam = jointPosInParam_[i];
+    jd.posInDof = jointPosInDof_[i];
+    jd.pred = pred_[i];
+    jd.succ = succ_[i];
+    jd.hasActuatorDynamics = j.hasActuatorDynamics();
+    jd.armature = j.armature();
+    jd.damping = j.damping();
+    jd.friction = j.friction();
+    S_.middleCols(jd.posInDof, jd.dof) = j.motionSubspace();
+  }
+  stamp_ = nextStamp();
+  inertiaStamp_ = stamp_;
+  geometryStamp_ = stamp_;
+}
+
+void MultiBody::updateBodyData(int num)
+{
+  for(JointData & jd : jointsData_)
+  {
+    if(jd.succ == num)
+    {
+      jd.inertia = bodies_[num].inertia();
+    }
+  }
+  stamp_ = nextStamp();
+  inertiaStamp_ = stamp_;
+}
+
+void MultiBody::sJointAxis(int num, const Eigen::Vector3d & axis)
+{
+  Joint::Type type = joints_.at(num).type();
+  if(type != Joint::Rev && type != Joint::Prism && type != Joint::Cylindrical)
+  {
+    std::ostringstream str;
+    str << "joint " << joints_[num].name() << " has no axis: expected Rev, Prism or Cylindrical joint";
+    throw std::domain_error(str.str());
+  }
+  if(std::abs(axis.norm() - 1.) > 1e-8)
+  {
+    std::ostringstream str;
+    str << "joint " << joints_[num].name() << " axis must be unitary: expected norm 1 gived " << axis.norm();
+    throw std::domain_error(str.str());
+  }
+  jointAxis(num, axis);
+}
+
+int MultiBody::addFrame(const std::string & name, int body, const sva::PTransformd & X_b_f)
+{
+  int index = static_cast<int>(frames_.size());
+  frames_.push_back({name, body, X_b_f});
+  frameNameToInd_[name] = index;
+  return index;
+}
+
+int MultiBody::sAddFrame(const std::string & name, int body, const sva::PTransformd & X_b_f)
+{
+  if(body < 0 || body >= nrBodies())
+  {
+    std::ostringstream str;
+    str << "frame " << name << " body index out of range: expected [0, " << nrBodies() << ") gived " << body;
+    throw std::out_of_range(str.str());
+  }
+  if(hasFrame(name))
+  {
+    std::ostringstream str;
+    str << "frame " << name << " already exists";
+    throw std::domain_error(str.str());
+  }
+  return addFrame(name, body, X_b_f);
+}
+
+std::vector<int> bodiesOrder(const MultiBody & mb, BodyOrder order)
+{
+  std::vector<std::vector<int>> children(static_cast<std::size_t>(mb.nrBodies()));
+  std::vector<int> roots;
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    if(mb.parent(i) == -1)
+      roots.push_back(i);
+    else
+      children[mb.parent(i)].push_back(i);
+  }
+
+  if(order == BodyOrder::LongestChainFirst)
+  {
+    // height of each subtree, the index of a parent is always lower than its children index
+    std::vector<int> height(static_cast<std::size_t>(mb.nrBodies()), 0);
+    for(int i = mb.nrBodies() - 1; i >= 0; --i)
+    {
+      if(mb.parent(i) != -1)
+      {
+        height[mb.parent(i)] = std::max(height[mb.parent(i)], height[i] + 1);
+      }
+    }
+    for(std::vector<int> & c : children)
+    {
+      std::stable_sort(c.begin(), c.end(), [&height](int a, int b) { return height[a] > height[b]; });
+    }
+  }
+
+  std::vector<int> res;
+  res.reserve(static_cast<std::size_t>(mb.nrBodies()));
+  if(order == BodyOrder::BreadthFirst)
+  {
+    res = roots;
+    for(std::size_t i = 0; i < res.size(); ++i)
+    {
+      const std::vector<int> & c = children[res[i]];
+      res.insert(res.end(), c.begin(), c.end());
+    }
+  }
+  else
+  {
+    std::function<void(int)> visit = [&](int i) {
+      res.push_back(i);
+      for(int c : children[i])
+      {
+        visit(c);
+      }
+    };
+    for(int r : roots)
+    {
+      visit(r);
+    }
+  }
+
+  return res;
+}
+
+MultiBody reorder(const MultiBody & mb, const std::vector<int> & order)
+{
+  std::vector<int> newIndex(order.size());
+  for(std::size_t i = 0; i < order.size(); ++i)
+  {
+    newIndex[order[i]] = static_cast<int>(i);
+  }
+  auto remap = [&newIndex](int i) { return i == -1 ? -1 : newIndex[i]; };
+
+  std::vector<Body> bodies;
+  std::vector<Joint> joints;
+  std::vector<int> pred, succ, parent;
+  std::vector<sva::PTransformd> Xt;
+  bodies.reserve(order.size());
+  joints.reserve(order.size());
+  for(int old : order)
+  {
+    bodies.push_back(mb.body(old));
+    joints.push_back(mb.joint(old));
+    pred.push_back(remap(mb.predecessor(old)));
+    succ.push_back(remap(mb.successor(old)));
+    parent.push_back(remap(mb.parent(old)));
+    Xt.push_back(mb.transform(old));
+  }
+
+  MultiBody res(std::move(bodies), std::move(joints), std::move(pred), std::move(succ), std::move(parent),
+                std::move(Xt));
+  for(const OperationalFrame & f : mb.frames())
+  {
+    res.addFrame(f.name, newIndex[f.body], f.X_b_f);
+  }
+  return res;
+}
+
+MultiBody reorder(const MultiBody & mb, BodyOrder order)
+{
+  return reorder(mb, bodiesOrder(mb, order));
+}
+
+MultiBody sReorder(const MultiBody & mb, const std::vector<int> & order)
+{
+  if(static_cast<int>(order.size()) != mb.nrBodies())
+  {
+    std::ostringstream str;
+    str << "order size mismatch: expected " << mb.nrBodies() << " gived " << order.size();
+    throw std::domain_error(str.str());
+  }
+
+  std::vector<int> newIndex(order.size(), -1);
+  for(std::size_t i = 0; i < order.size(); ++i)
+  {
+    if(order[i] < 0 || order[i] >= mb.nrBodies() || newIndex[order[i]] != -1)
+    {
+      std::ostringstream str;
+      str << "order is not a permutation: body " << order[i] << " at position " << i;
+      throw std::domain_error(str.str());
+    }
+    newIndex[order[i]] = static_cast<int>(i);
+  }
+
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    int p = mb.parent(i);
+    if(p != -1 && newIndex[p] > newIndex[i])
+    {
+      std::ostringstream str;
+      str << "body " << mb.body(i).name() << " is placed before its parent " << mb.body(p).name();
+      throw std::domain_error(str.str());
+    }
+  }
+
+  return reorder(mb, order);
 }
 
 } // namespace rbd
@@ -15,39 +15,11 @@
 namespace rbd
 {
 
-MultiBodyConfig::MultiBodyConfig(const MultiBody & mb)
-: q(mb.nrJoints()), alpha(mb.nrJoints()), alphaD(mb.nrJoints()), force(mb.nrBodies()), jointConfig(mb.nrJoints()),
-  jointVelocity(mb.nrJoints()), jointTorque(mb.nrJoints()), motionSubspace(mb.nrJoints()), bodyPosW(mb.nrBodies()),
-  parentToSon(mb.nrBodies()), bodyVelW(mb.nrBodies()), bodyVelB(mb.nrBodies()), bodyAccB(mb.nrBodies()),
-  gravity(0., 9.81, 0.)
-{
-  for(int i = 0; i < static_cast<int>(q.size()); ++i)
-  {
-    q[i].resize(mb.joint(i).params());
-    alpha[i].resize(mb.joint(i).dof());
-    alphaD[i].resize(mb.joint(i).dof());
+template struct MultiBodyConfigT<double>;
 
-    jointTorque[i].resize(mb.joint(i).dof());
-    motionSubspace[i].resize(6, mb.joint(i).dof());
-  }
-}
+MultiBodyConfig::MultiBodyConfig(const MultiBody & mb) : MultiBodyConfigT<double>(mb) {}
 
-void MultiBodyConfig::zero(const MultiBody & mb)
-{
-  for(int i = 0; i < static_cast<int>(q.size()); ++i)
-  {
-    q[i] = mb.joint(i).zeroParam();
-    alpha[i] = mb.joint(i).zeroDof();
-    alphaD[i] = mb.joint(i).zeroDof();
-
-    jointTorque[i] = mb.joint(i).zeroDof();
-  }
-
-  for(std::size_t i = 0; i < force.size(); ++i)
-  {
-    force[i] = sva::ForceVecd(Eigen::Vector6d::Zero());
-  }
-}
+MultiBodyConfig::MultiBodyConfig(const MultiBodyConfigT<double> & mbc) : MultiBodyConfigT<double>(mbc) {}
 
 std::vector<Eigen::MatrixXd> MultiBodyConfig::python_motionSubspace()
 {
@@ -74,17 +46,23 @@ void MultiBodyConfig::python_motionSubspace(const std::vector<Eigen::MatrixXd> &
  *													ConfigConverter
  */
 
-ConfigConverter::ConfigConverter(const MultiBody & from, const MultiBody & to)
-: jInd_(from.nrJoints() - 1), bInd_(from.nrBodies())
+ConfigConverter::ConfigConverter(const MultiBody & from, const MultiBody & to, bool convertBase)
+: first_(convertBase ? 0 : 1), fromNrParams_(from.nrParams()), toNrParams_(to.nrParams()),
+  fromNrDof_(from.nrDof()), toNrDof_(to.nrDof()), jInd_(from.nrJoints() - first_), bInd_(from.nrBodies())
 {
   using namespace Eigen;
 
   const std::vector<Body> & bodies = from.bodies();
   const std::vector<Joint> & joints = from.joints();
 
-  for(std::size_t i = 0; i < joints.size() - 1; ++i)
+  for(std::size_t i = 0; i < jInd_.size(); ++i)
   {
-    jInd_[i] = to.jointIndexByName(joints[i + 1].name());
+    int fromInd = static_cast<int>(i) + first_;
+    int toInd = to.jointIndexByName(joints[fromInd].name());
+    jInd_[i] = toInd;
+
+    addSegment(paramSegments_, from.jointPosInParam(fromInd), to.jointPosInParam(toInd), joints[fromInd].params());
+    addSegment(dofSegments_, from.jointPosInDof(fromInd), to.jointPosInDof(toInd), joints[fromInd].dof());
   }
 
   for(std::size_t i = 0; i < bodies.size(); ++i)
@@ -93,13 +71,33 @@ ConfigConverter::ConfigConverter(const MultiBody & from, const MultiBody & to)
   }
 }
 
+void ConfigConverter::addSegment(std::vector<Segment> & segments, int from, int to, int size)
+{
+  if(size == 0)
+  {
+    return;
+  }
+
+  // merge the joints that are contiguous in both vectors
+  if(!segments.empty())
+  {
+    Segment & last = segments.back();
+    if(last.from + last.size == from && last.to + last.size == to)
+    {
+      last.size += size;
+      return;
+    }
+  }
+  segments.push_back({from, to, size});
+}
+
 void ConfigConverter::convert(const MultiBodyConfig & from, MultiBodyConfig & to) const
 {
   for(std::size_t i = 0; i < jInd_.size(); ++i)
   {
-    to.q[jInd_[i]] = from.q[i + 1];
-    to.alpha[jInd_[i]] = from.alpha[i + 1];
-    to.alphaD[jInd_[i]] = from.alphaD[i + 1];
+    to.q[jInd_[i]] = from.q[i + first_];
+    to.alpha[jInd_[i]] = from.alpha[i + first_];
+    to.alphaD[jInd_[i]] = from.alphaD[i + first_];
   }
 
   for(std::size_t i = 0; i < bInd_.size(); ++i)
@@ -108,7 +106,23 @@ void ConfigConverter::convert(const MultiBodyConfig & from, MultiBodyConfig & to
   }
 }
 
-ConfigConverter * ConfigConverter::sConstructor(const MultiBody & from, const MultiBody & to)
+void ConfigConverter::convertParam(const Eigen::Ref<const Eigen::VectorXd> & from, Eigen::Ref<Eigen::VectorXd> to) const
+{
+  for(const Segment & s : paramSegments_)
+  {
+    to.segment(s.to, s.size) = from.segment(s.from, s.size);
+  }
+}
+
+void ConfigConverter::convertDof(const Eigen::Ref<const Eigen::VectorXd> & from, Eigen::Ref<Eigen::VectorXd> to) const
+{
+  for(const Segment & s : dofSegments_)
+  {
+    to.segment(s.to, s.size) = from.segment(s.from, s.size);
+  }
+}
+
+ConfigConverter * ConfigConverter::sConstructor(const MultiBody & from, const MultiBody & to, bool convertBase)
 {
   bool isOk = true;
 
@@ -116,6 +130,8 @@ ConfigConverter * ConfigConverter::sConstructor(const MultiBody & from, const Mu
 
   if(from.nrJoints() != to.nrJoints()) isOk = false;
 
+  if(isOk && convertBase && from.joint(0).type() != to.joint(0).type()) isOk = false;
+
   if(isOk)
   {
     const std::vector<Joint> & joints = from.joints();
@@ -151,7 +167,7 @@ ConfigConverter * ConfigConverter::sConstructor(const MultiBody & from, const Mu
     throw std::domain_error("MultiBody mismatch");
   }
 
-  return new ConfigConverter(from, to);
+  return new ConfigConverter(from, to, convertBase);
 }
 
 void ConfigConverter::sConvert(const MultiBodyConfig & from, MultiBodyConfig & to) const
@@ -174,6 +190,33 @@ void ConfigConverter::sConvert(const MultiBodyConfig & from, MultiBodyConfig & t
   convert(from, to);
 }
 
+void ConfigConverter::sConvertParam(const Eigen::Ref<const Eigen::VectorXd> & from,
+                                    Eigen::Ref<Eigen::VectorXd> to) const
+{
+  if(from.size() != fromNrParams_ || to.size() != toNrParams_)
+  {
+    std::ostringstream str;
+    str << "param vector size mismatch: expected " << fromNrParams_ << " and " << toNrParams_ << " gived "
+        << from.size() << " and " << to.size();
+    throw std::domain_error(str.str());
+  }
+
+  convertParam(from, to);
+}
+
+void ConfigConverter::sConvertDof(const Eigen::Ref<const Eigen::VectorXd> & from, Eigen::Ref<Eigen::VectorXd> to) const
+{
+  if(from.size() != fromNrDof_ || to.size() != toNrDof_)
+  {
+    std::ostringstream str;
+    str << "dof vector size mismatch: expected " << fromNrDof_ << " and " << toNrDof_ << " gived " << from.size()
+        << " and " << to.size();
+    throw std::domain_error(str.str());
+  }
+
+  convertDof(from, to);
+}
+
 /**
  *													Param convertion
  */
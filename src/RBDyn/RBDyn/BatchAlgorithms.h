@@ -0,0 +1,197 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <vector>
+
+// Eigen
+#include <Eigen/Core>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+// RBDyn
+#include <rbdyn/config.hh>
+
+#include "FD.h"
+#include "ID.h"
+#include "Jacobian.h"
+#include "MultiBodyConfig.h"
+
+namespace rbd
+{
+class MultiBody;
+
+/**
+ * Run the kinematics and dynamics algorithms over many samples (a trajectory
+ * or a batch of states) in one call.
+ * Samples are stored by column, so the C-contiguous (T x nrParams) or
+ * (T x nrDof) arrays of Python map to the (nrParams x T) and (nrDof x T)
+ * inputs without copy. Matrices of a sample are stored row-major in its
+ * column, which is the layout of the C-contiguous arrays of shape
+ * (T, nrBodies, 4, 4), (T, nrBodies, 6) and (T, 6, dof).
+ * Samples are dispatched on a set of worker threads, each worker own a copy
+ * of the MultiBodyConfig and of the algorithms, nothing is allocated per
+ * sample. Results are written in the output matrices given by the caller.
+ * The workers state is shared by all the calls, an instance must not be used
+ * by two threads at the same time.
+ */
+class RBDYN_DLLAPI BatchAlgorithms
+{
+public:
+  /**
+   * @param mb MultiBody associated with this algorithm.
+   * @param nrThreads Number of worker threads, 0 means one per hardware thread.
+   */
+  BatchAlgorithms(const MultiBody & mb, int nrThreads = 0);
+
+  /**
+   * Compute the forward kinematics of each sample.
+   * @param mb MultiBody used has model.
+   * @param q Generalized position of each sample stored by column (nrParams x T).
+   * @param bodyPosW Body transforms of each sample stored by column
+   * (16*nrBodies x T). The transform of body i is the row-major homogeneous
+   * matrix [E^T r; 0 0 0 1] of the body frame in the world frame starting at
+   * row 16*i.
+   */
+  void forwardKinematics(const MultiBody & mb,
+                         const Eigen::Ref<const Eigen::MatrixXd> & q,
+                         Eigen::Ref<Eigen::MatrixXd> bodyPosW);
+
+  /**
+   * Compute the forward velocity of each sample.
+   * @param mb MultiBody used has model.
+   * @param q Generalized position of each sample stored by column (nrParams x T).
+   * @param alpha Generalized velocity of each sample stored by column (nrDof x T).
+   * @param bodyVelW Body velocities in world frame of each sample stored by
+   * column (6*nrBodies x T), angular then linear velocity of body i start at
+   * row 6*i.
+   */
+  void forwardVelocity(const MultiBody & mb,
+                       const Eigen::Ref<const Eigen::MatrixXd> & q,
+                       const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                       Eigen::Ref<Eigen::MatrixXd> bodyVelW);
+
+  /**
+   * Compute the inverse dynamics of each sample without external forces.
+   * @param mb MultiBody used has model.
+   * @param q Generalized position of each sample stored by column (nrParams x T).
+   * @param alpha Generalized velocity of each sample stored by column (nrDof x T).
+   * @param alphaD Generalized acceleration of each sample stored by column (nrDof x T).
+   * @param torque Joint torque of each sample stored by column (nrDof x T).
+   */
+  void inverseDynamics(const MultiBody & mb,
+                       const Eigen::Ref<const Eigen::MatrixXd> & q,
+                       const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                       const Eigen::Ref<const Eigen::MatrixXd> & alphaD,
+                       Eigen::Ref<Eigen::MatrixXd> torque);
+
+  /**
+   * Compute the forward dynamics of each sample without external forces.
+   * @param mb MultiBody used has model.
+   * @param q Generalized position of each sample stored by column (nrParams x T).
+   * @param alpha Generalized velocity of each sample stored by column (nrDof x T).
+   * @param torque Joint torque of each sample stored by column (nrDof x T).
+   * @param alphaD Generalized acceleration of each sample stored by column (nrDof x T).
+   */
+  void forwardDynamics(const MultiBody & mb,
+                       const Eigen::Ref<const Eigen::MatrixXd> & q,
+                       const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                       const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                       Eigen::Ref<Eigen::MatrixXd> alphaD);
+
+  /**
+   * Compute the jacobian in world frame of each sample (@see Jacobian::jacobian).
+   * @param mb MultiBody used has model.
+   * @param jac Jacobian to compute, copied on each worker.
+   * @param q Generalized position of each sample stored by column (nrParams x T).
+   * @param jacobians Row-major (6 x jac.dof()) jacobian of each sample stored
+   * by column (6*jac.dof() x T).
+   */
+  void jacobian(const MultiBody & mb,
+                const Jacobian & jac,
+                const Eigen::Ref<const Eigen::MatrixXd> & q,
+                Eigen::Ref<Eigen::MatrixXd> jacobians);
+
+  /// @return Number of worker threads.
+  int nrThreads() const
+  {
+    return static_cast<int>(workspaces_.size());
+  }
+
+  // safe version for python binding
+
+  /** safe version of @see forwardKinematics.
+   * @throw std::domain_error If mb don't match this algorithm or if the samples
+   * or the output don't match mb.
+   */
+  void sForwardKinematics(const MultiBody & mb,
+                          const Eigen::Ref<const Eigen::MatrixXd> & q,
+                          Eigen::Ref<Eigen::MatrixXd> bodyPosW);
+
+  /** safe version of @see forwardVelocity.
+   * @throw std::domain_error If mb don't match this algorithm or if the samples
+   * or the output don't match mb.
+   */
+  void sForwardVelocity(const MultiBody & mb,
+                        const Eigen::Ref<const Eigen::MatrixXd> & q,
+                        const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                        Eigen::Ref<Eigen::MatrixXd> bodyVelW);
+
+  /** safe version of @see inverseDynamics.
+   * @throw std::domain_error If mb don't match this algorithm or if the samples
+   * or the output don't match mb.
+   */
+  void sInverseDynamics(const MultiBody & mb,
+                        const Eigen::Ref<const Eigen::MatrixXd> & q,
+                        const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                        const Eigen::Ref<const Eigen::MatrixXd> & alphaD,
+                        Eigen::Ref<Eigen::MatrixXd> torque);
+
+  /** safe version of @see forwardDynamics.
+   * @throw std::domain_error If mb don't match this algorithm or if the samples
+   * or the output don't match mb.
+   */
+  void sForwardDynamics(const MultiBody & mb,
+                        const Eigen::Ref<const Eigen::MatrixXd> & q,
+                        const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                        const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                        Eigen::Ref<Eigen::MatrixXd> alphaD);
+
+  /** safe version of @see jacobian.
+   * @throw std::domain_error If mb don't match this algorithm or if the samples,
+   * jac or the output don't match mb.
+   */
+  void sJacobian(const MultiBody & mb,
+                 const Jacobian & jac,
+                 const Eigen::Ref<const Eigen::MatrixXd> & q,
+                 Eigen::Ref<Eigen::MatrixXd> jacobians);
+
+  /// Gravity acting on the multibody in inverseDynamics and forwardDynamics.
+  Eigen::Vector3d gravity_;
+  // @brief Number of samples given to a worker at once
+  int chunk_size_;
+
+private:
+  struct Workspace
+  {
+    MultiBodyConfig mbc;
+    InverseDynamics id;
+    ForwardDynamics fd;
+    Jacobian jac;
+  };
+
+  void checkMatchMultiBody(const MultiBody & mb) const;
+
+private:
+  int nrBodies_;
+  int nrParams_;
+  int nrDof_;
+  std::vector<Workspace> workspaces_;
+};
+
+} // namespace rbd
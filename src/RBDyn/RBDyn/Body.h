@@ -51,6 +51,12 @@ public:
     return inertia_;
   }
 
+  /// Set the body spatial rigid body inertia.
+  void inertia(const sva::RBInertiad & rbInertia)
+  {
+    inertia_ = rbInertia;
+  }
+
   bool operator==(const Body & b) const
   {
     return name_ == b.name_;
@@ -5,6 +5,8 @@
 #pragma once
 
 // std
+#include <cassert>
+#include <cstdint>
 #include <vector>
 
 // Eigen
@@ -14,11 +16,11 @@
 #include <rbdyn/config.hh>
 
 #include "Jacobian.h"
+#include "MultiBody.h"
+#include "MultiBodyConfig.h"
 
 namespace rbd
 {
-class MultiBody;
-struct MultiBodyConfig;
 
 /**
  * Compute the Center of Mass (CoM) position of a multibody.
@@ -44,6 +46,27 @@ RBDYN_DLLAPI Eigen::Vector3d computeCoMVelocity(const MultiBody & mb, const Mult
  */
 RBDYN_DLLAPI Eigen::Vector3d computeCoMAcceleration(const MultiBody & mb, const MultiBodyConfig & mbc);
 
+/**
+ * Compute the CoM position of a multibody with the scalar type T.
+ * @see computeCoM.
+ */
+template<typename T>
+Eigen::Matrix<T, 3, 1> computeCoM(const MultiBody & mb, const MultiBodyConfigT<T> & mbc);
+
+/**
+ * Compute the CoM velocity of a multibody with the scalar type T.
+ * @see computeCoMVelocity.
+ */
+template<typename T>
+Eigen::Matrix<T, 3, 1> computeCoMVelocity(const MultiBody & mb, const MultiBodyConfigT<T> & mbc);
+
+/**
+ * Compute the CoM acceleration of a multibody with the scalar type T.
+ * @see computeCoMAcceleration.
+ */
+template<typename T>
+Eigen::Matrix<T, 3, 1> computeCoMAcceleration(const MultiBody & mb, const MultiBodyConfigT<T> & mbc);
+
 /**
  * Compute the CoM jacobian with a simple but slow algorithm.
  */
@@ -141,6 +164,9 @@ public:
    * Compute bodies CoM position and mass based on a MultiBody.
    * This method allow to update some pre-computed parameters
    * when MultiBody inertia has changed.
+   * jacobian, jacobianDot and normalAcceleration(mb, mbc) call it when
+   * mb.inertiaStamp() has changed since the last update, the const methods
+   * use the parameters of the last update.
    * @param mb MultiBody used as model.
    */
   void updateInertialParameters(const MultiBody & mb);
@@ -159,6 +185,17 @@ public:
    */
   const Eigen::MatrixXd & jacobian(const MultiBody & mb, const MultiBodyConfig & mbc);
 
+  /**
+   * Compute the CoM jacobian only if the mbc position changed since the last
+   * updateJacobian call (@see ConfigStamps).
+   * The code that fill bodyPosW without forwardKinematics must call
+   * mbc.stamps.positionChanged.
+   * @param mb MultiBody used as model.
+   * @param mbc Use bodyPosW and motionSubspace.
+   * @return CoM Jacobian of mb with mbc configuration.
+   */
+  const Eigen::MatrixXd & updateJacobian(const MultiBody & mb, const MultiBodyConfig & mbc);
+
   /**
    * Access the last computed CoM jacobian
    * @return Latest CoM jacobian that was computed by this object
@@ -176,6 +213,15 @@ public:
    */
   const Eigen::MatrixXd & jacobianDot(const MultiBody & mb, const MultiBodyConfig & mbc);
 
+  /**
+   * Compute the time derivative of the CoM jacobian only if the mbc position
+   * or velocity changed since the last updateJacobianDot call (@see ConfigStamps).
+   * @param mb MultiBody used as model.
+   * @param mbc Use bodyPosW, bodyVelB, bodyVelW, and motionSubspace.
+   * @return Time derivativo of the jacobian of mb with mbc configuration.
+   */
+  const Eigen::MatrixXd & updateJacobianDot(const MultiBody & mb, const MultiBodyConfig & mbc);
+
   /**
    * Access the last computed derivative of the CoM jacobian
    * @return Latest derivative of the CoM jacobian that was computed by this object
@@ -254,6 +300,14 @@ public:
 
 private:
   void init(const rbd::MultiBody & mb);
+  /// Call updateInertialParameters if mb inertia has changed.
+  void checkInertialParameters(const MultiBody & mb)
+  {
+    if(!ConfigStamps::same(inertiaStamp_, mb.inertiaStamp()))
+    {
+      updateInertialParameters(mb);
+    }
+  }
 
 private:
   Eigen::MatrixXd jac_;
@@ -272,6 +326,13 @@ private:
   std::vector<sva::MotionVecd> normalAcc_;
 
   std::vector<double> weight_;
+
+  // mbc.stamps of the last updateJacobian and updateJacobianDot computation
+  std::uint64_t jacPositionStamp_ = 0;
+  std::uint64_t jacDotPositionStamp_ = 0;
+  std::uint64_t jacDotVelocityStamp_ = 0;
+  // mb.inertiaStamp() of bodiesCoeff_ and bodiesCoM_
+  std::uint64_t inertiaStamp_ = 0;
 };
 
 // safe version for python binding
@@ -297,4 +358,99 @@ RBDYN_DLLAPI Eigen::Vector3d sComputeCoMVelocity(const MultiBody & mb, const Mul
  */
 RBDYN_DLLAPI Eigen::Vector3d sComputeCoMAcceleration(const MultiBody & mb, const MultiBodyConfig & mbc);
 
+template<typename T>
+Eigen::Matrix<T, 3, 1> computeCoM(const MultiBody & mb, const MultiBodyConfigT<T> & mbc)
+{
+  typedef Eigen::Matrix<T, 3, 1> Vector3;
+
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  Vector3 com = Vector3::Zero();
+  T totalMass(0.);
+
+  for(const JointData & jd : joints)
+  {
+    const int i = jd.succ;
+    T mass(jd.inertia.mass());
+
+    totalMass += mass;
+    sva::PTransform<T> scaledBobyPosW(mbc.bodyPosW[i].rotation(), mass * mbc.bodyPosW[i].translation());
+    com += (sva::PTransform<T>(Vector3(jd.inertia.momentum().template cast<T>())) * scaledBobyPosW).translation();
+  }
+
+  assert(totalMass > T(0.) && "Invalid multibody. Totalmass must be strictly positive");
+  return com / totalMass;
+}
+
+template<typename T>
+Eigen::Matrix<T, 3, 1> computeCoMVelocity(const MultiBody & mb, const MultiBodyConfigT<T> & mbc)
+{
+  typedef Eigen::Matrix<T, 3, 1> Vector3;
+
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  Vector3 comV = Vector3::Zero();
+  T totalMass(0.);
+
+  for(const JointData & jd : joints)
+  {
+    const int i = jd.succ;
+    T mass(jd.inertia.mass());
+    totalMass += mass;
+
+    // Velocity at CoM : com_T_b·V_b
+    // Velocity at CoM world frame : 0_R_b·com_T_b·V_b
+    sva::PTransform<T> X_0_i(mbc.bodyPosW[i].rotation().transpose(),
+                             jd.inertia.momentum().template cast<T>());
+    sva::MotionVec<T> scaledBodyVelB(mbc.bodyVelB[i].angular(), mass * mbc.bodyVelB[i].linear());
+    comV += (X_0_i * scaledBodyVelB).linear();
+  }
+
+  assert(totalMass > T(0.) && "Invalid multibody. Totalmass must be strictly positive");
+  return comV / totalMass;
+}
+
+template<typename T>
+Eigen::Matrix<T, 3, 1> computeCoMAcceleration(const MultiBody & mb, const MultiBodyConfigT<T> & mbc)
+{
+  typedef Eigen::Matrix<T, 3, 1> Vector3;
+
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  Vector3 comA = Vector3::Zero();
+  T totalMass(0.);
+
+  for(const JointData & jd : joints)
+  {
+    const int i = jd.succ;
+    T mass(jd.inertia.mass());
+
+    totalMass += mass;
+
+    // Acceleration at CoM : com_T_b·A_b
+    // Acceleration at CoM world frame :
+    //    0_R_b·com_T_b·A_b + 0_R_b_d·com_T_b·V_b
+    // O_R_b_d : (Angvel_W)_b x 0_R_b
+    sva::PTransform<T> X_0_iscaled(mbc.bodyPosW[i].rotation().transpose(),
+                                   jd.inertia.momentum().template cast<T>());
+    sva::MotionVec<T> angvel_W(mbc.bodyVelW[i].angular(), Vector3::Zero());
+
+    sva::MotionVec<T> scaledBodyAccB(mbc.bodyAccB[i].angular(), mass * mbc.bodyAccB[i].linear());
+    sva::MotionVec<T> scaledBodyVelB(mbc.bodyVelB[i].angular(), mass * mbc.bodyVelB[i].linear());
+
+    comA += (X_0_iscaled * scaledBodyAccB).linear();
+    comA += (angvel_W.cross(X_0_iscaled * scaledBodyVelB)).linear();
+  }
+
+  assert(totalMass > T(0.) && "Invalid multibody. Totalmass must be strictly positive");
+  return comA / totalMass;
+}
+
+extern template RBDYN_DLLAPI Eigen::Vector3d computeCoM<double>(const MultiBody & mb,
+                                                                const MultiBodyConfigT<double> & mbc);
+extern template RBDYN_DLLAPI Eigen::Vector3d computeCoMVelocity<double>(const MultiBody & mb,
+                                                                        const MultiBodyConfigT<double> & mbc);
+extern template RBDYN_DLLAPI Eigen::Vector3d computeCoMAcceleration<double>(const MultiBody & mb,
+                                                                            const MultiBodyConfigT<double> & mbc);
+
 } // namespace rbd
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <string>
+#include <vector>
+
+// RBDyn
+#include <rbdyn/config.hh>
+
+namespace rbd
+{
+class MultiBody;
+
+/**
+ * Generate a C++ header specialized for one MultiBody.
+ * The generated code only depends on Eigen and SpaceVecAlg. The topology is
+ * unrolled, the joint types are resolved at generation time and the constant
+ * parameters (joint axes, fixed transforms, inertias and actuator parameters)
+ * are folded in the expressions, all the matrices have a fixed size.
+ *
+ * The generated namespace contains:
+ *  - nrBodies, nrParams and nrDof constants and the VectorQ, VectorV, MatrixH
+ *    and MatrixJ fixed size types.
+ *  - Kinematics: parentToSon, bodyPosW and bodyVelB arrays.
+ *  - forwardKinematics(q, kin) and forwardVelocity(alpha, kin)
+ *    (@see rbd::forwardKinematics, rbd::forwardVelocity).
+ *  - jacobian<Body>(kin, jac) for each body of jacobianBodies, the full
+ *    jacobian of the body origin (@see rbd::Jacobian::jacobian, rbd::Jacobian::fullJacobian).
+ *  - jacobian(body, kin, jac) that select one of the generated jacobians at runtime.
+ *  - inverseDynamics(kin, alpha, alphaD, gravity, torque), recursive Newton-Euler
+ *    algorithm (@see rbd::InverseDynamics::inverseDynamics).
+ *  - massMatrix(kin, H), composite rigid body algorithm (@see rbd::ForwardDynamics::computeH).
+ *  - forwardDynamics(kin, alpha, torque, gravity, alphaD), articulated body
+ *    algorithm (@see rbd::ForwardDynamics::forwardDynamics).
+ *  - Model, a struct with the same types and static functions, to write code
+ *    templated on the model.
+ * The generalized vectors have the same layout than paramToVector and dofToVector.
+ *
+ * @param mb MultiBody to specialize the code for.
+ * @param nameSpace Namespace of the generated code (nested namespaces are separated by ::).
+ * @param jacobianBodies Name of the bodies for which a jacobian is generated.
+ * @return Content of the generated header.
+ * @throw std::domain_error If nameSpace is not a valid identifier or if a body
+ * of jacobianBodies is not in mb.
+ */
+RBDYN_DLLAPI std::string generateCode(const MultiBody & mb,
+                                      const std::string & nameSpace,
+                                      const std::vector<std::string> & jacobianBodies = {});
+
+} // namespace rbd
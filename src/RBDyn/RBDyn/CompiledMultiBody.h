@@ -0,0 +1,171 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+// RBDyn
+#include <rbdyn/config.hh>
+
+#include "MultiBody.h"
+
+namespace rbd
+{
+struct MultiBodyConfig;
+
+/**
+ * MultiBody with the fixed joints folded at construction.
+ *
+ * Each body attached by a fixed joint (sensor frames, flanges, virtual links)
+ * is merged into its nearest non fixed ancestor: its inertia is added to the
+ * ancestor inertia and its child joints transformations are composed with the
+ * constant ancestor to body transformation, as MultiBodyGraph::mergeSubBodies
+ * do with the fixed joints.
+ * The root joint is always kept, even if fixed.
+ *
+ * The folded model (multiBody()) is used with the usual algorithms, the
+ * original bodies stay reachable as frames (a compiled body and a static
+ * offset) and their poses and velocities are only computed when queried.
+ * The operational frames of the original model are moved on the compiled
+ * bodies.
+ * The jacobian of a frame is the jacobian of its body at the point
+ * frame(i).X_b_f.translation().
+ */
+class RBDYN_DLLAPI CompiledMultiBody
+{
+public:
+  /// Original body attached to a body of the compiled model.
+  struct Frame
+  {
+    /// Original body name.
+    std::string name;
+    /// Body index in the compiled model.
+    int body;
+    /// Transformation from the compiled body base to the original body base.
+    sva::PTransformd X_b_f;
+  };
+
+public:
+  CompiledMultiBody() {}
+  /// @param mb Original MultiBody.
+  CompiledMultiBody(const MultiBody & mb);
+
+  /// @return MultiBody with the fixed joints folded.
+  const MultiBody & multiBody() const
+  {
+    return mb_;
+  }
+
+  /// @return Frames of all the original bodies, in the original order.
+  const std::vector<Frame> & frames() const
+  {
+    return frames_;
+  }
+
+  /// @return Frame of the original body num.
+  const Frame & frame(int num) const
+  {
+    return frames_[num];
+  }
+
+  /// @return Frame index of the original body name.
+  int frameIndexByName(const std::string & name) const
+  {
+    return frameNameToInd_.at(name);
+  }
+
+  /// @return true if the original body num is merged in another body.
+  bool isFolded(int num) const
+  {
+    return mb_.body(frames_[num].body).name() != frames_[num].name;
+  }
+
+  /// @return Number of folded joints.
+  int nrFoldedJoints() const
+  {
+    return static_cast<int>(frames_.size() - jointsIndex_.size());
+  }
+
+  /// @return Original joint index of each compiled joint.
+  const std::vector<int> & jointsIndex() const
+  {
+    return jointsIndex_;
+  }
+
+  /**
+   * Compute a frame pose in world coordinate.
+   * @param mbc Compiled model configuration, use bodyPosW.
+   * @param num Frame index.
+   */
+  sva::PTransformd framePosW(const MultiBodyConfig & mbc, int num) const;
+
+  /**
+   * Compute a frame velocity in frame coordinate.
+   * @param mbc Compiled model configuration, use bodyVelB.
+   * @param num Frame index.
+   */
+  sva::MotionVecd frameVelB(const MultiBodyConfig & mbc, int num) const;
+
+  /**
+   * Convert an original model configuration to the compiled model.
+   * q, alpha, alphaD, force and gravity are converted, the forces applied on
+   * a folded body are added to its compiled body.
+   * @param from Original model configuration.
+   * @param to Compiled model configuration.
+   */
+  void toCompiled(const MultiBodyConfig & from, MultiBodyConfig & to) const;
+
+  /**
+   * Convert a compiled model configuration to the original model.
+   * q, alpha, alphaD and jointTorque are converted.
+   * @param from Compiled model configuration.
+   * @param to Original model configuration.
+   */
+  void fromCompiled(const MultiBodyConfig & from, MultiBodyConfig & to) const;
+
+  // safe version for python binding
+
+  /** safe version of @see framePosW.
+   * @throw std::domain_error If the compiled model don't match mbc or num is out of range.
+   */
+  sva::PTransformd sFramePosW(const MultiBodyConfig & mbc, int num) const;
+
+  /** safe version of @see frameVelB.
+   * @throw std::domain_error If the compiled model don't match mbc or num is out of range.
+   */
+  sva::MotionVecd sFrameVelB(const MultiBodyConfig & mbc, int num) const;
+
+  /** safe version of @see toCompiled.
+   * @throw std::domain_error If the models don't match from or to.
+   */
+  void sToCompiled(const MultiBodyConfig & from, MultiBodyConfig & to) const;
+
+  /** safe version of @see fromCompiled.
+   * @throw std::domain_error If the models don't match from or to.
+   */
+  void sFromCompiled(const MultiBodyConfig & from, MultiBodyConfig & to) const;
+
+private:
+  void checkFrameIndex(int num) const;
+  void checkMatchOriginal(const MultiBodyConfig & mbc) const;
+
+private:
+  MultiBody mb_;
+  std::vector<Frame> frames_;
+  std::unordered_map<std::string, int> frameNameToInd_;
+  std::vector<int> jointsIndex_;
+  // original joints parameters and dof numbers
+  std::vector<int> originalParams_;
+  std::vector<int> originalDof_;
+};
+
+} // namespace rbd
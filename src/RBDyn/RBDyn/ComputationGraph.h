@@ -0,0 +1,262 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Eigen
+#include <Eigen/Core>
+
+// RBDyn
+#include <rbdyn/config.hh>
+
+#include "CoM.h"
+#include "FD.h"
+#include "Jacobian.h"
+#include "Momentum.h"
+#include "MultiBodyConfig.h"
+
+namespace rbd
+{
+class MultiBody;
+struct MultiBodyConfig;
+
+/**
+ * Dependency aware evaluator of the per tick robot quantities.
+ *
+ * The caller declare the quantities it need with require, then compute
+ * evaluate them and all their prerequisites exactly once, in dependency
+ * order. The quantities that are not required (directly or as a
+ * prerequisite) are never computed.
+ * Intermediate results are shared between the quantities: forward
+ * kinematics and velocity are computed once for all the jacobians,
+ * the CoM position and velocity are reused by the centroidal momentum
+ * matrix and the centroidal momentum matrix and its derivative are computed
+ * in one pass when both are required.
+ * A quantity is skipped when its inputs are unchanged since its last
+ * evaluation: mb stamp, mbc q, alpha and alphaD values and the mbc stamps of
+ * the forward kinematics, velocity and acceleration results
+ * (@see ConfigStamps). NonLinearEffects read force and gravity and is always
+ * evaluated.
+ *
+ * The wall time of each quantity is measured at each compute call.
+ */
+class RBDYN_DLLAPI ComputationGraph
+{
+public:
+  /// Quantities that can be required, ordered in a topological order.
+  enum class Quantity
+  {
+    /// forwardKinematics (mbc bodyPosW, parentToSon, motionSubspace...).
+    Kinematics,
+    /// forwardVelocity (mbc bodyVelW, bodyVelB, jointVelocity).
+    Velocity,
+    /// forwardAcceleration (mbc bodyAccB), use mbc alphaD.
+    Acceleration,
+    /// computeCoM.
+    CoM,
+    /// computeCoMVelocity.
+    CoMVelocity,
+    /// CoMJacobian::jacobian.
+    CoMJacobian,
+    /// CoMJacobian::jacobianDot.
+    CoMJacobianDot,
+    /// CentroidalMomentumMatrix::matrix.
+    CentroidalMomentumMatrix,
+    /// CentroidalMomentumMatrix::matrixDot.
+    CentroidalMomentumMatrixDot,
+    /// ForwardDynamics::H.
+    InertiaMatrix,
+    /// ForwardDynamics::C.
+    NonLinearEffects,
+    /// Jacobian::jacobian of all the jacobians added with addJacobian.
+    Jacobians,
+    /// Jacobian::jacobianDot of all the jacobians added with addJacobian.
+    JacobianDots
+  };
+
+  /// Number of quantities.
+  static constexpr int NrQuantities = static_cast<int>(Quantity::JacobianDots) + 1;
+
+public:
+  ComputationGraph() {}
+  /// @param mb MultiBody associated with this algorithm.
+  ComputationGraph(const MultiBody & mb);
+
+  /**
+   * Require a quantity and its prerequisites.
+   * @param q Required quantity.
+   */
+  void require(Quantity q);
+
+  /// @return true if q is required directly or as a prerequisite.
+  bool required(Quantity q) const
+  {
+    return required_[index(q)];
+  }
+
+  /**
+   * @param q Quantity.
+   * @return Prerequisites of q.
+   */
+  static const std::vector<Quantity> & prerequisites(Quantity q);
+
+  /**
+   * Add a jacobian to compute with the Jacobians and JacobianDots quantities.
+   * @param mb MultiBody used has model.
+   * @param bodyName Specified body.
+   * @param point Point in the body exprimed in body coordinate.
+   * @return Jacobian index.
+   * @throw std::out_of_range If bodyName don't exist.
+   */
+  int addJacobian(const MultiBody & mb,
+                  const std::string & bodyName,
+                  const Eigen::Vector3d & point = Eigen::Vector3d::Zero());
+
+  /**
+   * Evaluate all the required quantities.
+   * @param mb MultiBody used has model.
+   * @param mbc Use q, alpha, alphaD (Acceleration), force and gravity
+   * (NonLinearEffects). Fill the forward kinematics, velocity and
+   * acceleration results.
+   */
+  void compute(const MultiBody & mb, MultiBodyConfig & mbc);
+
+  /// @return CoM position.
+  const Eigen::Vector3d & com() const
+  {
+    return com_;
+  }
+
+  /// @return CoM velocity.
+  const Eigen::Vector3d & comVelocity() const
+  {
+    return comVel_;
+  }
+
+  /// @return CoM jacobian.
+  const Eigen::MatrixXd & comJacobian() const
+  {
+    return comJac_.jacobian();
+  }
+
+  /// @return CoM jacobian time derivative.
+  const Eigen::MatrixXd & comJacobianDot() const
+  {
+    return comJac_.jacobianDot();
+  }
+
+  /// @return Centroidal momentum matrix.
+  const Eigen::MatrixXd & centroidalMomentumMatrix() const
+  {
+    return cmm_.matrix();
+  }
+
+  /// @return Centroidal momentum matrix time derivative.
+  const Eigen::MatrixXd & centroidalMomentumMatrixDot() const
+  {
+    return cmm_.matrixDot();
+  }
+
+  /// @return Inertia matrix H.
+  const Eigen::MatrixXd & H() const
+  {
+    return fd_.H();
+  }
+
+  /// @return Non linear effect vector C.
+  const Eigen::VectorXd & C() const
+  {
+    return fd_.C();
+  }
+
+  /// @return Jacobian num on its joints path.
+  const Eigen::MatrixXd & jacobian(int num) const
+  {
+    return jacs_[num];
+  }
+
+  /// @return Jacobian num time derivative on its joints path.
+  const Eigen::MatrixXd & jacobianDot(int num) const
+  {
+    return jacDots_[num];
+  }
+
+  /// @return Jacobian object num (joints path, full jacobian projection).
+  const Jacobian & jacobianObject(int num) const
+  {
+    return jacObjs_[num];
+  }
+
+  /**
+   * @return Wall time of the last evaluation of q in seconds (0 if never required).
+   * When both centroidal momentum matrices are required they are computed
+   * by CentroidalMomentumMatrixDot.
+   */
+  double duration(Quantity q) const
+  {
+    return durations_[index(q)];
+  }
+
+  /// @return Number of evaluations of q since the construction (skipped computations are not counted).
+  int nrEvaluations(Quantity q) const
+  {
+    return nrEvaluations_[index(q)];
+  }
+
+  // safe version for python binding
+
+  /** safe version of @see addJacobian.
+   * @throw std::domain_error If mb don't match this algorithm.
+   */
+  int sAddJacobian(const MultiBody & mb,
+                   const std::string & bodyName,
+                   const Eigen::Vector3d & point = Eigen::Vector3d::Zero());
+
+  /** safe version of @see compute.
+   * @throw std::domain_error If mb don't match mbc or this algorithm.
+   */
+  void sCompute(const MultiBody & mb, MultiBodyConfig & mbc);
+
+private:
+  static int index(Quantity q)
+  {
+    return static_cast<int>(q);
+  }
+
+  bool upToDate(const MultiBody & mb, const MultiBodyConfig & mbc, int i) const;
+  void evaluate(const MultiBody & mb, MultiBodyConfig & mbc, Quantity q);
+  void checkMatchMultiBody(const MultiBody & mb) const;
+
+private:
+  int nrDof_ = 0;
+  std::array<bool, NrQuantities> required_ = {};
+  std::array<double, NrQuantities> durations_ = {};
+  std::array<int, NrQuantities> nrEvaluations_ = {};
+  // mb and mbc stamps of the last evaluation of each quantity
+  std::array<std::uint64_t, NrQuantities> modelStamps_ = {};
+  std::array<ConfigStamps, NrQuantities> stamps_ = {};
+  // q, alpha and alphaD of the last Kinematics, Velocity and Acceleration evaluation
+  std::vector<std::vector<double>> q_;
+  std::vector<std::vector<double>> alpha_;
+  std::vector<std::vector<double>> alphaD_;
+
+  Eigen::Vector3d com_ = Eigen::Vector3d::Zero();
+  Eigen::Vector3d comVel_ = Eigen::Vector3d::Zero();
+  rbd::CoMJacobian comJac_;
+  rbd::CentroidalMomentumMatrix cmm_;
+  ForwardDynamics fd_;
+
+  std::vector<Jacobian> jacObjs_;
+  std::vector<Eigen::MatrixXd> jacs_;
+  std::vector<Eigen::MatrixXd> jacDots_;
+};
+
+} // namespace rbd
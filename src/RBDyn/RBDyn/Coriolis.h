@@ -29,16 +29,24 @@ public:
   Coriolis(const rbd::MultiBody & mb);
 
   /** Compute the matrix C of Coriolis effects.
+   * The bodies CoM are updated if mb inertia has changed
+   * (@see MultiBody::inertiaStamp).
    * @param mb Multibody system
    * @param mbc Multibody configuration associated to mb
    */
   const Eigen::MatrixXd & coriolis(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
 
+private:
+  /// Set the jacobians point to the bodies CoM.
+  void updateCoM(const rbd::MultiBody & mb);
+
 private:
   std::vector<rbd::Jacobian> jacs_;
   std::vector<Blocks> compactPaths_;
   Eigen::MatrixXd coriolis_;
   Eigen::MatrixXd res_;
+  // mb.inertiaStamp() of the jacobians point
+  std::uint64_t inertiaStamp_;
 };
 
 } // namespace rbd
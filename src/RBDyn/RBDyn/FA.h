@@ -10,10 +10,11 @@
 
 #include <SpaceVecAlg/SpaceVecAlg>
 
+#include "MultiBody.h"
+#include "MultiBodyConfig.h"
+
 namespace rbd
 {
-class MultiBody;
-struct MultiBodyConfig;
 
 /**
  * Compute the forward acceleration of a MultiBody.
@@ -27,6 +28,15 @@ RBDYN_DLLAPI void forwardAcceleration(const MultiBody & mb,
                                       MultiBodyConfig & mbc,
                                       const sva::MotionVecd & A_0 = sva::MotionVecd(Eigen::Vector6d::Zero()));
 
+/**
+ * Compute the forward acceleration of a MultiBody with the scalar type T.
+ * @see forwardAcceleration.
+ */
+template<typename T>
+void forwardAcceleration(const MultiBody & mb,
+                         MultiBodyConfigT<T> & mbc,
+                         const sva::MotionVec<T> & A_0 = sva::MotionVec<T>(Eigen::Matrix<T, 6, 1>::Zero()));
+
 /**
  * Safe version.
  * @see forwardAcceleration.
@@ -36,4 +46,31 @@ RBDYN_DLLAPI void sForwardAcceleration(const MultiBody & mb,
                                        MultiBodyConfig & mbc,
                                        const sva::MotionVecd & A_0 = sva::MotionVecd(Eigen::Vector6d::Zero()));
 
+template<typename T>
+void forwardAcceleration(const MultiBody & mb, MultiBodyConfigT<T> & mbc, const sva::MotionVec<T> & A_0)
+{
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  for(std::size_t i = 0; i < joints.size(); ++i)
+  {
+    const JointData & jd = joints[i];
+    const sva::PTransform<T> & X_p_i = mbc.parentToSon[i];
+
+    const sva::MotionVec<T> & vj_i = mbc.jointVelocity[i];
+    sva::MotionVec<T> ai_tan = Joint::Motion(jd.type, mb.motionSubspace(static_cast<int>(i)), mbc.alphaD[i]);
+
+    const sva::MotionVec<T> & vb_i = mbc.bodyVelB[i];
+
+    if(jd.pred != -1)
+      mbc.bodyAccB[jd.succ] = X_p_i * mbc.bodyAccB[jd.pred] + ai_tan + vb_i.cross(vj_i);
+    else
+      mbc.bodyAccB[jd.succ] = X_p_i * A_0 + ai_tan + vb_i.cross(vj_i);
+  }
+  mbc.stamps.accelerationChanged();
+}
+
+extern template RBDYN_DLLAPI void forwardAcceleration<double>(const MultiBody & mb,
+                                                              MultiBodyConfigT<double> & mbc,
+                                                              const sva::MotionVecd & A_0);
+
 } // namespace rbd
@@ -6,6 +6,7 @@
 
 // includes
 // std
+#include <cstdint>
 #include <vector>
 
 // Eigen
@@ -16,63 +17,274 @@
 
 #include <SpaceVecAlg/SpaceVecAlg>
 
+#include "MultiBody.h"
+#include "MultiBodyConfig.h"
+
 namespace rbd
 {
-class MultiBody;
-struct MultiBodyConfig;
 
 /**
- * Forward Dynamics algorithm.
+ * Forward Dynamics algorithm with the scalar type T.
+ * @see ForwardDynamics for the double version.
  */
-class RBDYN_DLLAPI ForwardDynamics
+template<typename T>
+class ForwardDynamicsT
 {
 public:
-  ForwardDynamics() {}
+  typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> matrix_t;
+  typedef Eigen::Matrix<T, Eigen::Dynamic, 1> vector_t;
+
+public:
+  ForwardDynamicsT() {}
   /// @param mb MultiBody associated with this algorithm.
-  ForwardDynamics(const MultiBody & mb);
+  ForwardDynamicsT(const MultiBody & mb);
 
   /**
    * Compute the forward dynamics.
    * @param mb MultiBody used has model.
-   * @param mbc Use parentToSon, motionSubspace jointVelocity, bodyVelB,
+   * @param mbc Use parentToSon, motionSubspace, alpha, jointVelocity, bodyVelB,
    * bodyPosW, force, gravity and jointTorque.
    * Fill alphaD generalized acceleration vector.
    */
-  void forwardDynamics(const MultiBody & mb, MultiBodyConfig & mbc);
+  void forwardDynamics(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
 
   /**
    * Compute the inertia matrix H.
+   * Joints armature is added to the diagonal.
    * @param mb MultiBody used has model.
    * @param mbc Use parentToSon and motionSubspace.
    */
-  void computeH(const MultiBody & mb, const MultiBodyConfig & mbc);
+  void computeH(const MultiBody & mb, const MultiBodyConfigT<T> & mbc);
 
   /**
-   * Compute the non linear effect vector (coriolis, gravity, external force).
+   * Compute the inertia matrix H only if mb or the mbc position changed since
+   * the last updateH call (@see ConfigStamps).
+   * The code that fill parentToSon without forwardKinematics must call
+   * mbc.stamps.positionChanged.
    * @param mb MultiBody used has model.
-   * @param mbc Use parentToSon, motionSubspace jointVelocity, bodyVelB,
+   * @param mbc Use parentToSon and motionSubspace.
+   * @return true if H has been recomputed.
+   */
+  bool updateH(const MultiBody & mb, const MultiBodyConfigT<T> & mbc);
+
+  /**
+   * Compute the non linear effect vector (coriolis, gravity, external force,
+   * joint damping and Coulomb friction).
+   * @param mb MultiBody used has model.
+   * @param mbc Use parentToSon, motionSubspace, alpha, jointVelocity, bodyVelB,
    * bodyPosW, force and gravity.
    */
-  void computeC(const MultiBody & mb, const MultiBodyConfig & mbc);
+  void computeC(const MultiBody & mb, const MultiBodyConfigT<T> & mbc);
 
   /// @return The inertia matrix H.
-  const Eigen::MatrixXd & H() const
+  const matrix_t & H() const
   {
     return H_;
   }
 
   /// @return The non linear effect vector (coriolis, gravity, external force).
-  const Eigen::VectorXd & C() const
+  const vector_t & C() const
   {
     return C_;
   }
 
   /// @return Inertia of tho subtree rooted at body i.
-  const std::vector<sva::RBInertiad> & inertiaSubTree() const
+  const std::vector<sva::RBInertia<T>> & inertiaSubTree() const
   {
     return I_st_;
   }
 
+private:
+  matrix_t H_;
+  vector_t C_;
+
+  // H computation
+  std::vector<sva::RBInertia<T>> I_st_;
+  std::vector<Eigen::Matrix<T, 6, Eigen::Dynamic>> F_;
+
+  // C computation
+  std::vector<sva::MotionVec<T>> acc_;
+  std::vector<sva::ForceVec<T>> f_;
+
+  // torque computation
+  vector_t tmpFd_;
+
+  std::vector<int> dofPos_;
+
+  Eigen::LDLT<matrix_t> ldlt_;
+
+  // mb and mbc.stamps.position of the last updateH computation
+  std::uint64_t HModelStamp_ = 0;
+  std::uint64_t HPositionStamp_ = 0;
+};
+
+template<typename T>
+ForwardDynamicsT<T>::ForwardDynamicsT(const MultiBody & mb)
+: H_(mb.nrDof(), mb.nrDof()), C_(mb.nrDof()), I_st_(mb.nrBodies()), F_(mb.nrJoints()), acc_(mb.nrBodies()),
+  f_(mb.nrBodies()), tmpFd_(mb.nrDof()), dofPos_(mb.nrJoints()), ldlt_(mb.nrDof())
+{
+  int dofP = 0;
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    F_[i].resize(6, mb.joint(i).dof());
+    dofPos_[i] = dofP;
+    dofP += mb.joint(i).dof();
+  }
+}
+
+template<typename T>
+void ForwardDynamicsT<T>::forwardDynamics(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  computeH(mb, mbc);
+  computeC(mb, mbc);
+
+  for(std::size_t i = 0; i < dofPos_.size(); ++i)
+  {
+    for(std::size_t dof = 0; dof < mbc.jointTorque[i].size(); ++dof)
+    {
+      tmpFd_(dofPos_[i] + dof) = mbc.jointTorque[i][dof];
+    }
+  }
+  ldlt_.compute(H_);
+  tmpFd_ = ldlt_.solve(tmpFd_ - C_);
+
+  for(std::size_t i = 0; i < dofPos_.size(); ++i)
+  {
+    for(std::size_t dof = 0; dof < mbc.alphaD[i].size(); ++dof)
+    {
+      mbc.alphaD[i][dof] = tmpFd_(dofPos_[i] + dof);
+    }
+  }
+}
+
+template<typename T>
+bool ForwardDynamicsT<T>::updateH(const MultiBody & mb, const MultiBodyConfigT<T> & mbc)
+{
+  if(ConfigStamps::same(HPositionStamp_, mbc.stamps.position) && ConfigStamps::same(HModelStamp_, mb.stamp()))
+  {
+    return false;
+  }
+  computeH(mb, mbc);
+  HModelStamp_ = mb.stamp();
+  HPositionStamp_ = mbc.stamps.position;
+  return true;
+}
+
+template<typename T>
+void ForwardDynamicsT<T>::computeH(const MultiBody & mb, const MultiBodyConfigT<T> & mbc)
+{
+  // H may not match the configuration of the last updateH call anymore
+  HPositionStamp_ = 0;
+
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  H_.setZero();
+  for(std::size_t i = 0; i < joints.size(); ++i)
+  {
+    I_st_[i] = detail::scalarCast<T>(joints[i].inertia);
+  }
+
+  for(int i = static_cast<int>(joints.size()) - 1; i >= 0; --i)
+  {
+    const JointData & jd = joints[i];
+    if(jd.pred != -1)
+    {
+      const sva::PTransform<T> & X_p_i = mbc.parentToSon[i];
+      I_st_[jd.pred] += X_p_i.transMul(I_st_[i]);
+    }
+
+    for(int dof = 0; dof < jd.dof; ++dof)
+    {
+      F_[i].col(dof).noalias() = (I_st_[i] * sva::MotionVec<T>(mbc.motionSubspace[i].col(dof))).vector();
+    }
+
+    H_.block(dofPos_[i], dofPos_[i], jd.dof, jd.dof).noalias() = mbc.motionSubspace[i].transpose() * F_[i];
+    if(jd.armature != 0.)
+    {
+      H_.block(dofPos_[i], dofPos_[i], jd.dof, jd.dof).diagonal().array() += T(jd.armature);
+    }
+
+    int j = i;
+    while(joints[j].pred != -1)
+    {
+      const sva::PTransform<T> & X_p_j = mbc.parentToSon[j];
+      for(int dof = 0; dof < jd.dof; ++dof)
+      {
+        F_[i].col(dof) = X_p_j.transMul(sva::ForceVec<T>(F_[i].col(dof))).vector();
+      }
+      j = joints[j].pred;
+
+      const int dofj = joints[j].dof;
+      if(dofj != 0)
+      {
+        H_.block(dofPos_[i], dofPos_[j], jd.dof, dofj).noalias() = F_[i].transpose() * mbc.motionSubspace[j];
+
+        H_.block(dofPos_[j], dofPos_[i], dofj, jd.dof).noalias() =
+            H_.block(dofPos_[i], dofPos_[j], jd.dof, dofj).transpose();
+      }
+    }
+  }
+}
+
+template<typename T>
+void ForwardDynamicsT<T>::computeC(const MultiBody & mb, const MultiBodyConfigT<T> & mbc)
+{
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  sva::MotionVec<T> a_0(Eigen::Matrix<T, 3, 1>::Zero(), mbc.gravity);
+
+  for(std::size_t i = 0; i < joints.size(); ++i)
+  {
+    const JointData & jd = joints[i];
+    const sva::PTransform<T> & X_p_i = mbc.parentToSon[i];
+
+    const sva::MotionVec<T> & vj_i = mbc.jointVelocity[i];
+
+    const sva::MotionVec<T> & vb_i = mbc.bodyVelB[i];
+
+    const auto & I_i = detail::scalarCast<T>(jd.inertia);
+
+    if(jd.pred != -1)
+      acc_[i] = X_p_i * acc_[jd.pred] + vb_i.cross(vj_i);
+    else
+      acc_[i] = X_p_i * a_0 + vb_i.cross(vj_i);
+
+    f_[i] = I_i * acc_[i] + vb_i.crossDual(I_i * vb_i) - mbc.bodyPosW[i].dualMul(mbc.force[i]);
+  }
+
+  for(int i = static_cast<int>(joints.size()) - 1; i >= 0; --i)
+  {
+    const JointData & jd = joints[i];
+    C_.segment(dofPos_[i], jd.dof).noalias() = mbc.motionSubspace[i].transpose() * f_[i].vector();
+    if(jd.damping != 0. || jd.friction != 0.)
+    {
+      for(int dof = 0; dof < jd.dof; ++dof)
+      {
+        const T & alpha = mbc.alpha[i][dof];
+        C_(dofPos_[i] + dof) += T(jd.damping) * alpha + T(jd.friction) * T((alpha > T(0.)) - (alpha < T(0.)));
+      }
+    }
+
+    if(jd.pred != -1)
+    {
+      const sva::PTransform<T> & X_p_i = mbc.parentToSon[i];
+      f_[jd.pred] += X_p_i.transMul(f_[i]);
+    }
+  }
+}
+
+extern template class RBDYN_DLLAPI ForwardDynamicsT<double>;
+
+/**
+ * Forward Dynamics algorithm.
+ */
+class RBDYN_DLLAPI ForwardDynamics : public ForwardDynamicsT<double>
+{
+public:
+  ForwardDynamics() {}
+  /// @param mb MultiBody associated with this algorithm.
+  ForwardDynamics(const MultiBody & mb);
+
   // safe version for python binding
 
   /** safe version of @see forwardDynamics.
@@ -89,25 +301,6 @@ public:
    * @throw std::domain_error If mb don't match mbc.
    */
   void sComputeC(const MultiBody & mb, const MultiBodyConfig & mbc);
-
-private:
-  Eigen::MatrixXd H_;
-  Eigen::VectorXd C_;
-
-  // H computation
-  std::vector<sva::RBInertiad> I_st_;
-  std::vector<Eigen::Matrix<double, 6, Eigen::Dynamic>> F_;
-
-  // C computation
-  std::vector<sva::MotionVecd> acc_;
-  std::vector<sva::ForceVecd> f_;
-
-  // torque computation
-  Eigen::VectorXd tmpFd_;
-
-  std::vector<int> dofPos_;
-
-  Eigen::LDLT<Eigen::MatrixXd> ldlt_;
 };
 
 } // namespace rbd
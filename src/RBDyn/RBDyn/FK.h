@@ -6,10 +6,11 @@
 
 #include <rbdyn/config.hh>
 
+#include "MultiBody.h"
+#include "MultiBodyConfig.h"
+
 namespace rbd
 {
-class MultiBody;
-struct MultiBodyConfig;
 
 /**
  * Compute the forward kinematic of a MultiBody.
@@ -19,6 +20,13 @@ struct MultiBodyConfig;
  */
 RBDYN_DLLAPI void forwardKinematics(const MultiBody & mb, MultiBodyConfig & mbc);
 
+/**
+ * Compute the forward kinematic of a MultiBody with the scalar type T.
+ * @see forwardKinematics.
+ */
+template<typename T>
+void forwardKinematics(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
+
 /**
  * Safe version.
  * @see forwardKinematics.
@@ -26,4 +34,28 @@ RBDYN_DLLAPI void forwardKinematics(const MultiBody & mb, MultiBodyConfig & mbc)
  */
 RBDYN_DLLAPI void sForwardKinematics(const MultiBody & mb, MultiBodyConfig & mbc);
 
+template<typename T>
+void forwardKinematics(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  for(std::size_t i = 0; i < joints.size(); ++i)
+  {
+    const JointData & jd = joints[i];
+    const auto S = mb.motionSubspace(static_cast<int>(i));
+
+    mbc.jointConfig[i] = Joint::Pose(jd.type, jd.direction, S, mbc.q[i]);
+    mbc.parentToSon[i] = mbc.jointConfig[i] * detail::scalarCast<T>(jd.Xt);
+    mbc.motionSubspace[i] = S.template cast<T>();
+
+    if(jd.pred != -1)
+      mbc.bodyPosW[jd.succ] = mbc.parentToSon[i] * mbc.bodyPosW[jd.pred];
+    else
+      mbc.bodyPosW[jd.succ] = mbc.parentToSon[i];
+  }
+  mbc.stamps.positionChanged();
+}
+
+extern template RBDYN_DLLAPI void forwardKinematics<double>(const MultiBody & mb, MultiBodyConfigT<double> & mbc);
+
 } // namespace rbd
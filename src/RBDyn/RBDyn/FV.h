@@ -6,10 +6,11 @@
 
 #include <rbdyn/config.hh>
 
+#include "MultiBody.h"
+#include "MultiBodyConfig.h"
+
 namespace rbd
 {
-class MultiBody;
-struct MultiBodyConfig;
 
 /**
  * Compute the forward velocity of a MultiBody.
@@ -20,6 +21,13 @@ struct MultiBodyConfig;
  */
 RBDYN_DLLAPI void forwardVelocity(const MultiBody & mb, MultiBodyConfig & mbc);
 
+/**
+ * Compute the forward velocity of a MultiBody with the scalar type T.
+ * @see forwardVelocity.
+ */
+template<typename T>
+void forwardVelocity(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
+
 /**
  * Safe version.
  * @see forwardVelocity.
@@ -27,4 +35,29 @@ RBDYN_DLLAPI void forwardVelocity(const MultiBody & mb, MultiBodyConfig & mbc);
  */
 RBDYN_DLLAPI void sForwardVelocity(const MultiBody & mb, MultiBodyConfig & mbc);
 
+template<typename T>
+void forwardVelocity(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  for(std::size_t i = 0; i < joints.size(); ++i)
+  {
+    const JointData & jd = joints[i];
+    const sva::PTransform<T> & X_p_i = mbc.parentToSon[i];
+
+    mbc.jointVelocity[i] = Joint::Motion(jd.type, mb.motionSubspace(static_cast<int>(i)), mbc.alpha[i]);
+
+    if(jd.pred != -1)
+      mbc.bodyVelB[jd.succ] = X_p_i * mbc.bodyVelB[jd.pred] + mbc.jointVelocity[i];
+    else
+      mbc.bodyVelB[jd.succ] = mbc.jointVelocity[i];
+
+    sva::PTransform<T> E_0_i(mbc.bodyPosW[jd.succ].rotation());
+    mbc.bodyVelW[jd.succ] = E_0_i.invMul(mbc.bodyVelB[jd.succ]);
+  }
+  mbc.stamps.velocityChanged();
+}
+
+extern template RBDYN_DLLAPI void forwardVelocity<double>(const MultiBody & mb, MultiBodyConfigT<double> & mbc);
+
 } // namespace rbd
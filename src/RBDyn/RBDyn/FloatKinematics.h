@@ -0,0 +1,137 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <cstdint>
+#include <vector>
+
+// Eigen
+#include <Eigen/Core>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+// RBDyn
+#include <rbdyn/config.hh>
+
+#include "Joint.h"
+
+namespace rbd
+{
+class MultiBody;
+struct MultiBodyConfig;
+class Jacobian;
+
+/**
+ * Single precision forward kinematics and jacobian for sampling heavy
+ * workloads (collision checking, reachability maps...).
+ *
+ * Each transformation is packed in a row major 3x4 float matrix [R | p],
+ * R is the frame orientation and p the frame origin in the reference frame.
+ * Each row is a 16 bytes aligned SIMD packet and the model constants (Xt, joint
+ * axes and motion subspaces) are converted to float at construction, so the kinematic loop does
+ * not touch any double data. They are converted again by forwardKinematics when
+ * the model geometry change (@see MultiBody::geometryStamp).
+ * Revolute, prismatic and fixed joints are computed in place, the other joint
+ * types use Joint::pose<float>.
+ *
+ * Error bounds relative to forwardKinematics and Jacobian::jacobian, with
+ * eps = FLT_EPSILON (1.19e-7), d the number of joints between the root and
+ * the body and L the sum of the norms of the Xt translations and prismatic
+ * displacements along this path (quaternions must be normalized):
+ *  - rotation: |R_float - R_double|_max <= 2*d*eps
+ *  - translation: |p_float - p_double|_max <= 2*d*eps*L
+ *  - jacobian: angular columns as the rotation, linear columns as the
+ *    translation with L increased by the distance to the jacobian point.
+ * These bounds assume the generalized position is exactly representable in
+ * float, rounding q itself adds |dR/dq|*|q|*eps/2.
+ */
+class RBDYN_DLLAPI FloatKinematics
+{
+public:
+  /// Transformation [R | p] packed in a row major 3x4 matrix.
+  typedef Eigen::Matrix<float, 3, 4, Eigen::RowMajor> Transform;
+  typedef std::vector<Transform, Eigen::aligned_allocator<Transform>> TransformVector;
+
+public:
+  FloatKinematics() {}
+  /// @param mb MultiBody associated with this algorithm.
+  FloatKinematics(const MultiBody & mb);
+
+  /**
+   * Compute the forward kinematic.
+   * @param mb MultiBody used has model.
+   * @param q Generalized position vector (paramToVector layout).
+   */
+  void forwardKinematics(const MultiBody & mb, const Eigen::Ref<const Eigen::VectorXf> & q);
+
+  /**
+   * Compute the forward kinematic.
+   * @param mb MultiBody used has model.
+   * @param mbc Use q generalized position vector.
+   */
+  void forwardKinematics(const MultiBody & mb, const MultiBodyConfig & mbc);
+
+  /// @return Bodies transformation in world coordinate.
+  const TransformVector & bodyPosW() const
+  {
+    return bodyPosW_;
+  }
+
+  /**
+   * Compute the jacobian in world frame at the jac point
+   * (@see Jacobian::jacobian) from the last forwardKinematics call.
+   * @param mb MultiBody used has model.
+   * @param jac Jacobian that describe the joints path and the point.
+   * @param res Jacobian (resized to 6 x jac.dof()).
+   */
+  void jacobian(const MultiBody & mb, const Jacobian & jac, Eigen::Matrix<float, 6, Eigen::Dynamic> & res) const;
+
+  /// Convert a packed transformation to the MultiBodyConfig::bodyPosW convention.
+  static sva::PTransformd toPTransform(const Transform & X);
+
+  /// Convert a MultiBodyConfig::bodyPosW like transformation to a packed transformation.
+  static Transform fromPTransform(const sva::PTransformd & X);
+
+  // safe version for python binding
+
+  /** safe version of @see forwardKinematics.
+   * @throw std::domain_error If mb don't match q.
+   */
+  void sForwardKinematics(const MultiBody & mb, const Eigen::Ref<const Eigen::VectorXf> & q);
+
+  /** safe version of @see forwardKinematics.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sForwardKinematics(const MultiBody & mb, const MultiBodyConfig & mbc);
+
+  /** safe version of @see jacobian.
+   * @throw std::domain_error If mb don't match this algorithm or jac.
+   */
+  void sJacobian(const MultiBody & mb, const Jacobian & jac, Eigen::Matrix<float, 6, Eigen::Dynamic> & res) const;
+
+private:
+  /// Convert the joints axis, motion subspace and Xt to float.
+  void updateGeometry(const MultiBody & mb);
+  void checkMatchMultiBody(const MultiBody & mb) const;
+
+private:
+  // joint data
+  std::vector<Joint::Type> type_;
+  std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f>> axis_;
+  std::vector<Eigen::Matrix<float, 6, Eigen::Dynamic>> S_;
+  std::vector<int> paramPos_;
+  TransformVector Xt_;
+  std::vector<std::vector<float>> q_;
+
+  TransformVector bodyPosW_;
+  Eigen::VectorXf qf_;
+  // mb.geometryStamp() of the joint data
+  std::uint64_t geometryStamp_ = 0;
+};
+
+} // namespace rbd
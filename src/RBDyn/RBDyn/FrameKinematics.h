@@ -0,0 +1,164 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <cstdint>
+#include <vector>
+
+// Eigen
+#include <Eigen/Core>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+// RBDyn
+#include <rbdyn/config.hh>
+
+#include "Jacobian.h"
+
+namespace rbd
+{
+class MultiBody;
+struct MultiBodyConfig;
+
+/**
+ * Compute on demand the poses, velocities and jacobians of the operational
+ * frames registered in a MultiBody (@see MultiBody::addFrame).
+ *
+ * Each result is computed at the first query and cached until the model
+ * geometry or the configuration position or velocity change (@see ConfigStamps),
+ * so repeated queries in the same control tick are free and unused frames cost
+ * nothing.
+ */
+class RBDYN_DLLAPI FrameKinematics
+{
+public:
+  FrameKinematics() {}
+  /// @param mb MultiBody with the registered frames.
+  FrameKinematics(const MultiBody & mb);
+
+  /// Invalidate all the cached results (not needed when the stamps are maintained).
+  void reset();
+
+  /**
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyPosW.
+   * @param num Frame index.
+   * @return Frame pose in world coordinate.
+   */
+  const sva::PTransformd & framePosW(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /**
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyVelB.
+   * @param num Frame index.
+   * @return Frame velocity in frame coordinate.
+   */
+  const sva::MotionVecd & frameVelB(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /**
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyPosW and bodyVelB.
+   * @param num Frame index.
+   * @return Frame origin velocity in world orientation (@see Jacobian::velocity).
+   */
+  const sva::MotionVecd & frameVelW(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /**
+   * Jacobian at the frame origin in world orientation (@see Jacobian::jacobian).
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyPosW and motionSubspace.
+   * @param num Frame index.
+   * @return Jacobian on the frame joints path.
+   */
+  const Eigen::MatrixXd & jacobian(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /**
+   * Jacobian in frame coordinate (@see Jacobian::bodyJacobian).
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyPosW and motionSubspace.
+   * @param num Frame index.
+   * @return Jacobian on the frame joints path.
+   */
+  const Eigen::MatrixXd & bodyJacobian(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /**
+   * Jacobian object of a frame, used to get the joints path or to project
+   * the jacobian on the full dof vector.
+   * @param mb MultiBody used has model.
+   * @param num Frame index.
+   */
+  const Jacobian & frameJacobian(const MultiBody & mb, int num);
+
+  // safe version for python binding
+
+  /** safe version of @see framePosW.
+   * @throw std::domain_error If mb don't match mbc or this algorithm or num is out of range.
+   */
+  const sva::PTransformd & sFramePosW(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /** safe version of @see frameVelB.
+   * @throw std::domain_error If mb don't match mbc or this algorithm or num is out of range.
+   */
+  const sva::MotionVecd & sFrameVelB(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /** safe version of @see frameVelW.
+   * @throw std::domain_error If mb don't match mbc or this algorithm or num is out of range.
+   */
+  const sva::MotionVecd & sFrameVelW(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /** safe version of @see jacobian.
+   * @throw std::domain_error If mb don't match mbc or this algorithm or num is out of range.
+   */
+  const Eigen::MatrixXd & sJacobian(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+  /** safe version of @see bodyJacobian.
+   * @throw std::domain_error If mb don't match mbc or this algorithm or num is out of range.
+   */
+  const Eigen::MatrixXd & sBodyJacobian(const MultiBody & mb, const MultiBodyConfig & mbc, int num);
+
+private:
+  /// Cached results flags.
+  enum Cached : unsigned char
+  {
+    PosW = 1 << 0,
+    VelB = 1 << 1,
+    VelW = 1 << 2,
+    Jac = 1 << 3,
+    BodyJac = 1 << 4,
+    JacObject = 1 << 5
+  };
+
+  bool cached(int num, Cached c) const
+  {
+    return (cached_[num] & c) != 0;
+  }
+
+  /// Invalidate the cached results if mb or mbc stamps changed.
+  void update(const MultiBody & mb, const MultiBodyConfig & mbc);
+  void invalidate(unsigned char flags);
+  Jacobian & jacobianObject(const MultiBody & mb, int num);
+  void checkMatch(const MultiBody & mb, int num) const;
+
+private:
+  /// JacObject is never reset
+  std::vector<unsigned char> cached_;
+
+  std::vector<sva::PTransformd> posW_;
+  std::vector<sva::MotionVecd> velB_;
+  std::vector<sva::MotionVecd> velW_;
+  std::vector<Eigen::MatrixXd> jac_;
+  std::vector<Eigen::MatrixXd> bodyJac_;
+  std::vector<Jacobian> jacObj_;
+
+  // stamps of the cached results
+  std::uint64_t modelStamp_ = 0;
+  std::uint64_t positionStamp_ = 0;
+  std::uint64_t velocityStamp_ = 0;
+};
+
+} // namespace rbd
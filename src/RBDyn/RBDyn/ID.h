@@ -13,20 +13,23 @@
 
 #include <SpaceVecAlg/SpaceVecAlg>
 
+#include "MultiBody.h"
+#include "MultiBodyConfig.h"
+
 namespace rbd
 {
-class MultiBody;
-struct MultiBodyConfig;
 
 /**
- * Inverse Dynamics algorithm.
+ * Inverse Dynamics algorithm with the scalar type T.
+ * @see InverseDynamics for the double version.
  */
-class RBDYN_DLLAPI InverseDynamics
+template<typename T>
+class InverseDynamicsT
 {
 public:
-  InverseDynamics() {}
+  InverseDynamicsT() {}
   /// @param mb MultiBody associated with this algorithm.
-  InverseDynamics(const MultiBody & mb);
+  InverseDynamicsT(const MultiBody & mb);
 
   /**
    * Compute the inverse dynamics.
@@ -34,48 +37,281 @@ public:
    * @param mbc Use alphaD generalized acceleration vector, force, jointConfig,
    * jointVelocity, bodyPosW, parentToSon, bodyVelV, motionSubspace and gravity.
    * Fill bodyAccB and jointTorque.
+   * Joint armature, damping and friction are taken into account
+   * (@see Joint::armature).
    */
-  void inverseDynamics(const MultiBody & mb, MultiBodyConfig & mbc);
+  void inverseDynamics(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
   /**
    * Compute the inverse dynamics with the inertia parameters.
    * @param mb MultiBody used has model.
    * @param mbc Use force, bodyPosW, parentToSon and motionSubspace.
    * Fill jointTorque.
    */
-  void inverseDynamicsNoInertia(const MultiBody & mb, MultiBodyConfig & mbc);
-
-  // safe version for python binding
+  void inverseDynamicsNoInertia(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
 
-  /** safe version of @see inverseDynamics.
-   * @throw std::domain_error If mb don't match mbc.
+  /**
+   * Compute only the gravity term of the inverse dynamics (g(q)).
+   * Velocity, acceleration and external forces are ignored.
+   * @param mb MultiBody used has model.
+   * @param mbc Use parentToSon, motionSubspace and gravity.
+   * Fill jointTorque.
    */
-  void sInverseDynamics(const MultiBody & mb, MultiBodyConfig & mbc);
-  /** safe version of @see inverseDynamicsNoInertia.
-   * @throw std::domain_error If mb don't match mbc.
+  void gravityTorques(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
+  /**
+   * Compute only the Coriolis and centrifugal term of the inverse dynamics
+   * (C(q, alpha)alpha) plus the joints damping and friction torques.
+   * Acceleration, gravity and external forces are ignored.
+   * @param mb MultiBody used has model.
+   * @param mbc Use alpha, jointVelocity, parentToSon, bodyVelB and motionSubspace.
+   * Fill jointTorque.
    */
-  void sInverseDynamicsNoInertia(const MultiBody & mb, MultiBodyConfig & mbc);
+  void coriolisTorques(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
+  /**
+   * Compute only the external forces term of the inverse dynamics
+   * (-J^T f_ext).
+   * @param mb MultiBody used has model.
+   * @param mbc Use force, bodyPosW, parentToSon and motionSubspace.
+   * Fill jointTorque.
+   */
+  void externalForceTorques(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
+  /**
+   * Compute the inverse dynamics without the gravity term.
+   * @param mb MultiBody used has model.
+   * @param mbc Use alpha, alphaD, force, jointVelocity, bodyPosW, parentToSon,
+   * bodyVelB and motionSubspace.
+   * Fill jointTorque, bodyAccB is left untouched.
+   */
+  void inverseDynamicsNoGravity(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
 
   /**
    * @brief Get the internal forces.
    * @return vector of forces transmitted from body λ(i) to body i across
    * joint i.
    */
-  const std::vector<sva::ForceVecd> & f() const;
+  const std::vector<sva::ForceVec<T>> & f() const;
 
 private:
+  /**
+   * @brief Compute the body forces f_ with the selected terms.
+   * Terms that are not selected are removed at compile time, so their
+   * spatial products and MultiBodyConfig reads are skipped.
+   * @tparam Inertial Add the joint acceleration (alphaD) term.
+   * @tparam Velocity Add the velocity product terms.
+   * @tparam Gravity Add the gravity term.
+   * @tparam External Add the external forces term.
+   * @param acc Body acceleration in body coordinate, filled if any of
+   * Inertial, Velocity or Gravity is selected.
+   */
+  template<bool Inertial, bool Velocity, bool Gravity, bool External>
+  void computeBodyForces(const MultiBody & mb, const MultiBodyConfigT<T> & mbc, std::vector<sva::MotionVec<T>> & acc);
+
   /**
    * @brief Compute joint torques.
+   * @tparam Inertial Add the joint armature torque.
+   * @tparam Velocity Add the joint damping and friction torques.
    * @param mb MultiBody used has model.
    * @param mbc Use force, bodyPosW, parentToSon and motionSubspace.
    * Fill jointTorque.
    */
-  void computeJointTorques(const MultiBody & mb, MultiBodyConfig & mbc);
+  template<bool Inertial, bool Velocity>
+  void computeJointTorques(const MultiBody & mb, MultiBodyConfigT<T> & mbc);
 
 private:
   /// @brief Internal forces.
   /// f_ is the vector of forces transmitted from body λ(i) to body i across
   /// joint i.
-  std::vector<sva::ForceVecd> f_;
+  std::vector<sva::ForceVec<T>> f_;
+  /// @brief Body accelerations used by the partial inverse dynamics.
+  std::vector<sva::MotionVec<T>> acc_;
+};
+
+template<typename T>
+InverseDynamicsT<T>::InverseDynamicsT(const MultiBody & mb) : f_(mb.nrBodies()), acc_(mb.nrBodies())
+{
+}
+
+template<typename T>
+void InverseDynamicsT<T>::inverseDynamics(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  computeBodyForces<true, true, true, true>(mb, mbc, mbc.bodyAccB);
+  computeJointTorques<true, true>(mb, mbc);
+}
+
+template<typename T>
+void InverseDynamicsT<T>::inverseDynamicsNoInertia(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    f_[i] = mbc.bodyPosW[i].dualMul(mbc.force[i]);
+  }
+
+  computeJointTorques<false, false>(mb, mbc);
+}
+
+template<typename T>
+void InverseDynamicsT<T>::gravityTorques(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  computeBodyForces<false, false, true, false>(mb, mbc, acc_);
+  computeJointTorques<false, false>(mb, mbc);
+}
+
+template<typename T>
+void InverseDynamicsT<T>::coriolisTorques(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  computeBodyForces<false, true, false, false>(mb, mbc, acc_);
+  computeJointTorques<false, true>(mb, mbc);
+}
+
+template<typename T>
+void InverseDynamicsT<T>::externalForceTorques(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  computeBodyForces<false, false, false, true>(mb, mbc, acc_);
+  computeJointTorques<false, false>(mb, mbc);
+}
+
+template<typename T>
+void InverseDynamicsT<T>::inverseDynamicsNoGravity(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  computeBodyForces<true, true, false, true>(mb, mbc, acc_);
+  computeJointTorques<true, true>(mb, mbc);
+}
+
+template<typename T>
+const std::vector<sva::ForceVec<T>> & InverseDynamicsT<T>::f() const
+{
+  return f_;
+}
+
+template<typename T>
+template<bool Inertial, bool Velocity, bool Gravity, bool External>
+void InverseDynamicsT<T>::computeBodyForces(const MultiBody & mb,
+                                            const MultiBodyConfigT<T> & mbc,
+                                            std::vector<sva::MotionVec<T>> & acc)
+{
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  constexpr bool Acceleration = Inertial || Velocity || Gravity;
+  const Eigen::Matrix<T, 3, 1> zero = Eigen::Matrix<T, 3, 1>::Zero();
+  const sva::MotionVec<T> a_0(zero, Gravity ? mbc.gravity : zero);
+
+  for(std::size_t i = 0; i < joints.size(); ++i)
+  {
+    if(Acceleration)
+    {
+      const JointData & jd = joints[i];
+      const sva::PTransform<T> & X_p_i = mbc.parentToSon[i];
+      const auto & I_i = detail::scalarCast<T>(jd.inertia);
+
+      if(jd.pred != -1)
+        acc[i] = X_p_i * acc[jd.pred];
+      else if(Gravity)
+        acc[i] = X_p_i * a_0;
+      else
+        acc[i] = sva::MotionVec<T>(Eigen::Matrix<T, 6, 1>::Zero());
+
+      if(Inertial)
+      {
+        acc[i] += Joint::Motion(jd.type, mb.motionSubspace(static_cast<int>(i)), mbc.alphaD[i]);
+      }
+      if(Velocity)
+      {
+        acc[i] += mbc.bodyVelB[i].cross(mbc.jointVelocity[i]);
+      }
+
+      f_[i] = I_i * acc[i];
+      if(Velocity)
+      {
+        const sva::MotionVec<T> & vb_i = mbc.bodyVelB[i];
+        f_[i] = f_[i] + vb_i.crossDual(I_i * vb_i);
+      }
+      if(External)
+      {
+        f_[i] = f_[i] - mbc.bodyPosW[i].dualMul(mbc.force[i]);
+      }
+    }
+    else
+    {
+      f_[i] = -mbc.bodyPosW[i].dualMul(mbc.force[i]);
+    }
+  }
+}
+
+template<typename T>
+template<bool Inertial, bool Velocity>
+void InverseDynamicsT<T>::computeJointTorques(const MultiBody & mb, MultiBodyConfigT<T> & mbc)
+{
+  const std::vector<JointData> & joints = mb.jointsData();
+
+  for(int i = static_cast<int>(joints.size()) - 1; i >= 0; --i)
+  {
+    const JointData & jd = joints[i];
+    for(int j = 0; j < jd.dof; ++j)
+    {
+      mbc.jointTorque[i][j] = mbc.motionSubspace[i].col(j).transpose() * f_[i].vector();
+    }
+
+    if((Inertial || Velocity) && jd.hasActuatorDynamics)
+    {
+      for(int j = 0; j < jd.dof; ++j)
+      {
+        if(Inertial)
+        {
+          mbc.jointTorque[i][j] += T(jd.armature) * mbc.alphaD[i][j];
+        }
+        if(Velocity)
+        {
+          const T & alpha = mbc.alpha[i][j];
+          mbc.jointTorque[i][j] += T(jd.damping) * alpha + T(jd.friction) * T((alpha > T(0.)) - (alpha < T(0.)));
+        }
+      }
+    }
+
+    if(jd.pred != -1)
+    {
+      const sva::PTransform<T> & X_p_i = mbc.parentToSon[i];
+      f_[jd.pred] = f_[jd.pred] + X_p_i.transMul(f_[i]);
+    }
+  }
+}
+
+extern template class RBDYN_DLLAPI InverseDynamicsT<double>;
+
+/**
+ * Inverse Dynamics algorithm.
+ */
+class RBDYN_DLLAPI InverseDynamics : public InverseDynamicsT<double>
+{
+public:
+  InverseDynamics() {}
+  /// @param mb MultiBody associated with this algorithm.
+  InverseDynamics(const MultiBody & mb);
+
+  // safe version for python binding
+
+  /** safe version of @see inverseDynamics.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sInverseDynamics(const MultiBody & mb, MultiBodyConfig & mbc);
+  /** safe version of @see inverseDynamicsNoInertia.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sInverseDynamicsNoInertia(const MultiBody & mb, MultiBodyConfig & mbc);
+  /** safe version of @see gravityTorques.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sGravityTorques(const MultiBody & mb, MultiBodyConfig & mbc);
+  /** safe version of @see coriolisTorques.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sCoriolisTorques(const MultiBody & mb, MultiBodyConfig & mbc);
+  /** safe version of @see externalForceTorques.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sExternalForceTorques(const MultiBody & mb, MultiBodyConfig & mbc);
+  /** safe version of @see inverseDynamicsNoGravity.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sInverseDynamicsNoGravity(const MultiBody & mb, MultiBodyConfig & mbc);
 };
 
 } // namespace rbd
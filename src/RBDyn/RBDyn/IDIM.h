@@ -6,6 +6,7 @@
 
 // includes
 // std
+#include <utility>
 #include <vector>
 
 // SpaceVecAlg
@@ -13,6 +14,9 @@
 
 #include <SpaceVecAlg/SpaceVecAlg>
 
+// RBDyn
+#include "Jacobian.h"
+
 namespace rbd
 {
 class MultiBody;
@@ -87,4 +91,454 @@ private:
   Eigen::MatrixXd Y_;
 };
 
+/**
+ * Compact version of the Y matrix computed by IDIM.
+ * The 10 columns of body i are only non zero on the rows of the dof of
+ * body i joint and of its ancestors joints. Each body columns block is
+ * stored as a (path dof x 10) matrix with the Blocks that map its rows to the
+ * full dof vector (same representation than Jacobian::compactPath).
+ * Products with Y are computed directly from this compact representation.
+ */
+class RBDYN_DLLAPI CompactIDIM
+{
+public:
+  CompactIDIM() {}
+  /// @param mb MultiBody associated with this algorithm.
+  CompactIDIM(const rbd::MultiBody & mb);
+
+  /**
+   * Compute the compact Y matrix.
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyVelB, bodyAccB, parentToSon and motionSubspace.
+   * bodyAccB must been calculated with the gravity.
+   */
+  void computeY(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
+
+  /// @return Y^T torque (10*nrBodies).
+  Eigen::VectorXd YTtorque(const Eigen::Ref<const Eigen::VectorXd> & torque) const;
+
+  /// @return Y phi (nrDof).
+  Eigen::VectorXd Yphi(const Eigen::Ref<const Eigen::VectorXd> & phi) const;
+
+  /// @return Y^T Y (10*nrBodies x 10*nrBodies).
+  Eigen::MatrixXd YTY() const;
+
+  /**
+   * Add Y^T torque to result.
+   * @param torque Joint torque (nrDof).
+   * @param result Accumulator (10*nrBodies).
+   */
+  void addYTtorque(const Eigen::Ref<const Eigen::VectorXd> & torque, Eigen::Ref<Eigen::VectorXd> result) const;
+
+  /**
+   * Add Y^T Y to the lower triangular part of result.
+   * Only the products between the rows shared by two bodies paths are computed.
+   * @param result Accumulator (10*nrBodies x 10*nrBodies), the strictly upper
+   * triangular part is not modified.
+   */
+  void addYTY(Eigen::Ref<Eigen::MatrixXd> result) const;
+
+  /// @return Dense Y matrix (@see IDIM::Y).
+  Eigen::MatrixXd denseY() const;
+
+  /// @return Non zero rows of body i columns, ordered as bodyBlocks(i).
+  const Eigen::MatrixXd & bodyY(int i) const
+  {
+    return bodyY_[static_cast<std::size_t>(i)];
+  }
+
+  /// @return Blocks that map the rows of bodyY(i) to the dof vector.
+  const Blocks & bodyBlocks(int i) const
+  {
+    return bodyBlocks_[static_cast<std::size_t>(i)];
+  }
+
+  // safe version for python binding
+
+  /** safe version of @see computeY.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sComputeY(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
+
+private:
+  int nrDof_;
+  std::vector<Eigen::MatrixXd> bodyY_;
+  std::vector<Blocks> bodyBlocks_;
+  /// Row of each joint of the body path in bodyY_, from the body to the root.
+  std::vector<std::vector<int>> jointRows_;
+  /// Number of rows shared by the path of two bodies (only i >= j is filled).
+  Eigen::MatrixXi commonRows_;
+};
+
+/**
+ * Base inertial parameters of a MultiBody.
+ * Some columns of the Y matrix are always null (parameters that don't act on
+ * the dynamics) or are a linear combination of other columns (parameters that
+ * can only be identified in combination). The base parameters are the minimal
+ * set of combinations of inertial parameters that can be identified:
+ * Y*Phi = Yb*PhiB with PhiB = Phi_ind + beta*Phi_dep.
+ * The structure is computed numerically once at construction from random
+ * samples (QR decomposition with column pivoting of the stacked Y matrix).
+ */
+class RBDYN_DLLAPI IDIMBase
+{
+public:
+  IDIMBase() {}
+  /**
+   * Compute the base parameters structure.
+   * @param mb MultiBody associated with this algorithm.
+   * @param nrSamples Number of random samples used to compute the structure,
+   * 0 means enough samples to have twice more rows than parameters.
+   * @param tolerance Relative threshold used to compute the rank.
+   * @param gravity Gravity acceleration (@see MultiBodyConfig::gravity).
+   * @param seed Random generator seed.
+   */
+  IDIMBase(const rbd::MultiBody & mb,
+           int nrSamples = 0,
+           double tolerance = 1e-8,
+           const Eigen::Vector3d & gravity = Eigen::Vector3d(0., 9.81, 0.),
+           unsigned int seed = 0);
+
+  /**
+   * Compute the Yb matrix, only the columns of the base parameters are computed
+   * and bodies without base parameters are skipped.
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyVelB, bodyAccB, parentToSon and motionSubspace.
+   * bodyAccB must been calculated with the gravity.
+   */
+  void computeYBase(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
+
+  /// Return the Yb matrix (nrDof x nrBaseParameters).
+  const Eigen::MatrixXd & YBase() const
+  {
+    return Yb_;
+  }
+
+  /**
+   * Compute the base parameters from the inertial parameters.
+   * @param phi Inertial parameters vector (@see multiBodyToInertialVector).
+   * @return PhiB = Phi_ind + beta*Phi_dep.
+   */
+  Eigen::VectorXd baseParameters(const Eigen::VectorXd & phi) const;
+
+  /// @return Number of base parameters.
+  int nrBaseParameters() const
+  {
+    return static_cast<int>(independentColumns_.size());
+  }
+
+  /// @return Index in Phi of the parameters kept in the base parameters (sorted).
+  const std::vector<int> & independentColumns() const
+  {
+    return independentColumns_;
+  }
+
+  /// @return Index in Phi of the parameters regrouped in the base parameters (sorted).
+  const std::vector<int> & dependentColumns() const
+  {
+    return dependentColumns_;
+  }
+
+  /// @return beta matrix (nrBaseParameters x dependentColumns.size()).
+  const Eigen::MatrixXd & beta() const
+  {
+    return beta_;
+  }
+
+  // safe version for python binding
+
+  /** safe version of @see computeYBase.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sComputeYBase(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
+
+  /** safe version of @see baseParameters.
+   * @throw std::domain_error If phi size don't match.
+   */
+  Eigen::VectorXd sBaseParameters(const Eigen::VectorXd & phi) const;
+
+private:
+  std::vector<int> independentColumns_;
+  std::vector<int> dependentColumns_;
+  Eigen::MatrixXd beta_;
+  /// For each body, pairs of (body column, Yb column).
+  std::vector<std::vector<std::pair<int, int>>> bodyColumns_;
+  Eigen::MatrixXd Yb_;
+};
+
+/**
+ * Streaming least square estimator of the inertial parameters.
+ * Instead of stacking the Y matrix of each sample, the normal equations
+ * Y^T Y and Y^T torque are accumulated sample by sample, so the memory
+ * is bounded by (10*nrBodies)^2 whatever the trajectory length.
+ * An exponential forgetting factor allow to use it online:
+ * Y^T Y <- lambda*Y^T Y + Y_k^T Y_k (same for Y^T torque).
+ */
+class RBDYN_DLLAPI IDIMEstimator
+{
+public:
+  IDIMEstimator() {}
+  /**
+   * @param mb MultiBody associated with this algorithm.
+   * @param forgettingFactor Weight applied to the past samples at each new
+   * sample, in ]0, 1]. 1 means no forgetting.
+   */
+  IDIMEstimator(const rbd::MultiBody & mb, double forgettingFactor = 1.);
+
+  /// Forget all the accumulated samples.
+  void reset();
+
+  /**
+   * Accumulate one sample.
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyVelB, bodyAccB, parentToSon, motionSubspace and
+   * jointTorque. bodyAccB must been calculated with the gravity.
+   */
+  void addSample(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
+
+  /**
+   * Accumulate one sample.
+   * @param Y IDIM matrix of the sample (@see IDIM::computeY).
+   * @param torque Joint torque of the sample.
+   */
+  void addSample(const Eigen::Ref<const Eigen::MatrixXd> & Y, const Eigen::Ref<const Eigen::VectorXd> & torque);
+
+  /**
+   * Accumulate a whole trajectory.
+   * The trajectory is cut in contiguous chunks accumulated on nrThreads
+   * workers, chunks are then merged in order so the result is the same
+   * than calling addSample on each sample.
+   * @param mb MultiBody used has model.
+   * @param q Generalized position of each sample stored by column (nrParams x T).
+   * @param alpha Generalized velocity of each sample stored by column (nrDof x T).
+   * @param alphaD Generalized acceleration of each sample stored by column (nrDof x T).
+   * @param torque Joint torque of each sample stored by column (nrDof x T).
+   * @param gravity Gravity acceleration (@see MultiBodyConfig::gravity).
+   * @param nrThreads Number of worker threads, 0 means one per hardware thread.
+   */
+  void addTrajectory(const rbd::MultiBody & mb,
+                     const Eigen::Ref<const Eigen::MatrixXd> & q,
+                     const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                     const Eigen::Ref<const Eigen::MatrixXd> & alphaD,
+                     const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                     const Eigen::Vector3d & gravity = Eigen::Vector3d(0., 9.81, 0.),
+                     int nrThreads = 0);
+
+  /**
+   * Merge the samples accumulated by another estimator as if they had been
+   * added after the samples of this estimator.
+   * @param other Estimator with the same number of parameters and forgetting factor.
+   */
+  void merge(const IDIMEstimator & other);
+
+  /**
+   * Solve the least square problem.
+   * @param regularization Weight of the regularization toward prior, must be
+   * strictly positive when the samples don't excite all the parameters.
+   * @param prior Prior value of the inertial parameters (@see multiBodyToInertialVector).
+   * @return Inertial parameters vector.
+   */
+  Eigen::VectorXd solve(double regularization, const Eigen::VectorXd & prior) const;
+
+  /**
+   * Solve the least square problem.
+   * @return Inertial parameters vector (minimal norm solution if the samples
+   * don't excite all the parameters).
+   */
+  Eigen::VectorXd solve() const;
+
+  /// @return Accumulated Y^T Y matrix.
+  Eigen::MatrixXd YTY() const
+  {
+    return YTY_.selfadjointView<Eigen::Lower>();
+  }
+
+  /// @return Accumulated Y^T torque vector.
+  const Eigen::VectorXd & YTtorque() const
+  {
+    return YTtorque_;
+  }
+
+  /// @return Accumulated torque^T torque, used to compute the residual.
+  double torqueTtorque() const
+  {
+    return torqueTtorque_;
+  }
+
+  /// @return Number of accumulated samples.
+  long nrSamples() const
+  {
+    return nrSamples_;
+  }
+
+  /// @return Forgetting factor.
+  double forgettingFactor() const
+  {
+    return forgettingFactor_;
+  }
+
+  // safe version for python binding
+
+  /** safe version of @see addSample.
+   * @throw std::domain_error If mb don't match mbc or the estimator.
+   */
+  void sAddSample(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
+
+  /** safe version of @see addTrajectory.
+   * @throw std::domain_error If the trajectory don't match mb or the estimator.
+   */
+  void sAddTrajectory(const rbd::MultiBody & mb,
+                      const Eigen::Ref<const Eigen::MatrixXd> & q,
+                      const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                      const Eigen::Ref<const Eigen::MatrixXd> & alphaD,
+                      const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                      const Eigen::Vector3d & gravity = Eigen::Vector3d(0., 9.81, 0.),
+                      int nrThreads = 0);
+
+  /** safe version of @see merge.
+   * @throw std::domain_error If other don't match this estimator.
+   */
+  void sMerge(const IDIMEstimator & other);
+
+private:
+  void accumulate(const Eigen::Ref<const Eigen::MatrixXd> & Y, const Eigen::Ref<const Eigen::VectorXd> & torque);
+  void accumulate(const CompactIDIM & Y, const Eigen::Ref<const Eigen::VectorXd> & torque);
+  void decay();
+
+private:
+  CompactIDIM idim_;
+  /// Only the lower triangular part is used.
+  Eigen::MatrixXd YTY_;
+  Eigen::VectorXd YTtorque_;
+  Eigen::VectorXd torque_;
+  double torqueTtorque_ = 0.;
+  long nrSamples_ = 0;
+  double forgettingFactor_ = 1.;
+};
+
+/**
+ * Energy based identification model.
+ * The total energy of the system (kinetic energy of the bodies and of the
+ * joint actuators plus potential energy) is linear in the parameters:
+ * H = energy()*Phi. The power balance give
+ * torque^T alpha = dH/dt + dissipation()*Phi
+ * where dissipation() is the power lost in the viscous and Coulomb friction.
+ * Integrated over a time interval [t_a, t_b] this give one identification row
+ * (energy(t_b) - energy(t_a) + int dissipation)*Phi = int torque^T alpha
+ * that only need the joint position, velocity and torque, joint acceleration
+ * is not used.
+ *
+ * Phi is the inertial vector (@see multiBodyToInertialVector) optionally
+ * followed by the actuator parameters of the joints with dof, in the joint
+ * order: [armature_0, ..., armature_n, damping_0, ..., damping_n, friction_0, ..., friction_n]
+ * (@see Joint::armature, Joint::damping, Joint::friction).
+ */
+class RBDYN_DLLAPI EnergyIDIM
+{
+public:
+  EnergyIDIM() {}
+  /**
+   * @param mb MultiBody associated with this algorithm.
+   * @param actuator Add the armature, damping and friction parameters of each joint with dof.
+   */
+  EnergyIDIM(const rbd::MultiBody & mb, bool actuator = false);
+
+  /**
+   * Compute the energy and dissipation regressors and the joint power.
+   * @param mb MultiBody used has model.
+   * @param mbc Use bodyPosW, bodyVelB, alpha, jointTorque and gravity.
+   */
+  void computeEnergy(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
+
+  /// @return Energy regressor (nrParameters), H = energy()^T Phi.
+  const Eigen::VectorXd & energy() const
+  {
+    return energy_;
+  }
+
+  /// @return Dissipation regressor (nrParameters), only the friction parameters are non zero.
+  const Eigen::VectorXd & dissipation() const
+  {
+    return dissipation_;
+  }
+
+  /// @return Joint power torque^T alpha.
+  double power() const
+  {
+    return power_;
+  }
+
+  /**
+   * Compute the identification rows of a trajectory.
+   * The trajectory is cut in windows of window sampling periods, window i
+   * span the samples [i*window, (i+1)*window]. The integrals are computed with
+   * the trapezoidal rule.
+   * @param mb MultiBody used has model.
+   * @param q Generalized position of each sample (nrParams x nrSamples).
+   * @param alpha Generalized velocity of each sample (nrDof x nrSamples).
+   * @param torque Generalized force of each sample (nrDof x nrSamples).
+   * @param dt Sampling period.
+   * @param window Number of sampling periods of each window.
+   * @param gravity Gravity acceleration (@see MultiBodyConfig::gravity).
+   * @param nrThreads Number of worker threads, 0 means one per hardware thread.
+   */
+  void computeY(const rbd::MultiBody & mb,
+                const Eigen::Ref<const Eigen::MatrixXd> & q,
+                const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                double dt,
+                int window = 1,
+                const Eigen::Vector3d & gravity = Eigen::Vector3d(0., 9.81, 0.),
+                int nrThreads = 0);
+
+  /// @return Identification matrix (nrWindows x nrParameters) computed by computeY.
+  const Eigen::MatrixXd & Y() const
+  {
+    return Y_;
+  }
+
+  /// @return Work of the joint torques on each window computed by computeY.
+  const Eigen::VectorXd & work() const
+  {
+    return work_;
+  }
+
+  /// @return Parameters vector Phi of mb.
+  Eigen::VectorXd parameters(const rbd::MultiBody & mb) const;
+
+  /// @return Number of parameters.
+  int nrParameters() const
+  {
+    return static_cast<int>(energy_.size());
+  }
+
+  // safe version for python binding
+
+  /** safe version of @see computeEnergy.
+   * @throw std::domain_error If mb don't match mbc.
+   */
+  void sComputeEnergy(const rbd::MultiBody & mb, const rbd::MultiBodyConfig & mbc);
+
+  /** safe version of @see computeY.
+   * @throw std::domain_error If the trajectory don't match mb or window is not strictly positive.
+   */
+  void sComputeY(const rbd::MultiBody & mb,
+                 const Eigen::Ref<const Eigen::MatrixXd> & q,
+                 const Eigen::Ref<const Eigen::MatrixXd> & alpha,
+                 const Eigen::Ref<const Eigen::MatrixXd> & torque,
+                 double dt,
+                 int window = 1,
+                 const Eigen::Vector3d & gravity = Eigen::Vector3d(0., 9.81, 0.),
+                 int nrThreads = 0);
+
+private:
+  /// Joints with dof, one actuator parameter of each kind by joint.
+  std::vector<int> actuatedJoints_;
+  Eigen::VectorXd energy_;
+  Eigen::VectorXd dissipation_;
+  double power_;
+  Eigen::MatrixXd Y_;
+  Eigen::VectorXd work_;
+};
+
 } // namespace rbd
@@ -12,6 +12,7 @@
 #include <SpaceVecAlg/SpaceVecAlg>
 
 #include "Jacobian.h"
+#include "MultiBodyConfig.h"
 
 namespace rbd
 {
@@ -52,6 +53,13 @@ public:
    * @throw std::domain_error If mb doesn't match mbc.
    */
   bool sInverseKinematics(const MultiBody & mb, MultiBodyConfig & mbc, const sva::PTransformd & ef_target);
+
+  /// @return Number of iterations done by the last inverseKinematics call.
+  int iterations() const
+  {
+    return iterations_;
+  }
+
   /**
    * @brief Find q that minimizes the distance between ef and ef_target.
    * @return Bool if convergence has been reached
@@ -71,6 +79,105 @@ private:
   int ef_index_;
   Jacobian jac_;
   Eigen::JacobiSVD<Eigen::MatrixXd> svd_;
+  // jacobian, step and SVD solve workspace, sized once in the constructor
+  Eigen::MatrixXd jacMat_;
+  Eigen::VectorXd res_;
+  Eigen::VectorXd svdTmp_;
+  int iterations_;
+};
+
+/**
+ * Solve many independent inverse kinematics problems of the same end effector.
+ * Problems are dispatched on a set of worker threads, each worker own a copy
+ * of the MultiBodyConfig and an InverseKinematics instance (and so its own
+ * Jacobian and SVD workspace), nothing is allocated per problem.
+ * Results are stored in contiguous arrays indexed by the problem number.
+ */
+class RBDYN_DLLAPI BatchInverseKinematics
+{
+public:
+  /**
+   * @param mb MultiBody associated with this algorithm.
+   * @param ef_index End effector body index.
+   * @param nrThreads Number of worker threads, 0 means one per hardware thread.
+   */
+  BatchInverseKinematics(const MultiBody & mb, int ef_index, int nrThreads = 0);
+
+  /**
+   * Solve the inverse kinematics problem for each target.
+   * @param mb MultiBody used has model.
+   * @param targets End effector target of each problem.
+   * @param seeds Initial generalized position of each problem stored by column
+   * (nrParams x targets.size()). A single column is used as seed of every
+   * problem.
+   * @return Number of problems that have converged.
+   * Fill q, converged and iterations.
+   */
+  int inverseKinematics(const MultiBody & mb,
+                        const std::vector<sva::PTransformd> & targets,
+                        const Eigen::Ref<const Eigen::MatrixXd> & seeds);
+
+  /** safe version of @see inverseKinematics.
+   * @throw std::domain_error If mb doesn't match this algorithm or if seeds
+   * doesn't match mb or targets.
+   */
+  int sInverseKinematics(const MultiBody & mb,
+                         const std::vector<sva::PTransformd> & targets,
+                         const Eigen::Ref<const Eigen::MatrixXd> & seeds);
+
+  /// @return Solution of each problem stored by column (nrParams x nrProblems).
+  const Eigen::MatrixXd & q() const
+  {
+    return q_;
+  }
+
+  /// @return True for each problem that has converged.
+  const Eigen::Matrix<bool, Eigen::Dynamic, 1> & converged() const
+  {
+    return converged_;
+  }
+
+  /// @return Number of iterations done for each problem.
+  const Eigen::VectorXi & iterations() const
+  {
+    return iterations_;
+  }
+
+  /// @return Number of worker threads.
+  int nrThreads() const
+  {
+    return static_cast<int>(workspaces_.size());
+  }
+
+  // @brief Maximum number of iterations
+  int max_iterations_;
+  // @brief Learning rate
+  double lambda_;
+  // @brief Stopping criterion
+  double threshold_;
+  // @brief Rounding threshold for the Jacobian
+  double almost_zero_;
+  // @brief Number of problems given to a worker at once
+  int chunk_size_;
+
+private:
+  struct Workspace
+  {
+    MultiBodyConfig mbc;
+    InverseKinematics ik;
+  };
+
+  void checkMatchMultiBody(const MultiBody & mb) const;
+
+private:
+  int nrBodies_;
+  int nrParams_;
+  int nrDof_;
+  std::vector<Workspace> workspaces_;
+
+  Eigen::MatrixXd q_;
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> converged_;
+  Eigen::VectorXi iterations_;
 };
 
 } // namespace rbd
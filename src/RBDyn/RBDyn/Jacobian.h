@@ -9,10 +9,10 @@
 #include <rbdyn/config.hh>
 
 #include "MultiBody.h"
+#include "MultiBodyConfig.h"
 
 namespace rbd
 {
-struct MultiBodyConfig;
 
 /** Represents a contiguous block of DoFs in a Jacobian */
 struct Block
@@ -458,4 +458,109 @@ private:
   Eigen::MatrixXd jacDot_;
 };
 
+namespace detail
+{
+
+/**
+ * Jacobian of the joints of jointsPath at the point/frame Trans_0_p.
+ * Transform can be a PTransform or a translation vector, in the second case
+ * Eigen remove the identity rotation from the computation.
+ */
+template<typename T, typename Transform, typename Jac>
+inline void jacobian(const MultiBody & mb,
+                     const MultiBodyConfigT<T> & mbc,
+                     const Transform & Trans_0_p,
+                     const std::vector<int> & jointsPath,
+                     Jac & jac)
+{
+  const std::vector<JointData> & joints = mb.jointsData();
+  int curJ = 0;
+
+  sva::PTransform<T> X_0_p(Trans_0_p);
+
+  for(std::size_t index = 0; index < jointsPath.size(); ++index)
+  {
+    int i = jointsPath[index];
+
+    sva::PTransform<T> X_i_N = X_0_p * mbc.bodyPosW[i].inv();
+
+    for(int dof = 0; dof < joints[i].dof; ++dof)
+    {
+      jac.col(curJ + dof).noalias() = (X_i_N * (sva::MotionVec<T>(mbc.motionSubspace[i].col(dof)))).vector();
+    }
+
+    curJ += joints[i].dof;
+  }
+}
+
+} // namespace detail
+
+/**
+ * Compute the jacobian in world frame with the scalar type T.
+ * @param jac Jacobian describing the path and the point.
+ * @param mb MultiBody used has model.
+ * @param mbc Use bodyPosW and motionSubspace.
+ * @param res Jacobian of mb with mbc configuration (resized to 6 x jac.dof()).
+ * @see Jacobian::jacobian
+ */
+template<typename T>
+void computeJacobian(const Jacobian & jac,
+                     const MultiBody & mb,
+                     const MultiBodyConfigT<T> & mbc,
+                     Eigen::Matrix<T, 6, Eigen::Dynamic> & res)
+{
+  int N = jac.jointsPath().back();
+
+  res.resize(6, jac.dof());
+  const sva::PTransform<T> X_N_p(Eigen::Matrix<T, 3, 1>(jac.point().template cast<T>()));
+  Eigen::Matrix<T, 3, 1> T_0_Np((X_N_p * mbc.bodyPosW[N]).translation());
+  detail::jacobian(mb, mbc, T_0_Np, jac.jointsPath(), res);
+}
+
+/**
+ * Compute the jacobian in body coordinate frame with the scalar type T.
+ * @param jac Jacobian describing the path and the point.
+ * @param mb MultiBody used has model.
+ * @param mbc Use bodyPosW and motionSubspace.
+ * @param res Jacobian of mb with mbc configuration (resized to 6 x jac.dof()).
+ * @see Jacobian::bodyJacobian
+ */
+template<typename T>
+void computeBodyJacobian(const Jacobian & jac,
+                         const MultiBody & mb,
+                         const MultiBodyConfigT<T> & mbc,
+                         Eigen::Matrix<T, 6, Eigen::Dynamic> & res)
+{
+  int N = jac.jointsPath().back();
+
+  res.resize(6, jac.dof());
+  const sva::PTransform<T> X_N_p(Eigen::Matrix<T, 3, 1>(jac.point().template cast<T>()));
+  sva::PTransform<T> X_0_Np = X_N_p * mbc.bodyPosW[N];
+  detail::jacobian(mb, mbc, X_0_Np, jac.jointsPath(), res);
+}
+
+/**
+ * Project the jacobian in the full robot parameters vector with the scalar type T.
+ * @param jac Jacobian describing the path.
+ * @param mb MuliBody used has model.
+ * @param jacMat Jacobian to project.
+ * @param res Projected Jacobian (resized to 6 x mb.nrDof()).
+ * @see Jacobian::fullJacobian
+ */
+template<typename T>
+void computeFullJacobian(const Jacobian & jac,
+                         const MultiBody & mb,
+                         const Eigen::Matrix<T, 6, Eigen::Dynamic> & jacMat,
+                         Eigen::Matrix<T, 6, Eigen::Dynamic> & res)
+{
+  res.setZero(6, mb.nrDof());
+  int jacPos = 0;
+  for(int i : jac.jointsPath())
+  {
+    int dof = mb.joint(i).dof();
+    res.block(0, mb.jointPosInDof(i), 6, dof) = jacMat.block(0, jacPos, 6, dof);
+    jacPos += dof;
+  }
+}
+
 } // namespace rbd
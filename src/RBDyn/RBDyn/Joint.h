@@ -174,12 +174,83 @@ public:
     return mimicOffset_;
   }
 
+  /// @return Rotor inertia of the joint actuator (motor side).
+  double rotorInertia() const
+  {
+    return rotorInertia_;
+  }
+
+  /// @param rotorInertia Rotor inertia of the joint actuator (motor side).
+  void rotorInertia(double rotorInertia)
+  {
+    rotorInertia_ = rotorInertia;
+  }
+
+  /// @return Transmission ratio between the actuator and the joint (motor speed / joint speed).
+  double gearRatio() const
+  {
+    return gearRatio_;
+  }
+
+  /// @param gearRatio Transmission ratio between the actuator and the joint (motor speed / joint speed).
+  void gearRatio(double gearRatio)
+  {
+    gearRatio_ = gearRatio;
+  }
+
+  /**
+   * Rotor inertia reflected on the joint side (rotorInertia*gearRatio^2).
+   * It is added to each diagonal element of the joint block of the inertia matrix.
+   * @return Joint armature.
+   */
+  double armature() const
+  {
+    return rotorInertia_ * gearRatio_ * gearRatio_;
+  }
+
+  /// @return Viscous friction coefficient (joint side), friction torque is -damping*alpha.
+  double damping() const
+  {
+    return damping_;
+  }
+
+  /// @param damping Viscous friction coefficient (joint side).
+  void damping(double damping)
+  {
+    damping_ = damping;
+  }
+
+  /// @return Coulomb friction torque (joint side), friction torque is -friction*sign(alpha).
+  double friction() const
+  {
+    return friction_;
+  }
+
+  /// @param friction Coulomb friction torque (joint side).
+  void friction(double friction)
+  {
+    friction_ = friction;
+  }
+
+  /// @return True if the joint has a non zero armature, damping or friction.
+  bool hasActuatorDynamics() const
+  {
+    return armature() != 0. || damping_ != 0. || friction_ != 0.;
+  }
+
   /// @return Joint motion subspace in successor frame coordinate.
   const Eigen::Matrix<double, 6, Eigen::Dynamic> & motionSubspace() const
   {
     return S_;
   }
 
+  /**
+   * Change the axis of a Rev, Prism or Cylindrical joint, the motion subspace
+   * is updated in place. The other joint types have no axis and are unchanged.
+   * @param axis Joint axis in successor frame coordinate.
+   */
+  void axis(const Eigen::Vector3d & axis);
+
   /**
    * Compute the joint transformation from predecessor to successor frame.
    * @param q vector of generalized position variable.
@@ -195,6 +266,10 @@ public:
    */
   sva::MotionVecd motion(const std::vector<double> & alpha) const;
 
+  /// @see motion.
+  template<typename T>
+  sva::MotionVec<T> motion(const std::vector<T> & alpha) const;
+
   /**
    * Compute the tangential part of the acceleration S*alphaD.
    * @param alphaD vector of generalized acceleration variable.
@@ -202,6 +277,10 @@ public:
    */
   sva::MotionVecd tanAccel(const std::vector<double> & alphaD) const;
 
+  /// @see tanAccel.
+  template<typename T>
+  sva::MotionVec<T> tanAccel(const std::vector<T> & alphaD) const;
+
   /**
    * @return Joint configuation at zero.
    */
@@ -247,6 +326,27 @@ public:
   }
 
 public:
+  /**
+   * Compute the transformation from predecessor to successor frame of a joint.
+   * @param type Joint type.
+   * @param dir Joint direction.
+   * @param S Joint motion subspace (with the direction applied).
+   * @param q vector of generalized position variable.
+   * @see pose
+   */
+  template<typename T, typename Derived>
+  static sva::PTransform<T> Pose(Type type, double dir, const Eigen::MatrixBase<Derived> & S, const std::vector<T> & q);
+
+  /**
+   * Compute S*alpha for a joint.
+   * @param type Joint type.
+   * @param S Joint motion subspace (with the direction applied).
+   * @param alpha vector of generalized speed or acceleration variable.
+   * @see motion
+   */
+  template<typename T, typename Derived>
+  static sva::MotionVec<T> Motion(Type type, const Eigen::MatrixBase<Derived> & S, const std::vector<T> & alpha);
+
   /**
    * @return Joint configuation at zero.
    */
@@ -274,6 +374,11 @@ private:
   std::string mimicName_ = "";
   double mimicMultiplier_ = 1.0;
   double mimicOffset_ = 0.0;
+
+  double rotorInertia_ = 0.0;
+  double gearRatio_ = 1.0;
+  double damping_ = 0.0;
+  double friction_ = 0.0;
 };
 
 inline std::ostream & operator<<(std::ostream & out, const Joint & b)
@@ -342,35 +447,51 @@ inline void Joint::makeMimic(const std::string & name, double multiplier, double
 
 template<typename T>
 inline sva::PTransform<T> Joint::pose(const std::vector<T> & q) const
+{
+  return Pose(type_, dir_, S_, q);
+}
+
+template<typename T, typename Derived>
+inline sva::PTransform<T> Joint::Pose(Type type,
+                                      double dir,
+                                      const Eigen::MatrixBase<Derived> & S,
+                                      const std::vector<T> & q)
 {
   using namespace Eigen;
   using namespace sva;
   Matrix3<T> rot;
-  switch(type_)
+  switch(type)
   {
     case Rev:
       // minus S because rotation is anti trigonometric
-      return PTransform<T>(AngleAxis<T>(-q[0], S_.block<3, 1>(0, 0).cast<T>()).matrix());
+      return PTransform<T>(AngleAxis<T>(-q[0], S.template block<3, 1>(0, 0).template cast<T>()).matrix());
     case Prism:
-      return PTransform<T>(Vector3<T>(S_.block<3, 1>(3, 0).cast<T>() * q[0]));
+      return PTransform<T>(Vector3<T>(S.template block<3, 1>(3, 0).template cast<T>() * q[0]));
     case Spherical:
-      return PTransform<T>(Quaternion<T>(q[0], dir_ * q[1], dir_ * q[2], dir_ * q[3]).inverse());
+      return PTransform<T>(Quaternion<T>(q[0], dir * q[1], dir * q[2], dir * q[3]).inverse());
     case Planar:
-      rot = sva::RotZ(q[0]);
-      if(dir_ == 1.)
+    {
+      // same as sva::RotZ but the unqualified calls allow custom scalar types
+      using std::cos;
+      using std::sin;
+      const T c = cos(q[0]);
+      const T s = sin(q[0]);
+      rot << c, s, T(0.), -s, c, T(0.), T(0.), T(0.), T(1.);
+      if(dir == 1.)
       {
-        return PTransform<T>(rot, rot.transpose() * Vector3d(q[1], q[2], 0.));
+        return PTransform<T>(rot, rot.transpose() * Vector3<T>(q[1], q[2], T(0.)));
       }
       else
       {
-        return PTransform<T>(rot, rot.transpose() * Vector3d(q[1], q[2], 0.)).inv();
+        return PTransform<T>(rot, rot.transpose() * Vector3<T>(q[1], q[2], T(0.))).inv();
       }
+    }
     case Cylindrical:
-      return PTransform<T>(AngleAxis<T>(-q[0], S_.col(0).head<3>().cast<T>()).matrix(),
-                           S_.col(1).tail<3>().cast<T>() * q[1]);
+      return PTransform<T>(AngleAxis<T>(-q[0], S.col(0).template head<3>().template cast<T>()).matrix(),
+                           S.col(1).template tail<3>().template cast<T>() * q[1]);
     case Free:
       rot = QuatToE(q);
-      if(dir_ == 1.)
+      if(dir == 1.)
       {
         return PTransform<T>(rot, Vector3<T>(q[4], q[5], q[6]));
       }
@@ -386,50 +507,48 @@ inline sva::PTransform<T> Joint::pose(const std::vector<T> & q) const
 
 inline sva::MotionVecd Joint::motion(const std::vector<double> & alpha) const
 {
-  using namespace Eigen;
-  using namespace sva;
-  switch(type_)
-  {
-    case Rev:
-      return MotionVecd((Vector6d() << S_.block<3, 1>(0, 0) * alpha[0], Vector3d::Zero()).finished());
-    case Prism:
-      return MotionVecd((Vector6d() << Vector3d::Zero(), S_.block<3, 1>(3, 0) * alpha[0]).finished());
-    case Spherical:
-      return MotionVecd(S_ * Vector3d(alpha[0], alpha[1], alpha[2]));
-    case Planar:
-      return MotionVecd(S_ * Vector3d(alpha[0], alpha[1], alpha[2]));
-    case Cylindrical:
-      return MotionVecd(S_ * Vector2d(alpha[0], alpha[1]));
-    case Free:
-      return MotionVecd(S_ * (Vector6d() << alpha[0], alpha[1], alpha[2], alpha[3], alpha[4], alpha[5]).finished());
-    case Fixed:
-    default:
-      return MotionVecd(Vector6d::Zero());
-  }
+  return motion<double>(alpha);
+}
+
+template<typename T>
+inline sva::MotionVec<T> Joint::motion(const std::vector<T> & alpha) const
+{
+  return Motion(type_, S_, alpha);
 }
 
 inline sva::MotionVecd Joint::tanAccel(const std::vector<double> & alphaD) const
+{
+  return tanAccel<double>(alphaD);
+}
+
+template<typename T>
+inline sva::MotionVec<T> Joint::tanAccel(const std::vector<T> & alphaD) const
+{
+  return Motion(type_, S_, alphaD);
+}
+
+template<typename T, typename Derived>
+inline sva::MotionVec<T> Joint::Motion(Type type, const Eigen::MatrixBase<Derived> & S, const std::vector<T> & alpha)
 {
   using namespace Eigen;
   using namespace sva;
-  switch(type_)
+  switch(type)
   {
     case Rev:
-      return MotionVecd((Vector6d() << S_.block<3, 1>(0, 0) * alphaD[0], Vector3d::Zero()).finished());
+      return MotionVec<T>(S.template block<3, 1>(0, 0).template cast<T>() * alpha[0], Vector3<T>::Zero());
     case Prism:
-      return MotionVecd((Vector6d() << Vector3d::Zero(), S_.block<3, 1>(3, 0) * alphaD[0]).finished());
+      return MotionVec<T>(Vector3<T>::Zero(), S.template block<3, 1>(3, 0).template cast<T>() * alpha[0]);
     case Spherical:
-      return MotionVecd(S_ * Vector3d(alphaD[0], alphaD[1], alphaD[2]));
     case Planar:
-      return MotionVecd(S_ * Vector3d(alphaD[0], alphaD[1], alphaD[2]));
+      return MotionVec<T>(S.template cast<T>() * Vector3<T>(alpha[0], alpha[1], alpha[2]));
     case Cylindrical:
-      return MotionVecd(S_ * Vector2d(alphaD[0], alphaD[1]));
+      return MotionVec<T>(S.template cast<T>() * Matrix<T, 2, 1>(alpha[0], alpha[1]));
     case Free:
-      return MotionVecd(S_
-                        * (Vector6d() << alphaD[0], alphaD[1], alphaD[2], alphaD[3], alphaD[4], alphaD[5]).finished());
+      return MotionVec<T>(S.template cast<T>()
+                          * (Vector6<T>() << alpha[0], alpha[1], alpha[2], alpha[3], alpha[4], alpha[5]).finished());
     case Fixed:
     default:
-      return MotionVecd(Vector6d::Zero());
+      return MotionVec<T>(Vector6<T>::Zero());
   }
 }
 
@@ -579,6 +698,25 @@ inline void Joint::constructJoint(Type t, const Eigen::Vector3d & a)
   }
 }
 
+inline void Joint::axis(const Eigen::Vector3d & axis)
+{
+  switch(type_)
+  {
+    case Rev:
+      S_.col(0) << dir_ * axis, Eigen::Vector3d::Zero();
+      break;
+    case Prism:
+      S_.col(0) << Eigen::Vector3d::Zero(), dir_ * axis;
+      break;
+    case Cylindrical:
+      S_.col(0) << dir_ * axis, Eigen::Vector3d::Zero();
+      S_.col(1) << Eigen::Vector3d::Zero(), dir_ * axis;
+      break;
+    default:
+      break;
+  }
+}
+
 template<typename T>
 inline Eigen::Matrix3<T> QuatToE(const std::vector<T> & q)
 {
@@ -597,14 +735,15 @@ inline Eigen::Matrix3<T> QuatToE(const std::vector<T> & q)
 
   T p2p3 = p2 * p3;
 
-  T p0s = std::pow(p0, 2);
-  T p1s = std::pow(p1, 2);
-  T p2s = std::pow(p2, 2);
-  T p3s = std::pow(p3, 2);
+  T p0s = p0 * p0;
+  T p1s = p1 * p1;
+  T p2s = p2 * p2;
+  T p3s = p3 * p3;
 
-  return 2.
-         * (Matrix3<T>() << p0s + p1s - 0.5, p1p2 + p0p3, p1p3 - p0p2, p1p2 - p0p3, p0s + p2s - 0.5, p2p3 + p0p1,
-            p1p3 + p0p2, p2p3 - p0p1, p0s + p3s - 0.5)
+  const T half(0.5);
+  return T(2.)
+         * (Matrix3<T>() << p0s + p1s - half, p1p2 + p0p3, p1p3 - p0p2, p1p2 - p0p3, p0s + p2s - half, p2p3 + p0p1,
+            p1p3 + p0p2, p2p3 - p0p1, p0s + p3s - half)
                .finished();
 }
 
@@ -6,7 +6,9 @@
 
 // includes
 // std
+#include <cstdint>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -22,6 +24,62 @@
 namespace rbd
 {
 
+/**
+ * @return A new version stamp, stamps are unique and monotonically increasing
+ * across all the MultiBody and MultiBodyConfig (@see MultiBody::stamp,
+ * ConfigStamps). 0 is never returned and means unknown version.
+ */
+RBDYN_DLLAPI std::uint64_t nextStamp();
+
+/**
+ * Joint data used by the kinematic and dynamic algorithms.
+ * MultiBody store them contiguously, without the joints and bodies names and
+ * the mimic information, to keep the algorithm loops working set small.
+ * The joint motion subspace is a column block of MultiBody::motionSubspaces.
+ */
+struct JointData
+{
+  /// Transformation from the predecessor body base to the joint.
+  sva::PTransformd Xt;
+  /// Spatial rigid body inertia of the successor body.
+  sva::RBInertiad inertia;
+  Joint::Type type;
+  /// Joint direction.
+  double direction;
+  int params;
+  int dof;
+  /// Position in parameter vector (q).
+  int posInParam;
+  /// Position in dof vector (alpha, alphaD…).
+  int posInDof;
+  /// Predecessor body index.
+  int pred;
+  /// Successor body index.
+  int succ;
+  /// @see Joint::hasActuatorDynamics
+  bool hasActuatorDynamics;
+  /// @see Joint::armature
+  double armature;
+  /// @see Joint::damping
+  double damping;
+  /// @see Joint::friction
+  double friction;
+};
+
+/**
+ * Operational frame (sensor, tool tip, contact point...) rigidly attached to
+ * a body.
+ */
+struct OperationalFrame
+{
+  /// Frame name.
+  std::string name;
+  /// Index of the body the frame is attached to.
+  int body;
+  /// Transformation from the body base to the frame.
+  sva::PTransformd X_b_f;
+};
+
 /**
  * Kinematic tree of a multibody system.
  * Same representation as featherstone except joint 0 is the root joint.
@@ -68,6 +126,7 @@ public:
   void bodies(std::vector<Body> b)
   {
     bodies_ = std::move(b);
+    updateJointsData();
   }
 
   /// @return Body at num position in bodies list.
@@ -80,6 +139,18 @@ public:
   void body(int num, const Body & b)
   {
     bodies_[num] = b;
+    updateBodyData(num);
+  }
+
+  /**
+   * Set the inertia of body num in place, without copying the body.
+   * Intended for the models whose parameters are perturbed at runtime
+   * (identification, domain randomization), @see inertiaStamp.
+   */
+  void bodyInertia(int num, const sva::RBInertiad & inertia)
+  {
+    bodies_[num].inertia(inertia);
+    updateBodyData(num);
   }
 
   /// @return Joints of the multibody system.
@@ -94,6 +165,42 @@ public:
     return joints_[num];
   }
 
+  /**
+   * Set the axis of the Rev, Prism or Cylindrical joint num in place
+   * (@see Joint::axis), the motion subspaces are updated without allocation.
+   * The axis is given in successor frame coordinate, @see geometryStamp.
+   */
+  void jointAxis(int num, const Eigen::Vector3d & axis)
+  {
+    joints_[num].axis(axis);
+    S_.middleCols(jointsData_[num].posInDof, jointsData_[num].dof) = joints_[num].motionSubspace();
+    geometryChanged();
+  }
+
+  /// @return Joints data used by the algorithms, ordered as joints.
+  const std::vector<JointData> & jointsData() const
+  {
+    return jointsData_;
+  }
+
+  /// @return Data of the joint num.
+  const JointData & jointData(int num) const
+  {
+    return jointsData_[num];
+  }
+
+  /// @return Motion subspace of all the joints (6 x nrDof), ordered as the dof vector.
+  const Eigen::Matrix<double, 6, Eigen::Dynamic> & motionSubspaces() const
+  {
+    return S_;
+  }
+
+  /// @return Motion subspace of joint num, same as joint(num).motionSubspace().
+  Eigen::Block<const Eigen::Matrix<double, 6, Eigen::Dynamic>, 6, Eigen::Dynamic, true> motionSubspace(int num) const
+  {
+    return S_.middleCols(jointsData_[num].posInDof, jointsData_[num].dof);
+  }
+
   /// @return Predeccesor body index of each joint.
   const std::vector<int> & predecessors() const
   {
@@ -140,6 +247,7 @@ public:
   void transforms(std::vector<sva::PTransformd> Xt)
   {
     Xt_ = std::move(Xt);
+    updateJointsData();
   }
 
   /// @return Transformation from the body base to joint num
@@ -152,6 +260,8 @@ public:
   void transform(int num, const sva::PTransformd & Xt)
   {
     Xt_[num] = Xt;
+    jointsData_[num].Xt = Xt;
+    geometryChanged();
   }
 
   /// @return Index of the body with name 'name'.
@@ -214,6 +324,79 @@ public:
     return nrDof_;
   }
 
+  /**
+   * @return Version stamp of the data used by the algorithms, changed by the
+   * constructor and the bodies, transforms and joint axes setters.
+   * Algorithms that cache their results use it with ConfigStamps.
+   */
+  std::uint64_t stamp() const
+  {
+    return stamp_;
+  }
+
+  /**
+   * @return Version stamp of the bodies inertia, changed by the constructor
+   * and the bodies setters.
+   * Algorithms that precompute data from the inertia (CoMJacobian, Coriolis)
+   * refresh it when this stamp changes.
+   */
+  std::uint64_t inertiaStamp() const
+  {
+    return inertiaStamp_;
+  }
+
+  /**
+   * @return Version stamp of the joints transformation and axes, changed by
+   * the constructor and the transforms and joint axes setters.
+   * Algorithms that precompute data from the geometry (FloatKinematics)
+   * refresh it when this stamp changes.
+   */
+  std::uint64_t geometryStamp() const
+  {
+    return geometryStamp_;
+  }
+
+  /**
+   * Register an operational frame.
+   * Frames are not used by the algorithms, @see FrameKinematics to compute
+   * their poses, velocities and jacobians.
+   * @param name Frame name.
+   * @param body Index of the body the frame is attached to.
+   * @param X_b_f Transformation from the body base to the frame.
+   * @return Frame index.
+   */
+  int addFrame(const std::string & name, int body, const sva::PTransformd & X_b_f = sva::PTransformd::Identity());
+
+  /// @return Number of operational frames.
+  int nrFrames() const
+  {
+    return static_cast<int>(frames_.size());
+  }
+
+  /// @return Operational frames.
+  const std::vector<OperationalFrame> & frames() const
+  {
+    return frames_;
+  }
+
+  /// @return Operational frame at num position in frames list.
+  const OperationalFrame & frame(int num) const
+  {
+    return frames_[num];
+  }
+
+  /// @return Index of the frame with name 'name'.
+  int frameIndexByName(const std::string & name) const
+  {
+    return frameNameToInd_.find(name)->second;
+  }
+
+  /// @return true if a frame is named 'name'.
+  bool hasFrame(const std::string & name) const
+  {
+    return frameNameToInd_.count(name) != 0;
+  }
+
   // safe accessors version for python binding
 
   /** Safe version of @see bodies.
@@ -244,6 +427,16 @@ public:
   void sBody(int num, const Body & b)
   {
     bodies_.at(num) = b;
+    updateBodyData(num);
+  }
+
+  /** Safe version of @see bodyInertia.
+   * @throw std::out_of_range.
+   */
+  void sBodyInertia(int num, const sva::RBInertiad & inertia)
+  {
+    bodies_.at(num).inertia(inertia);
+    updateBodyData(num);
   }
 
   /** Safe version of @see joint.
@@ -254,6 +447,12 @@ public:
     return joints_.at(num);
   }
 
+  /** Safe version of @see jointAxis.
+   * @throw std::out_of_range If the joint don't exist.
+   * @throw std::domain_error If the joint has no axis or axis is not unitary.
+   */
+  void sJointAxis(int num, const Eigen::Vector3d & axis);
+
   /** Safe version of @see predecessor.
    * @throw std::out_of_range.
    */
@@ -306,6 +505,8 @@ public:
   void sTransform(int num, const sva::PTransformd & Xt)
   {
     Xt_.at(num) = Xt;
+    jointsData_[num].Xt = Xt;
+    geometryChanged();
   }
 
   /** Safe version of @see jointPosInParam.
@@ -342,6 +543,40 @@ public:
     return jointNameToInd_.at(name);
   }
 
+  /** Safe version of @see addFrame.
+   * @throw std::out_of_range If body don't exist.
+   * @throw std::domain_error If a frame is already named 'name'.
+   */
+  int sAddFrame(const std::string & name, int body, const sva::PTransformd & X_b_f = sva::PTransformd::Identity());
+
+  /** Safe version of @see frame.
+   * @throw std::out_of_range.
+   */
+  const OperationalFrame & sFrame(int num) const
+  {
+    return frames_.at(num);
+  }
+
+  /** Safe version of @see frameIndexByName.
+   * @throw std::out_of_range
+   */
+  int sFrameIndexByName(const std::string & name) const
+  {
+    return frameNameToInd_.at(name);
+  }
+
+protected:
+  /// Fill jointsData_ and S_ from the joints, bodies and transformations.
+  void updateJointsData();
+  /// Update the inertia of the joint that has body num as successor.
+  void updateBodyData(int num);
+  /// Change the stamps after a transformation or joint axis update.
+  void geometryChanged()
+  {
+    stamp_ = nextStamp();
+    geometryStamp_ = stamp_;
+  }
+
 protected:
   std::vector<Body> bodies_;
   std::vector<Joint> joints_;
@@ -362,6 +597,68 @@ protected:
 
   int nrParams_;
   int nrDof_;
+
+  /// Hot data of joint i, must be kept in sync with bodies_ and Xt_.
+  std::vector<JointData> jointsData_;
+  /// Motion subspace of all the joints.
+  Eigen::Matrix<double, 6, Eigen::Dynamic> S_;
+  /// Version of jointsData_.
+  std::uint64_t stamp_;
+  /// Version of the bodies inertia.
+  std::uint64_t inertiaStamp_;
+  /// Version of Xt_ and the joints motion subspace.
+  std::uint64_t geometryStamp_;
+
+  std::vector<OperationalFrame> frames_;
+  std::unordered_map<std::string, int> frameNameToInd_;
+};
+
+/// Bodies and joints numbering used by reorder.
+enum class BodyOrder
+{
+  /// Depth first (preorder), each subtree is contiguous.
+  DepthFirst,
+  /// Breadth first, the bodies of the same depth are contiguous and independent.
+  BreadthFirst,
+  /// Depth first visiting the deepest subtree first, the longest chains are contiguous.
+  LongestChainFirst
 };
 
+/**
+ * Compute a numbering of the bodies of mb.
+ * In all orders a parent body is placed before its children and children
+ * with the same rank keep their relative order.
+ * @param mb MultiBody to renumber.
+ * @param order Numbering strategy.
+ * @return Old index of each new body index.
+ */
+RBDYN_DLLAPI std::vector<int> bodiesOrder(const MultiBody & mb, BodyOrder order);
+
+/**
+ * Renumber the bodies and joints of mb, the joint i stay the joint that
+ * move the body i.
+ * Names, transformations, inertias and operational frames are not modified,
+ * so name based lookups (bodyIndexByName, jointIndexByName) are stable and
+ * ConfigConverter map the configurations between the two numberings.
+ * @param mb MultiBody to renumber.
+ * @param order Old index of each new body index, a parent body must be placed
+ * before its children.
+ * @return Renumbered MultiBody.
+ */
+RBDYN_DLLAPI MultiBody reorder(const MultiBody & mb, const std::vector<int> & order);
+
+/**
+ * Renumber the bodies and joints of mb.
+ * @see bodiesOrder
+ * @see reorder
+ */
+RBDYN_DLLAPI MultiBody reorder(const MultiBody & mb, BodyOrder order);
+
+/**
+ * Safe version of @see reorder.
+ * @throw std::domain_error If order is not a permutation of the bodies or
+ * if a body is placed before its parent.
+ */
+RBDYN_DLLAPI MultiBody sReorder(const MultiBody & mb, const std::vector<int> & order);
+
 } // namespace rbd
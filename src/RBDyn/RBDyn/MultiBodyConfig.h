@@ -6,7 +6,10 @@
 
 // includes
 // std
+#include <cstdint>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // sva
@@ -20,55 +23,138 @@
 namespace rbd
 {
 
-struct RBDYN_DLLAPI MultiBodyConfig
+/**
+ * Version stamps of a configuration.
+ * Each stamp is replaced by a new nextStamp() value when the matching inputs
+ * or the results computed from them change:
+ *  - position by forwardKinematics, eulerIntegration and zero,
+ *  - velocity by forwardVelocity, eulerIntegration and zero,
+ *  - acceleration by forwardAcceleration and zero,
+ *  - force by zero.
+ * The code that write q, alpha, alphaD, force or gravity without calling these
+ * functions must call the matching *Changed method.
+ * Algorithms that cache their results (ForwardDynamicsT::updateH,
+ * CoMJacobian::updateJacobian, FrameKinematics) compare these stamps with the
+ * ones of their last computation, 0 (never stamped) is never considered as
+ * cached.
+ */
+struct ConfigStamps
 {
-  MultiBodyConfig() {}
-  MultiBodyConfig(const MultiBody & mb);
+  std::uint64_t position = 0;
+  std::uint64_t velocity = 0;
+  std::uint64_t acceleration = 0;
+  /// Stamp of force and gravity.
+  std::uint64_t force = 0;
+
+  void positionChanged()
+  {
+    position = nextStamp();
+  }
+
+  void velocityChanged()
+  {
+    velocity = nextStamp();
+  }
+
+  void accelerationChanged()
+  {
+    acceleration = nextStamp();
+  }
+
+  void forceChanged()
+  {
+    force = nextStamp();
+  }
+
+  /// @return true if stamp is known and equal to cached.
+  static bool same(std::uint64_t cached, std::uint64_t stamp)
+  {
+    return stamp != 0 && stamp == cached;
+  }
+};
+
+/**
+ * MultiBody state and algorithms results with a generic scalar type.
+ * The MultiBody model stay in double, the algorithms templated on the
+ * scalar type (forwardKinematics, forwardVelocity, forwardAcceleration,
+ * InverseDynamicsT, ForwardDynamicsT, computeJacobian, computeCoM...) cast the
+ * model constants to T.
+ * T can be float, long double or any type that behave like a floating point
+ * (automatic differentiation or interval scalar).
+ * @see MultiBodyConfig for the double version used by the rest of the library.
+ */
+template<typename T>
+struct MultiBodyConfigT
+{
+  typedef T scalar_t;
+
+  MultiBodyConfigT() {}
+  MultiBodyConfigT(const MultiBody & mb);
 
   /// Set the multibody at zero configuration
   void zero(const MultiBody & mb);
 
+  /**
+   * Convert the configuration to another scalar type.
+   * All the fields are converted.
+   */
+  template<typename T2>
+  MultiBodyConfigT<T2> cast() const;
+
   /// Generalized position variable.
-  std::vector<std::vector<double>> q;
+  std::vector<std::vector<T>> q;
 
   /// Generalized speed variable.
-  std::vector<std::vector<double>> alpha;
+  std::vector<std::vector<T>> alpha;
 
   /// Generalized acceleration variable.
-  std::vector<std::vector<double>> alphaD;
+  std::vector<std::vector<T>> alphaD;
 
   /// Total external force acting on each body in world coordinate.
-  std::vector<sva::ForceVecd> force;
+  std::vector<sva::ForceVec<T>> force;
 
   /// Joints configuration (Xj).
-  std::vector<sva::PTransformd> jointConfig;
+  std::vector<sva::PTransform<T>> jointConfig;
 
   /// Joints velocity (Xj*j.motion()).
-  std::vector<sva::MotionVecd> jointVelocity;
+  std::vector<sva::MotionVec<T>> jointVelocity;
 
   /// Joints torque.
-  std::vector<std::vector<double>> jointTorque;
+  std::vector<std::vector<T>> jointTorque;
 
   /// Motion subspace (Xj.j.subspace).
-  std::vector<Eigen::Matrix<double, 6, Eigen::Dynamic>> motionSubspace;
+  std::vector<Eigen::Matrix<T, 6, Eigen::Dynamic>> motionSubspace;
 
   /// Bodies transformation in world coordinate.
-  std::vector<sva::PTransformd> bodyPosW;
+  std::vector<sva::PTransform<T>> bodyPosW;
 
   /// Transformation from parent(i) to i in body coordinate (Xj*Xt).
-  std::vector<sva::PTransformd> parentToSon;
+  std::vector<sva::PTransform<T>> parentToSon;
 
   /// Bodies speed in world coordinate.
-  std::vector<sva::MotionVecd> bodyVelW;
+  std::vector<sva::MotionVec<T>> bodyVelW;
 
   /// Bodies speed in Body coordinate.
-  std::vector<sva::MotionVecd> bodyVelB;
+  std::vector<sva::MotionVec<T>> bodyVelB;
 
   /// Bodies acceleration in Body coordinate.
-  std::vector<sva::MotionVecd> bodyAccB;
+  std::vector<sva::MotionVec<T>> bodyAccB;
 
   /// gravity acting on the multibody.
-  Eigen::Vector3d gravity;
+  Eigen::Matrix<T, 3, 1> gravity;
+
+  /// Version stamps of the configuration.
+  ConfigStamps stamps;
+};
+
+extern template struct RBDYN_DLLAPI MultiBodyConfigT<double>;
+
+struct RBDYN_DLLAPI MultiBodyConfig : public MultiBodyConfigT<double>
+{
+  MultiBodyConfig() {}
+  MultiBodyConfig(const MultiBody & mb);
+  /// Build a MultiBodyConfig from a generic configuration (@see MultiBodyConfigT::cast).
+  MultiBodyConfig(const MultiBodyConfigT<double> & mbc);
 
   // python binding function
 
@@ -83,13 +169,31 @@ struct RBDYN_DLLAPI MultiBodyConfig
 class RBDYN_DLLAPI ConfigConverter
 {
 public:
-  ConfigConverter(const MultiBody & from, const MultiBody & to);
+  /**
+   * @param from MultiBody of the source configurations.
+   * @param to MultiBody of the converted configurations.
+   * @param convertBase Also convert the first joint (base), from and to must
+   * have the same base joint (@see reorder).
+   */
+  ConfigConverter(const MultiBody & from, const MultiBody & to, bool convertBase = false);
 
   void convert(const MultiBodyConfig & from, MultiBodyConfig & to) const;
 
+  /**
+   * Convert a generalized position vector (@see paramToVector).
+   * The first joint (base) is ignored unless convertBase is true.
+   */
+  void convertParam(const Eigen::Ref<const Eigen::VectorXd> & from, Eigen::Ref<Eigen::VectorXd> to) const;
+
+  /**
+   * Convert a generalized speed, acceleration or torque vector (@see dofToVector).
+   * The first joint (base) is ignored unless convertBase is true.
+   */
+  void convertDof(const Eigen::Ref<const Eigen::VectorXd> & from, Eigen::Ref<Eigen::VectorXd> to) const;
+
   /**
    * Convert a vector representing joint data.
-   * The first joint (base) is ignored.
+   * The first joint (base) is ignored unless convertBase is true.
    */
   template<typename T>
   void convertJoint(const std::vector<T> & from, std::vector<T> & to) const;
@@ -100,15 +204,26 @@ public:
   // safe version for python binding
 
   /** safe version of @see ConfigConverter.
-   * @throw std::domain_error If mb don't match mbc.
+   * @throw std::domain_error If mb don't match mbc or if convertBase is true and
+   * the base joints type mismatch.
    */
-  static ConfigConverter * sConstructor(const MultiBody & from, const MultiBody & to);
+  static ConfigConverter * sConstructor(const MultiBody & from, const MultiBody & to, bool convertBase = false);
 
   /** safe version of @see convert.
    * @throw std::domain_error If mb don't match mbc.
    */
   void sConvert(const MultiBodyConfig & from, MultiBodyConfig & to) const;
 
+  /** safe version of @see convertParam.
+   * @throw std::domain_error If from or to size mismatch the MultiBody.
+   */
+  void sConvertParam(const Eigen::Ref<const Eigen::VectorXd> & from, Eigen::Ref<Eigen::VectorXd> to) const;
+
+  /** safe version of @see convertDof.
+   * @throw std::domain_error If from or to size mismatch the MultiBody.
+   */
+  void sConvertDof(const Eigen::Ref<const Eigen::VectorXd> & from, Eigen::Ref<Eigen::VectorXd> to) const;
+
   /** safe version of @see convertJoint.
    * @throw std::domain_error If mb don't match mbc.
    */
@@ -116,8 +231,25 @@ public:
   void sConvertJoint(const std::vector<T> & from, std::vector<T> & to) const;
 
 private:
+  /// Contiguous segment copied by convertParam and convertDof.
+  struct Segment
+  {
+    int from;
+    int to;
+    int size;
+  };
+
+  static void addSegment(std::vector<Segment> & segments, int from, int to, int size);
+
+private:
+  /// First converted joint.
+  int first_;
+  int fromNrParams_, toNrParams_;
+  int fromNrDof_, toNrDof_;
   std::vector<int> jInd_;
   std::vector<int> bInd_;
+  std::vector<Segment> paramSegments_;
+  std::vector<Segment> dofSegments_;
 };
 
 /**
@@ -269,12 +401,125 @@ void checkMatchJointsVector(const MultiBody & mb, const std::vector<T> & vec, co
   }
 }
 
+template<typename T>
+MultiBodyConfigT<T>::MultiBodyConfigT(const MultiBody & mb)
+: q(mb.nrJoints()), alpha(mb.nrJoints()), alphaD(mb.nrJoints()), force(mb.nrBodies()), jointConfig(mb.nrJoints()),
+  jointVelocity(mb.nrJoints()), jointTorque(mb.nrJoints()), motionSubspace(mb.nrJoints()), bodyPosW(mb.nrBodies()),
+  parentToSon(mb.nrBodies()), bodyVelW(mb.nrBodies()), bodyVelB(mb.nrBodies()), bodyAccB(mb.nrBodies()),
+  gravity(T(0.), T(9.81), T(0.))
+{
+  for(int i = 0; i < static_cast<int>(q.size()); ++i)
+  {
+    q[i].resize(mb.joint(i).params());
+    alpha[i].resize(mb.joint(i).dof());
+    alphaD[i].resize(mb.joint(i).dof());
+
+    jointTorque[i].resize(mb.joint(i).dof());
+    motionSubspace[i].resize(6, mb.joint(i).dof());
+  }
+}
+
+template<typename T>
+void MultiBodyConfigT<T>::zero(const MultiBody & mb)
+{
+  for(int i = 0; i < static_cast<int>(q.size()); ++i)
+  {
+    const std::vector<double> zeroParam = mb.joint(i).zeroParam();
+    q[i].assign(zeroParam.begin(), zeroParam.end());
+    alpha[i].assign(mb.joint(i).dof(), T(0.));
+    alphaD[i].assign(mb.joint(i).dof(), T(0.));
+
+    jointTorque[i].assign(mb.joint(i).dof(), T(0.));
+  }
+
+  for(std::size_t i = 0; i < force.size(); ++i)
+  {
+    force[i] = sva::ForceVec<T>(Eigen::Matrix<T, 6, 1>::Zero());
+  }
+
+  stamps.positionChanged();
+  stamps.velocityChanged();
+  stamps.accelerationChanged();
+  stamps.forceChanged();
+}
+
+namespace detail
+{
+
+/// Cast a model constant (sva or Eigen object in double) to the scalar type T.
+template<typename T, typename X>
+inline typename std::enable_if<!std::is_same<T, double>::value, decltype(std::declval<X>().template cast<T>())>::type
+    scalarCast(const X & x)
+{
+  return x.template cast<T>();
+}
+
+/// Overload without copy used by the double algorithms.
+template<typename T, typename X>
+inline typename std::enable_if<std::is_same<T, double>::value, const X &>::type scalarCast(const X & x)
+{
+  return x;
+}
+
+template<typename T2, typename T>
+void castParam(const std::vector<std::vector<T>> & from, std::vector<std::vector<T2>> & to)
+{
+  to.resize(from.size());
+  for(std::size_t i = 0; i < from.size(); ++i)
+  {
+    to[i].assign(from[i].begin(), from[i].end());
+  }
+}
+
+template<typename T2, typename Vec>
+auto castVector(const std::vector<Vec> & from) -> std::vector<decltype(from[0].template cast<T2>())>
+{
+  std::vector<decltype(from[0].template cast<T2>())> to;
+  to.reserve(from.size());
+  for(const Vec & v : from)
+  {
+    to.push_back(v.template cast<T2>());
+  }
+  return to;
+}
+
+} // namespace detail
+
+template<typename T>
+template<typename T2>
+MultiBodyConfigT<T2> MultiBodyConfigT<T>::cast() const
+{
+  MultiBodyConfigT<T2> mbc;
+  detail::castParam(q, mbc.q);
+  detail::castParam(alpha, mbc.alpha);
+  detail::castParam(alphaD, mbc.alphaD);
+  detail::castParam(jointTorque, mbc.jointTorque);
+
+  mbc.force = detail::castVector<T2>(force);
+  mbc.jointConfig = detail::castVector<T2>(jointConfig);
+  mbc.jointVelocity = detail::castVector<T2>(jointVelocity);
+  mbc.bodyPosW = detail::castVector<T2>(bodyPosW);
+  mbc.parentToSon = detail::castVector<T2>(parentToSon);
+  mbc.bodyVelW = detail::castVector<T2>(bodyVelW);
+  mbc.bodyVelB = detail::castVector<T2>(bodyVelB);
+  mbc.bodyAccB = detail::castVector<T2>(bodyAccB);
+
+  mbc.motionSubspace.resize(motionSubspace.size());
+  for(std::size_t i = 0; i < motionSubspace.size(); ++i)
+  {
+    mbc.motionSubspace[i] = motionSubspace[i].template cast<T2>();
+  }
+  mbc.gravity = gravity.template cast<T2>();
+  mbc.stamps = stamps;
+  return mbc;
+}
+
 template<typename T>
 inline void ConfigConverter::convertJoint(const std::vector<T> & from, std::vector<T> & to) const
 {
   for(std::size_t i = 0; i < jInd_.size(); ++i)
   {
-    to[jInd_[i]] = from[i + 1];
+    to[jInd_[i]] = from[i + first_];
   }
 }
 
@@ -295,7 +540,7 @@ inline std::vector<T> ConfigConverter::convertJoint(const std::vector<T> & from)
   std::vector<T> to(from.size());
   for(std::size_t i = 0; i < jInd_.size(); ++i)
   {
-    to[jInd_[i]] = from[i + 1];
+    to[jInd_[i]] = from[i + first_];
   }
 
   return std::move(to);
@@ -126,6 +126,24 @@ public:
   /// @return Numbers of joints.
   std::size_t nrJoints() const;
 
+  /// @return Nodes of the graph in insertion order.
+  const std::vector<std::shared_ptr<Node>> & nodes() const
+  {
+    return nodes_;
+  }
+
+  /// @return Joints of the graph in insertion order.
+  const std::vector<std::shared_ptr<Joint>> & joints() const
+  {
+    return joints_;
+  }
+
+  /// @return Name of the root joint created by makeMultiBody.
+  const std::string & rootJointName() const
+  {
+    return rootJointName_;
+  }
+
   /**
    * Create a MultiBody from the graph.
    * @param rootBodyName Name of the root body.
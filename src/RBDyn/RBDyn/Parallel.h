@@ -0,0 +1,107 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rbd
+{
+
+/**
+ * Resolve the number of worker threads to use.
+ * @param nrThreads Requested number of threads, 0 (or less) means one thread
+ * per hardware thread.
+ * @return Number of threads, always at least 1.
+ */
+inline int resolveNrThreads(int nrThreads)
+{
+  if(nrThreads <= 0)
+  {
+    nrThreads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::max(nrThreads, 1);
+}
+
+/**
+ * Run f(thread, begin, end) over the range [0, size) on nrThreads workers.
+ * The range is cut in chunks of chunkSize elements that are dispatched
+ * dynamically, so unequal per element costs are balanced between workers.
+ * The worker 0 run on the calling thread and each worker always receive the
+ * same thread index, this allow to use per thread workspaces.
+ * If a worker throw, the remaining chunks are skipped and the first exception
+ * is rethrown on the calling thread.
+ * @param size Number of elements.
+ * @param nrThreads Number of workers (@see resolveNrThreads).
+ * @param chunkSize Number of elements processed by a worker in one call of f.
+ * @param f Functor with the signature void(int thread, int begin, int end).
+ */
+template<typename Functor>
+void parallelFor(int size, int nrThreads, int chunkSize, Functor && f)
+{
+  nrThreads = resolveNrThreads(nrThreads);
+  chunkSize = std::max(chunkSize, 1);
+  int nrChunks = (size + chunkSize - 1) / chunkSize;
+  nrThreads = std::min(nrThreads, std::max(nrChunks, 1));
+
+  if(nrThreads == 1)
+  {
+    for(int begin = 0; begin < size; begin += chunkSize)
+    {
+      f(0, begin, std::min(begin + chunkSize, size));
+    }
+    return;
+  }
+
+  std::atomic<int> nextChunk(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto worker = [&](int thread) {
+    try
+    {
+      int chunk;
+      while((chunk = nextChunk.fetch_add(1)) < nrChunks)
+      {
+        int begin = chunk * chunkSize;
+        f(thread, begin, std::min(begin + chunkSize, size));
+      }
+    }
+    catch(...)
+    {
+      nextChunk = nrChunks;
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if(!error)
+      {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(static_cast<std::size_t>(nrThreads - 1));
+  for(int t = 1; t < nrThreads; ++t)
+  {
+    threads.emplace_back(worker, t);
+  }
+  worker(0);
+  for(std::thread & t : threads)
+  {
+    t.join();
+  }
+
+  if(error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace rbd
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// RBDyn
+#include <rbdyn/config.hh>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+namespace rbd
+{
+class MultiBody;
+
+/**
+ * Reachability map of an end effector body.
+ * The workspace is discretized in a regular voxel grid, each voxel store
+ * a reachability value (number of samples that reached the voxel, saturated
+ * at 255) and the best manipulability (product of the jacobian singular values,
+ * Yoshikawa index) found in this voxel.
+ *
+ * The in memory representation is the same than the file representation,
+ * this allow to load a map by mapping the file in memory without any copy.
+ * File layout (native endianness):
+ *  - 64 bytes header (magic "RBDRMAP", version, grid size, origin, resolution,
+ *    number of voxels)
+ *  - nrVoxels uint8 reachability values, padded to a multiple of 4 bytes
+ *  - nrVoxels float manipulability values
+ * Voxel (x, y, z) is stored at index (x*sizeY + y)*sizeZ + z.
+ */
+class RBDYN_DLLAPI ReachabilityMap
+{
+public:
+  /// File format version.
+  static constexpr std::uint32_t VERSION = 1;
+
+public:
+  ReachabilityMap();
+
+  /**
+   * Create an empty map.
+   * @param lower Lower corner of the grid in world coordinate.
+   * @param upper Upper corner of the grid in world coordinate.
+   * @param resolution Voxel edge length.
+   * @throw std::domain_error If resolution is not strictly positive, upper < lower
+   * or the number of voxels doesn't fit in an int.
+   */
+  ReachabilityMap(const Eigen::Vector3d & lower, const Eigen::Vector3d & upper, double resolution);
+
+  /**
+   * Fill the map by sampling the configuration space.
+   * Each parameter of mbc.q is drawn uniformly in [qMin, qMax], quaternion
+   * parameters of Spherical and Free joints are normalized after drawing.
+   * Sampling is done on nrThreads workers, the result only depends on seed.
+   * @param mb MultiBody used has model.
+   * @param efIndex End effector body index.
+   * @param qMin Lower bound of each joint parameter (same layout than mbc.q).
+   * @param qMax Upper bound of each joint parameter (same layout than mbc.q).
+   * @param nrSamples Number of configurations to sample.
+   * @param nrThreads Number of worker threads, 0 means one per hardware thread.
+   * @param seed Random generator seed.
+   */
+  void sample(const MultiBody & mb,
+              int efIndex,
+              const std::vector<std::vector<double>> & qMin,
+              const std::vector<std::vector<double>> & qMax,
+              int nrSamples,
+              int nrThreads = 0,
+              unsigned int seed = 0);
+
+  /** safe version of @see sample.
+   * @throw std::domain_error If efIndex, qMin or qMax doesn't match mb.
+   */
+  void sSample(const MultiBody & mb,
+               int efIndex,
+               const std::vector<std::vector<double>> & qMin,
+               const std::vector<std::vector<double>> & qMax,
+               int nrSamples,
+               int nrThreads = 0,
+               unsigned int seed = 0);
+
+  /**
+   * Fill the map by solving the inverse kinematics at each voxel center.
+   * Reachability is 1 for the voxels where the IK has converged, 0 otherwise.
+   * @param mb MultiBody used has model.
+   * @param efIndex End effector body index.
+   * @param E_0_ef End effector target orientation.
+   * @param seed Initial generalized position of each IK problem (nrParams).
+   * @param nrThreads Number of worker threads, 0 means one per hardware thread.
+   */
+  void solve(const MultiBody & mb,
+             int efIndex,
+             const Eigen::Matrix3d & E_0_ef,
+             const Eigen::VectorXd & seed,
+             int nrThreads = 0);
+
+  /** safe version of @see solve.
+   * @throw std::domain_error If efIndex or seed doesn't match mb.
+   */
+  void sSolve(const MultiBody & mb,
+              int efIndex,
+              const Eigen::Matrix3d & E_0_ef,
+              const Eigen::VectorXd & seed,
+              int nrThreads = 0);
+
+  /**
+   * Write the map in a binary file.
+   * @throw std::runtime_error If the file can't be written.
+   */
+  void save(const std::string & path) const;
+
+  /**
+   * Load a map from a binary file.
+   * The file is mapped in memory when the platform allow it.
+   * @throw std::runtime_error If the file can't be read or is not a valid map.
+   */
+  static ReachabilityMap load(const std::string & path);
+
+  /**
+   * @return Index of the voxel that contains p, -1 if p is outside the grid
+   * or is not finite.
+   */
+  int index(const Eigen::Vector3d & p) const
+  {
+    Eigen::Vector3d v = (p - origin_) / resolution_;
+    // checked before the integer conversion that is undefined for NaN or
+    // out of range values
+    if(!v.allFinite() || (v.array() < 0.).any() || (v.array() >= size_.cast<double>().array()).any())
+    {
+      return -1;
+    }
+    int x = static_cast<int>(v.x());
+    int y = static_cast<int>(v.y());
+    int z = static_cast<int>(v.z());
+    return (x * size_.y() + y) * size_.z() + z;
+  }
+
+  /// @return Center of the voxel index in world coordinate.
+  Eigen::Vector3d center(int index) const;
+
+  /// @return Reachability of the voxel index.
+  std::uint8_t reachability(int index) const
+  {
+    return reachability_[index];
+  }
+
+  /// @return Reachability of the voxel that contains p, 0 if p is outside the grid.
+  std::uint8_t reachability(const Eigen::Vector3d & p) const
+  {
+    int i = index(p);
+    return i < 0 ? std::uint8_t(0) : reachability_[i];
+  }
+
+  /// @return Manipulability of the voxel index.
+  float manipulability(int index) const
+  {
+    return manipulability_[index];
+  }
+
+  /// @return Manipulability of the voxel that contains p, 0 if p is outside the grid.
+  float manipulability(const Eigen::Vector3d & p) const
+  {
+    int i = index(p);
+    return i < 0 ? 0.f : manipulability_[i];
+  }
+
+  /// @return Number of voxels along each axis.
+  const Eigen::Vector3i & size() const
+  {
+    return size_;
+  }
+
+  /// @return Number of voxels.
+  int nrVoxels() const
+  {
+    return size_.prod();
+  }
+
+  /// @return Lower corner of the grid.
+  const Eigen::Vector3d & origin() const
+  {
+    return origin_;
+  }
+
+  /// @return Voxel edge length.
+  double resolution() const
+  {
+    return resolution_;
+  }
+
+private:
+  std::shared_ptr<unsigned char> allocate() const;
+  void attach(std::shared_ptr<const unsigned char> data, std::size_t dataSize);
+
+private:
+  Eigen::Vector3i size_;
+  Eigen::Vector3d origin_;
+  double resolution_;
+
+  std::shared_ptr<const unsigned char> data_;
+  std::size_t dataSize_;
+  const std::uint8_t * reachability_;
+  const float * manipulability_;
+};
+
+} // namespace rbd
@@ -0,0 +1,476 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// associated header
+#include "RBDyn/ReachabilityMap.h"
+
+// includes
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+// POSIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// RBDyn
+#include "RBDyn/FK.h"
+#include "RBDyn/FV.h"
+#include "RBDyn/IK.h"
+#include "RBDyn/Jacobian.h"
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/MultiBodyConfig.h"
+#include "RBDyn/Parallel.h"
+
+namespace rbd
+{
+
+namespace
+{
+
+const char MAGIC[8] = {'R', 'B', 'D', 'R', 'M', 'A', 'P', '\0'};
+
+struct Header
+{
+  char magic[8];
+  std::uint32_t version;
+  std::int32_t size[3];
+  double origin[3];
+  double resolution;
+  std::uint64_t nrVoxels;
+};
+static_assert(sizeof(Header) == 64, "ReachabilityMap header must be 64 bytes long");
+
+std::size_t manipulabilityOffset(std::size_t nrVoxels)
+{
+  return sizeof(Header) + ((nrVoxels + 3) / 4) * 4;
+}
+
+std::size_t dataSize(std::size_t nrVoxels)
+{
+  return manipulabilityOffset(nrVoxels) + nrVoxels * sizeof(float);
+}
+
+/// Voxel reached by a sample and manipulability of the sample.
+struct Hit
+{
+  std::size_t voxel;
+  float manipulability;
+};
+
+/// Number of hits stored by a worker before merging them in the map.
+const std::size_t MAX_HITS = 4096;
+
+/// Per worker data used to evaluate the end effector pose and manipulability.
+struct Workspace
+{
+  Workspace(const MultiBody & mb, int efIndex) : mbc(mb), jac(mb, mb.body(efIndex).name()), svd(6, jac.dof()), hits()
+  {
+    mbc.zero(mb);
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+  }
+
+  /// Compute the manipulability of the current configuration, FK must have been called.
+  float computeManipulability(const MultiBody & mb)
+  {
+    svd.compute(jac.jacobian(mb, mbc));
+    return static_cast<float>(svd.singularValues().prod());
+  }
+
+  MultiBodyConfig mbc;
+  Jacobian jac;
+  Eigen::JacobiSVD<Eigen::MatrixXd> svd;
+
+  std::vector<Hit> hits;
+};
+
+void checkLimits(const MultiBody & mb, const std::vector<std::vector<double>> & q, const std::string & name)
+{
+  if(static_cast<int>(q.size()) != mb.nrJoints())
+  {
+    std::ostringstream str;
+    str << name << " size mismatch: expected " << mb.nrJoints() << " gived " << q.size();
+    throw std::domain_error(str.str());
+  }
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    if(static_cast<int>(q[i].size()) != mb.joint(i).params())
+    {
+      std::ostringstream str;
+      str << name << "[" << i << "] size mismatch: expected " << mb.joint(i).params() << " gived " << q[i].size();
+      throw std::domain_error(str.str());
+    }
+  }
+}
+
+void checkEfIndex(const MultiBody & mb, int efIndex)
+{
+  if(efIndex < 0 || efIndex >= mb.nrBodies())
+  {
+    std::ostringstream str;
+    str << "efIndex out of range: expected [0, " << mb.nrBodies() << ") gived " << efIndex;
+    throw std::domain_error(str.str());
+  }
+}
+
+} // namespace
+
+ReachabilityMap::ReachabilityMap()
+: size_(Eigen::Vector3i::Zero()), origin_(Eigen::Vector3d::Zero()), resolution_(1.), data_(), dataSize_(0),
+  reachability_(nullptr), manipulability_(nullptr)
+{
+  auto data = allocate();
+  attach(data, dataSize(0));
+}
+
+ReachabilityMap::ReachabilityMap(const Eigen::Vector3d & lower, const Eigen::Vector3d & upper, double resolution)
+: size_(Eigen::Vector3i::Zero()), origin_(lower), resolution_(resolution), data_(), dataSize_(0),
+  reachability_(nullptr), manipulability_(nullptr)
+{
+  if(resolution <= 0.)
+  {
+    std::ostringstream str;
+    str << "resolution must be strictly positive, gived " << resolution;
+    throw std::domain_error(str.str());
+  }
+  if(((upper - lower).array() < 0.).any())
+  {
+    throw std::domain_error("upper must be greater than lower");
+  }
+
+  // voxels are indexed by int, the count is computed in 64 bits to detect the overflow
+  std::int64_t nrV = 1;
+  for(int i = 0; i < 3; ++i)
+  {
+    double n = std::max(std::ceil((upper[i] - lower[i]) / resolution), 1.);
+    if(!(n <= static_cast<double>(std::numeric_limits<int>::max())))
+    {
+      std::ostringstream str;
+      str << "too many voxels along axis " << i << ": " << n;
+      throw std::domain_error(str.str());
+    }
+    size_[i] = static_cast<int>(n);
+    nrV *= size_[i];
+    if(nrV > std::numeric_limits<int>::max())
+    {
+      std::ostringstream str;
+      str << "too many voxels: expected at most " << std::numeric_limits<int>::max() << " gived " << nrV
+          << " for the first " << i + 1 << " axis";
+      throw std::domain_error(str.str());
+    }
+  }
+  auto data = allocate();
+  attach(data, dataSize(static_cast<std::size_t>(nrVoxels())));
+}
+
+void ReachabilityMap::sample(const MultiBody & mb,
+                             int efIndex,
+                             const std::vector<std::vector<double>> & qMin,
+                             const std::vector<std::vector<double>> & qMax,
+                             int nrSamples,
+                             int nrThreads,
+                             unsigned int seed)
+{
+  const std::size_t nrV = static_cast<std::size_t>(nrVoxels());
+  // samples are dispatched by chunk, each chunk having its own random generator
+  // this make the result independent of the threads scheduling
+  const int chunkSize = 256;
+
+  auto data = allocate();
+  std::uint8_t * reach = data.get() + sizeof(Header);
+  float * manip = reinterpret_cast<float *>(data.get() + manipulabilityOffset(nrV));
+
+  // the workers store their hits and merge them in the map by batch, so the
+  // memory used by a worker doesn't depend on the grid size, saturated count
+  // and max are independent of the merge order
+  std::mutex mergeMutex;
+  auto merge = [&](std::vector<Hit> & hits) {
+    std::lock_guard<std::mutex> lock(mergeMutex);
+    for(const Hit & h : hits)
+    {
+      if(reach[h.voxel] < 255)
+      {
+        ++reach[h.voxel];
+      }
+      manip[h.voxel] = std::max(manip[h.voxel], h.manipulability);
+    }
+    hits.clear();
+  };
+
+  nrThreads = resolveNrThreads(nrThreads);
+  std::vector<Workspace> workspaces;
+  workspaces.reserve(static_cast<std::size_t>(nrThreads));
+  for(int i = 0; i < nrThreads; ++i)
+  {
+    workspaces.emplace_back(mb, efIndex);
+    workspaces.back().hits.reserve(MAX_HITS);
+  }
+
+  parallelFor(nrSamples, nrThreads, chunkSize, [&](int thread, int begin, int end) {
+    Workspace & ws = workspaces[static_cast<std::size_t>(thread)];
+    std::mt19937 gen(seed + static_cast<unsigned int>(begin / chunkSize));
+    std::uniform_real_distribution<double> dist(0., 1.);
+    for(int s = begin; s < end; ++s)
+    {
+      for(int i = 0; i < mb.nrJoints(); ++i)
+      {
+        std::vector<double> & qi = ws.mbc.q[i];
+        for(std::size_t j = 0; j < qi.size(); ++j)
+        {
+          qi[j] = qMin[i][j] + dist(gen) * (qMax[i][j] - qMin[i][j]);
+        }
+        if(mb.joint(i).type() == Joint::Spherical || mb.joint(i).type() == Joint::Free)
+        {
+          Eigen::Map<Eigen::Vector4d> quat(qi.data());
+          double n = quat.norm();
+          if(n > 0.)
+          {
+            quat /= n;
+          }
+          else
+          {
+            quat << 1., 0., 0., 0.;
+          }
+        }
+      }
+      forwardKinematics(mb, ws.mbc);
+
+      int v = index(ws.mbc.bodyPosW[static_cast<std::size_t>(efIndex)].translation());
+      if(v >= 0)
+      {
+        ws.hits.push_back({static_cast<std::size_t>(v), ws.computeManipulability(mb)});
+        if(ws.hits.size() == MAX_HITS)
+        {
+          merge(ws.hits);
+        }
+      }
+    }
+  });
+
+  for(Workspace & ws : workspaces)
+  {
+    merge(ws.hits);
+  }
+  attach(data, dataSize(nrV));
+}
+
+void ReachabilityMap::sSample(const MultiBody & mb,
+                              int efIndex,
+                              const std::vector<std::vector<double>> & qMin,
+                              const std::vector<std::vector<double>> & qMax,
+                              int nrSamples,
+                              int nrThreads,
+                              unsigned int seed)
+{
+  checkEfIndex(mb, efIndex);
+  checkLimits(mb, qMin, "qMin");
+  checkLimits(mb, qMax, "qMax");
+
+  sample(mb, efIndex, qMin, qMax, nrSamples, nrThreads, seed);
+}
+
+void ReachabilityMap::solve(const MultiBody & mb,
+                            int efIndex,
+                            const Eigen::Matrix3d & E_0_ef,
+                            const Eigen::VectorXd & seed,
+                            int nrThreads)
+{
+  const int nrV = nrVoxels();
+
+  std::vector<sva::PTransformd> targets;
+  targets.reserve(static_cast<std::size_t>(nrV));
+  for(int v = 0; v < nrV; ++v)
+  {
+    targets.emplace_back(E_0_ef, center(v));
+  }
+
+  BatchInverseKinematics ik(mb, efIndex, nrThreads);
+  ik.inverseKinematics(mb, targets, seed);
+
+  std::vector<Workspace> workspaces;
+  workspaces.reserve(static_cast<std::size_t>(ik.nrThreads()));
+  for(int i = 0; i < ik.nrThreads(); ++i)
+  {
+    workspaces.emplace_back(mb, efIndex);
+  }
+
+  auto data = allocate();
+  std::uint8_t * reach = data.get() + sizeof(Header);
+  float * manip = reinterpret_cast<float *>(data.get() + manipulabilityOffset(static_cast<std::size_t>(nrV)));
+  parallelFor(nrV, ik.nrThreads(), ik.chunk_size_, [&](int thread, int begin, int end) {
+    Workspace & ws = workspaces[static_cast<std::size_t>(thread)];
+    for(int v = begin; v < end; ++v)
+    {
+      if(ik.converged()(v))
+      {
+        vectorToParam(ik.q().col(v), ws.mbc.q);
+        forwardKinematics(mb, ws.mbc);
+        reach[v] = 1;
+        manip[v] = ws.computeManipulability(mb);
+      }
+    }
+  });
+  attach(data, dataSize(static_cast<std::size_t>(nrV)));
+}
+
+void ReachabilityMap::sSolve(const MultiBody & mb,
+                             int efIndex,
+                             const Eigen::Matrix3d & E_0_ef,
+                             const Eigen::VectorXd & seed,
+                             int nrThreads)
+{
+  checkEfIndex(mb, efIndex);
+  if(seed.size() != mb.nrParams())
+  {
+    std::ostringstream str;
+    str << "seed size mismatch: expected " << mb.nrParams() << " gived " << seed.size();
+    throw std::domain_error(str.str());
+  }
+
+  solve(mb, efIndex, E_0_ef, seed, nrThreads);
+}
+
+void ReachabilityMap::save(const std::string & path) const
+{
+  std::ofstream ofs(path, std::ios::binary);
+  if(!ofs)
+  {
+    throw std::runtime_error("Can't open " + path + " for writing");
+  }
+  ofs.write(reinterpret_cast<const char *>(data_.get()), static_cast<std::streamsize>(dataSize_));
+  if(!ofs)
+  {
+    throw std::runtime_error("Failed to write " + path);
+  }
+}
+
+ReachabilityMap ReachabilityMap::load(const std::string & path)
+{
+  std::shared_ptr<const unsigned char> data;
+  std::size_t size = 0;
+
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd < 0)
+  {
+    throw std::runtime_error("Can't open " + path);
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("Can't stat " + path);
+  }
+  size = static_cast<std::size_t>(st.st_size);
+  void * ptr = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+  close(fd);
+  if(ptr == MAP_FAILED)
+  {
+    throw std::runtime_error("Can't map " + path);
+  }
+  data.reset(static_cast<const unsigned char *>(ptr),
+             [size](const unsigned char * p) { munmap(const_cast<unsigned char *>(p), size); });
+#else
+  std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+  if(!ifs)
+  {
+    throw std::runtime_error("Can't open " + path);
+  }
+  size = static_cast<std::size_t>(ifs.tellg());
+  std::shared_ptr<unsigned char> buffer(new unsigned char[size], std::default_delete<unsigned char[]>());
+  ifs.seekg(0);
+  ifs.read(reinterpret_cast<char *>(buffer.get()), static_cast<std::streamsize>(size));
+  if(!ifs)
+  {
+    throw std::runtime_error("Failed to read " + path);
+  }
+  data = buffer;
+#endif
+
+  if(size < sizeof(Header))
+  {
+    throw std::runtime_error(path + " is not a reachability map");
+  }
+  Header header;
+  std::memcpy(&header, data.get(), sizeof(Header));
+  if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    throw std::runtime_error(path + " is not a reachability map");
+  }
+  if(header.version != VERSION)
+  {
+    std::ostringstream str;
+    str << path << " version mismatch: expected " << VERSION << " gived " << header.version;
+    throw std::runtime_error(str.str());
+  }
+  if((header.size[0] <= 0 || header.size[1] <= 0 || header.size[2] <= 0)
+     || header.nrVoxels > static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+     || header.nrVoxels
+            != static_cast<std::uint64_t>(header.size[0]) * static_cast<std::uint64_t>(header.size[1])
+                * static_cast<std::uint64_t>(header.size[2])
+     || size != dataSize(static_cast<std::size_t>(header.nrVoxels)))
+  {
+    throw std::runtime_error(path + " is truncated or corrupted");
+  }
+
+  ReachabilityMap map;
+  map.size_ << header.size[0], header.size[1], header.size[2];
+  map.origin_ << header.origin[0], header.origin[1], header.origin[2];
+  map.resolution_ = header.resolution;
+  map.attach(data, size);
+  return map;
+}
+
+Eigen::Vector3d ReachabilityMap::center(int index) const
+{
+  int z = index % size_.z();
+  int y = (index / size_.z()) % size_.y();
+  int x = index / (size_.z() * size_.y());
+  return origin_ + resolution_ * (Eigen::Vector3d(x, y, z) + Eigen::Vector3d::Constant(0.5));
+}
+
+std::shared_ptr<unsigned char> ReachabilityMap::allocate() const
+{
+  const std::size_t nrV = static_cast<std::size_t>(nrVoxels());
+  const std::size_t size = dataSize(nrV);
+  std::shared_ptr<unsigned char> data(new unsigned char[size], std::default_delete<unsigned char[]>());
+  std::memset(data.get(), 0, size);
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  for(int i = 0; i < 3; ++i)
+  {
+    header.size[i] = size_[i];
+    header.origin[i] = origin_[i];
+  }
+  header.resolution = resolution_;
+  header.nrVoxels = nrV;
+  std::memcpy(data.get(), &header, sizeof(Header));
+
+  return data;
+}
+
+void ReachabilityMap::attach(std::shared_ptr<const unsigned char> data, std::size_t dataSize)
+{
+  data_ = std::move(data);
+  dataSize_ = dataSize;
+  reachability_ = data_.get() + sizeof(Header);
+  manipulability_ = reinterpret_cast<const float *>(data_.get() + manipulabilityOffset(static_cast<std::size_t>(nrVoxels())));
+}
+
+} // namespace rbd
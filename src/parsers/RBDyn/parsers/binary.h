@@ -0,0 +1,66 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include <RBDyn/parsers/common.h>
+
+#include <string>
+#include <vector>
+
+namespace rbd
+{
+
+namespace parsers
+{
+
+//! \brief Serialize a ParserResult in the RBDyn binary format
+//!
+//! The format is versioned and stores the MultiBodyGraph, the MultiBody (with its operational frames), the
+//! MultiBodyConfig inputs, the limits, the visuals and the collisions. Loading it requires no text parsing.
+//!
+//! \param res Result to serialize
+//! \return std::string Binary content
+RBDYN_PARSERS_DLLAPI std::string to_binary(const ParserResult & res);
+
+//! \brief Write a ParserResult in a binary file
+//!
+//! \throw std::runtime_error If the file can't be written
+RBDYN_PARSERS_DLLAPI void to_binary_file(const ParserResult & res, const std::string & file_path);
+
+//! \brief Load a ParserResult from a binary content created by to_binary
+//!
+//! The forward kinematics and velocity of the configuration are recomputed from its inputs.
+//!
+//! \throw std::runtime_error If the content is not a valid binary model or has a different version
+RBDYN_PARSERS_DLLAPI ParserResult from_binary(const std::string & content);
+
+//! \brief Load a ParserResult from a binary file created by to_binary_file
+//!
+//! The file is mapped in memory when the platform allow it.
+//!
+//! \throw std::runtime_error If the file can't be read, is not a valid binary model or has a different version
+RBDYN_PARSERS_DLLAPI ParserResult from_binary_file(const std::string & file_path);
+
+//! \brief Same as from_file but keep a binary copy of the result in cache_dir
+//!
+//! The cache entry is keyed by a hash of the source file content and of the parsing parameters, so a modified source
+//! is parsed again. When a valid entry exists the URDF or YAML file is not parsed at all. The cache is best effort:
+//! an entry that can't be written (e.g. cache_dir doesn't exist) is silently skipped.
+//!
+//! \param file_path Path to the URDF or YAML file to parse
+//! \param cache_dir Existing directory where the binary files are stored
+//! \return ParserResult The parsing result
+RBDYN_PARSERS_DLLAPI ParserResult from_file_cached(const std::string & file_path,
+                                                   const std::string & cache_dir,
+                                                   bool fixed = true,
+                                                   const std::vector<std::string> & filtered_links = {},
+                                                   bool transform_inertia = true,
+                                                   const std::string & base_link = "",
+                                                   bool with_virtual_links = true,
+                                                   const std::string & spherical_suffix = "_spherical");
+
+} // namespace parsers
+
+} // namespace rbd
@@ -15,6 +15,7 @@
 #include <boost/variant.hpp>
 
 #include <Eigen/Core>
+#include <functional>
 #include <string>
 
 namespace rbd
@@ -29,6 +30,15 @@ enum class RBDYN_PARSERS_DLLAPI ParserInput
   Description
 };
 
+//! \brief When the visuals and collisions are parsed
+enum class RBDYN_PARSERS_DLLAPI GeometryLoading
+{
+  //! With the kinematic and dynamic data
+  Eager,
+  //! At the first access with ParserResult::visuals, ParserResult::collisions or ParserResult::load_geometry
+  Deferred
+};
+
 struct RBDYN_PARSERS_DLLAPI Limits
 {
 public:
@@ -104,17 +114,52 @@ struct RBDYN_PARSERS_DLLAPI Visual
 
 struct RBDYN_PARSERS_DLLAPI ParserResult
 {
+  using VisualMap = std::map<std::string, std::vector<Visual>>;
+
   rbd::MultiBody mb;
   rbd::MultiBodyConfig mbc;
   rbd::MultiBodyGraph mbg;
   Limits limits;
-  std::map<std::string, std::vector<Visual>> visual;
-  std::map<std::string, std::vector<Visual>> collision;
+  //! Visuals by link name, empty until load_geometry is called when the geometry is deferred
+  VisualMap visual;
+  //! Collisions by link name, empty until load_geometry is called when the geometry is deferred
+  VisualMap collision;
   std::string name;
+
+  //! Parse the visuals and collisions of a result loaded with GeometryLoading::Deferred, set when they are not
+  //! loaded yet
+  std::function<void(VisualMap & visual, VisualMap & collision)> geometry_loader;
+
+  //! \brief Parse the deferred visuals and collisions, do nothing if they are already loaded
+  //!
+  //! This is not thread safe, load the geometry before sharing a deferred result between threads.
+  void load_geometry();
+
+  //! \return true if the visuals and collisions are not loaded yet
+  bool geometry_deferred() const
+  {
+    return static_cast<bool>(geometry_loader);
+  }
+
+  //! \return Visuals by link name, loaded at the first call when deferred
+  const VisualMap & visuals()
+  {
+    load_geometry();
+    return visual;
+  }
+
+  //! \return Collisions by link name, loaded at the first call when deferred
+  const VisualMap & collisions()
+  {
+    load_geometry();
+    return collision;
+  }
 };
 
 //! \brief Checks the file extension and parses it as URDF or YAML accordingly
 //!
+//! Files with the rbdbin extension are loaded with from_binary_file, the parsing parameters are then ignored.
+//!
 //! \param file_path Path to the file to parse
 //! \return ParserResult The parsing result
 RBDYN_PARSERS_DLLAPI ParserResult from_file(const std::string & file_path,
@@ -123,7 +168,50 @@ RBDYN_PARSERS_DLLAPI ParserResult from_file(const std::string & file_path,
                                             bool transform_inertia = true,
                                             const std::string & base_link = "",
                                             bool with_virtual_links = true,
-                                            const std::string spherical_suffix = "_spherical");
+                                            const std::string spherical_suffix = "_spherical",
+                                            GeometryLoading geometry = GeometryLoading::Eager);
+
+//! \brief Parse several files in parallel with from_file
+//!
+//! \param file_paths Paths to the files to parse
+//! \param nr_threads Number of threads, 0 use one thread per hardware thread
+//! \return std::vector<ParserResult> The parsing results in the file_paths order
+//! \throw The first exception thrown by from_file
+RBDYN_PARSERS_DLLAPI std::vector<ParserResult> from_files(const std::vector<std::string> & file_paths,
+                                                          int nr_threads = 0,
+                                                          bool fixed = true,
+                                                          const std::vector<std::string> & filtered_links = {},
+                                                          bool transform_inertia = true,
+                                                          const std::string & base_link = "",
+                                                          bool with_virtual_links = true,
+                                                          const std::string & spherical_suffix = "_spherical",
+                                                          GeometryLoading geometry = GeometryLoading::Eager);
+
+//! \brief Checks the file extension and writes the robot as URDF, YAML or binary accordingly
+//!
+//! \param res Robot to write
+//! \param file_path Path to the file to write, with an urdf, yaml, yml or rbdbin extension
+//! \throw std::runtime_error If the extension is unknown or the file can't be written
+RBDYN_PARSERS_DLLAPI void to_file(const ParserResult & res, const std::string & file_path);
+
+//! \brief Write variants of a robot in parallel with to_file
+//!
+//! Each variant is a copy of res modified by perturb, for example to randomize the bodies mass and inertia
+//! (MultiBody::body). perturb and file_path are called concurrently from several threads, a perturbation should
+//! seed its random generator with the variant index to be reproducible.
+//! Deferred geometry is loaded once before writing the variants.
+//!
+//! \param res Nominal robot
+//! \param nr_variants Number of variants to write
+//! \param perturb Modify the copy of res of a variant, called with the variant index
+//! \param file_path Return the path of the file of a variant
+//! \param nr_threads Number of threads, 0 use one thread per hardware thread
+//! \throw The first exception thrown by perturb, file_path or to_file
+RBDYN_PARSERS_DLLAPI void to_file_variants(const ParserResult & res,
+                                           int nr_variants,
+                                           const std::function<void(int variant, ParserResult & res)> & perturb,
+                                           const std::function<std::string(int variant)> & file_path,
+                                           int nr_threads = 0);
 
 } // namespace parsers
 
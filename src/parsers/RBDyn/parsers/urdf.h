@@ -15,6 +15,7 @@
 #include <boost/variant.hpp>
 
 #include <Eigen/Core>
+#include <ostream>
 #include <string>
 
 namespace tinyxml2
@@ -49,7 +50,8 @@ RBDYN_PARSERS_DLLAPI std::string parseMultiBodyGraphFromURDF(ParserResult & res,
                                                              bool transformInertia = true,
                                                              const std::string & baseLinkIn = "",
                                                              bool withVirtualLinks = true,
-                                                             const std::string & sphericalSuffix = "_spherical");
+                                                             const std::string & sphericalSuffix = "_spherical",
+                                                             GeometryLoading geometry = GeometryLoading::Eager);
 
 RBDYN_PARSERS_DLLAPI ParserResult from_urdf(const std::string & content,
                                             bool fixed = true,
@@ -57,7 +59,8 @@ RBDYN_PARSERS_DLLAPI ParserResult from_urdf(const std::string & content,
                                             bool transformInertia = true,
                                             const std::string & baseLinkIn = "",
                                             bool withVirtualLinks = true,
-                                            const std::string & sphericalSuffix = "_spherical");
+                                            const std::string & sphericalSuffix = "_spherical",
+                                            GeometryLoading geometry = GeometryLoading::Eager);
 
 RBDYN_PARSERS_DLLAPI ParserResult from_urdf_file(const std::string & file_path,
                                                  bool fixed = true,
@@ -65,10 +68,24 @@ RBDYN_PARSERS_DLLAPI ParserResult from_urdf_file(const std::string & file_path,
                                                  bool transformInertia = true,
                                                  const std::string & baseLinkIn = "",
                                                  bool withVirtualLinks = true,
-                                                 const std::string & sphericalSuffix = "_spherical");
+                                                 const std::string & sphericalSuffix = "_spherical",
+                                                 GeometryLoading geometry = GeometryLoading::Eager);
 
+//! \brief Write a ParserResult as a URDF document
+//!
+//! \return std::string URDF content
 RBDYN_PARSERS_DLLAPI std::string to_urdf(const ParserResult & res);
 
+//! \brief Write a ParserResult as a URDF document directly to a stream
+//!
+//! The document is written by blocks as it is generated, without intermediate document, and the numbers are
+//! written in the C locale with the shortest representation that is read back to the same value.
+//!
+//! \param res Robot to write
+//! \param out Output stream, a part of the document can be written if an exception is thrown
+//! \throw std::invalid_argument If a joint type is not supported by the format
+RBDYN_PARSERS_DLLAPI void to_urdf(const ParserResult & res, std::ostream & out);
+
 } // namespace parsers
 
 } // namespace rbd
@@ -9,6 +9,10 @@
 #include <RBDyn/MultiBodyGraph.h>
 #include <RBDyn/parsers/common.h>
 
+#include <memory>
+#include <ostream>
+#include <utility>
+
 namespace YAML
 {
 class Node;
@@ -30,7 +34,8 @@ public:
                 bool transform_inertia = true,
                 const std::string & base_link = "",
                 bool with_virtual_links = true,
-                const std::string & spherical_suffix = "_spherical");
+                const std::string & spherical_suffix = "_spherical",
+                GeometryLoading geometry = GeometryLoading::Eager);
 
   ParserResult & result()
   {
@@ -42,6 +47,13 @@ public:
     return std::tie(res.mb, res.mbc, res.mbg);
   }
 
+private:
+  /// Parser of the deferred geometry.
+  RBDynFromYAML(bool angles_in_degrees);
+
+  /// Event handler of the streaming parser.
+  class StreamHandler;
+
 private:
   ParserResult res;
   bool verbose_;
@@ -54,6 +66,9 @@ private:
   std::vector<std::string> filtered_links_;
   bool with_virtual_links_;
   const std::string & spherical_suffix_;
+  GeometryLoading geometry_;
+  /// Name and node of the links whose geometry is deferred, the nodes keep the document alive.
+  std::shared_ptr<std::vector<std::pair<std::string, YAML::Node>>> deferred_links_;
 
   Eigen::Matrix3d makeInertia(double ixx, double iyy, double izz, double iyz, double ixz, double ixy);
 
@@ -90,6 +105,8 @@ private:
                         const rbd::Joint & joint,
                         bool is_continuous);
 
+  void parseJointDynamics(const YAML::Node & dynamics, rbd::Joint & joint);
+
   void parseJoint(const YAML::Node & joint);
 };
 
@@ -99,7 +116,8 @@ RBDYN_PARSERS_DLLAPI ParserResult from_yaml(const std::string & content,
                                             bool transformInertia = true,
                                             const std::string & baseLinkIn = "",
                                             bool withVirtualLinks = true,
-                                            const std::string & sphericalSuffix = "_spherical");
+                                            const std::string & sphericalSuffix = "_spherical",
+                                            GeometryLoading geometry = GeometryLoading::Eager);
 
 RBDYN_PARSERS_DLLAPI ParserResult from_yaml_file(const std::string & file_path,
                                                  bool fixed = true,
@@ -107,10 +125,24 @@ RBDYN_PARSERS_DLLAPI ParserResult from_yaml_file(const std::string & file_path,
                                                  bool transformInertia = true,
                                                  const std::string & baseLinkIn = "",
                                                  bool withVirtualLinks = true,
-                                                 const std::string & sphericalSuffix = "_spherical");
+                                                 const std::string & sphericalSuffix = "_spherical",
+                                                 GeometryLoading geometry = GeometryLoading::Eager);
 
+//! \brief Write a ParserResult as a YAML document
+//!
+//! \return std::string YAML content
 RBDYN_PARSERS_DLLAPI std::string to_yaml(const ParserResult & res);
 
+//! \brief Write a ParserResult as a YAML document directly to a stream
+//!
+//! The document is written by blocks as it is generated, without intermediate document, and the numbers are
+//! written in the C locale with the shortest representation that is read back to the same value.
+//!
+//! \param res Robot to write
+//! \param out Output stream, a part of the document can be written if an exception is thrown
+//! \throw std::invalid_argument If a joint type is not supported by the format
+RBDYN_PARSERS_DLLAPI void to_yaml(const ParserResult & res, std::ostream & out);
+
 } // namespace parsers
 
 } // namespace rbd
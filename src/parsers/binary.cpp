@@ -0,0 +1,897 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#include <RBDyn/FK.h>
+#include <RBDyn/FV.h>
+#include <RBDyn/parsers/binary.h>
+#include <RBDyn/parsers/urdf.h>
+#include <RBDyn/parsers/yaml.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+// POSIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace rbd
+{
+
+namespace parsers
+{
+
+namespace
+{
+
+const char MAGIC[8] = {'R', 'B', 'D', 'M', 'O', 'D', 'E', 'L'};
+const std::uint32_t VERSION = 1;
+// must be incremented when the parsers give a different result for the same source file,
+// it is part of the from_file_cached key so the entries created by an older parser are never used
+const std::uint32_t PARSER_VERSION = 1;
+// written in native byte order, a file created on a machine with a different endianness is rejected
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct Header
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+  std::uint64_t key;
+  std::uint64_t payloadSize;
+};
+static_assert(sizeof(Header) == 32, "binary model header must be 32 bytes long");
+
+/// Append the binary representation of the model elements to a buffer.
+class Writer
+{
+public:
+  void u8(std::uint8_t v)
+  {
+    buf.push_back(static_cast<char>(v));
+  }
+
+  void u32(std::uint32_t v)
+  {
+    raw(&v, sizeof(v));
+  }
+
+  void size(std::size_t v)
+  {
+    u32(static_cast<std::uint32_t>(v));
+  }
+
+  void i32(int v)
+  {
+    std::int32_t i = v;
+    raw(&i, sizeof(i));
+  }
+
+  void f64(double v)
+  {
+    raw(&v, sizeof(v));
+  }
+
+  void str(const std::string & s)
+  {
+    size(s.size());
+    buf.append(s);
+  }
+
+  void vec(const std::vector<double> & v)
+  {
+    size(v.size());
+    raw(v.data(), v.size() * sizeof(double));
+  }
+
+  template<typename Derived>
+  void mat(const Eigen::MatrixBase<Derived> & m)
+  {
+    for(Eigen::Index c = 0; c < m.cols(); ++c)
+    {
+      for(Eigen::Index r = 0; r < m.rows(); ++r)
+      {
+        f64(m(r, c));
+      }
+    }
+  }
+
+  void transform(const sva::PTransformd & X)
+  {
+    mat(X.rotation());
+    mat(X.translation());
+  }
+
+  void body(const Body & b)
+  {
+    str(b.name());
+    f64(b.inertia().mass());
+    mat(b.inertia().momentum());
+    mat(b.inertia().inertia());
+  }
+
+  void joint(const Joint & j)
+  {
+    str(j.name());
+    u8(static_cast<std::uint8_t>(j.type()));
+    u8(j.forward() ? 1 : 0);
+    // the motion subspace is stored with the direction applied
+    const auto & S = j.motionSubspace();
+    Eigen::Vector3d axis = Eigen::Vector3d::UnitZ();
+    switch(j.type())
+    {
+      case Joint::Rev:
+      case Joint::Cylindrical:
+        axis = j.direction() * S.col(0).head<3>();
+        break;
+      case Joint::Prism:
+        axis = j.direction() * S.col(0).tail<3>();
+        break;
+      default:
+        break;
+    }
+    mat(axis);
+    u8(j.isMimic() ? 1 : 0);
+    str(j.mimicName());
+    f64(j.mimicMultiplier());
+    f64(j.mimicOffset());
+    f64(j.rotorInertia());
+    f64(j.gearRatio());
+    f64(j.damping());
+    f64(j.friction());
+  }
+
+  void geometry(const Geometry & g)
+  {
+    u8(static_cast<std::uint8_t>(g.type));
+    switch(g.type)
+    {
+      case Geometry::BOX:
+        mat(boost::get<Geometry::Box>(g.data).size);
+        break;
+      case Geometry::CYLINDER:
+      {
+        const auto & c = boost::get<Geometry::Cylinder>(g.data);
+        f64(c.radius);
+        f64(c.length);
+        break;
+      }
+      case Geometry::SPHERE:
+        f64(boost::get<Geometry::Sphere>(g.data).radius);
+        break;
+      case Geometry::MESH:
+      {
+        const auto & m = boost::get<Geometry::Mesh>(g.data);
+        str(m.filename);
+        f64(m.scale);
+        break;
+      }
+      case Geometry::SUPERELLIPSOID:
+      {
+        const auto & se = boost::get<Geometry::Superellipsoid>(g.data);
+        mat(se.size);
+        f64(se.epsilon1);
+        f64(se.epsilon2);
+        break;
+      }
+      case Geometry::UNKNOWN:
+        break;
+    }
+  }
+
+  void visuals(const std::map<std::string, std::vector<Visual>> & visuals)
+  {
+    size(visuals.size());
+    for(const auto & v : visuals)
+    {
+      str(v.first);
+      size(v.second.size());
+      for(const Visual & visual : v.second)
+      {
+        str(visual.name);
+        transform(visual.origin);
+        geometry(visual.geometry);
+      }
+    }
+  }
+
+  void limits(const std::map<std::string, std::vector<double>> & limits)
+  {
+    size(limits.size());
+    for(const auto & l : limits)
+    {
+      str(l.first);
+      vec(l.second);
+    }
+  }
+
+  std::string buf;
+
+private:
+  void raw(const void * data, std::size_t size)
+  {
+    buf.append(static_cast<const char *>(data), size);
+  }
+};
+
+/// Decode the model elements from a memory buffer, all the reads are bounds checked.
+class Reader
+{
+public:
+  Reader(const char * data, std::size_t size) : cur_(data), end_(data + size) {}
+
+  std::uint8_t u8()
+  {
+    std::uint8_t v;
+    raw(&v, sizeof(v));
+    return v;
+  }
+
+  std::uint32_t u32()
+  {
+    std::uint32_t v;
+    raw(&v, sizeof(v));
+    return v;
+  }
+
+  /// Read a number of elements of at least minElemSize bytes (protect against corrupted sizes).
+  std::size_t size(std::size_t minElemSize = 1)
+  {
+    std::size_t s = u32();
+    if(s * minElemSize > remaining())
+    {
+      corrupted();
+    }
+    return s;
+  }
+
+  int i32()
+  {
+    std::int32_t v;
+    raw(&v, sizeof(v));
+    return v;
+  }
+
+  double f64()
+  {
+    double v;
+    raw(&v, sizeof(v));
+    return v;
+  }
+
+  std::string str()
+  {
+    std::size_t s = size();
+    std::string res(cur_, s);
+    cur_ += s;
+    return res;
+  }
+
+  std::vector<double> vec()
+  {
+    std::vector<double> v(size(sizeof(double)));
+    raw(v.data(), v.size() * sizeof(double));
+    return v;
+  }
+
+  template<typename Derived>
+  void mat(Eigen::MatrixBase<Derived> & m)
+  {
+    for(Eigen::Index c = 0; c < m.cols(); ++c)
+    {
+      for(Eigen::Index r = 0; r < m.rows(); ++r)
+      {
+        m(r, c) = f64();
+      }
+    }
+  }
+
+  Eigen::Vector3d vector3()
+  {
+    Eigen::Vector3d v;
+    mat(v);
+    return v;
+  }
+
+  sva::PTransformd transform()
+  {
+    Eigen::Matrix3d E;
+    mat(E);
+    return sva::PTransformd(E, vector3());
+  }
+
+  Body body()
+  {
+    std::string name = str();
+    double mass = f64();
+    Eigen::Vector3d momentum = vector3();
+    Eigen::Matrix3d inertia;
+    mat(inertia);
+    return Body(sva::RBInertiad(mass, momentum, inertia), name);
+  }
+
+  Joint joint()
+  {
+    std::string name = str();
+    std::uint8_t type = u8();
+    if(type > Joint::Fixed)
+    {
+      corrupted();
+    }
+    bool forward = u8() != 0;
+    Eigen::Vector3d axis = vector3();
+    Joint j(static_cast<Joint::Type>(type), axis, forward, name);
+    bool isMimic = u8() != 0;
+    std::string mimicName = str();
+    double mimicMultiplier = f64();
+    double mimicOffset = f64();
+    if(isMimic)
+    {
+      j.makeMimic(mimicName, mimicMultiplier, mimicOffset);
+    }
+    j.rotorInertia(f64());
+    j.gearRatio(f64());
+    j.damping(f64());
+    j.friction(f64());
+    return j;
+  }
+
+  Geometry geometry()
+  {
+    Geometry g;
+    std::uint8_t type = u8();
+    if(type > Geometry::UNKNOWN)
+    {
+      corrupted();
+    }
+    g.type = static_cast<Geometry::Type>(type);
+    switch(g.type)
+    {
+      case Geometry::BOX:
+      {
+        Geometry::Box b;
+        b.size = vector3();
+        g.data = b;
+        break;
+      }
+      case Geometry::CYLINDER:
+      {
+        Geometry::Cylinder c;
+        c.radius = f64();
+        c.length = f64();
+        g.data = c;
+        break;
+      }
+      case Geometry::SPHERE:
+      {
+        Geometry::Sphere s;
+        s.radius = f64();
+        g.data = s;
+        break;
+      }
+      case Geometry::MESH:
+      {
+        Geometry::Mesh m;
+        m.filename = str();
+        m.scale = f64();
+        g.data = m;
+        break;
+      }
+      case Geometry::SUPERELLIPSOID:
+      {
+        Geometry::Superellipsoid se;
+        se.size = vector3();
+        se.epsilon1 = f64();
+        se.epsilon2 = f64();
+        g.data = se;
+        break;
+      }
+      case Geometry::UNKNOWN:
+        break;
+    }
+    return g;
+  }
+
+  void visuals(std::map<std::string, std::vector<Visual>> & visuals)
+  {
+    std::size_t nrBodies = size();
+    for(std::size_t i = 0; i < nrBodies; ++i)
+    {
+      std::vector<Visual> & v = visuals[str()];
+      v.resize(size());
+      for(Visual & visual : v)
+      {
+        visual.name = str();
+        visual.origin = transform();
+        visual.geometry = geometry();
+      }
+    }
+  }
+
+  void limits(std::map<std::string, std::vector<double>> & limits)
+  {
+    std::size_t nrJoints = size();
+    for(std::size_t i = 0; i < nrJoints; ++i)
+    {
+      std::string name = str();
+      limits[name] = vec();
+    }
+  }
+
+  std::size_t remaining() const
+  {
+    return static_cast<std::size_t>(end_ - cur_);
+  }
+
+  [[noreturn]] static void corrupted()
+  {
+    throw std::runtime_error("Binary model is truncated or corrupted");
+  }
+
+private:
+  void raw(void * data, std::size_t size)
+  {
+    if(size > remaining())
+    {
+      corrupted();
+    }
+    std::memcpy(data, cur_, size);
+    cur_ += size;
+  }
+
+private:
+  const char * cur_;
+  const char * end_;
+};
+
+std::string serialize(const ParserResult & res, std::uint64_t key)
+{
+  Writer w;
+  w.str(res.name);
+
+  // MultiBodyGraph, the arcs are stored to keep their order
+  const MultiBodyGraph & mbg = res.mbg;
+  w.str(mbg.rootJointName());
+  w.size(mbg.nrNodes());
+  for(const auto & node : mbg.nodes())
+  {
+    w.body(node->body);
+  }
+  w.size(mbg.nrJoints());
+  for(const auto & joint : mbg.joints())
+  {
+    w.joint(*joint);
+  }
+  for(const auto & node : mbg.nodes())
+  {
+    w.size(node->arcs.size());
+    for(const MultiBodyGraph::Arc & arc : node->arcs)
+    {
+      w.str(arc.next->body.name());
+      w.transform(arc.X);
+      w.joint(arc.joint);
+    }
+  }
+
+  // MultiBody
+  const MultiBody & mb = res.mb;
+  w.size(static_cast<std::size_t>(mb.nrBodies()));
+  for(const Body & b : mb.bodies())
+  {
+    w.body(b);
+  }
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    w.joint(mb.joint(i));
+    w.i32(mb.predecessor(i));
+    w.i32(mb.successor(i));
+    w.i32(mb.parent(i));
+    w.transform(mb.transform(i));
+  }
+  w.size(static_cast<std::size_t>(mb.nrFrames()));
+  for(const OperationalFrame & f : mb.frames())
+  {
+    w.str(f.name);
+    w.i32(f.body);
+    w.transform(f.X_b_f);
+  }
+
+  // MultiBodyConfig inputs, the other members are recomputed at loading
+  const MultiBodyConfig & mbc = res.mbc;
+  auto writeParams = [&w](const std::vector<std::vector<double>> & params) {
+    w.size(params.size());
+    for(const std::vector<double> & p : params)
+    {
+      w.vec(p);
+    }
+  };
+  writeParams(mbc.q);
+  writeParams(mbc.alpha);
+  writeParams(mbc.alphaD);
+  writeParams(mbc.jointTorque);
+  w.size(mbc.force.size());
+  for(const sva::ForceVecd & f : mbc.force)
+  {
+    w.mat(f.vector());
+  }
+  w.mat(mbc.gravity);
+
+  w.limits(res.limits.lower);
+  w.limits(res.limits.upper);
+  w.limits(res.limits.velocity);
+  w.limits(res.limits.torque);
+
+  if(res.geometry_deferred())
+  {
+    // res is const, load a copy of the deferred geometry
+    ParserResult::VisualMap visual, collision;
+    res.geometry_loader(visual, collision);
+    w.visuals(visual);
+    w.visuals(collision);
+  }
+  else
+  {
+    w.visuals(res.visual);
+    w.visuals(res.collision);
+  }
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.byteOrder = BYTE_ORDER_MARK;
+  header.key = key;
+  header.payloadSize = w.buf.size();
+
+  std::string content(reinterpret_cast<const char *>(&header), sizeof(Header));
+  content.append(w.buf);
+  return content;
+}
+
+/// Check the header of a binary content and return its key.
+std::uint64_t readHeader(const char * data, std::size_t size)
+{
+  Header header;
+  if(size < sizeof(Header))
+  {
+    throw std::runtime_error("Not a RBDyn binary model");
+  }
+  std::memcpy(&header, data, sizeof(Header));
+  if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    throw std::runtime_error("Not a RBDyn binary model");
+  }
+  if(header.version != VERSION || header.byteOrder != BYTE_ORDER_MARK)
+  {
+    std::ostringstream str;
+    str << "Binary model version mismatch: expected " << VERSION << " gived " << header.version;
+    throw std::runtime_error(str.str());
+  }
+  if(header.payloadSize != size - sizeof(Header))
+  {
+    Reader::corrupted();
+  }
+  return header.key;
+}
+
+ParserResult deserialize(const char * data, std::size_t size)
+{
+  readHeader(data, size);
+  Reader r(data + sizeof(Header), size - sizeof(Header));
+
+  ParserResult res;
+  res.name = r.str();
+
+  res.mbg = MultiBodyGraph(r.str());
+  MultiBodyGraph & mbg = res.mbg;
+  std::size_t nrNodes = r.size();
+  std::vector<std::shared_ptr<MultiBodyGraph::Node>> nodes;
+  nodes.reserve(nrNodes);
+  for(std::size_t i = 0; i < nrNodes; ++i)
+  {
+    mbg.addBody(r.body());
+    nodes.push_back(mbg.nodes().back());
+  }
+  std::size_t nrGraphJoints = r.size();
+  for(std::size_t i = 0; i < nrGraphJoints; ++i)
+  {
+    mbg.addJoint(r.joint());
+  }
+  try
+  {
+    for(const auto & node : nodes)
+    {
+      std::size_t nrArcs = r.size();
+      for(std::size_t i = 0; i < nrArcs; ++i)
+      {
+        std::shared_ptr<MultiBodyGraph::Node> next = mbg.nodeByName(r.str());
+        sva::PTransformd X = r.transform();
+        Joint joint = r.joint();
+        node->arcs.emplace_back(X, joint, joint.forward(), next);
+      }
+    }
+  }
+  catch(const std::out_of_range &)
+  {
+    Reader::corrupted();
+  }
+
+  std::size_t nrBodies = r.size();
+  std::vector<Body> bodies;
+  std::vector<Joint> joints;
+  std::vector<int> pred, succ, parent;
+  std::vector<sva::PTransformd> Xt;
+  bodies.reserve(nrBodies);
+  for(std::size_t i = 0; i < nrBodies; ++i)
+  {
+    bodies.push_back(r.body());
+  }
+  const int nrB = static_cast<int>(nrBodies);
+  auto bodyIndex = [&r, nrB](int minIndex) {
+    int index = r.i32();
+    if(index < minIndex || index >= nrB)
+    {
+      Reader::corrupted();
+    }
+    return index;
+  };
+  for(std::size_t i = 0; i < nrBodies; ++i)
+  {
+    joints.push_back(r.joint());
+    pred.push_back(bodyIndex(-1));
+    succ.push_back(bodyIndex(0));
+    parent.push_back(bodyIndex(-1));
+    Xt.push_back(r.transform());
+  }
+  res.mb = MultiBody(std::move(bodies), std::move(joints), std::move(pred), std::move(succ), std::move(parent),
+                     std::move(Xt));
+  std::size_t nrFrames = r.size();
+  for(std::size_t i = 0; i < nrFrames; ++i)
+  {
+    std::string name = r.str();
+    int body = r.i32();
+    sva::PTransformd X = r.transform();
+    try
+    {
+      res.mb.sAddFrame(name, body, X);
+    }
+    catch(const std::logic_error &)
+    {
+      // unknown body or duplicated frame name
+      Reader::corrupted();
+    }
+  }
+
+  // the MultiBodyConfig constructor give the params and dof size of each joint
+  res.mbc = MultiBodyConfig(res.mb);
+  auto readParams = [&r](std::vector<std::vector<double>> & params) {
+    if(r.size() != params.size())
+    {
+      Reader::corrupted();
+    }
+    for(std::vector<double> & p : params)
+    {
+      std::vector<double> v = r.vec();
+      if(v.size() != p.size())
+      {
+        Reader::corrupted();
+      }
+      p = std::move(v);
+    }
+  };
+  readParams(res.mbc.q);
+  readParams(res.mbc.alpha);
+  readParams(res.mbc.alphaD);
+  readParams(res.mbc.jointTorque);
+  if(r.size() != res.mbc.force.size())
+  {
+    Reader::corrupted();
+  }
+  for(sva::ForceVecd & f : res.mbc.force)
+  {
+    Eigen::Vector6d v;
+    r.mat(v);
+    f = sva::ForceVecd(v);
+  }
+  r.mat(res.mbc.gravity);
+  rbd::forwardKinematics(res.mb, res.mbc);
+  rbd::forwardVelocity(res.mb, res.mbc);
+
+  r.limits(res.limits.lower);
+  r.limits(res.limits.upper);
+  r.limits(res.limits.velocity);
+  r.limits(res.limits.torque);
+
+  r.visuals(res.visual);
+  r.visuals(res.collision);
+
+  if(r.remaining() != 0)
+  {
+    Reader::corrupted();
+  }
+  return res;
+}
+
+/// Read only view of a whole file, mapped in memory when the platform allow it.
+struct FileView
+{
+  FileView(const std::string & path)
+  {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+      throw std::runtime_error("Can't open " + path);
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+    {
+      close(fd);
+      throw std::runtime_error("Can't stat " + path);
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    void * ptr = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if(ptr == MAP_FAILED)
+    {
+      throw std::runtime_error("Can't map " + path);
+    }
+    const std::size_t s = size;
+    data.reset(static_cast<const char *>(ptr), [s](const char * p) { munmap(const_cast<char *>(p), s); });
+#else
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if(!ifs)
+    {
+      throw std::runtime_error("Can't open " + path);
+    }
+    size = static_cast<std::size_t>(ifs.tellg());
+    std::shared_ptr<char> buffer(new char[size], std::default_delete<char[]>());
+    ifs.seekg(0);
+    ifs.read(buffer.get(), static_cast<std::streamsize>(size));
+    if(!ifs)
+    {
+      throw std::runtime_error("Failed to read " + path);
+    }
+    data = buffer;
+#endif
+  }
+
+  std::shared_ptr<const char> data;
+  std::size_t size = 0;
+};
+
+/// 64 bits FNV-1a hash.
+std::uint64_t hash(const std::string & data, std::uint64_t h = 14695981039346656037ULL)
+{
+  for(char c : data)
+  {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+void writeFile(const std::string & content, const std::string & file_path)
+{
+  std::ofstream ofs(file_path, std::ios::binary);
+  if(!ofs)
+  {
+    throw std::runtime_error("Can't open " + file_path + " for writing");
+  }
+  ofs.write(content.data(), static_cast<std::streamsize>(content.size()));
+  if(!ofs)
+  {
+    throw std::runtime_error("Failed to write " + file_path);
+  }
+}
+
+} // namespace
+
+std::string to_binary(const ParserResult & res)
+{
+  return serialize(res, 0);
+}
+
+void to_binary_file(const ParserResult & res, const std::string & file_path)
+{
+  writeFile(to_binary(res), file_path);
+}
+
+ParserResult from_binary(const std::string & content)
+{
+  return deserialize(content.data(), content.size());
+}
+
+ParserResult from_binary_file(const std::string & file_path)
+{
+  FileView file(file_path);
+  return deserialize(file.data.get(), file.size);
+}
+
+ParserResult from_file_cached(const std::string & file_path,
+                              const std::string & cache_dir,
+                              bool fixed,
+                              const std::vector<std::string> & filtered_links,
+                              bool transform_inertia,
+                              const std::string & base_link,
+                              bool with_virtual_links,
+                              const std::string & spherical_suffix)
+{
+  auto extension = file_path.substr(file_path.rfind('.') + 1);
+  bool is_yaml = extension == "yaml" || extension == "yml";
+  if(!is_yaml && extension != "urdf")
+  {
+    throw std::runtime_error("rbd::parsers::from_file_cached: Unkown robot model extension '" + extension
+                             + "'. Please provide a yaml, yml or urdf file.");
+  }
+
+  std::ifstream file(file_path);
+  if(!file.is_open())
+  {
+    throw std::runtime_error("Can't open " + file_path + " file for reading");
+  }
+  std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  // the key depends on the parsers and format versions and on the parsing parameters, a '\0' separate each of them
+  std::ostringstream params;
+  params << PARSER_VERSION << '\0' << VERSION << '\0' << fixed << '\0' << transform_inertia << '\0' << with_virtual_links
+         << '\0' << base_link << '\0' << spherical_suffix << '\0';
+  for(const std::string & l : filtered_links)
+  {
+    params << l << '\0';
+  }
+  std::uint64_t key = hash(params.str(), hash(content));
+
+  std::ostringstream cache_path;
+  cache_path << cache_dir << "/" << file_path.substr(file_path.find_last_of("/\\") + 1) << "." << std::hex << key
+             << ".rbdbin";
+
+  try
+  {
+    FileView cached(cache_path.str());
+    if(readHeader(cached.data.get(), cached.size) == key)
+    {
+      return deserialize(cached.data.get(), cached.size);
+    }
+  }
+  catch(const std::exception &)
+  {
+    // missing, outdated or corrupted entry, parse the source file
+  }
+
+  ParserResult res = is_yaml ? from_yaml(content, fixed, filtered_links, transform_inertia, base_link,
+                                         with_virtual_links, spherical_suffix)
+                             : from_urdf(content, fixed, filtered_links, transform_inertia, base_link,
+                                         with_virtual_links, spherical_suffix);
+
+  // write in a temporary file then rename it so concurrent processes never read a partial entry
+  std::ostringstream tmp_path;
+  tmp_path << cache_path.str() << ".tmp" << std::hex << std::random_device()();
+  try
+  {
+    writeFile(serialize(res, key), tmp_path.str());
+    if(std::rename(tmp_path.str().c_str(), cache_path.str().c_str()) != 0)
+    {
+      std::remove(tmp_path.str().c_str());
+    }
+  }
+  catch(const std::exception &)
+  {
+    std::remove(tmp_path.str().c_str());
+  }
+  return res;
+}
+
+} // namespace parsers
+
+} // namespace rbd
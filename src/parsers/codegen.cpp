@@ -0,0 +1,103 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#include <RBDyn/CodeGen.h>
+#include <RBDyn/parsers/common.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, const char * argv[])
+{
+  auto print_usage = [&]() {
+    std::cout << "Generates a C++ header specialized for a robot model (forward kinematics, jacobians, inverse "
+                 "dynamics, mass matrix and forward dynamics).\n";
+    std::cout << "Usage:\n";
+    std::cout << "\t" << argv[0] << " [options] input_file output_file\n";
+    std::cout << "input_file is an URDF (.urdf) or YAML (.yaml, .yml) robot model\n";
+    std::cout << "Options:\n";
+    std::cout << "\t--namespace ns: namespace of the generated code (default: robot)\n";
+    std::cout << "\t--jacobian body: generate the jacobian of body (can be repeated)\n";
+    std::cout << "\t--floating: the base is a free joint instead of a fixed one\n";
+    std::cout << "\t--base link: base link of the model (default: first link of the model)\n";
+  };
+
+  std::string nameSpace = "robot";
+  std::vector<std::string> jacobianBodies;
+  bool fixed = true;
+  std::string baseLink;
+  std::vector<std::string> files;
+  for(int i = 1; i < argc; ++i)
+  {
+    if(std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0)
+    {
+      print_usage();
+      std::exit(0);
+    }
+    else if(std::strcmp(argv[i], "--floating") == 0)
+    {
+      fixed = false;
+    }
+    else if(std::strcmp(argv[i], "--namespace") == 0 || std::strcmp(argv[i], "--jacobian") == 0
+            || std::strcmp(argv[i], "--base") == 0)
+    {
+      if(i + 1 == argc)
+      {
+        std::cerr << argv[i] << " expects a value" << std::endl;
+        print_usage();
+        std::exit(-1);
+      }
+      const std::string value = argv[i + 1];
+      if(std::strcmp(argv[i], "--namespace") == 0)
+      {
+        nameSpace = value;
+      }
+      else if(std::strcmp(argv[i], "--jacobian") == 0)
+      {
+        jacobianBodies.push_back(value);
+      }
+      else
+      {
+        baseLink = value;
+      }
+      ++i;
+    }
+    else
+    {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if(files.size() != 2)
+  {
+    print_usage();
+    std::exit(-1);
+  }
+
+  std::string code;
+  try
+  {
+    const auto parser_result = rbd::parsers::from_file(files[0], fixed, {}, true, baseLink);
+    code = rbd::generateCode(parser_result.mb, nameSpace, jacobianBodies);
+  }
+  catch(const std::exception & e)
+  {
+    std::cerr << "Failed to generate the code of " << files[0] << ": " << e.what() << std::endl;
+    std::exit(-1);
+  }
+
+  std::ofstream file(files[1], std::ios::out);
+  if(!file.is_open())
+  {
+    std::cerr << "Failed to open " << files[1] << " for writing" << std::endl;
+    std::exit(-1);
+  }
+  file << code;
+
+  return 0;
+}
@@ -1,38 +1,145 @@
+#include <RBDyn/parsers/binary.h>
 #include <RBDyn/parsers/common.h>
 #include <RBDyn/parsers/urdf.h>
 #include <RBDyn/parsers/yaml.h>
 
+#include <RBDyn/Parallel.h>
+
+#include <fstream>
+
 namespace rbd
 {
 
 namespace parsers
 {
 
+void ParserResult::load_geometry()
+{
+  if(geometry_loader)
+  {
+    // the result stay deferred if the loader throw
+    visual.clear();
+    collision.clear();
+    geometry_loader(visual, collision);
+    geometry_loader = nullptr;
+  }
+}
+
 ParserResult from_file(const std::string & file_path,
                        bool fixed,
                        const std::vector<std::string> & filtered_links,
                        bool transform_inertia,
                        const std::string & base_link,
                        bool with_virtual_links,
-                       const std::string spherical_suffix)
+                       const std::string spherical_suffix,
+                       GeometryLoading geometry)
 {
   auto extension_pos = file_path.rfind('.');
   auto extension = file_path.substr(extension_pos + 1);
   if(extension == "yaml" || extension == "yml")
   {
     return from_yaml_file(file_path, fixed, filtered_links, transform_inertia, base_link, with_virtual_links,
-                          spherical_suffix);
+                          spherical_suffix, geometry);
   }
   else if(extension == "urdf")
   {
     return from_urdf_file(file_path, fixed, filtered_links, transform_inertia, base_link, with_virtual_links,
-                          spherical_suffix);
+                          spherical_suffix, geometry);
+  }
+  else if(extension == "rbdbin")
+  {
+    return from_binary_file(file_path);
   }
   else
   {
     throw std::runtime_error("rbd::parsers::from_file: Unkown robot model extension '" + extension
-                             + "'. Please provide a yaml, yml or urdf file.");
+                             + "'. Please provide a yaml, yml, urdf or rbdbin file.");
+  }
+}
+
+std::vector<ParserResult> from_files(const std::vector<std::string> & file_paths,
+                                     int nr_threads,
+                                     bool fixed,
+                                     const std::vector<std::string> & filtered_links,
+                                     bool transform_inertia,
+                                     const std::string & base_link,
+                                     bool with_virtual_links,
+                                     const std::string & spherical_suffix,
+                                     GeometryLoading geometry)
+{
+  std::vector<ParserResult> res(file_paths.size());
+  // one file per chunk, the parsing time of the files can be very different
+  rbd::parallelFor(static_cast<int>(file_paths.size()), nr_threads, 1, [&](int, int begin, int end) {
+    for(int i = begin; i < end; ++i)
+    {
+      res[static_cast<std::size_t>(i)] =
+          from_file(file_paths[static_cast<std::size_t>(i)], fixed, filtered_links, transform_inertia, base_link,
+                    with_virtual_links, spherical_suffix, geometry);
+    }
+  });
+  return res;
+}
+
+void to_file(const ParserResult & res, const std::string & file_path)
+{
+  auto extension_pos = file_path.rfind('.');
+  auto extension = file_path.substr(extension_pos + 1);
+  if(extension == "rbdbin")
+  {
+    to_binary_file(res, file_path);
+    return;
   }
+  bool is_urdf = extension == "urdf";
+  if(!is_urdf && extension != "yaml" && extension != "yml")
+  {
+    throw std::runtime_error("rbd::parsers::to_file: Unknown robot model extension '" + extension
+                             + "'. Please provide a yaml, yml, urdf or rbdbin file.");
+  }
+
+  std::ofstream file(file_path, std::ios::binary);
+  if(!file.is_open())
+  {
+    throw std::runtime_error("Can't open " + file_path + " for writing");
+  }
+  if(is_urdf)
+  {
+    to_urdf(res, file);
+  }
+  else
+  {
+    to_yaml(res, file);
+  }
+  file.close();
+  if(!file)
+  {
+    throw std::runtime_error("Failed to write " + file_path);
+  }
+}
+
+void to_file_variants(const ParserResult & res,
+                      int nr_variants,
+                      const std::function<void(int variant, ParserResult & res)> & perturb,
+                      const std::function<std::string(int variant)> & file_path,
+                      int nr_threads)
+{
+  // the variants must not share the geometry loader
+  const ParserResult * nominal = &res;
+  ParserResult loaded;
+  if(res.geometry_deferred())
+  {
+    loaded = res;
+    loaded.load_geometry();
+    nominal = &loaded;
+  }
+
+  rbd::parallelFor(nr_variants, nr_threads, 1, [&](int, int begin, int end) {
+    for(int i = begin; i < end; ++i)
+    {
+      ParserResult variant = *nominal;
+      perturb(i, variant);
+      to_file(variant, file_path(i));
+    }
+  });
 }
 
 } // namespace parsers
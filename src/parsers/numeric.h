@@ -0,0 +1,221 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <locale.h>
+#ifdef __APPLE__
+#  include <xlocale.h>
+#endif
+
+namespace rbd
+{
+
+namespace parsers
+{
+
+namespace detail
+{
+
+// Every real number in a URDF file needs to be parsed and written assuming
+// that the decimal point separator is the period, as specified in XML Schema
+// definition of xs:double. The conversions use the C locale instead of the
+// current global locale.
+// Related PR: https://github.com/ros/urdfdom_headers/pull/42 .
+#ifdef _WIN32
+inline _locale_t cLocale()
+{
+  static _locale_t loc = _create_locale(LC_ALL, "C");
+  return loc;
+}
+
+inline double strtodC(const char * str, char ** end)
+{
+  return _strtod_l(str, end, cLocale());
+}
+
+/// snprintf(buf, size, "%.*g", precision, v) in the C locale.
+inline int printC(char * buf, std::size_t size, int precision, double v)
+{
+  return _snprintf_l(buf, size, "%.*g", cLocale(), precision, v);
+}
+#else
+inline locale_t cLocale()
+{
+  static locale_t loc = newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+  return loc;
+}
+
+inline double strtodC(const char * str, char ** end)
+{
+  return strtod_l(str, end, cLocale());
+}
+
+/// snprintf(buf, size, "%.*g", precision, v) in the C locale.
+inline int printC(char * buf, std::size_t size, int precision, double v)
+{
+  // the locale is only changed for the calling thread
+  locale_t old = uselocale(cLocale());
+  int res = std::snprintf(buf, size, "%.*g", precision, v);
+  uselocale(old);
+  return res;
+}
+#endif
+
+inline bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+/**
+ * Read a real number at the beginning of str, leading whitespaces are skipped.
+ * Accept the same inputs and give the same results than reading a double
+ * from a std::istream imbued with the classic locale (no inf, nan or
+ * hexadecimal numbers, out of range values are errors) without any
+ * allocation.
+ * @param str Null terminated string.
+ * @param res Parsed number.
+ * @return Pointer after the number or nullptr if no number can be read.
+ */
+inline const char * parseDouble(const char * str, double & res)
+{
+  while(isSpace(*str))
+  {
+    ++str;
+  }
+  const char * digits = (*str == '+' || *str == '-') ? str + 1 : str;
+  if(!isDigit(digits[0]) && !(digits[0] == '.' && isDigit(digits[1])))
+  {
+    return nullptr;
+  }
+  // strtod would read an hexadecimal number, the stream stop after the 0
+  if(digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'))
+  {
+    res = *str == '-' ? -0. : 0.;
+    return digits + 1;
+  }
+
+  char * end = nullptr;
+  errno = 0;
+  res = strtodC(str, &end);
+  // the stream also fail on an incomplete exponent ("1e", "1e+")
+  if(end == str || *end == 'e' || *end == 'E' || (errno == ERANGE && std::isinf(res)))
+  {
+    return nullptr;
+  }
+  return end;
+}
+
+/**
+ * Read a number that must start at the beginning of str and fill the whole
+ * string (trailing whitespaces are allowed).
+ * @return false if str is not a number.
+ */
+inline bool parseDoubleStrict(const char * str, double & res)
+{
+  if(isSpace(*str))
+  {
+    return false;
+  }
+  const char * end = parseDouble(str, res);
+  if(end == nullptr)
+  {
+    return false;
+  }
+  while(isSpace(*end))
+  {
+    ++end;
+  }
+  return *end == '\0';
+}
+
+/**
+ * Read a whitespace separated list of numbers, stop at the first element
+ * that is not a number.
+ */
+inline std::vector<double> parseList(const char * str)
+{
+  std::vector<double> res;
+  double v;
+  while((str = parseDouble(str, v)) != nullptr)
+  {
+    res.push_back(v);
+  }
+  return res;
+}
+
+/// Size of the buffer given to formatDouble.
+constexpr std::size_t FormatDoubleSize = 32;
+
+/**
+ * Write the shortest representation of v that is read back as v by
+ * parseDouble, in the C locale and without allocation. The non finite values
+ * are written like a stream does (inf, -inf, nan).
+ * @param v Number to write.
+ * @param buf Buffer of at least FormatDoubleSize characters, null terminated.
+ * @return Number of characters written.
+ */
+inline int formatDouble(double v, char * buf)
+{
+  if(std::isnan(v) || std::isinf(v))
+  {
+    const char * str = std::isnan(v) ? "nan" : (v > 0. ? "inf" : "-inf");
+    std::strcpy(buf, str);
+    return static_cast<int>(std::strlen(str));
+  }
+
+  // integers (mass, zeros...) are common and don't need snprintf
+  if(v == std::floor(v) && std::abs(v) < 1e15)
+  {
+    char digits[FormatDoubleSize];
+    long long n = static_cast<long long>(std::abs(v));
+    int nrDigits = 0;
+    do
+    {
+      digits[nrDigits++] = static_cast<char>('0' + n % 10);
+      n /= 10;
+    } while(n != 0);
+    int len = 0;
+    if(std::signbit(v))
+    {
+      buf[len++] = '-';
+    }
+    while(nrDigits > 0)
+    {
+      buf[len++] = digits[--nrDigits];
+    }
+    buf[len] = '\0';
+    return len;
+  }
+
+  int len = 0;
+  for(int precision = 15; precision <= 17; ++precision)
+  {
+    len = printC(buf, FormatDoubleSize, precision, v);
+    if(precision == 17 || strtodC(buf, nullptr) == v)
+    {
+      break;
+    }
+  }
+  return len;
+}
+
+} // namespace detail
+
+} // namespace parsers
+
+} // namespace rbd
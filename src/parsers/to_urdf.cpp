@@ -1,50 +1,173 @@
 #include <RBDyn/parsers/urdf.h>
 
-#include <tinyxml2.h>
+#include "writer.h"
+
+#include <limits>
+#include <sstream>
 
 namespace rbd
 {
 namespace parsers
 {
 
+namespace
+{
+
+/**
+ * XML output without intermediate document, indented like the tinyxml2
+ * printer. The start tag of an element is closed at its first child, an
+ * element without children is written as an empty element tag.
+ */
+class XMLWriter
+{
+public:
+  XMLWriter(std::ostream & out) : out_(out) {}
+
+  void start(const char * name)
+  {
+    closeTag();
+    out_.indent(4 * names_.size()) << '<' << name;
+    names_.push_back(name);
+    open_ = true;
+  }
+
+  void end()
+  {
+    const char * name = names_.back();
+    names_.pop_back();
+    if(open_)
+    {
+      out_ << "/>\n";
+      open_ = false;
+    }
+    else
+    {
+      out_.indent(4 * names_.size()) << "</" << name << ">\n";
+    }
+  }
+
+  void attribute(const char * name, const std::string & value)
+  {
+    out_ << ' ' << name << "=\"";
+    for(char c : value)
+    {
+      switch(c)
+      {
+        case '&':
+          out_ << "&amp;";
+          break;
+        case '<':
+          out_ << "&lt;";
+          break;
+        case '>':
+          out_ << "&gt;";
+          break;
+        case '"':
+          out_ << "&quot;";
+          break;
+        case '\'':
+          out_ << "&apos;";
+          break;
+        default:
+          out_ << c;
+      }
+    }
+    out_ << '"';
+  }
+
+  void number(const char * name, double value)
+  {
+    out_ << ' ' << name << "=\"" << value << '"';
+  }
+
+  void vec3d(const char * name, Eigen::Ref<const Eigen::Vector3d> xyz)
+  {
+    out_ << ' ' << name << "=\"" << xyz.x() << ' ' << xyz.y() << ' ' << xyz.z() << '"';
+  }
+
+  void vector(const char * name, const std::vector<double> & v)
+  {
+    out_ << ' ' << name << "=\"";
+    for(std::size_t i = 0; i < v.size(); ++i)
+    {
+      if(i != 0)
+      {
+        out_ << ' ';
+      }
+      out_ << v[i];
+    }
+    out_ << '"';
+  }
+
+  void flush()
+  {
+    out_.flush();
+  }
+
+private:
+  void closeTag()
+  {
+    if(open_)
+    {
+      out_ << ">\n";
+      open_ = false;
+    }
+  }
+
+private:
+  detail::TextWriter out_;
+  std::vector<const char *> names_;
+  /// true if the start tag of the last element is not closed.
+  bool open_ = false;
+};
+
+} // namespace
+
 std::string to_urdf(const ParserResult & res)
 {
-  using namespace tinyxml2;
+  std::ostringstream out;
+  to_urdf(res, out);
+  return out.str();
+}
 
-  XMLDocument doc;
-  auto robot = doc.NewElement("robot");
-  robot->SetAttribute("name", res.name.c_str());
+void to_urdf(const ParserResult & res, std::ostream & out)
+{
+  // res is const, load a copy of the deferred geometry
+  ParserResult::VisualMap deferred_visual, deferred_collision;
+  if(res.geometry_deferred())
+  {
+    res.geometry_loader(deferred_visual, deferred_collision);
+  }
+  const auto & visual = res.geometry_deferred() ? deferred_visual : res.visual;
+  const auto & collision = res.geometry_deferred() ? deferred_collision : res.collision;
 
-  auto set_vec3d = [](XMLElement * e, const char * name, Eigen::Ref<const Eigen::Vector3d> xyz) {
-    std::stringstream ss;
-    Eigen::IOFormat f(Eigen::StreamPrecision, Eigen::DontAlignCols);
-    ss << xyz.transpose().format(f);
-    e->SetAttribute(name, ss.str().c_str());
-  };
+  XMLWriter doc(out);
+  doc.start("robot");
+  doc.attribute("name", res.name);
 
-  auto set_origin_from_ptransform = [&](XMLElement * node, const sva::PTransformd & X) {
+  auto set_origin_from_ptransform = [&](const sva::PTransformd & X) {
     const auto & xyz = X.translation();
     const auto rpy = X.rotation().transpose().eulerAngles(0, 1, 2);
     if(!xyz.isZero() || !rpy.isZero())
     {
-      auto origin_node = doc.NewElement("origin");
+      doc.start("origin");
       if(!xyz.isZero())
       {
-        set_vec3d(origin_node, "xyz", xyz);
+        doc.vec3d("xyz", xyz);
       }
       if(!rpy.isZero())
       {
-        set_vec3d(origin_node, "rpy", rpy);
+        doc.vec3d("rpy", rpy);
       }
-      node->InsertEndChild(origin_node);
+      doc.end();
     }
   };
 
   // Links
   for(const auto & link : res.mb.bodies())
   {
-    auto node = doc.NewElement("link");
-    node->SetAttribute("name", link.name().c_str());
+    doc.start("link");
+    doc.attribute("name", link.name());
 
     // Inertial
     const auto has_mass = link.inertia().mass() > 0.;
@@ -52,8 +175,7 @@ std::string to_urdf(const ParserResult & res)
     const auto has_inertia = !link.inertia().inertia().isZero();
     if(has_mass || has_momentum || has_inertia)
     {
-
-      auto inertial_node = doc.NewElement("inertial");
+      doc.start("inertial");
 
       const auto com = [&]() -> Eigen::Vector3d {
         if(link.inertia().mass() > 0.)
@@ -67,16 +189,16 @@ std::string to_urdf(const ParserResult & res)
       }();
       if(!com.isZero())
       {
-        auto origin_node = doc.NewElement("origin");
-        set_vec3d(origin_node, "xyz", com);
-        inertial_node->InsertEndChild(origin_node);
+        doc.start("origin");
+        doc.vec3d("xyz", com);
+        doc.end();
       }
 
       if(link.inertia().mass() > 0.)
       {
-        auto mass_node = doc.NewElement("mass");
-        mass_node->SetAttribute("value", link.inertia().mass());
-        inertial_node->InsertEndChild(mass_node);
+        doc.start("mass");
+        doc.number("value", link.inertia().mass());
+        doc.end();
       }
 
       if(!link.inertia().inertia().isZero())
@@ -86,17 +208,17 @@ std::string to_urdf(const ParserResult & res)
         const auto inertia = sva::inertiaToOrigin(link.inertia().inertia(), -link.inertia().mass(), com,
                                                   Eigen::Matrix3d::Identity().eval());
 
-        auto inertia_node = doc.NewElement("inertia");
-        inertia_node->SetAttribute("ixx", inertia(0, 0));
-        inertia_node->SetAttribute("ixy", inertia(0, 1));
-        inertia_node->SetAttribute("ixz", inertia(0, 2));
-        inertia_node->SetAttribute("iyy", inertia(1, 1));
-        inertia_node->SetAttribute("iyz", inertia(1, 2));
-        inertia_node->SetAttribute("izz", inertia(2, 2));
-        inertial_node->InsertEndChild(inertia_node);
+        doc.start("inertia");
+        doc.number("ixx", inertia(0, 0));
+        doc.number("ixy", inertia(0, 1));
+        doc.number("ixz", inertia(0, 2));
+        doc.number("iyy", inertia(1, 1));
+        doc.number("iyz", inertia(1, 2));
+        doc.number("izz", inertia(2, 2));
+        doc.end();
       }
 
-      node->InsertEndChild(inertial_node);
+      doc.end();
     }
 
     auto generate_visual = [&](const char * type, const std::map<std::string, std::vector<Visual>> & visuals) {
@@ -110,71 +232,71 @@ std::string to_urdf(const ParserResult & res)
             continue;
           }
 
-          auto visual_node = doc.NewElement(type);
+          doc.start(type);
 
-          set_origin_from_ptransform(visual_node, visual.origin);
+          set_origin_from_ptransform(visual.origin);
 
-          auto geometry_node = doc.NewElement("geometry");
+          doc.start("geometry");
           switch(visual.geometry.type)
           {
             case Geometry::Type::BOX:
             {
-              auto node = doc.NewElement("box");
-              const auto box = boost::get<Geometry::Box>(visual.geometry.data);
-              set_vec3d(node, "size", box.size);
-              geometry_node->InsertEndChild(node);
+              doc.start("box");
+              const auto & box = boost::get<Geometry::Box>(visual.geometry.data);
+              doc.vec3d("size", box.size);
+              doc.end();
             }
             break;
             case Geometry::Type::CYLINDER:
             {
-              auto node = doc.NewElement("cylinder");
-              const auto cylinder = boost::get<Geometry::Cylinder>(visual.geometry.data);
-              node->SetAttribute("radius", std::to_string(cylinder.radius).c_str());
-              node->SetAttribute("length", std::to_string(cylinder.length).c_str());
-              geometry_node->InsertEndChild(node);
+              doc.start("cylinder");
+              const auto & cylinder = boost::get<Geometry::Cylinder>(visual.geometry.data);
+              doc.number("radius", cylinder.radius);
+              doc.number("length", cylinder.length);
+              doc.end();
             }
             break;
             case Geometry::Type::MESH:
             {
-              auto node = doc.NewElement("mesh");
-              const auto mesh = boost::get<Geometry::Mesh>(visual.geometry.data);
-              node->SetAttribute("filename", mesh.filename.c_str());
-              node->SetAttribute("scale", std::to_string(mesh.scale).c_str());
-              geometry_node->InsertEndChild(node);
+              doc.start("mesh");
+              const auto & mesh = boost::get<Geometry::Mesh>(visual.geometry.data);
+              doc.attribute("filename", mesh.filename);
+              doc.number("scale", mesh.scale);
+              doc.end();
             }
             break;
             case Geometry::Type::SPHERE:
             {
-              auto node = doc.NewElement("sphere");
-              const auto sphere = boost::get<Geometry::Sphere>(visual.geometry.data);
-              node->SetAttribute("radius", std::to_string(sphere.radius).c_str());
-              geometry_node->InsertEndChild(node);
+              doc.start("sphere");
+              const auto & sphere = boost::get<Geometry::Sphere>(visual.geometry.data);
+              doc.number("radius", sphere.radius);
+              doc.end();
             }
             break;
             case Geometry::Type::SUPERELLIPSOID:
             {
-              auto node = doc.NewElement("superellipsoid");
-              const auto superellipsoid = boost::get<Geometry::Superellipsoid>(visual.geometry.data);
-              set_vec3d(node, "size", superellipsoid.size);
-              node->SetAttribute("epsilon1", std::to_string(superellipsoid.epsilon1).c_str());
-              node->SetAttribute("epsilon2", std::to_string(superellipsoid.epsilon2).c_str());
-              geometry_node->InsertEndChild(node);
+              doc.start("superellipsoid");
+              const auto & superellipsoid = boost::get<Geometry::Superellipsoid>(visual.geometry.data);
+              doc.vec3d("size", superellipsoid.size);
+              doc.number("epsilon1", superellipsoid.epsilon1);
+              doc.number("epsilon2", superellipsoid.epsilon2);
+              doc.end();
             }
             break;
             case Geometry::Type::UNKNOWN:
               break;
           }
-          visual_node->InsertEndChild(geometry_node);
+          doc.end(); // geometry
 
-          node->InsertEndChild(visual_node);
+          doc.end(); // visual or collision
         }
       }
     };
 
-    generate_visual("visual", res.visual);
-    generate_visual("collision", res.collision);
+    generate_visual("visual", visual);
+    generate_visual("collision", collision);
 
-    robot->InsertEndChild(node);
+    doc.end(); // link
   }
 
   auto is_continuous = [&](const rbd::Joint & joint) -> bool {
@@ -198,19 +320,6 @@ std::string to_urdf(const ParserResult & res)
     }
   };
 
-  auto set_vector = [](XMLElement * e, const char * name, const std::vector<double> & v) {
-    std::stringstream ss;
-    for(size_t i = 0; i < v.size(); i++)
-    {
-      ss << v[i];
-      if(i != v.size() - 1)
-      {
-        ss << ' ';
-      }
-    }
-    e->SetAttribute(name, ss.str().c_str());
-  };
-
   auto has_limits = [&](const Joint & joint) {
     auto check = [](const Joint & joint, const std::map<std::string, std::vector<double>> & limits) {
       auto it = limits.find(joint.name());
@@ -227,12 +336,12 @@ std::string to_urdf(const ParserResult & res)
            && check(joint, res.limits.torque);
   };
 
-  auto set_limit = [&](XMLElement * e, const Joint & joint, const char * name,
+  auto set_limit = [&](const Joint & joint, const char * name,
                        const std::map<std::string, std::vector<double>> & limits) {
     auto it = limits.find(joint.name());
     if(it != limits.end())
     {
-      set_vector(e, name, it->second);
+      doc.vector(name, it->second);
     }
   };
 
@@ -244,43 +353,42 @@ std::string to_urdf(const ParserResult & res)
     {
       continue;
     }
-    auto node = doc.NewElement("joint");
-    node->SetAttribute("name", joint.name().c_str());
+    doc.start("joint");
+    doc.attribute("name", joint.name());
     switch(joint.type())
     {
       case Joint::Type::Rev:
         if(is_continuous(joint))
         {
-          node->SetAttribute("type", "continuous");
+          doc.attribute("type", "continuous");
         }
         else
         {
-          node->SetAttribute("type", "revolute");
+          doc.attribute("type", "revolute");
         }
         break;
       case Joint::Type::Prism:
-        node->SetAttribute("type", "prismatic");
+        doc.attribute("type", "prismatic");
         break;
       case Joint::Type::Spherical:
         throw std::invalid_argument("URDF: Spherical is an unsupported joint type");
         break;
       case Joint::Type::Planar:
-        node->SetAttribute("type", "planar");
+        doc.attribute("type", "planar");
         break;
       case Joint::Type::Cylindrical:
         throw std::invalid_argument("URDF: Cylindrical is an unsupported joint type");
         break;
       case Joint::Type::Free:
-        node->SetAttribute("type", "floating");
+        doc.attribute("type", "floating");
         break;
       case Joint::Type::Fixed:
-        node->SetAttribute("type", "fixed");
+        doc.attribute("type", "fixed");
         break;
     }
 
     auto index = res.mb.jointIndexByName(joint.name());
     const auto pred = res.mb.predecessor(index);
-    auto parent_node = doc.NewElement("parent");
     const auto & parent = [&]() {
       if(pred != -1)
       {
@@ -291,25 +399,24 @@ std::string to_urdf(const ParserResult & res)
         return res.mb.body(0);
       }
     }();
-    parent_node->SetAttribute("link", parent.name().c_str());
+    doc.start("parent");
+    doc.attribute("link", parent.name());
+    doc.end();
 
     auto succ = res.mb.successor(index);
     const auto & child = res.mb.body(succ);
-    auto child_node = doc.NewElement("child");
-    child_node->SetAttribute("link", child.name().c_str());
-
-    node->InsertEndChild(parent_node);
-    node->InsertEndChild(child_node);
+    doc.start("child");
+    doc.attribute("link", child.name());
+    doc.end();
 
     for(const auto & arc : res.mbg.nodeByName(parent.name())->arcs)
     {
       if(arc.joint.name() == joint.name())
       {
-        set_origin_from_ptransform(node, arc.X);
+        set_origin_from_ptransform(arc.X);
       }
     }
 
-    auto axis_node = doc.NewElement("axis");
     Eigen::Vector3d axis = Eigen::Vector3d::Zero();
     switch(joint.type())
     {
@@ -335,29 +442,38 @@ std::string to_urdf(const ParserResult & res)
     }
     if(!axis.isZero())
     {
-      set_vec3d(axis_node, "xyz", axis);
-      node->InsertEndChild(axis_node);
+      doc.start("axis");
+      doc.vec3d("xyz", axis);
+      doc.end();
     }
 
     if(has_limits(joint) && !(joint.type() == Joint::Type::Rev && is_continuous(joint)))
     {
-      auto limit_node = doc.NewElement("limit");
-      set_limit(limit_node, joint, "lower", res.limits.lower);
-      set_limit(limit_node, joint, "upper", res.limits.upper);
-      set_limit(limit_node, joint, "velocity", res.limits.velocity);
-      set_limit(limit_node, joint, "effort", res.limits.torque);
-      node->InsertEndChild(limit_node);
+      doc.start("limit");
+      set_limit(joint, "lower", res.limits.lower);
+      set_limit(joint, "upper", res.limits.upper);
+      set_limit(joint, "velocity", res.limits.velocity);
+      set_limit(joint, "effort", res.limits.torque);
+      doc.end();
     }
 
-    robot->InsertEndChild(node);
-  }
-
-  doc.InsertEndChild(robot);
+    if(joint.hasActuatorDynamics())
+    {
+      doc.start("dynamics");
+      doc.number("damping", joint.damping());
+      doc.number("friction", joint.friction());
+      if(joint.armature() != 0.)
+      {
+        doc.number("armature", joint.armature());
+      }
+      doc.end();
+    }
 
-  XMLPrinter printer;
-  doc.Print(&printer);
+    doc.end(); // joint
+  }
 
-  return std::string(printer.CStr());
+  doc.end(); // robot
+  doc.flush();
 }
 
 } // namespace parsers
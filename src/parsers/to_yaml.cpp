@@ -1,53 +1,218 @@
 #include <RBDyn/parsers/yaml.h>
 
-#include <yaml-cpp/yaml.h>
+#include "writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
 
 namespace rbd
 {
 namespace parsers
 {
 
+namespace
+{
+
+/**
+ * Block style YAML output without intermediate document.
+ * A key is written at an indentation level, the keys of a sequence item are
+ * written two spaces after the item dash.
+ */
+class YAMLWriter
+{
+public:
+  YAMLWriter(std::ostream & out) : out_(out) {}
+
+  /// Start a key, the value is written by the caller.
+  detail::TextWriter & key(std::size_t indent, const char * name)
+  {
+    if(item_)
+    {
+      out_.indent(indent - 2) << "- ";
+      item_ = false;
+    }
+    else
+    {
+      out_.indent(indent);
+    }
+    return out_ << name << ':';
+  }
+
+  /// The next key is the first key of a sequence item.
+  void item()
+  {
+    item_ = true;
+  }
+
+  /// Key with a map or a sequence value.
+  void map(std::size_t indent, const char * name)
+  {
+    key(indent, name) << '\n';
+  }
+
+  void string(std::size_t indent, const char * name, const std::string & value)
+  {
+    key(indent, name) << ' ';
+    writeString(value);
+    out_ << '\n';
+  }
+
+  void number(std::size_t indent, const char * name, double value)
+  {
+    key(indent, name) << ' ';
+    writeNumber(value);
+    out_ << '\n';
+  }
+
+  void vec3d(std::size_t indent, const char * name, Eigen::Ref<const Eigen::Vector3d> xyz)
+  {
+    key(indent, name) << " [";
+    writeNumber(xyz.x());
+    out_ << ", ";
+    writeNumber(xyz.y());
+    out_ << ", ";
+    writeNumber(xyz.z());
+    out_ << "]\n";
+  }
+
+  void vector(std::size_t indent, const char * name, const std::vector<double> & v)
+  {
+    key(indent, name) << " [";
+    for(std::size_t i = 0; i < v.size(); ++i)
+    {
+      if(i != 0)
+      {
+        out_ << ", ";
+      }
+      writeNumber(v[i]);
+    }
+    out_ << "]\n";
+  }
+
+  void flush()
+  {
+    out_.flush();
+  }
+
+private:
+  // The strings that could be read as another type or YAML syntax are double quoted
+  static bool isPlain(const std::string & str)
+  {
+    if(str.empty() || str[0] == '-' || str == "null" || str == "Null" || str == "NULL")
+    {
+      return false;
+    }
+    for(char c : str)
+    {
+      bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || detail::isDigit(c) || c == '_' || c == '-'
+                  || c == '.' || c == '/';
+      if(!safe)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void writeString(const std::string & str)
+  {
+    if(isPlain(str))
+    {
+      out_ << str;
+      return;
+    }
+    out_ << '"';
+    for(char c : str)
+    {
+      if(c == '"' || c == '\\')
+      {
+        out_ << '\\' << c;
+      }
+      else if(static_cast<unsigned char>(c) < 0x20)
+      {
+        const char * hex = "0123456789abcdef";
+        out_ << "\\x" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+      }
+      else
+      {
+        out_ << c;
+      }
+    }
+    out_ << '"';
+  }
+
+  void writeNumber(double v)
+  {
+    if(std::isnan(v))
+    {
+      out_ << ".nan";
+    }
+    else if(std::isinf(v))
+    {
+      out_ << (v > 0. ? ".inf" : "-.inf");
+    }
+    else
+    {
+      out_ << v;
+    }
+  }
+
+private:
+  detail::TextWriter out_;
+  bool item_ = false;
+};
+
+} // namespace
+
 std::string to_yaml(const ParserResult & res)
 {
-  using namespace YAML;
+  std::ostringstream out;
+  to_yaml(res, out);
+  return out.str();
+}
 
-  Emitter doc;
+void to_yaml(const ParserResult & res, std::ostream & out)
+{
+  // res is const, load a copy of the deferred geometry
+  ParserResult::VisualMap deferred_visual, deferred_collision;
+  if(res.geometry_deferred())
+  {
+    res.geometry_loader(deferred_visual, deferred_collision);
+  }
+  const auto & visual = res.geometry_deferred() ? deferred_visual : res.visual;
+  const auto & collision = res.geometry_deferred() ? deferred_collision : res.collision;
 
-  doc << BeginMap;
-  doc << Key << "robot" << Value << BeginMap;
-  doc << Key << "name" << Value << res.name;
-  doc << Key << "anglesInDegrees" << Value << false;
+  YAMLWriter doc(out);
 
-  auto set_vec3d = [&](const char * name, Eigen::Ref<const Eigen::Vector3d> xyz) {
-    doc << Value << name << Key << Flow << BeginSeq;
-    doc << xyz.x() << xyz.y() << xyz.z();
-    doc << EndSeq;
-  };
+  doc.map(0, "robot");
+  doc.string(2, "name", res.name);
+  doc.key(2, "anglesInDegrees") << " false\n";
 
-  auto set_origin_from_ptransform = [&](const sva::PTransformd & X) {
+  auto set_origin_from_ptransform = [&](std::size_t indent, const sva::PTransformd & X) {
     const auto & xyz = X.translation();
     const auto rpy = X.rotation().transpose().eulerAngles(0, 1, 2);
     if(!xyz.isZero() || !rpy.isZero())
     {
-      doc << Key << "frame" << BeginMap;
+      doc.map(indent, "frame");
       if(!xyz.isZero())
       {
-        set_vec3d("xyz", xyz);
+        doc.vec3d(indent + 2, "xyz", xyz);
       }
       if(!rpy.isZero())
       {
-        set_vec3d("rpy", rpy);
+        doc.vec3d(indent + 2, "rpy", rpy);
       }
-      doc << EndMap;
     }
   };
 
   // Links
-  doc << Key << "links" << Value << BeginSeq;
+  doc.map(2, "links");
   for(const auto & link : res.mb.bodies())
   {
-    doc << BeginMap;
-    doc << Key << "name" << Value << link.name();
+    doc.item();
+    doc.string(6, "name", link.name());
 
     // Inertial
     const auto has_mass = link.inertia().mass() > 0.;
@@ -55,11 +220,11 @@ std::string to_yaml(const ParserResult & res)
     const auto has_inertia = !link.inertia().inertia().isZero();
     if(has_mass || has_momentum || has_inertia)
     {
-      doc << Key << "inertial" << BeginMap;
+      doc.map(6, "inertial");
 
       if(link.inertia().mass() > 0.)
       {
-        doc << Key << "mass" << Value << link.inertia().mass();
+        doc.number(8, "mass", link.inertia().mass());
       }
 
       const auto com = [&]() -> Eigen::Vector3d {
@@ -74,9 +239,8 @@ std::string to_yaml(const ParserResult & res)
       }();
       if(!com.isZero())
       {
-        doc << Key << "frame" << BeginMap;
-        set_vec3d("xyz", com);
-        doc << EndMap;
+        doc.map(8, "frame");
+        doc.vec3d(10, "xyz", com);
       }
 
       if(!link.inertia().inertia().isZero())
@@ -86,24 +250,30 @@ std::string to_yaml(const ParserResult & res)
         const auto inertia = sva::inertiaToOrigin(link.inertia().inertia(), -link.inertia().mass(), com,
                                                   Eigen::Matrix3d::Identity().eval());
 
-        doc << Key << "inertia" << BeginMap;
-        doc << Key << "Ixx" << Value << inertia(0, 0);
-        doc << Key << "Iyy" << Value << inertia(1, 1);
-        doc << Key << "Izz" << Value << inertia(2, 2);
-        doc << Key << "Iyz" << Value << inertia(1, 2);
-        doc << Key << "Ixz" << Value << inertia(0, 2);
-        doc << Key << "Ixy" << Value << inertia(0, 1);
-        doc << EndMap;
+        doc.map(8, "inertia");
+        doc.number(10, "Ixx", inertia(0, 0));
+        doc.number(10, "Iyy", inertia(1, 1));
+        doc.number(10, "Izz", inertia(2, 2));
+        doc.number(10, "Iyz", inertia(1, 2));
+        doc.number(10, "Ixz", inertia(0, 2));
+        doc.number(10, "Ixy", inertia(0, 1));
       }
-
-      doc << EndMap;
     }
 
     auto generate_visual = [&](const char * type, const std::map<std::string, std::vector<Visual>> & visuals) {
       auto visuals_it = visuals.find(link.name());
       if(visuals_it != visuals.end())
       {
-        doc << Key << type << Value << BeginSeq;
+        bool empty = std::all_of(visuals_it->second.begin(), visuals_it->second.end(), [](const Visual & visual) {
+          return visual.geometry.type == Geometry::Type::UNKNOWN;
+        });
+        if(empty)
+        {
+          doc.key(6, type) << " []\n";
+          return;
+        }
+
+        doc.map(6, type);
         for(const auto & visual : visuals_it->second)
         {
           if(visual.geometry.type == Geometry::Type::UNKNOWN)
@@ -111,75 +281,63 @@ std::string to_yaml(const ParserResult & res)
             continue;
           }
 
-          doc << BeginMap;
+          doc.item();
 
-          set_origin_from_ptransform(visual.origin);
+          set_origin_from_ptransform(10, visual.origin);
 
-          doc << Key << "geometry" << Value << BeginMap;
+          doc.map(10, "geometry");
 
           switch(visual.geometry.type)
           {
             case Geometry::Type::BOX:
             {
-              doc << Key << "box" << BeginMap;
-              const auto box = boost::get<Geometry::Box>(visual.geometry.data);
-              set_vec3d("size", box.size);
-              doc << EndMap;
+              doc.map(12, "box");
+              const auto & box = boost::get<Geometry::Box>(visual.geometry.data);
+              doc.vec3d(14, "size", box.size);
             }
             break;
             case Geometry::Type::CYLINDER:
             {
-              doc << Key << "cylinder" << BeginMap;
-              const auto cylinder = boost::get<Geometry::Cylinder>(visual.geometry.data);
-              doc << Key << "radius" << Value << cylinder.radius;
-              doc << Key << "length" << Value << cylinder.length;
-              doc << EndMap;
+              doc.map(12, "cylinder");
+              const auto & cylinder = boost::get<Geometry::Cylinder>(visual.geometry.data);
+              doc.number(14, "radius", cylinder.radius);
+              doc.number(14, "length", cylinder.length);
             }
             break;
             case Geometry::Type::MESH:
             {
-              doc << Key << "mesh" << BeginMap;
-              const auto mesh = boost::get<Geometry::Mesh>(visual.geometry.data);
-              doc << Key << "filename" << Value << mesh.filename;
-              doc << Key << "scale" << Value << mesh.scale;
-              doc << EndMap;
+              doc.map(12, "mesh");
+              const auto & mesh = boost::get<Geometry::Mesh>(visual.geometry.data);
+              doc.string(14, "filename", mesh.filename);
+              doc.number(14, "scale", mesh.scale);
             }
             break;
             case Geometry::Type::SPHERE:
             {
-              doc << Key << "sphere" << BeginMap;
-              const auto sphere = boost::get<Geometry::Sphere>(visual.geometry.data);
-              doc << Key << "radius" << Value << sphere.radius;
-              doc << EndMap;
+              doc.map(12, "sphere");
+              const auto & sphere = boost::get<Geometry::Sphere>(visual.geometry.data);
+              doc.number(14, "radius", sphere.radius);
             }
             break;
             case Geometry::Type::SUPERELLIPSOID:
             {
-              doc << Key << "superellipsoid" << BeginMap;
-              const auto superellipsoid = boost::get<Geometry::Superellipsoid>(visual.geometry.data);
-              set_vec3d("size", superellipsoid.size);
-              doc << Key << "epsilon1" << Value << superellipsoid.epsilon1;
-              doc << Key << "epsilon2" << Value << superellipsoid.epsilon2;
-              doc << EndMap;
+              doc.map(12, "superellipsoid");
+              const auto & superellipsoid = boost::get<Geometry::Superellipsoid>(visual.geometry.data);
+              doc.vec3d(14, "size", superellipsoid.size);
+              doc.number(14, "epsilon1", superellipsoid.epsilon1);
+              doc.number(14, "epsilon2", superellipsoid.epsilon2);
             }
             break;
             case Geometry::Type::UNKNOWN:
               break;
           }
-
-          doc << EndMap << EndMap;
         }
-
-        doc << EndSeq;
       }
     };
 
-    generate_visual("visual", res.visual);
-    generate_visual("collision", res.collision);
-
-    doc << EndMap;
+    generate_visual("visual", visual);
+    generate_visual("collision", collision);
   }
-  doc << EndSeq;
 
   auto is_continuous = [&](const rbd::Joint & joint) -> bool {
     const bool has_upper_limit = res.limits.upper.count(joint.name()) > 0;
@@ -202,10 +360,6 @@ std::string to_yaml(const ParserResult & res)
     }
   };
 
-  auto set_vector = [&](const char * name, const std::vector<double> & v) {
-    doc << Key << name << Value << Flow << BeginSeq << v << EndSeq;
-  };
-
   auto has_limits = [&](const Joint & joint) {
     auto check = [](const Joint & joint, const std::map<std::string, std::vector<double>> & limits) {
       auto it = limits.find(joint.name());
@@ -229,17 +383,24 @@ std::string to_yaml(const ParserResult & res)
     {
       if(it->second.size() == 1)
       {
-        doc << Key << name << Value << it->second[0];
+        doc.number(8, name, it->second[0]);
       }
       else
       {
-        set_vector(name, it->second);
+        doc.vector(8, name, it->second);
       }
     }
   };
 
   // Joints
-  doc << Key << "joints" << Value << BeginSeq;
+  if(res.mb.nrJoints() <= 1)
+  {
+    doc.key(2, "joints") << " []\n";
+  }
+  else
+  {
+    doc.map(2, "joints");
+  }
   for(const auto & joint : res.mb.joints())
   {
     // Skip the root joint
@@ -248,38 +409,38 @@ std::string to_yaml(const ParserResult & res)
       continue;
     }
 
-    doc << BeginMap;
-    doc << Key << "name" << Value << joint.name();
+    doc.item();
+    doc.string(6, "name", joint.name());
 
     switch(joint.type())
     {
       case Joint::Type::Rev:
         if(is_continuous(joint))
         {
-          doc << Key << "type" << Value << "continuous";
+          doc.key(6, "type") << " continuous\n";
         }
         else
         {
-          doc << Key << "type" << Value << "revolute";
+          doc.key(6, "type") << " revolute\n";
         }
         break;
       case Joint::Type::Prism:
-        doc << Key << "type" << Value << "prismatic";
+        doc.key(6, "type") << " prismatic\n";
         break;
       case Joint::Type::Spherical:
         throw std::invalid_argument("URDF: Spherical is an unsupported joint type");
         break;
       case Joint::Type::Planar:
-        doc << Key << "type" << Value << "planar";
+        doc.key(6, "type") << " planar\n";
         break;
       case Joint::Type::Cylindrical:
         throw std::invalid_argument("URDF: Cylindrical is an unsupported joint type");
         break;
       case Joint::Type::Free:
-        doc << Key << "type" << Value << "floating";
+        doc.key(6, "type") << " floating\n";
         break;
       case Joint::Type::Fixed:
-        doc << Key << "type" << Value << "fixed";
+        doc.key(6, "type") << " fixed\n";
         break;
     }
 
@@ -295,17 +456,17 @@ std::string to_yaml(const ParserResult & res)
         return res.mb.body(0);
       }
     }();
-    doc << Key << "parent" << Value << parent.name();
+    doc.string(6, "parent", parent.name());
 
     auto succ = res.mb.successor(index);
     const auto & child = res.mb.body(succ);
-    doc << Key << "child" << Value << child.name();
+    doc.string(6, "child", child.name());
 
     for(const auto & arc : res.mbg.nodeByName(parent.name())->arcs)
     {
       if(arc.joint.name() == joint.name())
       {
-        set_origin_from_ptransform(arc.X);
+        set_origin_from_ptransform(6, arc.X);
       }
     }
 
@@ -334,27 +495,31 @@ std::string to_yaml(const ParserResult & res)
     }
     if(!axis.isZero())
     {
-      set_vec3d("axis", axis);
+      doc.vec3d(6, "axis", axis);
     }
 
     if(has_limits(joint) && !(joint.type() == Joint::Type::Rev && is_continuous(joint)))
     {
-      doc << Key << "limits" << Value << BeginMap;
+      doc.map(6, "limits");
       set_limit(joint, "lower", res.limits.lower);
       set_limit(joint, "upper", res.limits.upper);
       set_limit(joint, "velocity", res.limits.velocity);
       set_limit(joint, "effort", res.limits.torque);
-      doc << EndMap;
     }
 
-    doc << EndMap;
+    if(joint.hasActuatorDynamics())
+    {
+      doc.map(6, "dynamics");
+      doc.number(8, "damping", joint.damping());
+      doc.number(8, "friction", joint.friction());
+      if(joint.armature() != 0.)
+      {
+        doc.number(8, "armature", joint.armature());
+      }
+    }
   }
-  doc << EndSeq; // Joints
-
-  doc << EndMap; // Robot
-  doc << EndMap; // Doc
 
-  return std::string(doc.c_str());
+  doc.flush();
 }
 
 } // namespace parsers
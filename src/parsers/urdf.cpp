@@ -6,12 +6,15 @@
 #include <RBDyn/FV.h>
 #include <RBDyn/parsers/urdf.h>
 
+#include "numeric.h"
+
 #include <algorithm>
 #include <ciso646>
 #include <cmath>
 #include <fstream>
 #include <iostream>
-#include <locale>
+#include <memory>
+#include <set>
 #include <streambuf>
 #include <string>
 #include <tinyxml2.h>
@@ -25,22 +28,21 @@ namespace parsers
 double attrToDouble(const tinyxml2::XMLElement & dom, const std::string & attr, double def = 0.0)
 {
   const char * attrTxt = dom.Attribute(attr.c_str());
-  if(attrTxt)
+  double res;
+  if(attrTxt && detail::parseDouble(attrTxt, res))
   {
-    std::stringstream ss;
-    // Every real number in a URDF file needs to be parsed assuming that the
-    // decimal point separator is the period, as specified in XML Schema
-    // definition of xs:double. The call to imbue ensures that a suitable
-    // locale is used, instead of using the current C++ global locale.
-    // Related PR: https://github.com/ros/urdfdom_headers/pull/42 .
-    ss.imbue(std::locale::classic());
-    ss << attrTxt;
-    double res;
-    ss >> res;
-    if(!ss.fail())
-    {
-      return res;
-    }
+    return res;
+  }
+  return def;
+}
+
+double textToDouble(const tinyxml2::XMLElement & dom, double def = 0.0)
+{
+  const char * txt = dom.GetText();
+  double res;
+  if(txt && detail::parseDouble(txt, res))
+  {
+    return res;
   }
   return def;
 }
@@ -49,33 +51,12 @@ std::vector<double> attrToList(const tinyxml2::XMLElement & dom,
                                const std::string & attr,
                                const std::vector<double> & def)
 {
-  std::vector<double> res;
   const char * attrTxt = dom.Attribute(attr.c_str());
   if(attrTxt)
   {
-    std::stringstream ss;
-    // Every real number in a URDF file needs to be parsed assuming that the
-    // decimal point separator is the period, as specified in XML Schema
-    // definition of xs:double. The call to imbue ensures that a suitable
-    // locale is used, instead of using the current C++ global locale.
-    // Related PR: https://github.com/ros/urdfdom_headers/pull/42 .
-    ss.imbue(std::locale::classic());
-    ss << attrTxt;
-    double tmp;
-    while(ss.good())
-    {
-      ss >> tmp;
-      if(!ss.fail())
-      {
-        res.push_back(tmp);
-      }
-    }
-  }
-  else
-  {
-    res = def;
+    return detail::parseList(attrTxt);
   }
-  return res;
+  return def;
 }
 
 Eigen::Vector3d attrToVector(const tinyxml2::XMLElement & dom, const std::string & attr, const Eigen::Vector3d & def)
@@ -247,13 +228,42 @@ bool visualFromTag(const tinyxml2::XMLElement & dom, Visual & out)
   return true;
 }
 
+void geometryFromLink(const tinyxml2::XMLElement & linkDom,
+                      const std::string & linkName,
+                      ParserResult::VisualMap & visual,
+                      ParserResult::VisualMap & collision)
+{
+  // Parse all visual tags. There may be several per link
+  for(const tinyxml2::XMLElement * child = linkDom.FirstChildElement("visual"); child != nullptr;
+      child = child->NextSiblingElement("visual"))
+  {
+    Visual v;
+    if(visualFromTag(*child, v))
+    {
+      visual[linkName].push_back(v);
+    }
+  }
+
+  // Parse all collision tags. There may be several per link
+  for(const tinyxml2::XMLElement * child = linkDom.FirstChildElement("collision"); child != nullptr;
+      child = child->NextSiblingElement("collision"))
+  {
+    Visual v;
+    if(visualFromTag(*child, v))
+    {
+      collision[linkName].push_back(v);
+    }
+  }
+}
+
 std::string parseMultiBodyGraphFromURDF(ParserResult & res,
                                         const std::string & content,
                                         const std::vector<std::string> & filteredLinksIn,
                                         bool transformInertia,
                                         const std::string & baseLinkIn,
                                         bool withVirtualLinks,
-                                        const std::string & sphericalSuffix)
+                                        const std::string & sphericalSuffix,
+                                        GeometryLoading geometry)
 {
   tinyxml2::XMLDocument doc;
   doc.Parse(content.c_str());
@@ -302,6 +312,32 @@ std::string parseMultiBodyGraphFromURDF(ParserResult & res,
 
   std::string baseLink = baseLinkIn == "" ? links[0]->Attribute("name") : baseLinkIn;
 
+  if(geometry == GeometryLoading::Deferred)
+  {
+    // tinyxml2 doesn't give access to the elements position, the source is
+    // kept and only the geometry tags of the parsed links are visited at loading
+    auto source = std::make_shared<const std::string>(content);
+    auto linkNames = std::make_shared<std::set<std::string>>();
+    for(tinyxml2::XMLElement * linkDom : links)
+    {
+      linkNames->insert(linkDom->Attribute("name"));
+    }
+    res.geometry_loader = [source, linkNames](ParserResult::VisualMap & visual, ParserResult::VisualMap & collision) {
+      tinyxml2::XMLDocument doc;
+      doc.Parse(source->c_str());
+      const tinyxml2::XMLElement * robot = doc.FirstChildElement("robot");
+      for(const tinyxml2::XMLElement * linkDom = robot->FirstChildElement("link"); linkDom != nullptr;
+          linkDom = linkDom->NextSiblingElement("link"))
+      {
+        std::string linkName = linkDom->Attribute("name");
+        if(linkNames->count(linkName))
+        {
+          geometryFromLink(*linkDom, linkName, visual, collision);
+        }
+      }
+    };
+  }
+
   for(tinyxml2::XMLElement * linkDom : links)
   {
     std::string linkName = linkDom->Attribute("name");
@@ -336,26 +372,9 @@ std::string parseMultiBodyGraphFromURDF(ParserResult & res,
       }
     }
 
-    // Parse all visual tags. There may be several per link
-    for(tinyxml2::XMLElement * child = linkDom->FirstChildElement("visual"); child != nullptr;
-        child = child->NextSiblingElement("visual"))
+    if(geometry == GeometryLoading::Eager)
     {
-      Visual v;
-      if(visualFromTag(*child, v))
-      {
-        res.visual[linkName].push_back(v);
-      }
-    }
-
-    // Parse all collision tags. There may be several per link
-    for(tinyxml2::XMLElement * child = linkDom->FirstChildElement("collision"); child != nullptr;
-        child = child->NextSiblingElement("collision"))
-    {
-      Visual v;
-      if(visualFromTag(*child, v))
-      {
-        res.collision[linkName].push_back(v);
-      }
+      geometryFromLink(*linkDom, linkName, res.visual, res.collision);
     }
 
     rbd::Body b(mass, com, inertia_o, linkName);
@@ -379,6 +398,34 @@ std::string parseMultiBodyGraphFromURDF(ParserResult & res,
     }
   }
 
+  // Extract the transmissions reduction ratio of each joint
+  std::map<std::string, double> gearRatios;
+  for(tinyxml2::XMLElement * transDom = robot->FirstChildElement("transmission"); transDom != nullptr;
+      transDom = transDom->NextSiblingElement("transmission"))
+  {
+    tinyxml2::XMLElement * transJointDom = transDom->FirstChildElement("joint");
+    if(!transJointDom || !transJointDom->Attribute("name"))
+    {
+      continue;
+    }
+    // mechanicalReduction is a child of actuator in the current format and a
+    // child of transmission in the old one
+    tinyxml2::XMLElement * reductionDom = nullptr;
+    tinyxml2::XMLElement * actuatorDom = transDom->FirstChildElement("actuator");
+    if(actuatorDom)
+    {
+      reductionDom = actuatorDom->FirstChildElement("mechanicalReduction");
+    }
+    if(!reductionDom)
+    {
+      reductionDom = transDom->FirstChildElement("mechanicalReduction");
+    }
+    if(reductionDom)
+    {
+      gearRatios[transJointDom->Attribute("name")] = textToDouble(*reductionDom, 1.0);
+    }
+  }
+
   for(tinyxml2::XMLElement * jointDom : joints)
   {
     std::string jointName = jointDom->Attribute("name");
@@ -422,6 +469,23 @@ std::string parseMultiBodyGraphFromURDF(ParserResult & res,
       j.makeMimic(mimicJoint, attrToDouble(*mimicDom, "multiplier", 1.0), attrToDouble(*mimicDom, "offset"));
     }
 
+    // Actuator dynamics, armature is not part of the URDF specification but is
+    // commonly used to store the reflected rotor inertia
+    tinyxml2::XMLElement * dynamicsDom = jointDom->FirstChildElement("dynamics");
+    double armature = 0.;
+    if(dynamicsDom)
+    {
+      j.damping(attrToDouble(*dynamicsDom, "damping"));
+      j.friction(attrToDouble(*dynamicsDom, "friction"));
+      armature = attrToDouble(*dynamicsDom, "armature");
+    }
+    auto gearRatioIt = gearRatios.find(jointName);
+    if(gearRatioIt != gearRatios.end() && gearRatioIt->second != 0.)
+    {
+      j.gearRatio(gearRatioIt->second);
+    }
+    j.rotorInertia(armature / (j.gearRatio() * j.gearRatio()));
+
     res.mbg.addJoint(j);
 
     res.mbg.linkBodies(jointParent, staticTransform, jointChild, sva::PTransformd::Identity(), jointName);
@@ -469,12 +533,13 @@ ParserResult from_urdf(const std::string & content,
                        bool transformInertia,
                        const std::string & baseLinkIn,
                        bool withVirtualLinks,
-                       const std::string & sphericalSuffix)
+                       const std::string & sphericalSuffix,
+                       GeometryLoading geometry)
 {
   ParserResult res;
 
   std::string baseLink = parseMultiBodyGraphFromURDF(res, content, filteredLinksIn, transformInertia, baseLinkIn,
-                                                     withVirtualLinks, sphericalSuffix);
+                                                     withVirtualLinks, sphericalSuffix, geometry);
 
   res.mb = res.mbg.makeMultiBody(baseLink, fixed);
   res.mbc = rbd::MultiBodyConfig(res.mb);
@@ -492,7 +557,8 @@ ParserResult from_urdf_file(const std::string & file_path,
                             bool transformInertia,
                             const std::string & baseLinkIn,
                             bool withVirtualLinks,
-                            const std::string & sphericalSuffix)
+                            const std::string & sphericalSuffix,
+                            GeometryLoading geometry)
 {
   std::ifstream file(file_path);
   if(!file.is_open())
@@ -500,7 +566,8 @@ ParserResult from_urdf_file(const std::string & file_path,
     throw std::runtime_error("URDF: Can't open " + file_path + " file for reading");
   }
   std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-  return from_urdf(content, fixed, filteredLinksIn, transformInertia, baseLinkIn, withVirtualLinks, sphericalSuffix);
+  return from_urdf(content, fixed, filteredLinksIn, transformInertia, baseLinkIn, withVirtualLinks, sphericalSuffix,
+                   geometry);
 }
 
 } // namespace parsers
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+#include "numeric.h"
+
+#include <ostream>
+#include <string>
+
+namespace rbd
+{
+
+namespace parsers
+{
+
+namespace detail
+{
+
+/**
+ * Buffered text output of the URDF and YAML writers.
+ * The text is accumulated in a buffer that is written to the stream by blocks
+ * and the numbers are written with formatDouble.
+ */
+class TextWriter
+{
+public:
+  TextWriter(std::ostream & out) : out_(out)
+  {
+    buf_.reserve(BlockSize);
+  }
+
+  TextWriter(const TextWriter &) = delete;
+  TextWriter & operator=(const TextWriter &) = delete;
+
+  TextWriter & operator<<(const char * str)
+  {
+    buf_.append(str);
+    return check();
+  }
+
+  TextWriter & operator<<(const std::string & str)
+  {
+    buf_.append(str);
+    return check();
+  }
+
+  TextWriter & operator<<(char c)
+  {
+    buf_.push_back(c);
+    return check();
+  }
+
+  TextWriter & operator<<(double v)
+  {
+    char num[FormatDoubleSize];
+    buf_.append(num, static_cast<std::size_t>(formatDouble(v, num)));
+    return check();
+  }
+
+  /// Write n spaces.
+  TextWriter & indent(std::size_t n)
+  {
+    buf_.append(n, ' ');
+    return *this;
+  }
+
+  /// Write the buffered text to the stream.
+  void flush()
+  {
+    out_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+    buf_.clear();
+  }
+
+private:
+  enum : std::size_t
+  {
+    BlockSize = 1 << 16
+  };
+
+  TextWriter & check()
+  {
+    if(buf_.size() >= BlockSize)
+    {
+      flush();
+    }
+    return *this;
+  }
+
+private:
+  std::ostream & out_;
+  std::string buf_;
+};
+
+} // namespace detail
+
+} // namespace parsers
+
+} // namespace rbd
@@ -6,9 +6,13 @@
 #include <RBDyn/FV.h>
 #include <RBDyn/parsers/yaml.h>
 
+#include "numeric.h"
+
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <sstream>
+#include <yaml-cpp/eventhandler.h>
 #include <yaml-cpp/yaml.h>
 
 #ifndef WIN32
@@ -40,75 +44,514 @@ static inline std::string demangle(const char * name)
 #endif
 }
 
+// spherical suffix of the deferred geometry parser, unused
+const std::string empty_suffix;
+
+// The numbers are read with the locale independent parser of the URDF
+// parser, yaml-cpp is only used for the scalars it can't read (.inf, .nan)
+// and to report the conversion errors
+bool fastDouble(const YAML::Node & node, double & res)
+{
+  return node.IsDefined() && node.IsScalar() && detail::parseDoubleStrict(node.Scalar().c_str(), res);
+}
+
+bool fastList(const YAML::Node & node, std::vector<double> & res)
+{
+  if(!node.IsDefined() || !node.IsSequence())
+  {
+    return false;
+  }
+  res.resize(node.size());
+  std::size_t i = 0;
+  for(const YAML::Node & n : node)
+  {
+    if(!fastDouble(n, res[i++]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+double asDouble(const YAML::Node & node)
+{
+  double res;
+  return fastDouble(node, res) ? res : node.as<double>();
+}
+
+double asDouble(const YAML::Node & node, double def)
+{
+  double res;
+  return fastDouble(node, res) ? res : node.as<double>(def);
+}
+
+std::vector<double> asList(const YAML::Node & node)
+{
+  std::vector<double> res;
+  return fastList(node, res) ? res : node.as<std::vector<double>>();
+}
+
+std::vector<double> asList(const YAML::Node & node, const std::vector<double> & def)
+{
+  std::vector<double> res;
+  return fastList(node, res) ? res : node.as<std::vector<double>>(def);
+}
+
 } // namespace
 
-RBDynFromYAML::RBDynFromYAML(const std::string & input,
-                             ParserInput input_type,
-                             bool fixed,
-                             const std::vector<std::string> & filtered_links,
-                             bool transform_inertia,
-                             const std::string & base_link,
-                             bool with_virtual_links,
-                             const std::string & spherical_suffix)
-: verbose_(false), transform_inertia_(transform_inertia), link_idx_(1), joint_idx_(1), filtered_links_(filtered_links),
-  with_virtual_links_(with_virtual_links), spherical_suffix_(spherical_suffix)
+/**
+ * Build the robot from the parser events.
+ *
+ * Only the link and joint records (and the name and anglesInDegrees values)
+ * are built as YAML::Node, one at a time, and given to parseLink and
+ * parseJoint as soon as they are complete. The other elements are built and
+ * dropped at once, so the memory used is bounded by the biggest record
+ * instead of the whole document.
+ *
+ * The links are parsed once anglesInDegrees is known and the joints once all
+ * the links are parsed, the records that come before are kept until then.
+ */
+class RBDynFromYAML::StreamHandler : public YAML::EventHandler
 {
-  joint_types_ = std::map<std::string, rbd::Joint::Type>{
-      {"revolute", rbd::Joint::Rev},        {"continuous", rbd::Joint::Rev}, {"prismatic", rbd::Joint::Prism},
-      {"spherical", rbd::Joint::Spherical}, {"ball", rbd::Joint::Spherical}, {"free", rbd::Joint::Free},
-      {"fixed", rbd::Joint::Fixed}};
+public:
+  StreamHandler(RBDynFromYAML & parser) : parser_(parser) {}
 
-  YAML::Node config;
-  if(input_type == ParserInput::File)
+  void OnDocumentStart(const YAML::Mark &) override {}
+
+  void OnDocumentEnd() override {}
+
+  void OnNull(const YAML::Mark &, YAML::anchor_t anchor) override
   {
-    config = YAML::LoadFile(input);
+    if(building_.empty())
+    {
+      target_ = structuralTarget(YAML::NodeType::Null, false);
+    }
+    add(YAML::Node(YAML::NodeType::Null), anchor);
   }
-  else
+
+  void OnAlias(const YAML::Mark &, YAML::anchor_t anchor) override
   {
-    config = YAML::Load(input);
+    auto it = anchors_.find(anchor);
+    if(it == anchors_.end())
+    {
+      throw std::runtime_error("YAML: aliases of the robot, links or joints elements are not supported");
+    }
+    if(building_.empty())
+    {
+      target_ = structuralTarget(it->second.Type(), false);
+    }
+    add(it->second, 0);
   }
 
-  YAML::Node robot = config["robot"];
-  if(!robot)
+  void OnScalar(const YAML::Mark &, const std::string & tag, YAML::anchor_t anchor, const std::string & value) override
   {
-    throw std::runtime_error("YAML: missing 'robot' root element");
+    if(building_.empty())
+    {
+      target_ = structuralTarget(YAML::NodeType::Scalar, false);
+    }
+    YAML::Node node(value);
+    node.SetTag(tag);
+    add(node, anchor);
   }
 
-  res.name = robot["name"].as<std::string>();
-  if(verbose_)
+  void OnSequenceStart(const YAML::Mark &,
+                       const std::string & tag,
+                       YAML::anchor_t anchor,
+                       YAML::EmitterStyle::value) override
   {
-    std::cout << "Robot name: " << res.name << std::endl;
+    start(YAML::NodeType::Sequence, tag, anchor);
   }
 
-  YAML::Node links = robot["links"];
-  if(!links)
+  void OnSequenceEnd() override
   {
-    throw std::runtime_error("YAML: missing 'robot->links' element");
+    end();
   }
 
-  YAML::Node angles_in_degrees = robot["anglesInDegrees"];
-  if(!angles_in_degrees)
+  void OnMapStart(const YAML::Mark &,
+                  const std::string & tag,
+                  YAML::anchor_t anchor,
+                  YAML::EmitterStyle::value) override
   {
-    throw std::runtime_error("YAML: missing 'robot->anglesInDegrees: true/false' element");
+    start(YAML::NodeType::Map, tag, anchor);
   }
-  else
+
+  void OnMapEnd() override
   {
-    angles_in_degrees_ = angles_in_degrees.as<bool>();
+    end();
   }
 
-  for(const auto & link : links)
+  /// Check the document and parse the pending records.
+  void finish()
   {
-    parseLink(link);
+    if(!robot_)
+    {
+      throw std::runtime_error("YAML: missing 'robot' root element");
+    }
+    if(!name_)
+    {
+      throw std::runtime_error("YAML: missing 'robot->name' element");
+    }
+    if(!links_)
+    {
+      throw std::runtime_error("YAML: missing 'robot->links' element");
+    }
+    if(!angles_)
+    {
+      throw std::runtime_error("YAML: missing 'robot->anglesInDegrees: true/false' element");
+    }
+    flush();
+    if(!joints_)
+    {
+      throw std::runtime_error("YAML: missing 'robot->joints' element");
+    }
+    flush();
   }
 
-  YAML::Node joints = robot["joints"];
-  if(!joints)
+private:
+  /// Use of a complete node.
+  enum class Target
   {
-    throw std::runtime_error("YAML: missing 'robot->joints' element");
+    /// Opened a structural container, nothing to build.
+    None,
+    Discard,
+    Key,
+    Name,
+    AnglesInDegrees,
+    Links,
+    Joints,
+    Link,
+    Joint
+  };
+
+  /// Structural container (document root map, robot map, links and joints sequences).
+  struct Context
+  {
+    enum Kind
+    {
+      Root,
+      Robot,
+      LinkRecords,
+      JointRecords
+    };
+
+    Kind kind;
+    /// In a map, true if the next node is a value.
+    bool value;
+    std::string key;
+  };
+
+  /// Node being built with its pending map key.
+  struct Building
+  {
+    YAML::Node node;
+    bool hasKey;
+    YAML::Node key;
+  };
+
+private:
+  /**
+   * Find the target of a node that start at the structural level, open the
+   * structural containers.
+   * @param type Node type.
+   * @param container true if the node children events follow (false for an alias).
+   */
+  Target structuralTarget(YAML::NodeType::value type, bool container)
+  {
+    if(contexts_.empty())
+    {
+      if(type == YAML::NodeType::Map && container && !root_)
+      {
+        root_ = true;
+        contexts_.push_back({Context::Root, false, ""});
+        return Target::None;
+      }
+      return Target::Discard;
+    }
+
+    Context & c = contexts_.back();
+    if(c.kind == Context::LinkRecords)
+    {
+      return Target::Link;
+    }
+    if(c.kind == Context::JointRecords)
+    {
+      return Target::Joint;
+    }
+    if(!c.value)
+    {
+      return Target::Key;
+    }
+
+    // the first occurence of a key is used like in a YAML::Node
+    if(c.kind == Context::Root)
+    {
+      if(c.key == "robot" && !robot_)
+      {
+        robot_ = true;
+        if(type != YAML::NodeType::Map)
+        {
+          throw std::runtime_error("YAML: 'robot' root element must be a map");
+        }
+        if(!container)
+        {
+          throw std::runtime_error("YAML: aliases of the robot, links or joints elements are not supported");
+        }
+        contexts_.push_back({Context::Robot, false, ""});
+        return Target::None;
+      }
+      return Target::Discard;
+    }
+
+    if(c.key == "name" && !name_)
+    {
+      name_ = true;
+      return Target::Name;
+    }
+    if(c.key == "anglesInDegrees" && !angles_)
+    {
+      return Target::AnglesInDegrees;
+    }
+    if(c.key == "links" && !links_)
+    {
+      links_ = true;
+      if(type == YAML::NodeType::Sequence && container)
+      {
+        contexts_.push_back({Context::LinkRecords, false, ""});
+        return Target::None;
+      }
+      return Target::Links;
+    }
+    if(c.key == "joints" && !joints_)
+    {
+      joints_ = true;
+      if(type == YAML::NodeType::Sequence && container)
+      {
+        contexts_.push_back({Context::JointRecords, false, ""});
+        return Target::None;
+      }
+      return Target::Joints;
+    }
+    return Target::Discard;
+  }
+
+  void start(YAML::NodeType::value type, const std::string & tag, YAML::anchor_t anchor)
+  {
+    if(building_.empty())
+    {
+      target_ = structuralTarget(type, true);
+      if(target_ == Target::None)
+      {
+        return;
+      }
+    }
+    YAML::Node node(type);
+    node.SetTag(tag);
+    if(anchor != 0)
+    {
+      anchors_[anchor].reset(node);
+    }
+    building_.push_back({node, false, YAML::Node()});
+  }
+
+  void end()
+  {
+    if(building_.empty())
+    {
+      Context::Kind kind = contexts_.back().kind;
+      contexts_.pop_back();
+      if(kind == Context::LinkRecords)
+      {
+        linksDone_ = true;
+        flush();
+      }
+      valueDone();
+      return;
+    }
+    YAML::Node node = building_.back().node;
+    building_.pop_back();
+    add(node, 0);
+  }
+
+  /// Add a complete node to its parent or use it if it is a root.
+  void add(const YAML::Node & node, YAML::anchor_t anchor)
+  {
+    if(anchor != 0)
+    {
+      anchors_[anchor].reset(node);
+    }
+    if(building_.empty())
+    {
+      use(node);
+      return;
+    }
+
+    Building & parent = building_.back();
+    if(parent.node.IsSequence())
+    {
+      parent.node.push_back(node);
+    }
+    else if(!parent.hasKey)
+    {
+      // YAML::Node::operator= would assign the previous key node
+      parent.key.reset(node);
+      parent.hasKey = true;
+    }
+    else
+    {
+      parent.node[parent.key] = node;
+      parent.hasKey = false;
+    }
+  }
+
+  void use(const YAML::Node & node)
+  {
+    switch(target_)
+    {
+      case Target::None:
+      case Target::Discard:
+        break;
+      case Target::Key:
+        contexts_.back().key = node.IsScalar() ? node.Scalar() : "";
+        contexts_.back().value = true;
+        return;
+      case Target::Name:
+        parser_.res.name = node.as<std::string>();
+        if(parser_.verbose_)
+        {
+          std::cout << "Robot name: " << parser_.res.name << std::endl;
+        }
+        break;
+      case Target::AnglesInDegrees:
+        parser_.angles_in_degrees_ = node.as<bool>();
+        angles_ = true;
+        flush();
+        break;
+      case Target::Links:
+        for(const auto & link : node)
+        {
+          pendingLinks_.push_back(link);
+        }
+        linksDone_ = true;
+        flush();
+        break;
+      case Target::Joints:
+        for(const auto & joint : node)
+        {
+          pendingJoints_.push_back(joint);
+        }
+        flush();
+        break;
+      case Target::Link:
+        pendingLinks_.push_back(node);
+        flush();
+        return;
+      case Target::Joint:
+        pendingJoints_.push_back(node);
+        flush();
+        return;
+    }
+    valueDone();
+  }
+
+  /// A value of a structural map is complete.
+  void valueDone()
+  {
+    if(!contexts_.empty())
+    {
+      contexts_.back().value = false;
+    }
+  }
+
+  /// Parse the records that can be parsed.
+  void flush()
+  {
+    if(!angles_)
+    {
+      return;
+    }
+    for(const YAML::Node & link : pendingLinks_)
+    {
+      parser_.parseLink(link);
+    }
+    pendingLinks_.clear();
+    if(linksDone_)
+    {
+      for(const YAML::Node & joint : pendingJoints_)
+      {
+        parser_.parseJoint(joint);
+      }
+      pendingJoints_.clear();
+    }
+  }
+
+private:
+  RBDynFromYAML & parser_;
+  std::vector<Context> contexts_;
+  std::vector<Building> building_;
+  Target target_ = Target::None;
+  std::map<YAML::anchor_t, YAML::Node> anchors_;
+  std::vector<YAML::Node> pendingLinks_;
+  std::vector<YAML::Node> pendingJoints_;
+  bool root_ = false;
+  bool robot_ = false;
+  bool name_ = false;
+  bool angles_ = false;
+  bool links_ = false;
+  bool linksDone_ = false;
+  bool joints_ = false;
+};
+
+RBDynFromYAML::RBDynFromYAML(const std::string & input,
+                             ParserInput input_type,
+                             bool fixed,
+                             const std::vector<std::string> & filtered_links,
+                             bool transform_inertia,
+                             const std::string & base_link,
+                             bool with_virtual_links,
+                             const std::string & spherical_suffix,
+                             GeometryLoading geometry)
+: verbose_(false), transform_inertia_(transform_inertia), link_idx_(1), joint_idx_(1), filtered_links_(filtered_links),
+  with_virtual_links_(with_virtual_links), spherical_suffix_(spherical_suffix), geometry_(geometry),
+  deferred_links_(std::make_shared<std::vector<std::pair<std::string, YAML::Node>>>())
+{
+  joint_types_ = std::map<std::string, rbd::Joint::Type>{
+      {"revolute", rbd::Joint::Rev},        {"continuous", rbd::Joint::Rev}, {"prismatic", rbd::Joint::Prism},
+      {"spherical", rbd::Joint::Spherical}, {"ball", rbd::Joint::Spherical}, {"free", rbd::Joint::Free},
+      {"fixed", rbd::Joint::Fixed}};
+
+  std::ifstream file;
+  std::istringstream description;
+  if(input_type == ParserInput::File)
+  {
+    file.open(input);
+    if(!file.is_open())
+    {
+      throw std::runtime_error("YAML: Can't open " + input + " file for reading");
+    }
   }
-  for(const auto & joint : joints)
+  else
   {
-    parseJoint(joint);
+    description.str(input);
+  }
+
+  YAML::Parser events(input_type == ParserInput::File ? static_cast<std::istream &>(file) : description);
+  StreamHandler handler(*this);
+  events.HandleNextDocument(handler);
+  handler.finish();
+
+  if(geometry_ == GeometryLoading::Deferred)
+  {
+    // the document is already parsed, only the Visual creation is deferred
+    std::shared_ptr<RBDynFromYAML> parser(new RBDynFromYAML(angles_in_degrees_));
+    auto deferred_links = deferred_links_;
+    res.geometry_loader = [parser, deferred_links](ParserResult::VisualMap & visual,
+                                                   ParserResult::VisualMap & collision) {
+      for(const auto & link : *deferred_links)
+      {
+        parser->parseVisuals(link.second["visual"], visual, link.first);
+        parser->parseVisuals(link.second["collision"], collision, link.first);
+      }
+    };
   }
 
   if(!base_link.empty())
@@ -129,6 +572,12 @@ RBDynFromYAML::RBDynFromYAML(const std::string & input,
   rbd::forwardVelocity(res.mb, res.mbc);
 }
 
+RBDynFromYAML::RBDynFromYAML(bool angles_in_degrees)
+: verbose_(false), transform_inertia_(true), angles_in_degrees_(angles_in_degrees), link_idx_(1), joint_idx_(1),
+  with_virtual_links_(true), spherical_suffix_(empty_suffix), geometry_(GeometryLoading::Eager)
+{
+}
+
 Eigen::Matrix3d RBDynFromYAML::makeInertia(double ixx, double iyy, double izz, double iyz, double ixz, double ixy)
 {
   Eigen::Matrix3d inertia;
@@ -157,7 +606,7 @@ void RBDynFromYAML::parseFrame(const YAML::Node & frame,
     auto xyz_node = frame["xyz"];
     if(xyz_node)
     {
-      auto xyz_data = xyz_node.as<std::vector<double>>();
+      auto xyz_data = asList(xyz_node);
       if(xyz_data.size() != 3)
       {
         throw std::runtime_error("YAML: Invalid array size (" + name + "->intertial->frame->xyz");
@@ -170,7 +619,7 @@ void RBDynFromYAML::parseFrame(const YAML::Node & frame,
     auto rpy_node = frame["rpy"];
     if(rpy_node)
     {
-      auto rpy_data = rpy_node.as<std::vector<double>>();
+      auto rpy_data = asList(rpy_node);
       if(rpy_data.size() != 3)
       {
         throw std::runtime_error("YAML: Invalid array size (" + name + "->intertial->frame->rpy");
@@ -193,8 +642,8 @@ void RBDynFromYAML::parseInertia(const YAML::Node & inertia, Eigen::Matrix3d & i
   if(inertia)
   {
     inertia_mat =
-        makeInertia(inertia["Ixx"].as<double>(1.), inertia["Iyy"].as<double>(1.), inertia["Izz"].as<double>(1.),
-                    inertia["Iyz"].as<double>(0.), inertia["Ixz"].as<double>(0.), inertia["Ixy"].as<double>(0.));
+        makeInertia(asDouble(inertia["Ixx"], 1.), asDouble(inertia["Iyy"], 1.), asDouble(inertia["Izz"], 1.),
+                    asDouble(inertia["Iyz"], 0.), asDouble(inertia["Ixz"], 0.), asDouble(inertia["Ixy"], 0.));
   }
 }
 
@@ -211,7 +660,7 @@ void RBDynFromYAML::parseInertial(const YAML::Node & inertial,
   inertia.setZero();
   if(inertial)
   {
-    mass = inertial["mass"].as<double>(mass);
+    mass = asDouble(inertial["mass"], mass);
     parseFrame(inertial["frame"], name, xyz, rpy);
     parseInertia(inertial["inertia"], inertia);
 
@@ -246,7 +695,7 @@ bool RBDynFromYAML::parseGeometry(const YAML::Node & geometry, Geometry & data)
         {
           throw std::runtime_error("YAML: a mesh geometry requires a filename field.");
         }
-        mesh_data.scale = mesh["scale"].as<double>(1.);
+        mesh_data.scale = asDouble(mesh["scale"], 1.);
         has_geometry = true;
         data.data = mesh_data;
       }
@@ -258,7 +707,7 @@ bool RBDynFromYAML::parseGeometry(const YAML::Node & geometry, Geometry & data)
         auto box_data = Geometry::Box();
         try
         {
-          box_data.size = Eigen::Vector3d(box["size"].as<std::vector<double>>().data());
+          box_data.size = Eigen::Vector3d(asList(box["size"]).data());
           if(box_data.size.size() != 3)
           {
             throw std::runtime_error("YAML: Invalid box size, should have 3 components (x, y, z)");
@@ -279,8 +728,8 @@ bool RBDynFromYAML::parseGeometry(const YAML::Node & geometry, Geometry & data)
         auto cylinder_data = Geometry::Cylinder();
         try
         {
-          cylinder_data.radius = cylinder["radius"].as<double>();
-          cylinder_data.length = cylinder["length"].as<double>();
+          cylinder_data.radius = asDouble(cylinder["radius"]);
+          cylinder_data.length = asDouble(cylinder["length"]);
         }
         catch(...)
         {
@@ -297,7 +746,7 @@ bool RBDynFromYAML::parseGeometry(const YAML::Node & geometry, Geometry & data)
         auto sphere_data = Geometry::Sphere();
         try
         {
-          sphere_data.radius = sphere["radius"].as<double>();
+          sphere_data.radius = asDouble(sphere["radius"]);
         }
         catch(...)
         {
@@ -314,13 +763,13 @@ bool RBDynFromYAML::parseGeometry(const YAML::Node & geometry, Geometry & data)
         auto superellipsoid_data = Geometry::Superellipsoid();
         try
         {
-          superellipsoid_data.size = Eigen::Vector3d(superellipsoid["size"].as<std::vector<double>>().data());
+          superellipsoid_data.size = Eigen::Vector3d(asList(superellipsoid["size"]).data());
           if(superellipsoid_data.size.size() != 3)
           {
             throw std::runtime_error("YAML: Invalid superellipsoid size, should have 3 components (x, y, z)");
           }
-          superellipsoid_data.epsilon1 = superellipsoid["epsilon1"].as<double>();
-          superellipsoid_data.epsilon2 = superellipsoid["epsilon2"].as<double>();
+          superellipsoid_data.epsilon1 = asDouble(superellipsoid["epsilon1"]);
+          superellipsoid_data.epsilon2 = asDouble(superellipsoid["epsilon2"]);
         }
         catch(...)
         {
@@ -399,8 +848,15 @@ void RBDynFromYAML::parseLink(const YAML::Node & link)
 
   res.mbg.addBody(rbd::Body(mass, xyz, inertia, name));
 
-  parseVisuals(link["visual"], res.visual, name);
-  parseVisuals(link["collision"], res.collision, name);
+  if(geometry_ == GeometryLoading::Eager)
+  {
+    parseVisuals(link["visual"], res.visual, name);
+    parseVisuals(link["collision"], res.collision, name);
+  }
+  else
+  {
+    deferred_links_->emplace_back(name, link);
+  }
 
   if(verbose_)
   {
@@ -487,7 +943,7 @@ void RBDynFromYAML::parseJointAxis(const YAML::Node & axis, const std::string &
 {
   if(axis)
   {
-    auto axis_data = axis.as<std::vector<double>>();
+    auto axis_data = asList(axis);
     if(axis_data.size() != 3)
     {
       throw std::runtime_error("YAML: Invalid array size (" + name + "->intertial->frame->axis");
@@ -521,21 +977,21 @@ void RBDynFromYAML::parseJointLimits(const YAML::Node & limits,
     {
       if(!is_continuous)
       {
-        lower = limits["lower"].as<std::vector<double>>(lower);
-        upper = limits["upper"].as<std::vector<double>>(upper);
+        lower = asList(limits["lower"], lower);
+        upper = asList(limits["upper"], upper);
       }
-      effort = limits["effort"].as<std::vector<double>>(effort);
-      velocity = limits["velocity"].as<std::vector<double>>(velocity);
+      effort = asList(limits["effort"], effort);
+      velocity = asList(limits["velocity"], velocity);
     }
     else if(dof_count == 1)
     {
       if(!is_continuous)
       {
-        lower[0] = limits["lower"].as<double>(-infinity);
-        upper[0] = limits["upper"].as<double>(infinity);
+        lower[0] = asDouble(limits["lower"], -infinity);
+        upper[0] = asDouble(limits["upper"], infinity);
       }
-      effort[0] = limits["effort"].as<double>(infinity);
-      velocity[0] = limits["velocity"].as<double>(infinity);
+      effort[0] = asDouble(limits["effort"], infinity);
+      velocity[0] = asDouble(limits["velocity"], infinity);
     }
     auto check_limit = [&joint](const std::string & name, const std::vector<double> & limit) {
       if(limit.size() != static_cast<size_t>(joint.dof()))
@@ -566,6 +1022,18 @@ void RBDynFromYAML::parseJointLimits(const YAML::Node & limits,
   res.limits.velocity[name] = velocity;
 }
 
+void RBDynFromYAML::parseJointDynamics(const YAML::Node & dynamics, rbd::Joint & joint)
+{
+  // same actuator dynamics than the URDF dynamics element, armature is given
+  // on the joint side
+  if(dynamics)
+  {
+    joint.damping(asDouble(dynamics["damping"], 0.));
+    joint.friction(asDouble(dynamics["friction"], 0.));
+    joint.rotorInertia(asDouble(dynamics["armature"], 0.) / (joint.gearRatio() * joint.gearRatio()));
+  }
+}
+
 void RBDynFromYAML::parseJoint(const YAML::Node & joint)
 {
   std::string name = joint["name"].as<std::string>("joint" + std::to_string(joint_idx_));
@@ -594,6 +1062,7 @@ void RBDynFromYAML::parseJoint(const YAML::Node & joint)
   rbd::Joint j(type, axis, true, name);
 
   parseJointLimits(joint["limits"], name, j, is_continuous);
+  parseJointDynamics(joint["dynamics"], j);
 
   if(verbose_)
   {
@@ -634,10 +1103,11 @@ ParserResult from_yaml(const std::string & content,
                        bool transformInertia,
                        const std::string & baseLinkIn,
                        bool withVirtualLinks,
-                       const std::string & sphericalSuffix)
+                       const std::string & sphericalSuffix,
+                       GeometryLoading geometry)
 {
   return RBDynFromYAML(content, ParserInput::Description, fixed, filteredLinksIn, transformInertia, baseLinkIn,
-                       withVirtualLinks, sphericalSuffix)
+                       withVirtualLinks, sphericalSuffix, geometry)
       .result();
 }
 
@@ -647,10 +1117,11 @@ ParserResult from_yaml_file(const std::string & file_path,
                             bool transformInertia,
                             const std::string & baseLinkIn,
                             bool withVirtualLinks,
-                            const std::string & sphericalSuffix)
+                            const std::string & sphericalSuffix,
+                            GeometryLoading geometry)
 {
   return RBDynFromYAML(file_path, ParserInput::File, fixed, filteredLinksIn, transformInertia, baseLinkIn,
-                       withVirtualLinks, sphericalSuffix)
+                       withVirtualLinks, sphericalSuffix, geometry)
       .result();
 }
 
@@ -15,15 +15,20 @@
 #include <SpaceVecAlg/SpaceVecAlg>
 
 // RBDyn
+#include "RBDyn/BatchAlgorithms.h"
 #include "RBDyn/Body.h"
+#include "RBDyn/CoM.h"
+#include "RBDyn/ComputationGraph.h"
 #include "RBDyn/EulerIntegration.h"
 #include "RBDyn/FA.h"
+#include "RBDyn/FD.h"
 #include "RBDyn/FK.h"
 #include "RBDyn/FV.h"
 #include "RBDyn/ID.h"
 #include "RBDyn/IK.h"
 #include "RBDyn/Jacobian.h"
 #include "RBDyn/Joint.h"
+#include "RBDyn/Momentum.h"
 #include "RBDyn/MultiBody.h"
 #include "RBDyn/MultiBodyConfig.h"
 #include "RBDyn/MultiBodyGraph.h"
@@ -663,3 +668,283 @@ BOOST_AUTO_TEST_CASE(FailureIKTest)
   ik.max_iterations_ = 40;
   BOOST_CHECK(ik.inverseKinematics(mb, mbc, reachable_target));
 }
+
+BOOST_AUTO_TEST_CASE(BatchIKTest)
+{
+  using namespace Eigen;
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+
+  std::tie(mb, mbc, mbg) = makeXYZarm();
+
+  const int nrProblems = 50;
+  std::vector<sva::PTransformd> targets;
+  for(int i = 0; i < nrProblems; ++i)
+  {
+    rbd::vectorToParam(Eigen::VectorXd::Random(mb.nrParams()), mbc.q);
+    rbd::forwardKinematics(mb, mbc);
+    targets.push_back(mbc.bodyPosW[3]);
+  }
+  // last target is outside the reach of the arm
+  targets.back() = sva::PTransformd(sva::RotX(rbd::PI / 2), Eigen::Vector3d(0., 0.5, 2.5));
+
+  Eigen::MatrixXd seeds = Eigen::MatrixXd::Zero(mb.nrParams(), nrProblems);
+  for(int i = 0; i < nrProblems; ++i)
+  {
+    seeds.col(i).setConstant(0.01 * i);
+  }
+
+  rbd::InverseKinematics ik(mb, 3);
+  for(int nrThreads : {1, 4})
+  {
+    rbd::BatchInverseKinematics batch(mb, 3, nrThreads);
+    batch.chunk_size_ = 3;
+    BOOST_CHECK_EQUAL(batch.nrThreads(), nrThreads);
+    BOOST_CHECK_EQUAL(batch.sInverseKinematics(mb, targets, seeds), nrProblems - 1);
+    BOOST_CHECK_EQUAL(batch.q().cols(), nrProblems);
+
+    // each problem must give the same result than the serial solver
+    for(int i = 0; i < nrProblems; ++i)
+    {
+      rbd::vectorToParam(seeds.col(i), mbc.q);
+      bool converged = ik.inverseKinematics(mb, mbc, targets[static_cast<std::size_t>(i)]);
+      BOOST_CHECK_EQUAL(batch.converged()(i), converged);
+      BOOST_CHECK_EQUAL(batch.iterations()(i), ik.iterations());
+      BOOST_CHECK_SMALL((batch.q().col(i) - rbd::paramToVector(mb, mbc.q)).norm(), TOL);
+    }
+
+    // a single seed is shared by every problem
+    batch.inverseKinematics(mb, targets, seeds.col(0));
+    rbd::vectorToParam(seeds.col(0), mbc.q);
+    ik.inverseKinematics(mb, mbc, targets[1]);
+    BOOST_CHECK_SMALL((batch.q().col(1) - rbd::paramToVector(mb, mbc.q)).norm(), TOL);
+  }
+
+  rbd::BatchInverseKinematics batch(mb, 3, 2);
+  BOOST_CHECK_THROW(batch.sInverseKinematics(mb, targets, Eigen::MatrixXd::Zero(mb.nrParams() + 1, 1)),
+                    std::domain_error);
+  BOOST_CHECK_THROW(batch.sInverseKinematics(mb, targets, Eigen::MatrixXd::Zero(mb.nrParams(), 2)),
+                    std::domain_error);
+
+  // seeds that match another MultiBody are rejected
+  rbd::MultiBody mbOther;
+  std::tie(mbOther, mbc, mbg) = makeXYZSarm();
+  BOOST_CHECK_THROW(batch.sInverseKinematics(mbOther, targets, Eigen::MatrixXd::Zero(mbOther.nrParams(), 1)),
+                    std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(BatchAlgorithmsTest)
+{
+  using namespace Eigen;
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+
+  std::tie(mb, mbc, mbg) = makeXYZSarm();
+
+  const int nrS = 37;
+  MatrixXd q(mb.nrParams(), nrS);
+  MatrixXd alpha = MatrixXd::Random(mb.nrDof(), nrS);
+  MatrixXd alphaD = MatrixXd::Random(mb.nrDof(), nrS);
+  for(int s = 0; s < nrS; ++s)
+  {
+    rbd::vectorToParam(VectorXd::Random(mb.nrParams()), mbc.q);
+    for(std::size_t i = 0; i < mbc.q.size(); ++i)
+    {
+      if(mbc.q[i].size() == 4)
+      {
+        Map<Vector4d>(mbc.q[i].data()).normalize();
+      }
+    }
+    rbd::paramToVector(mbc.q, q.col(s));
+  }
+
+  rbd::Jacobian jac(mb, "b4", Vector3d(0.1, 0.2, 0.3));
+  rbd::InverseDynamics id(mb);
+  rbd::ForwardDynamics fd(mb);
+  mbc.gravity = Vector3d(0., 0., 9.81);
+
+  for(int nrThreads : {1, 4})
+  {
+    rbd::BatchAlgorithms batch(mb, nrThreads);
+    batch.chunk_size_ = 5;
+    batch.gravity_ = mbc.gravity;
+    BOOST_CHECK_EQUAL(batch.nrThreads(), nrThreads);
+
+    MatrixXd bodyPosW(16 * mb.nrBodies(), nrS);
+    MatrixXd bodyVelW(6 * mb.nrBodies(), nrS);
+    MatrixXd torque(mb.nrDof(), nrS);
+    MatrixXd fdAlphaD(mb.nrDof(), nrS);
+    MatrixXd jacobians(6 * jac.dof(), nrS);
+    batch.sForwardKinematics(mb, q, bodyPosW);
+    batch.sForwardVelocity(mb, q, alpha, bodyVelW);
+    batch.sInverseDynamics(mb, q, alpha, alphaD, torque);
+    batch.sForwardDynamics(mb, q, alpha, torque, fdAlphaD);
+    batch.sJacobian(mb, jac, q, jacobians);
+
+    // each sample must give the same result than the serial algorithms
+    for(int s = 0; s < nrS; ++s)
+    {
+      rbd::vectorToParam(q.col(s), mbc.q);
+      rbd::vectorToParam(alpha.col(s), mbc.alpha);
+      rbd::vectorToParam(alphaD.col(s), mbc.alphaD);
+      rbd::forwardKinematics(mb, mbc);
+      rbd::forwardVelocity(mb, mbc);
+      id.inverseDynamics(mb, mbc);
+
+      for(int i = 0; i < mb.nrBodies(); ++i)
+      {
+        Map<const Matrix<double, 4, 4, RowMajor>> H(bodyPosW.col(s).data() + 16 * i);
+        const sva::PTransformd & X = mbc.bodyPosW[static_cast<std::size_t>(i)];
+        BOOST_CHECK_SMALL((H.topLeftCorner<3, 3>() - X.rotation().transpose()).norm(), TOL);
+        BOOST_CHECK_SMALL((H.topRightCorner<3, 1>() - X.translation()).norm(), TOL);
+        BOOST_CHECK_SMALL((H.row(3) - RowVector4d(0., 0., 0., 1.)).norm(), TOL);
+        BOOST_CHECK_SMALL(
+            (bodyVelW.col(s).segment<6>(6 * i) - mbc.bodyVelW[static_cast<std::size_t>(i)].vector()).norm(), TOL);
+      }
+      BOOST_CHECK_SMALL((torque.col(s) - rbd::dofToVector(mb, mbc.jointTorque)).norm(), TOL);
+      Map<const Matrix<double, 6, Dynamic, RowMajor>> J(jacobians.col(s).data(), 6, jac.dof());
+      BOOST_CHECK_SMALL((J - jac.jacobian(mb, mbc)).norm(), TOL);
+
+      // forward dynamics of the inverse dynamics torque give back alphaD
+      fd.forwardDynamics(mb, mbc);
+      BOOST_CHECK_SMALL((fdAlphaD.col(s) - alphaD.col(s)).norm(), 1e-6);
+      BOOST_CHECK_SMALL((fdAlphaD.col(s) - rbd::dofToVector(mb, mbc.alphaD)).norm(), TOL);
+    }
+  }
+
+  rbd::BatchAlgorithms batch(mb, 2);
+  MatrixXd torque(mb.nrDof(), nrS);
+  MatrixXd jacobians(6 * jac.dof(), nrS);
+  BOOST_CHECK_THROW(batch.sInverseDynamics(mb, q.leftCols(nrS - 1), alpha, alphaD, torque), std::domain_error);
+  BOOST_CHECK_THROW(batch.sInverseDynamics(mb, q, alpha.topRows(2), alphaD, torque), std::domain_error);
+  BOOST_CHECK_THROW(batch.sForwardKinematics(mb, q, torque), std::domain_error);
+  BOOST_CHECK_THROW(batch.sJacobian(mb, rbd::Jacobian(), q, jacobians), std::domain_error);
+
+  // samples that match another MultiBody are rejected
+  rbd::MultiBody mbFree;
+  rbd::MultiBodyConfig mbcFree;
+  std::tie(mbFree, mbcFree, mbg) = makeXYZSarm(false);
+  MatrixXd qFree = MatrixXd::Zero(mbFree.nrParams(), nrS);
+  MatrixXd bodyPosWFree(16 * mbFree.nrBodies(), nrS);
+  BOOST_CHECK_THROW(batch.sForwardKinematics(mbFree, qFree, bodyPosWFree), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(ComputationGraphTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+  typedef ComputationGraph::Quantity Quantity;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZSarm(false);
+
+  ComputationGraph graph(mb);
+  int jac3 = graph.sAddJacobian(mb, "b3", Vector3d(0.1, 0.2, 0.));
+  int jac4 = graph.sAddJacobian(mb, "b4");
+  graph.require(Quantity::CentroidalMomentumMatrix);
+  graph.require(Quantity::CentroidalMomentumMatrixDot);
+  graph.require(Quantity::InertiaMatrix);
+  graph.require(Quantity::Jacobians);
+  graph.require(Quantity::CoMJacobian);
+
+  // prerequisites are required, the other quantities are not
+  BOOST_CHECK(graph.required(Quantity::Kinematics));
+  BOOST_CHECK(graph.required(Quantity::Velocity));
+  BOOST_CHECK(graph.required(Quantity::CoM));
+  BOOST_CHECK(graph.required(Quantity::CoMVelocity));
+  BOOST_CHECK(!graph.required(Quantity::Acceleration));
+  BOOST_CHECK(!graph.required(Quantity::NonLinearEffects));
+  BOOST_CHECK(!graph.required(Quantity::JacobianDots));
+  BOOST_CHECK(!graph.required(Quantity::CoMJacobianDot));
+
+  Jacobian jac3Ref(mb, "b3", Vector3d(0.1, 0.2, 0.));
+  Jacobian jac4Ref(mb, "b4");
+  CoMJacobian comJacRef(mb);
+  CentroidalMomentumMatrix cmmRef(mb);
+  ForwardDynamics fdRef(mb);
+  MultiBodyConfig mbcRef(mbc);
+  for(int iter = 1; iter <= 3; ++iter)
+  {
+    VectorXd q = VectorXd::Random(mb.nrParams());
+    q.head<4>().normalize();
+    Map<Vector4d>(&q(mb.jointPosInParam(mb.jointIndexByName("j3")))).normalize();
+    vectorToParam(q, mbc.q);
+    mbc.alpha = vectorToDof(mb, VectorXd::Random(mb.nrDof()));
+    mbcRef.q = mbc.q;
+    mbcRef.alpha = mbc.alpha;
+
+    graph.sCompute(mb, mbc);
+
+    forwardKinematics(mb, mbcRef);
+    forwardVelocity(mb, mbcRef);
+    Vector3d com = computeCoM(mb, mbcRef);
+    Vector3d comVel = computeCoMVelocity(mb, mbcRef);
+    cmmRef.computeMatrixAndMatrixDot(mb, mbcRef, com, comVel);
+    fdRef.computeH(mb, mbcRef);
+
+    for(int i = 0; i < mb.nrBodies(); ++i)
+    {
+      BOOST_CHECK_SMALL((mbc.bodyPosW[i].matrix() - mbcRef.bodyPosW[i].matrix()).norm(), TOL);
+      BOOST_CHECK_SMALL((mbc.bodyVelB[i] - mbcRef.bodyVelB[i]).vector().norm(), TOL);
+    }
+    BOOST_CHECK_SMALL((graph.com() - com).norm(), TOL);
+    BOOST_CHECK_SMALL((graph.comVelocity() - comVel).norm(), TOL);
+    BOOST_CHECK_SMALL((graph.comJacobian() - comJacRef.jacobian(mb, mbcRef)).norm(), TOL);
+    BOOST_CHECK_SMALL((graph.centroidalMomentumMatrix() - cmmRef.matrix()).norm(), TOL);
+    BOOST_CHECK_SMALL((graph.centroidalMomentumMatrixDot() - cmmRef.matrixDot()).norm(), TOL);
+    BOOST_CHECK_SMALL((graph.H() - fdRef.H()).norm(), TOL);
+    BOOST_CHECK_SMALL((graph.jacobian(jac3) - jac3Ref.jacobian(mb, mbcRef)).norm(), TOL);
+    BOOST_CHECK_SMALL((graph.jacobian(jac4) - jac4Ref.jacobian(mb, mbcRef)).norm(), TOL);
+    BOOST_CHECK(graph.jacobianObject(jac4).jointsPath() == jac4Ref.jointsPath());
+
+    // each required quantity is evaluated once per compute
+    BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::Kinematics), iter);
+    BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::CoM), iter);
+    BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::NonLinearEffects), 0);
+    BOOST_CHECK_GE(graph.duration(Quantity::InertiaMatrix), 0.);
+    BOOST_CHECK_EQUAL(graph.duration(Quantity::NonLinearEffects), 0.);
+
+    // nothing changed since the last compute, no quantity is evaluated
+    graph.sCompute(mb, mbc);
+    BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::Kinematics), iter);
+    BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::CentroidalMomentumMatrixDot), iter);
+    BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::Jacobians), iter);
+  }
+
+  // only the quantities that depend on the velocity are evaluated
+  mbc.alpha[1][0] += 0.1;
+  graph.sCompute(mb, mbc);
+  BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::Kinematics), 3);
+  BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::InertiaMatrix), 3);
+  BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::Velocity), 4);
+  BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::CentroidalMomentumMatrixDot), 4);
+  mbcRef.alpha = mbc.alpha;
+  forwardVelocity(mb, mbcRef);
+  cmmRef.computeMatrixAndMatrixDot(mb, mbcRef, computeCoM(mb, mbcRef), computeCoMVelocity(mb, mbcRef));
+  BOOST_CHECK_SMALL((graph.centroidalMomentumMatrixDot() - cmmRef.matrixDot()).norm(), TOL);
+
+  // NonLinearEffects read force and gravity that have no stamp, it is always evaluated
+  graph.require(Quantity::NonLinearEffects);
+  graph.sCompute(mb, mbc);
+  graph.sCompute(mb, mbc);
+  BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::NonLinearEffects), 2);
+  BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::Velocity), 4);
+
+  // a new jacobian is computed even if the state didn't change
+  int jac5 = graph.sAddJacobian(mb, "b4", Vector3d(0., 0.1, 0.));
+  graph.sCompute(mb, mbc);
+  BOOST_CHECK_EQUAL(graph.nrEvaluations(Quantity::Jacobians), 4);
+  Jacobian jac5Ref(mb, "b4", Vector3d(0., 0.1, 0.));
+  BOOST_CHECK_SMALL((graph.jacobian(jac5) - jac5Ref.jacobian(mb, mbc)).norm(), TOL);
+
+  MultiBody mbFixed;
+  MultiBodyConfig mbcFixed;
+  std::tie(mbFixed, mbcFixed, mbg) = makeXYZSarm();
+  BOOST_CHECK_THROW(graph.sCompute(mbFixed, mbcFixed), std::domain_error);
+  BOOST_CHECK_THROW(graph.sCompute(mb, mbcFixed), std::domain_error);
+}
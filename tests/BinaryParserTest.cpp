@@ -0,0 +1,289 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// boost
+#define BOOST_TEST_MODULE BinaryParserTest
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+// RBDyn parsers
+#include <RBDyn/parsers/binary.h>
+#include <RBDyn/parsers/yaml.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+// Test utilties
+#include "ParsersTestUtils.h"
+
+namespace
+{
+
+void checkEqual(const rbd::parsers::ParserResult & r1, const rbd::parsers::ParserResult & r2)
+{
+  BOOST_CHECK_EQUAL(r1.name, r2.name);
+
+  BOOST_REQUIRE_EQUAL(r1.mb.nrBodies(), r2.mb.nrBodies());
+  BOOST_CHECK_EQUAL(r1.mb.nrParams(), r2.mb.nrParams());
+  BOOST_CHECK_EQUAL(r1.mb.nrDof(), r2.mb.nrDof());
+  BOOST_CHECK(r1.mb.predecessors() == r2.mb.predecessors());
+  BOOST_CHECK(r1.mb.successors() == r2.mb.successors());
+  BOOST_CHECK(r1.mb.parents() == r2.mb.parents());
+  for(int i = 0; i < r1.mb.nrBodies(); ++i)
+  {
+    const auto & b1 = r1.mb.body(i);
+    const auto & b2 = r2.mb.body(i);
+    BOOST_CHECK_EQUAL(b1.name(), b2.name());
+    BOOST_CHECK_EQUAL(b1.inertia().mass(), b2.inertia().mass());
+    BOOST_CHECK_EQUAL(b1.inertia().momentum(), b2.inertia().momentum());
+    BOOST_CHECK_EQUAL(b1.inertia().inertia(), b2.inertia().inertia());
+
+    const auto & j1 = r1.mb.joint(i);
+    const auto & j2 = r2.mb.joint(i);
+    BOOST_CHECK_EQUAL(j1.name(), j2.name());
+    BOOST_CHECK_EQUAL(j1.type(), j2.type());
+    BOOST_CHECK_EQUAL(j1.direction(), j2.direction());
+    BOOST_CHECK_EQUAL(j1.motionSubspace(), j2.motionSubspace());
+    BOOST_CHECK_EQUAL(j1.isMimic(), j2.isMimic());
+    BOOST_CHECK_EQUAL(j1.mimicName(), j2.mimicName());
+    BOOST_CHECK_EQUAL(r1.mb.transform(i), r2.mb.transform(i));
+  }
+
+  BOOST_CHECK(r1.mbc.q == r2.mbc.q);
+  BOOST_CHECK_EQUAL(r1.mbc.gravity, r2.mbc.gravity);
+
+  BOOST_CHECK(r1.limits.lower == r2.limits.lower);
+  BOOST_CHECK(r1.limits.upper == r2.limits.upper);
+  BOOST_CHECK(r1.limits.velocity == r2.limits.velocity);
+  BOOST_CHECK(r1.limits.torque == r2.limits.torque);
+
+  BOOST_CHECK(r1.visual == r2.visual);
+  BOOST_CHECK(r1.collision == r2.collision);
+
+  // the graph must generate the same MultiBody
+  BOOST_REQUIRE_EQUAL(r1.mbg.nrNodes(), r2.mbg.nrNodes());
+  BOOST_REQUIRE_EQUAL(r1.mbg.nrJoints(), r2.mbg.nrJoints());
+  BOOST_CHECK_EQUAL(r1.mbg.rootJointName(), r2.mbg.rootJointName());
+  const std::string & root = r1.mb.body(0).name();
+  rbd::MultiBody mb1 = rbd::MultiBodyGraph(r1.mbg).makeMultiBody(root, false);
+  rbd::MultiBody mb2 = rbd::MultiBodyGraph(r2.mbg).makeMultiBody(root, false);
+  BOOST_REQUIRE_EQUAL(mb1.nrBodies(), mb2.nrBodies());
+  for(int i = 0; i < mb1.nrBodies(); ++i)
+  {
+    BOOST_CHECK_EQUAL(mb1.body(i).name(), mb2.body(i).name());
+    BOOST_CHECK_EQUAL(mb1.joint(i).name(), mb2.joint(i).name());
+    BOOST_CHECK_EQUAL(mb1.transform(i), mb2.transform(i));
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(BinaryRoundTripTest)
+{
+  auto robot = rbd::parsers::from_yaml(XYZSarmYaml);
+  robot.mb.addFrame("tool", 3, sva::PTransformd(Eigen::Vector3d(0.1, 0.2, 0.3)));
+  robot.mbc.gravity = Eigen::Vector3d(0., 0., 9.81);
+
+  auto robot2 = rbd::parsers::from_binary(rbd::parsers::to_binary(robot));
+  checkEqual(robot, robot2);
+  // the forward kinematics is computed at loading
+  for(int i = 0; i < robot.mb.nrBodies(); ++i)
+  {
+    BOOST_CHECK_EQUAL(robot.mbc.bodyPosW[i], robot2.mbc.bodyPosW[i]);
+  }
+  BOOST_REQUIRE(robot2.mb.hasFrame("tool"));
+  BOOST_CHECK_EQUAL(robot2.mb.frame(robot2.mb.frameIndexByName("tool")).body, 3);
+
+  // visuals of all the geometry types
+  auto created = createRobot();
+  checkEqual(created, rbd::parsers::from_binary(rbd::parsers::to_binary(created)));
+
+  // file
+  auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.rbdbin");
+  rbd::parsers::to_binary_file(robot, path.string());
+  checkEqual(robot, rbd::parsers::from_binary_file(path.string()));
+  boost::filesystem::remove(path);
+
+  // invalid contents
+  std::string bin = rbd::parsers::to_binary(robot);
+  BOOST_CHECK_THROW(rbd::parsers::from_binary(bin.substr(0, bin.size() - 1)), std::runtime_error);
+  BOOST_CHECK_THROW(rbd::parsers::from_binary(XYZSarmYaml), std::runtime_error);
+  bin[8] = 42;
+  BOOST_CHECK_THROW(rbd::parsers::from_binary(bin), std::runtime_error);
+
+  // joint params and dof that don't match the joint type
+  auto badParams = robot;
+  badParams.mbc.q[2].clear();
+  BOOST_CHECK_THROW(rbd::parsers::from_binary(rbd::parsers::to_binary(badParams)), std::runtime_error);
+  badParams = robot;
+  badParams.mbc.alpha[4].push_back(0.);
+  BOOST_CHECK_THROW(rbd::parsers::from_binary(rbd::parsers::to_binary(badParams)), std::runtime_error);
+
+  // invalid frames are reported as a corrupted file
+  auto frames = robot;
+  frames.mb.addFrame("toolA", 2, sva::PTransformd::Identity());
+  frames.mb.addFrame("toolB", 2, sva::PTransformd::Identity());
+  bin = rbd::parsers::to_binary(frames);
+  std::size_t pos = bin.find("toolB");
+  BOOST_REQUIRE(pos != std::string::npos);
+  bin[pos + 4] = 'A';
+  BOOST_CHECK_THROW(rbd::parsers::from_binary(bin), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryCacheTest)
+{
+  namespace fs = boost::filesystem;
+  fs::path dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directory(dir);
+  fs::path model = dir / "XYZSarm.yaml";
+  auto writeModel = [&model](const std::string & content) {
+    std::ofstream ofs(model.string());
+    ofs << content;
+  };
+  auto nrCacheEntries = [&dir]() {
+    int nr = 0;
+    for(fs::directory_iterator it(dir); it != fs::directory_iterator(); ++it)
+    {
+      nr += it->path().extension() == ".rbdbin" ? 1 : 0;
+    }
+    return nr;
+  };
+
+  writeModel(XYZSarmYaml);
+  auto robot = rbd::parsers::from_file_cached(model.string(), dir.string());
+  BOOST_CHECK_EQUAL(nrCacheEntries(), 1);
+  checkEqual(robot, rbd::parsers::from_yaml(XYZSarmYaml));
+
+  // second loading use the cache
+  auto cached = rbd::parsers::from_file_cached(model.string(), dir.string());
+  BOOST_CHECK_EQUAL(nrCacheEntries(), 1);
+  checkEqual(robot, cached);
+
+  // other parameters or content create a new entry
+  auto floating = rbd::parsers::from_file_cached(model.string(), dir.string(), false);
+  BOOST_CHECK_EQUAL(nrCacheEntries(), 2);
+  BOOST_CHECK_EQUAL(floating.mb.joint(0).type(), rbd::Joint::Free);
+
+  std::string renamed = XYZSarmYaml;
+  renamed.replace(renamed.find("XYZSarm"), 7, "XYZSarm2");
+  writeModel(renamed);
+  BOOST_CHECK_EQUAL(rbd::parsers::from_file_cached(model.string(), dir.string()).name, "XYZSarm2");
+  BOOST_CHECK_EQUAL(nrCacheEntries(), 3);
+
+  // a corrupted entry is detected and replaced
+  fs::path entry;
+  for(fs::directory_iterator it(dir); it != fs::directory_iterator(); ++it)
+  {
+    if(it->path().extension() == ".rbdbin" && rbd::parsers::from_binary_file(it->path().string()).name == "XYZSarm2")
+    {
+      entry = it->path();
+    }
+  }
+  BOOST_REQUIRE(!entry.empty());
+  auto readEntry = [&entry]() {
+    std::ifstream ifs(entry.string(), std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  };
+  std::string bin = readEntry();
+  const rbd::MultiBody & mb = robot.mb;
+  const int last = mb.nrBodies() - 1;
+  std::int32_t link[3] = {mb.predecessor(last), mb.successor(last), mb.parent(last)};
+  std::size_t pos = bin.find(std::string(reinterpret_cast<const char *>(link), sizeof(link)));
+  BOOST_REQUIRE(pos != std::string::npos);
+  for(std::int32_t succ : {mb.nrBodies(), -1})
+  {
+    std::memcpy(&bin[pos + sizeof(std::int32_t)], &succ, sizeof(succ));
+    {
+      std::ofstream ofs(entry.string(), std::ios::binary);
+      ofs << bin;
+    }
+    BOOST_CHECK_THROW(rbd::parsers::from_binary_file(entry.string()), std::runtime_error);
+    BOOST_CHECK_EQUAL(rbd::parsers::from_file_cached(model.string(), dir.string()).name, "XYZSarm2");
+    BOOST_CHECK_NO_THROW(rbd::parsers::from_binary_file(entry.string()));
+  }
+  BOOST_CHECK_EQUAL(nrCacheEntries(), 3);
+
+  // the cache is best effort
+  auto noCache = rbd::parsers::from_file_cached(model.string(), (dir / "missing").string());
+  BOOST_CHECK_EQUAL(noCache.name, "XYZSarm2");
+
+  fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(FromFilesTest)
+{
+  namespace fs = boost::filesystem;
+  fs::path dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directory(dir);
+
+  std::vector<std::string> paths;
+  for(int i = 0; i < 5; ++i)
+  {
+    std::string content = XYZSarmYaml;
+    content.replace(content.find("XYZSarm"), 7, "XYZSarm" + std::to_string(i));
+    paths.push_back((dir / ("XYZSarm" + std::to_string(i) + ".yaml")).string());
+    std::ofstream ofs(paths.back());
+    ofs << content;
+  }
+
+  auto robots = rbd::parsers::from_files(paths, 3);
+  BOOST_REQUIRE_EQUAL(robots.size(), paths.size());
+  for(std::size_t i = 0; i < robots.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(robots[i].name, "XYZSarm" + std::to_string(i));
+  }
+
+  // the deferred geometry is loaded before the serialization
+  auto deferred = rbd::parsers::from_files(paths, 1, true, {}, true, "", true, "_spherical",
+                                           rbd::parsers::GeometryLoading::Deferred);
+  BOOST_CHECK(deferred[0].geometry_deferred());
+  auto loaded = rbd::parsers::from_binary(rbd::parsers::to_binary(deferred[0]));
+  checkEqual(loaded, robots[0]);
+
+  fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(FileVariantsTest)
+{
+  namespace fs = boost::filesystem;
+  fs::path dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directory(dir);
+
+  auto robot = rbd::parsers::from_yaml(XYZSarmYaml);
+  auto path = [&dir](int i) {
+    return (dir / ("variant" + std::to_string(i) + (i % 2 ? ".rbdbin" : ".yaml"))).string();
+  };
+  auto scale = [](int i) { return 1. + 0.1 * i; };
+
+  const int nrVariants = 6;
+  rbd::parsers::to_file_variants(
+      robot, nrVariants,
+      [&scale](int i, rbd::parsers::ParserResult & variant) {
+        int index = variant.mb.bodyIndexByName("b1");
+        const sva::RBInertiad & I = variant.mb.body(index).inertia();
+        double s = scale(i);
+        variant.mb.body(index, rbd::Body(sva::RBInertiad(s * I.mass(), s * I.momentum(), s * I.inertia()), "b1"));
+      },
+      path, 3);
+
+  std::vector<std::string> paths;
+  for(int i = 0; i < nrVariants; ++i)
+  {
+    paths.push_back(path(i));
+  }
+  auto variants = rbd::parsers::from_files(paths);
+  const auto & b1 = robot.mb.body(robot.mb.bodyIndexByName("b1"));
+  for(int i = 0; i < nrVariants; ++i)
+  {
+    const auto & v = variants[static_cast<std::size_t>(i)];
+    BOOST_CHECK_EQUAL(v.mb.body(v.mb.bodyIndexByName("b1")).inertia().mass(), scale(i) * b1.inertia().mass());
+    BOOST_CHECK_EQUAL(v.mb.body(v.mb.bodyIndexByName("b2")).inertia().mass(),
+                      robot.mb.body(robot.mb.bodyIndexByName("b2")).inertia().mass());
+  }
+
+  BOOST_CHECK_THROW(rbd::parsers::to_file(robot, (dir / "robot.txt").string()), std::runtime_error);
+
+  fs::remove_all(dir);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+#pragma once
+
+// includes
+// std
+#include <string>
+#include <tuple>
+#include <vector>
+
+// RBDyn
+#include "RBDyn/Body.h"
+#include "RBDyn/Joint.h"
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/MultiBodyConfig.h"
+#include "RBDyn/MultiBodyGraph.h"
+
+// arm
+#include "Tree30Dof.h"
+#include "XYZSarm.h"
+
+/// Model used to check the code generated by rbd::generateCode.
+struct CodeGenModel
+{
+  std::string nameSpace;
+  rbd::MultiBody mb;
+  std::vector<std::string> jacobianBodies;
+};
+
+/// @return A chain with all the joint types, backward joints and offset transforms.
+rbd::MultiBody makeAllJointsChain()
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBodyGraph mbg;
+
+  const std::vector<Joint> joints = {{Joint::Free, true, "j0"},
+                                     {Joint::Rev, Vector3d(1., 2., 3.).normalized(), false, "j1"},
+                                     {Joint::Prism, Vector3d(0., 1., 1.).normalized(), true, "j2"},
+                                     {Joint::Spherical, false, "j3"},
+                                     {Joint::Fixed, true, "j4"},
+                                     {Joint::Planar, true, "j5"},
+                                     {Joint::Cylindrical, Vector3d::UnitY(), true, "j6"},
+                                     {Joint::RevZ, true, "j7"}};
+
+  for(std::size_t i = 0; i <= joints.size(); ++i)
+  {
+    const double mass = 1. + 0.1 * static_cast<double>(i);
+    Matrix3d I(Vector3d(0.1, 0.2, 0.3).asDiagonal());
+    mbg.addBody(Body(mass, Vector3d(0.1, -0.2, 0.05 * static_cast<double>(i)), I, "b" + std::to_string(i)));
+  }
+  for(const Joint & j : joints)
+  {
+    mbg.addJoint(j);
+  }
+
+  for(std::size_t i = 0; i < joints.size(); ++i)
+  {
+    PTransformd to(RotX(0.1 * static_cast<double>(i)) * RotZ(0.3), Vector3d(0., 0.4, 0.1));
+    PTransformd from(i % 2 == 0 ? PTransformd::Identity() : PTransformd(Vector3d(0.05, 0., 0.)));
+    mbg.linkBodies("b" + std::to_string(i), to, "b" + std::to_string(i + 1), from, joints[i].name());
+  }
+
+  return mbg.makeMultiBody("b0", true);
+}
+
+/// @return Models checked by the code generator test.
+std::vector<CodeGenModel> makeCodeGenModels()
+{
+  using namespace rbd;
+
+  MultiBody tree;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(tree, mbc, mbg) = makeTree30Dof(false);
+
+  // different inertias and actuator parameters to check their folding
+  std::vector<Body> bodies;
+  for(int i = 0; i < tree.nrBodies(); ++i)
+  {
+    const double k = static_cast<double>(i);
+    Eigen::Matrix3d I(Eigen::Vector3d(0.1 + 0.01 * k, 0.2, 0.3).asDiagonal());
+    bodies.push_back(Body(1. + 0.1 * k, Eigen::Vector3d(0.01 * k, -0.02, 0.03), I, tree.body(i).name()));
+  }
+  std::vector<Joint> joints = tree.joints();
+  for(std::size_t i = 1; i < joints.size(); ++i)
+  {
+    joints[i].rotorInertia(0.01 * static_cast<double>(i));
+    joints[i].gearRatio(2.);
+    joints[i].damping(0.1);
+    joints[i].friction(i % 2 == 0 ? 0.3 : 0.);
+  }
+  tree = MultiBody(bodies, joints, tree.predecessors(), tree.successors(), tree.parents(), tree.transforms());
+
+  MultiBody xyzs;
+  std::tie(xyzs, mbc, mbg) = makeXYZSarm();
+
+  return {{"gen::tree30", tree, {"LARM6", "RLEG5", "HEAD0"}},
+          {"gen::xyzs", xyzs, {"b3", "b4"}},
+          {"gen::chain", makeAllJointsChain(), {"b8", "b4"}}};
+}
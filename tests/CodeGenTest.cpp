@@ -0,0 +1,157 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <iostream>
+
+// boost
+#define BOOST_TEST_MODULE CodeGenTest
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+// RBDyn
+#include "RBDyn/CodeGen.h"
+#include "RBDyn/FD.h"
+#include "RBDyn/FK.h"
+#include "RBDyn/FV.h"
+#include "RBDyn/ID.h"
+#include "RBDyn/Jacobian.h"
+
+// models
+#include "CodeGenModels.h"
+
+// code generated by CodeGenTestGenerator
+#include "CodeGenTestModels.h"
+
+const double TOL = 1e-10;
+
+/// Check the generated Model against the generic algorithms on random configurations.
+template<typename Model>
+void checkModel(const CodeGenModel & model)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  const MultiBody & mb = model.mb;
+  BOOST_REQUIRE_EQUAL(static_cast<int>(Model::nrBodies), mb.nrBodies());
+  BOOST_REQUIRE_EQUAL(static_cast<int>(Model::nrParams), mb.nrParams());
+  BOOST_REQUIRE_EQUAL(static_cast<int>(Model::nrDof), mb.nrDof());
+
+  MultiBodyConfig mbc(mb);
+  mbc.zero(mb);
+  mbc.gravity = Vector3d(0., 9.81, 0.);
+  InverseDynamics id(mb);
+  ForwardDynamics fd(mb);
+
+  typename Model::Kinematics kin;
+  typename Model::VectorQ q;
+  typename Model::VectorV alpha, alphaD, torque;
+  typename Model::MatrixH H;
+  typename Model::MatrixJ jac;
+
+  for(int i = 0; i < 20; ++i)
+  {
+    q.setRandom();
+    // quaternion must be normalized to have rigid transformations
+    for(int j = 0; j < mb.nrJoints(); ++j)
+    {
+      if(mb.joint(j).type() == Joint::Spherical || mb.joint(j).type() == Joint::Free)
+      {
+        q.template segment<4>(mb.jointPosInParam(j)).normalize();
+      }
+    }
+    alpha.setRandom();
+    alphaD.setRandom();
+    vectorToParam(q, mbc.q);
+    vectorToParam(alpha, mbc.alpha);
+    vectorToParam(alphaD, mbc.alphaD);
+
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+    Model::forwardKinematics(q, kin);
+    Model::forwardVelocity(alpha, kin);
+    for(int b = 0; b < mb.nrBodies(); ++b)
+    {
+      BOOST_CHECK_SMALL((kin.parentToSon[b].matrix() - mbc.parentToSon[b].matrix()).norm(), TOL);
+      BOOST_CHECK_SMALL((kin.bodyPosW[b].matrix() - mbc.bodyPosW[b].matrix()).norm(), TOL);
+      BOOST_CHECK_SMALL((kin.bodyVelB[b].vector() - mbc.bodyVelB[b].vector()).norm(), TOL);
+    }
+
+    for(const std::string & name : model.jacobianBodies)
+    {
+      Jacobian jacobian(mb, name);
+      MatrixXd fullJac(6, mb.nrDof());
+      jacobian.fullJacobian(mb, jacobian.jacobian(mb, mbc), fullJac);
+      BOOST_CHECK(Model::jacobian(mb.bodyIndexByName(name), kin, jac));
+      BOOST_CHECK_SMALL((jac - fullJac).norm(), TOL);
+    }
+
+    id.inverseDynamics(mb, mbc);
+    Model::inverseDynamics(kin, alpha, alphaD, mbc.gravity, torque);
+    BOOST_CHECK_SMALL((torque - dofToVector(mb, mbc.jointTorque)).norm(), 1e-8);
+
+    fd.computeH(mb, mbc);
+    Model::massMatrix(kin, H);
+    BOOST_CHECK_SMALL((H - fd.H()).norm(), 1e-8);
+
+    // forward dynamics of the inverse dynamics torque must give back alphaD
+    typename Model::VectorV alphaDFD;
+    Model::forwardDynamics(kin, alpha, torque, mbc.gravity, alphaDFD);
+    BOOST_CHECK_SMALL((alphaDFD - alphaD).norm(), 1e-6);
+
+    fd.forwardDynamics(mb, mbc);
+    BOOST_CHECK_SMALL((alphaDFD - dofToVector(mb, mbc.alphaD)).norm(), 1e-6);
+  }
+
+  BOOST_CHECK(!Model::jacobian(-1, kin, jac));
+}
+
+BOOST_AUTO_TEST_CASE(GeneratedCodeTest)
+{
+  const std::vector<CodeGenModel> models = makeCodeGenModels();
+  checkModel<gen::tree30::Model>(models[0]);
+  checkModel<gen::xyzs::Model>(models[1]);
+  checkModel<gen::chain::Model>(models[2]);
+
+  // compile time body selection
+  const rbd::MultiBody & mb = models[0].mb;
+  const int last = gen::tree30::nrBodies - 1;
+  BOOST_REQUIRE_EQUAL(mb.body(last).name(), "RLEG5");
+
+  gen::tree30::VectorQ q = gen::tree30::VectorQ::Random();
+  for(int j = 0; j < mb.nrJoints(); ++j)
+  {
+    if(mb.joint(j).type() == rbd::Joint::Spherical || mb.joint(j).type() == rbd::Joint::Free)
+    {
+      q.segment<4>(mb.jointPosInParam(j)).normalize();
+    }
+  }
+  gen::tree30::Kinematics kin;
+  gen::tree30::forwardKinematics(q, kin);
+  gen::tree30::MatrixJ jac, jacRT;
+  BOOST_CHECK(gen::tree30::jacobian(last, kin, jacRT));
+  gen::tree30::Model::jacobian<last>(kin, jac);
+  BOOST_CHECK_SMALL((jac - jacRT).norm(), TOL);
+
+  rbd::MultiBodyConfig mbc(mb);
+  rbd::vectorToParam(q, mbc.q);
+  rbd::forwardKinematics(mb, mbc);
+  rbd::Jacobian jacobian(mb, "RLEG5");
+  Eigen::MatrixXd fullJac(6, mb.nrDof());
+  jacobian.fullJacobian(mb, jacobian.jacobian(mb, mbc), fullJac);
+  BOOST_CHECK_SMALL((jac - fullJac).norm(), TOL);
+}
+
+BOOST_AUTO_TEST_CASE(GeneratorErrorsTest)
+{
+  const std::vector<CodeGenModel> models = makeCodeGenModels();
+  BOOST_CHECK_THROW(rbd::generateCode(models[1].mb, "1gen"), std::domain_error);
+  BOOST_CHECK_THROW(rbd::generateCode(models[1].mb, "gen::"), std::domain_error);
+  BOOST_CHECK_THROW(rbd::generateCode(models[1].mb, "gen", {"unknown"}), std::domain_error);
+  BOOST_CHECK_NO_THROW(rbd::generateCode(models[1].mb, "a::b_2", {"b3"}));
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <fstream>
+#include <iostream>
+
+// RBDyn
+#include "RBDyn/CodeGen.h"
+
+// models
+#include "CodeGenModels.h"
+
+/// Write the code generated for the CodeGenTest models in argv[1].
+int main(int argc, char * argv[])
+{
+  if(argc != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " output_file" << std::endl;
+    return 1;
+  }
+
+  std::ofstream file(argv[1]);
+  if(!file.is_open())
+  {
+    std::cerr << "Failed to open " << argv[1] << " for writing" << std::endl;
+    return 1;
+  }
+  for(const CodeGenModel & model : makeCodeGenModels())
+  {
+    file << rbd::generateCode(model.mb, model.nameSpace, model.jacobianBodies) << "\n";
+  }
+  return 0;
+}
@@ -19,6 +19,9 @@
 
 // RBDyn
 #include "RBDyn/Body.h"
+#include "RBDyn/CoM.h"
+#include "RBDyn/Coriolis.h"
+#include "RBDyn/EulerIntegration.h"
 #include "RBDyn/FD.h"
 #include "RBDyn/FK.h"
 #include "RBDyn/FV.h"
@@ -476,6 +479,136 @@ BOOST_AUTO_TEST_CASE(IDvsFDFree)
   BOOST_CHECK_SMALL((vA1 - vA2).norm(), 1e-10);
 }
 
+BOOST_AUTO_TEST_CASE(IDTerms)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZSarm();
+
+  makeRandomConfig(mbc);
+  for(auto & f : mbc.force)
+  {
+    f = ForceVecd(Vector6d::Random() * 10.);
+  }
+
+  forwardKinematics(mb, mbc);
+  forwardVelocity(mb, mbc);
+
+  InverseDynamics id(mb);
+  ForwardDynamics fd(mb);
+
+  VectorXd full(mb.nrDof()), gravity(mb.nrDof()), coriolis(mb.nrDof()), external(mb.nrDof()),
+      noGravity(mb.nrDof());
+
+  id.sInverseDynamics(mb, mbc);
+  paramToVector(mbc.jointTorque, full);
+  std::vector<MotionVecd> bodyAccB = mbc.bodyAccB;
+
+  id.sGravityTorques(mb, mbc);
+  paramToVector(mbc.jointTorque, gravity);
+  id.sCoriolisTorques(mb, mbc);
+  paramToVector(mbc.jointTorque, coriolis);
+  id.sExternalForceTorques(mb, mbc);
+  paramToVector(mbc.jointTorque, external);
+  id.sInverseDynamicsNoGravity(mb, mbc);
+  paramToVector(mbc.jointTorque, noGravity);
+
+  // partial inverse dynamics must not modify bodyAccB
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    BOOST_CHECK_EQUAL(mbc.bodyAccB[i].vector(), bodyAccB[i].vector());
+  }
+
+  BOOST_CHECK_SMALL((full - (noGravity + gravity)).norm(), 1e-10);
+
+  // C(q, alpha) from FD is the sum of the velocity, gravity and external terms
+  fd.computeC(mb, mbc);
+  BOOST_CHECK_SMALL((fd.C() - (coriolis + gravity + external)).norm(), 1e-10);
+  // and the remaining part of the inverse dynamics is H*alphaD
+  fd.computeH(mb, mbc);
+  VectorXd alphaD(mb.nrDof());
+  paramToVector(mbc.alphaD, alphaD);
+  BOOST_CHECK_SMALL((full - (fd.H() * alphaD + fd.C())).norm(), 1e-10);
+
+  // gravity torques don't depend on the velocity, coriolis torques don't depend on gravity
+  mbc.gravity = Vector3d::Zero();
+  id.gravityTorques(mb, mbc);
+  paramToVector(mbc.jointTorque, gravity);
+  BOOST_CHECK(gravity.isZero());
+  id.coriolisTorques(mb, mbc);
+  paramToVector(mbc.jointTorque, noGravity);
+  BOOST_CHECK_SMALL((coriolis - noGravity).norm(), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(ActuatorDynamics)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZSarm();
+
+  // same model with actuated joints
+  std::vector<Joint> joints = mb.joints();
+  for(std::size_t i = 1; i < joints.size(); ++i)
+  {
+    joints[i].rotorInertia(0.1 * static_cast<double>(i));
+    joints[i].gearRatio(2.);
+    joints[i].damping(0.3);
+    joints[i].friction(0.7);
+  }
+  MultiBody mbAct(mb.bodies(), joints, mb.predecessors(), mb.successors(), mb.parents(), mb.transforms());
+  BOOST_CHECK_EQUAL(mbAct.joint(2).armature(), 0.8);
+
+  makeRandomConfig(mbc);
+  forwardKinematics(mb, mbc);
+  forwardVelocity(mb, mbc);
+
+  InverseDynamics id(mb);
+  ForwardDynamics fd(mbAct);
+
+  VectorXd tau(mb.nrDof()), tauAct(mb.nrDof()), alpha(mb.nrDof()), alphaD(mb.nrDof());
+  paramToVector(mbc.alpha, alpha);
+  paramToVector(mbc.alphaD, alphaD);
+
+  id.inverseDynamics(mb, mbc);
+  paramToVector(mbc.jointTorque, tau);
+  id.sInverseDynamics(mbAct, mbc);
+  paramToVector(mbc.jointTorque, tauAct);
+
+  VectorXd expected = tau;
+  for(int i = 1; i < mbAct.nrJoints(); ++i)
+  {
+    const Joint & j = mbAct.joint(i);
+    for(int d = 0; d < j.dof(); ++d)
+    {
+      int dof = mbAct.jointPosInDof(i) + d;
+      expected(dof) += j.armature() * alphaD(dof) + j.damping() * alpha(dof)
+                       + j.friction() * (alpha(dof) > 0. ? 1. : (alpha(dof) < 0. ? -1. : 0.));
+    }
+  }
+  BOOST_CHECK_SMALL((tauAct - expected).norm(), 1e-10);
+
+  // H and C must take the actuators into account
+  fd.computeH(mbAct, mbc);
+  fd.computeC(mbAct, mbc);
+  BOOST_CHECK_SMALL((tauAct - (fd.H() * alphaD + fd.C())).norm(), 1e-10);
+
+  // torque -> FD -> alphaD -> ID -> torque
+  fd.sForwardDynamics(mbAct, mbc);
+  id.inverseDynamics(mbAct, mbc);
+  paramToVector(mbc.jointTorque, tau);
+  BOOST_CHECK_SMALL((tauAct - tau).norm(), 1e-10);
+}
+
 BOOST_AUTO_TEST_CASE(MultiBodyGraphMerge)
 {
   rbd::MultiBody mb;
@@ -514,3 +647,92 @@ BOOST_AUTO_TEST_CASE(MultiBodyGraphMerge)
 
   BOOST_CHECK_SMALL(error, TOL);
 }
+
+BOOST_AUTO_TEST_CASE(StampsTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZSarm();
+
+  // zero stamp all the inputs
+  BOOST_CHECK_NE(mbc.stamps.position, 0u);
+  BOOST_CHECK_NE(mbc.stamps.force, 0u);
+  BOOST_CHECK_NE(mb.stamp(), 0u);
+
+  mbc.q = {{}, {0.4}, {-0.2}, {0.8}, {1., 0., 0., 0.}};
+  mbc.alpha = {{}, {0.1}, {0.3}, {-0.2}, {0.5, 0.2, 0.1}};
+  ConfigStamps old = mbc.stamps;
+  forwardKinematics(mb, mbc);
+  BOOST_CHECK_GT(mbc.stamps.position, old.position);
+  BOOST_CHECK_EQUAL(mbc.stamps.velocity, old.velocity);
+  forwardVelocity(mb, mbc);
+  BOOST_CHECK_GT(mbc.stamps.velocity, mbc.stamps.position);
+  old = mbc.stamps;
+  eulerIntegration(mb, mbc, 1e-3);
+  BOOST_CHECK_GT(mbc.stamps.position, old.position);
+  BOOST_CHECK_GT(mbc.stamps.velocity, old.velocity);
+  BOOST_CHECK_EQUAL(mbc.stamps.acceleration, old.acceleration);
+  forwardKinematics(mb, mbc);
+  forwardVelocity(mb, mbc);
+
+  // computeH always recompute H, updateH only when the position or the model change
+  ForwardDynamics fd(mb);
+  BOOST_CHECK(fd.updateH(mb, mbc));
+  MatrixXd H = fd.H();
+  std::vector<PTransformd> parentToSon = mbc.parentToSon;
+  mbc.parentToSon[2] = PTransformd(RotZ(1.)) * mbc.parentToSon[2];
+  BOOST_CHECK(!fd.updateH(mb, mbc));
+  BOOST_CHECK_EQUAL(fd.H(), H);
+  mbc.stamps.positionChanged();
+  BOOST_CHECK(fd.updateH(mb, mbc));
+  BOOST_CHECK_GT((fd.H() - H).norm(), 1e-6);
+  mbc.parentToSon = parentToSon;
+  fd.computeH(mb, mbc);
+  BOOST_CHECK_SMALL((fd.H() - H).norm(), 1e-12);
+  // computeH invalidate the updateH cache
+  mbc.parentToSon[2] = PTransformd(RotZ(1.)) * mbc.parentToSon[2];
+  BOOST_CHECK(fd.updateH(mb, mbc));
+  BOOST_CHECK_GT((fd.H() - H).norm(), 1e-6);
+  mbc.parentToSon = parentToSon;
+  forwardKinematics(mb, mbc);
+  BOOST_CHECK(fd.updateH(mb, mbc));
+  BOOST_CHECK_SMALL((fd.H() - H).norm(), 1e-12);
+
+  mb.body(3, Body(2., Vector3d(0.1, 0., 0.), Matrix3d::Identity(), mb.body(3).name()));
+  BOOST_CHECK(fd.updateH(mb, mbc));
+  BOOST_CHECK_GT((fd.H() - H).norm(), 1e-6);
+  ForwardDynamics fdRef(mb);
+  fdRef.computeH(mb, mbc);
+  BOOST_CHECK_SMALL((fd.H() - fdRef.H()).norm(), 1e-12);
+
+  // jacobian and jacobianDot always recompute, updateJacobian and
+  // updateJacobianDot only when the position or velocity change
+  CoMJacobian comJac(mb);
+  MatrixXd J = comJac.updateJacobian(mb, mbc);
+  MatrixXd JDot = comJac.updateJacobianDot(mb, mbc);
+  std::vector<PTransformd> bodyPosW = mbc.bodyPosW;
+  mbc.bodyPosW[3] = PTransformd::Identity();
+  BOOST_CHECK_EQUAL(comJac.updateJacobian(mb, mbc), J);
+  BOOST_CHECK_EQUAL(comJac.updateJacobianDot(mb, mbc), JDot);
+  BOOST_CHECK_GT((comJac.jacobian(mb, mbc) - J).norm(), 1e-6);
+  BOOST_CHECK_GT((comJac.updateJacobian(mb, mbc) - J).norm(), 1e-6);
+  mbc.stamps.velocityChanged();
+  BOOST_CHECK_GT((comJac.updateJacobianDot(mb, mbc) - JDot).norm(), 1e-6);
+  mbc.bodyPosW = bodyPosW;
+  BOOST_CHECK_SMALL((comJac.jacobian(mb, mbc) - J).norm(), 1e-12);
+  comJac.updateInertialParameters(mb);
+  BOOST_CHECK_SMALL((comJac.jacobian(mb, mbc) - CoMJacobian(mb).jacobian(mb, mbc)).norm(), 1e-12);
+
+  // the bodies CoM are refreshed when the model inertia change
+  Coriolis coriolis(mb);
+  coriolis.coriolis(mb, mbc);
+  mb.bodyInertia(2, RBInertiad(3., Vector3d(0., 0.3, 0.6), Matrix3d::Identity()));
+  BOOST_CHECK_SMALL((comJac.jacobian(mb, mbc) - CoMJacobian(mb).jacobian(mb, mbc)).norm(), 1e-12);
+  BOOST_CHECK_SMALL((comJac.jacobianDot(mb, mbc) - CoMJacobian(mb).jacobianDot(mb, mbc)).norm(), 1e-12);
+  BOOST_CHECK_SMALL((coriolis.coriolis(mb, mbc) - Coriolis(mb).coriolis(mb, mbc)).norm(), 1e-12);
+}
@@ -14,6 +14,10 @@
 #include <SpaceVecAlg/SpaceVecAlg>
 
 // RBDyn
+#include "RBDyn/CoM.h"
+#include "RBDyn/EulerIntegration.h"
+#include "RBDyn/FA.h"
+#include "RBDyn/FD.h"
 #include "RBDyn/FK.h"
 #include "RBDyn/FV.h"
 #include "RBDyn/ID.h"
@@ -128,3 +132,291 @@ BOOST_AUTO_TEST_CASE(computeY)
     BOOST_CHECK_SMALL((idTorque - idimTorque).norm(), 1e-8);
   }
 }
+
+BOOST_AUTO_TEST_CASE(IDIMEstimatorTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof();
+
+  std::vector<Body> newB;
+  for(const Body & b : mb.bodies())
+  {
+    newB.push_back(Body(randomInertia(), b.name()));
+  }
+  mb = MultiBody(newB, mb.joints(), mb.predecessors(), mb.successors(), mb.parents(), mb.transforms());
+  VectorXd inertiaVec(multiBodyToInertialVector(mb));
+
+  const int nrS = 60;
+  MatrixXd q(MatrixXd::Random(mb.nrParams(), nrS) * 2.);
+  MatrixXd alpha(MatrixXd::Random(mb.nrDof(), nrS));
+  MatrixXd alphaD(MatrixXd::Random(mb.nrDof(), nrS));
+  MatrixXd torque(mb.nrDof(), nrS);
+
+  // stacked regressor used as reference
+  InverseDynamics id(mb);
+  IDIM idim(mb);
+  MatrixXd Ys(mb.nrDof() * nrS, mb.nrBodies() * 10);
+  IDIMEstimator serial(mb, 0.98);
+  for(int s = 0; s < nrS; ++s)
+  {
+    vectorToParam(q.col(s), mbc.q);
+    vectorToParam(alpha.col(s), mbc.alpha);
+    vectorToParam(alphaD.col(s), mbc.alphaD);
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+    id.inverseDynamics(mb, mbc);
+
+    VectorXd t(mb.nrDof());
+    paramToVector(mbc.jointTorque, t);
+    torque.col(s) = t;
+    idim.computeY(mb, mbc);
+    Ys.middleRows(s * mb.nrDof(), mb.nrDof()) = idim.Y();
+    serial.sAddSample(mb, mbc);
+  }
+
+  // without forgetting the normal equations must match the stacked problem
+  IDIMEstimator est(mb);
+  est.sAddTrajectory(mb, q, alpha, alphaD, torque, mbc.gravity, 3);
+  BOOST_CHECK_EQUAL(est.nrSamples(), nrS);
+  MatrixXd YTY = Ys.transpose() * Ys;
+  BOOST_CHECK_SMALL((est.YTY() - YTY).norm() / YTY.norm(), 1e-12);
+  BOOST_CHECK_SMALL((est.YTtorque() - Ys.transpose() * VectorXd(Map<VectorXd>(torque.data(), torque.size()))).norm(),
+                    1e-8);
+
+  // the real parameters explain the torques, so must any solution
+  VectorXd phi = est.solve();
+  BOOST_CHECK_SMALL((Ys * (phi - inertiaVec)).norm(), 1e-6);
+  VectorXd phiReg = est.solve(1e-9, inertiaVec);
+  BOOST_CHECK_SMALL((Ys * (phiReg - inertiaVec)).norm(), 1e-6);
+
+  // threaded accumulation with forgetting is equivalent to the serial one
+  IDIMEstimator forget(mb, 0.98);
+  forget.addTrajectory(mb, q, alpha, alphaD, torque, mbc.gravity, 4);
+  BOOST_CHECK_SMALL((forget.YTY() - serial.YTY()).norm() / serial.YTY().norm(), 1e-12);
+  BOOST_CHECK_SMALL((forget.YTtorque() - serial.YTtorque()).norm() / serial.YTtorque().norm(), 1e-12);
+  BOOST_CHECK_SMALL(forget.torqueTtorque() - serial.torqueTtorque(), 1e-8);
+
+  // merging two halves
+  IDIMEstimator first(mb, 0.98), second(mb, 0.98);
+  first.addTrajectory(mb, q.leftCols(nrS / 2), alpha.leftCols(nrS / 2), alphaD.leftCols(nrS / 2),
+                      torque.leftCols(nrS / 2), mbc.gravity, 1);
+  second.addTrajectory(mb, q.rightCols(nrS / 2), alpha.rightCols(nrS / 2), alphaD.rightCols(nrS / 2),
+                       torque.rightCols(nrS / 2), mbc.gravity, 2);
+  first.sMerge(second);
+  BOOST_CHECK_SMALL((first.YTY() - serial.YTY()).norm() / serial.YTY().norm(), 1e-12);
+
+  BOOST_CHECK_THROW(first.sMerge(est), std::domain_error);
+  BOOST_CHECK_THROW(est.sAddTrajectory(mb, q, alpha, alphaD, torque.leftCols(2)), std::domain_error);
+
+  est.reset();
+  BOOST_CHECK_EQUAL(est.nrSamples(), 0);
+  BOOST_CHECK(est.YTY().isZero());
+
+  IDIMEstimator empty;
+  BOOST_CHECK_EQUAL(empty.nrSamples(), 0);
+  BOOST_CHECK_EQUAL(empty.torqueTtorque(), 0.);
+  BOOST_CHECK_EQUAL(empty.forgettingFactor(), 1.);
+}
+
+BOOST_AUTO_TEST_CASE(IDIMBaseTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof();
+
+  std::vector<Body> newB;
+  for(const Body & b : mb.bodies())
+  {
+    newB.push_back(Body(randomInertia(), b.name()));
+  }
+  mb = MultiBody(newB, mb.joints(), mb.predecessors(), mb.successors(), mb.parents(), mb.transforms());
+  VectorXd inertiaVec(multiBodyToInertialVector(mb));
+
+  IDIMBase base(mb);
+  const int nrBase = base.nrBaseParameters();
+  BOOST_CHECK(nrBase > 0);
+  BOOST_CHECK(nrBase < mb.nrBodies() * 10);
+  BOOST_CHECK_EQUAL(base.independentColumns().size() + base.dependentColumns().size(),
+                    static_cast<std::size_t>(mb.nrBodies() * 10));
+  BOOST_CHECK_EQUAL(base.beta().rows(), nrBase);
+  BOOST_CHECK(std::is_sorted(base.independentColumns().begin(), base.independentColumns().end()));
+  // the root body is fixed so none of its parameters can be identified
+  BOOST_CHECK(base.independentColumns().front() >= 10);
+
+  VectorXd phiB = base.sBaseParameters(inertiaVec);
+  BOOST_CHECK_EQUAL(phiB.size(), nrBase);
+
+  IDIM idim(mb);
+  InverseDynamics id(mb);
+  VectorXd idTorque(mb.nrDof());
+  for(int i = 0; i < 50; ++i)
+  {
+    vectorToParam(VectorXd::Random(mb.nrParams()) * 4., mbc.q);
+    vectorToParam(VectorXd::Random(mb.nrDof()), mbc.alpha);
+    vectorToParam(VectorXd::Random(mb.nrDof()), mbc.alphaD);
+
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+    id.inverseDynamics(mb, mbc);
+    paramToVector(mbc.jointTorque, idTorque);
+
+    idim.computeY(mb, mbc);
+    base.sComputeYBase(mb, mbc);
+
+    // Yb is made of the independent columns of Y
+    for(int k = 0; k < nrBase; ++k)
+    {
+      BOOST_CHECK_SMALL((base.YBase().col(k) - idim.Y().col(base.independentColumns()[k])).norm(), 1e-10);
+    }
+    BOOST_CHECK_SMALL((idTorque - base.YBase() * phiB).norm(), 1e-6);
+  }
+
+  BOOST_CHECK_THROW(base.sBaseParameters(VectorXd::Zero(3)), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(CompactIDIMTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof(false);
+
+  IDIM idim(mb);
+  CompactIDIM compact(mb);
+  for(int i = 0; i < 10; ++i)
+  {
+    vectorToParam(VectorXd::Random(mb.nrParams()), mbc.q);
+    vectorToParam(VectorXd::Random(mb.nrDof()), mbc.alpha);
+    vectorToParam(VectorXd::Random(mb.nrDof()), mbc.alphaD);
+
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+    forwardAcceleration(mb, mbc, MotionVecd(Vector3d::Zero(), Vector3d(0., 0., 9.81)));
+
+    idim.computeY(mb, mbc);
+    compact.sComputeY(mb, mbc);
+    const MatrixXd & Y = idim.Y();
+
+    BOOST_CHECK_SMALL((compact.denseY() - Y).norm(), 1e-10);
+
+    VectorXd torque(VectorXd::Random(mb.nrDof()));
+    VectorXd phi(VectorXd::Random(mb.nrBodies() * 10));
+    BOOST_CHECK_SMALL((compact.YTtorque(torque) - Y.transpose() * torque).norm(), 1e-10);
+    BOOST_CHECK_SMALL((compact.Yphi(phi) - Y * phi).norm(), 1e-10);
+
+    MatrixXd YTY(Y.transpose() * Y);
+    BOOST_CHECK_SMALL((compact.YTY() - YTY).norm(), 1e-8);
+
+    // addYTY only write the lower triangular part
+    MatrixXd acc(MatrixXd::Zero(YTY.rows(), YTY.cols()));
+    compact.addYTY(acc);
+    MatrixXd lower(acc.triangularView<Lower>());
+    BOOST_CHECK_SMALL((lower - MatrixXd(YTY.triangularView<Lower>())).norm(), 1e-8);
+    BOOST_CHECK_EQUAL(MatrixXd(acc.triangularView<StrictlyUpper>()).norm(), 0.);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(EnergyIDIMTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof();
+
+  std::vector<Joint> joints = mb.joints();
+  for(std::size_t i = 1; i < joints.size(); ++i)
+  {
+    joints[i].rotorInertia(0.01 * static_cast<double>(i));
+    joints[i].gearRatio(3.);
+    joints[i].damping(0.2);
+    joints[i].friction(0.5);
+  }
+  mb = MultiBody(mb.bodies(), joints, mb.predecessors(), mb.successors(), mb.parents(), mb.transforms());
+
+  EnergyIDIM eidim(mb, true);
+  BOOST_CHECK_EQUAL(eidim.nrParameters(), mb.nrBodies() * 10 + (mb.nrJoints() - 1) * 3);
+  VectorXd phi(eidim.parameters(mb));
+
+  const Vector3d gravity(0., 9.81, 0.);
+  mbc.gravity = gravity;
+  ForwardDynamics fd(mb);
+  InverseDynamics id(mb);
+  double totalMass = 0.;
+  for(const Body & b : mb.bodies())
+  {
+    totalMass += b.inertia().mass();
+  }
+
+  // energy is the kinetic energy of the bodies and rotors plus the potential energy
+  for(int i = 0; i < 10; ++i)
+  {
+    vectorToParam(VectorXd::Random(mb.nrParams()), mbc.q);
+    vectorToParam(VectorXd::Random(mb.nrDof()), mbc.alpha);
+    vectorToParam(VectorXd::Random(mb.nrDof()), mbc.alphaD);
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+    fd.computeH(mb, mbc);
+    id.inverseDynamics(mb, mbc);
+
+    VectorXd alpha(dofToVector(mb, mbc.alpha));
+    VectorXd tau(dofToVector(mb, mbc.jointTorque));
+    eidim.sComputeEnergy(mb, mbc);
+
+    double kinetic = 0.5 * alpha.dot(fd.H() * alpha);
+    double potential = totalMass * gravity.dot(computeCoM(mb, mbc));
+    BOOST_CHECK_SMALL(eidim.energy().dot(phi) - kinetic - potential, 1e-8);
+    BOOST_CHECK_SMALL(eidim.power() - tau.dot(alpha), 1e-8);
+    BOOST_CHECK_SMALL(eidim.dissipation().head(mb.nrBodies() * 10).norm(), 1e-12);
+  }
+
+  // power balance on a trajectory with constant acceleration
+  const int nrS = 201;
+  const double dt = 1e-3;
+  MatrixXd Q(mb.nrParams(), nrS), Alpha(mb.nrDof(), nrS), Tau(mb.nrDof(), nrS);
+  mbc.zero(mb);
+  vectorToParam(VectorXd::Random(mb.nrDof()), mbc.alpha);
+  vectorToParam(VectorXd::Random(mb.nrDof()), mbc.alphaD);
+  for(int s = 0; s < nrS; ++s)
+  {
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+    id.inverseDynamics(mb, mbc);
+    Q.col(s) = paramToVector(mb, mbc.q);
+    Alpha.col(s) = dofToVector(mb, mbc.alpha);
+    Tau.col(s) = dofToVector(mb, mbc.jointTorque);
+    eulerIntegration(mb, mbc, dt);
+  }
+
+  eidim.sComputeY(mb, Q, Alpha, Tau, dt, 50, gravity, 2);
+  BOOST_CHECK_EQUAL(eidim.Y().rows(), 4);
+  BOOST_CHECK_EQUAL(eidim.Y().cols(), eidim.nrParameters());
+  VectorXd err(eidim.Y() * phi - eidim.work());
+  BOOST_CHECK_SMALL(err.norm() / eidim.work().norm(), 1e-4);
+
+  // windows are independent of the thread count
+  MatrixXd Y1(eidim.Y());
+  eidim.computeY(mb, Q, Alpha, Tau, dt, 50, gravity, 1);
+  BOOST_CHECK_SMALL((eidim.Y() - Y1).norm(), 1e-12);
+
+  BOOST_CHECK_THROW(eidim.sComputeY(mb, Q, Alpha, Tau, dt, 0, gravity), std::domain_error);
+  BOOST_CHECK_THROW(eidim.sComputeY(mb, Q, Alpha, Tau.leftCols(3), dt, 1, gravity), std::domain_error);
+}
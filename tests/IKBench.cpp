@@ -0,0 +1,79 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <vector>
+
+// benchmark
+#include "benchmark/benchmark.h"
+
+// RBDyn
+#include "RBDyn/FK.h"
+#include "RBDyn/IK.h"
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/MultiBodyConfig.h"
+#include "RBDyn/MultiBodyGraph.h"
+
+// Arm
+#include "Tree30Dof.h"
+
+static std::vector<sva::PTransformd> makeTargets(const rbd::MultiBody & mb, rbd::MultiBodyConfig mbc, int bodyIndex)
+{
+  std::vector<sva::PTransformd> targets;
+  for(int i = 0; i < 256; ++i)
+  {
+    rbd::vectorToParam(0.3 * Eigen::VectorXd::Random(mb.nrParams()), mbc.q);
+    rbd::forwardKinematics(mb, mbc);
+    targets.push_back(mbc.bodyPosW[static_cast<std::size_t>(bodyIndex)]);
+  }
+  return targets;
+}
+
+static void BM_InverseKinematics(benchmark::State & state)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof();
+
+  int ef = mb.bodyIndexByName("LARM6");
+  std::vector<sva::PTransformd> targets = makeTargets(mb, mbc, ef);
+  rbd::InverseKinematics ik(mb, ef);
+  Eigen::VectorXd seed = rbd::paramToVector(mb, mbc.q);
+
+  for(auto _ : state)
+  {
+    for(const sva::PTransformd & target : targets)
+    {
+      rbd::vectorToParam(seed, mbc.q);
+      benchmark::DoNotOptimize(ik.inverseKinematics(mb, mbc, target));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(targets.size()));
+}
+BENCHMARK(BM_InverseKinematics)->UseRealTime();
+
+static void BM_BatchInverseKinematics(benchmark::State & state)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof();
+
+  int ef = mb.bodyIndexByName("LARM6");
+  std::vector<sva::PTransformd> targets = makeTargets(mb, mbc, ef);
+  rbd::BatchInverseKinematics ik(mb, ef, static_cast<int>(state.range(0)));
+  ik.chunk_size_ = 8;
+  Eigen::VectorXd seed = rbd::paramToVector(mb, mbc.q);
+
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(ik.inverseKinematics(mb, targets, seed));
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(targets.size()));
+}
+BENCHMARK(BM_BatchInverseKinematics)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+BENCHMARK_MAIN();
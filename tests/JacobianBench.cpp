@@ -10,6 +10,7 @@
 #include "RBDyn/CoM.h"
 #include "RBDyn/FK.h"
 #include "RBDyn/FV.h"
+#include "RBDyn/FloatKinematics.h"
 #include "RBDyn/Jacobian.h"
 #include "RBDyn/Momentum.h"
 #include "RBDyn/MultiBody.h"
@@ -76,6 +77,74 @@ static void BM_VectorBodyJacobian(benchmark::State & state)
 }
 BENCHMARK(BM_VectorBodyJacobian);
 
+static void BM_ForwardKinematics(benchmark::State & state)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof(false);
+
+  for(auto _ : state)
+  {
+    rbd::forwardKinematics(mb, mbc);
+  }
+}
+BENCHMARK(BM_ForwardKinematics);
+
+static void BM_ForwardKinematicsJacobian(benchmark::State & state)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof(false);
+
+  rbd::Jacobian jac(mb, "LARM6");
+
+  for(auto _ : state)
+  {
+    rbd::forwardKinematics(mb, mbc);
+    jac.jacobian(mb, mbc);
+  }
+}
+BENCHMARK(BM_ForwardKinematicsJacobian);
+
+static void BM_FloatForwardKinematics(benchmark::State & state)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof(false);
+
+  rbd::FloatKinematics fk(mb);
+  Eigen::VectorXf q = rbd::paramToVector(mb, mbc.q).cast<float>();
+
+  for(auto _ : state)
+  {
+    fk.forwardKinematics(mb, q);
+  }
+}
+BENCHMARK(BM_FloatForwardKinematics);
+
+static void BM_FloatForwardKinematicsJacobian(benchmark::State & state)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof(false);
+
+  rbd::Jacobian jac(mb, "LARM6");
+  rbd::FloatKinematics fk(mb);
+  Eigen::VectorXf q = rbd::paramToVector(mb, mbc.q).cast<float>();
+  Eigen::Matrix<float, 6, Eigen::Dynamic> jacMat;
+
+  for(auto _ : state)
+  {
+    fk.forwardKinematics(mb, q);
+    fk.jacobian(mb, jac, jacMat);
+  }
+}
+BENCHMARK(BM_FloatForwardKinematicsJacobian);
+
 static void BM_JacobianDot(benchmark::State & state)
 {
   rbd::MultiBody mb;
@@ -20,6 +20,7 @@
 #include "RBDyn/FA.h"
 #include "RBDyn/FK.h"
 #include "RBDyn/FV.h"
+#include "RBDyn/FrameKinematics.h"
 #include "RBDyn/Jacobian.h"
 #include "RBDyn/Joint.h"
 #include "RBDyn/MultiBody.h"
@@ -797,3 +798,71 @@ BOOST_AUTO_TEST_CASE(JacobianVectorVelAccComputeTest)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(FrameKinematicsTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZSarm();
+
+  PTransformd X_b3_tool(RotZ(0.4) * RotX(-0.2), Vector3d(0.1, 0.3, -0.2));
+  PTransformd X_b4_sensor(Vector3d(0., 0.2, 0.));
+  int tool = mb.sAddFrame("tool", mb.bodyIndexByName("b3"), X_b3_tool);
+  int sensor = mb.sAddFrame("sensor", mb.bodyIndexByName("b4"), X_b4_sensor);
+  BOOST_CHECK_EQUAL(mb.nrFrames(), 2);
+  BOOST_CHECK_EQUAL(mb.frameIndexByName("sensor"), sensor);
+  BOOST_CHECK_THROW(mb.sAddFrame("tool", 0), std::domain_error);
+  BOOST_CHECK_THROW(mb.sAddFrame("bad", mb.nrBodies()), std::out_of_range);
+
+  FrameKinematics fk(mb);
+  for(int iter = 0; iter < 3; ++iter)
+  {
+    mbc.q = {{}, {0.3 * iter}, {-0.2}, {0.1 * iter}, {1., 0., 0., 0.}};
+    Map<Vector4d>(mbc.q[4].data()) = Vector4d::Random().normalized();
+    mbc.alpha = vectorToDof(mb, VectorXd::Random(mb.nrDof()));
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+
+    for(int f : {tool, sensor})
+    {
+      const OperationalFrame & frame = mb.frame(f);
+      Jacobian jac(mb, mb.body(frame.body).name(), frame.X_b_f.translation());
+      PTransformd X_0_f = frame.X_b_f * mbc.bodyPosW[frame.body];
+
+      BOOST_CHECK_SMALL((fk.sFramePosW(mb, mbc, f).matrix() - X_0_f.matrix()).norm(), TOL);
+      BOOST_CHECK_SMALL((fk.sFrameVelB(mb, mbc, f) - frame.X_b_f * mbc.bodyVelB[frame.body]).vector().norm(), TOL);
+      BOOST_CHECK_SMALL((fk.sFrameVelW(mb, mbc, f) - jac.velocity(mb, mbc)).vector().norm(), TOL);
+      BOOST_CHECK_SMALL((fk.sJacobian(mb, mbc, f) - jac.jacobian(mb, mbc)).norm(), TOL);
+      BOOST_CHECK_SMALL((fk.sBodyJacobian(mb, mbc, f) - jac.jacobian(mb, mbc, X_0_f)).norm(), TOL);
+      BOOST_CHECK(fk.frameJacobian(mb, f).jointsPath() == jac.jointsPath());
+
+      // the body jacobian give the frame velocity in frame coordinate
+      MatrixXd fullJac(6, mb.nrDof());
+      fk.frameJacobian(mb, f).fullJacobian(mb, fk.bodyJacobian(mb, mbc, f), fullJac);
+      BOOST_CHECK_SMALL((fullJac * dofToVector(mb, mbc.alpha) - fk.frameVelB(mb, mbc, f).vector()).norm(), TOL);
+    }
+  }
+
+  // results are cached until the configuration stamps change
+  PTransformd X_0_tool = fk.framePosW(mb, mbc, tool);
+  PTransformd X_0_b3 = mbc.bodyPosW[3];
+  mbc.bodyPosW[3] = PTransformd::Identity();
+  BOOST_CHECK_EQUAL(fk.framePosW(mb, mbc, tool).matrix(), X_0_tool.matrix());
+  fk.reset();
+  BOOST_CHECK_SMALL((fk.framePosW(mb, mbc, tool).matrix() - X_b3_tool.matrix()).norm(), TOL);
+  mbc.bodyPosW[3] = X_0_b3;
+  mbc.stamps.positionChanged();
+  BOOST_CHECK_SMALL((fk.framePosW(mb, mbc, tool).matrix() - X_0_tool.matrix()).norm(), TOL);
+  mbc.q[1][0] += 0.5;
+  forwardKinematics(mb, mbc);
+  BOOST_CHECK_SMALL((fk.framePosW(mb, mbc, tool).matrix() - (X_b3_tool * mbc.bodyPosW[3]).matrix()).norm(), TOL);
+  BOOST_CHECK_GT((fk.framePosW(mb, mbc, tool).matrix() - X_0_tool.matrix()).norm(), TOL);
+
+  BOOST_CHECK_THROW(fk.sFramePosW(mb, mbc, 2), std::domain_error);
+  BOOST_CHECK_THROW(FrameKinematics().sFramePosW(mb, mbc, tool), std::domain_error);
+}
@@ -5,6 +5,7 @@
 // includes
 // std
 #include <iostream>
+#include <memory>
 
 // boost
 #define BOOST_TEST_MODULE MultiBodyTest
@@ -16,13 +17,17 @@
 
 // RBDyn
 #include "RBDyn/Body.h"
+#include "RBDyn/CompiledMultiBody.h"
 #include "RBDyn/FK.h"
+#include "RBDyn/FV.h"
+#include "RBDyn/ID.h"
 #include "RBDyn/Joint.h"
 #include "RBDyn/MultiBody.h"
 #include "RBDyn/MultiBodyConfig.h"
 #include "RBDyn/MultiBodyGraph.h"
 
 // arm
+#include "Tree30Dof.h"
 #include "XYZSarm.h"
 
 BOOST_AUTO_TEST_CASE(MultiBodyGraphTest)
@@ -860,3 +865,357 @@ BOOST_AUTO_TEST_CASE(MultiBodyBaseTransformTest)
         1e-8);
   }
 }
+
+BOOST_AUTO_TEST_CASE(JointsDataTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZSarm();
+
+  auto checkJointsData = [](const MultiBody & mb) {
+    BOOST_REQUIRE_EQUAL(static_cast<int>(mb.jointsData().size()), mb.nrJoints());
+    BOOST_CHECK_EQUAL(mb.motionSubspaces().cols(), mb.nrDof());
+    for(int i = 0; i < mb.nrJoints(); ++i)
+    {
+      const Joint & j = mb.joint(i);
+      const JointData & jd = mb.jointData(i);
+      BOOST_CHECK_EQUAL(jd.type, j.type());
+      BOOST_CHECK_EQUAL(jd.direction, j.direction());
+      BOOST_CHECK_EQUAL(jd.params, j.params());
+      BOOST_CHECK_EQUAL(jd.dof, j.dof());
+      BOOST_CHECK_EQUAL(jd.posInParam, mb.jointPosInParam(i));
+      BOOST_CHECK_EQUAL(jd.posInDof, mb.jointPosInDof(i));
+      BOOST_CHECK_EQUAL(jd.pred, mb.predecessor(i));
+      BOOST_CHECK_EQUAL(jd.succ, mb.successor(i));
+      BOOST_CHECK_EQUAL(jd.Xt, mb.transform(i));
+      BOOST_CHECK_EQUAL(jd.inertia, mb.body(mb.successor(i)).inertia());
+      BOOST_CHECK_EQUAL(MatrixXd(mb.motionSubspace(i)), j.motionSubspace());
+    }
+  };
+  checkJointsData(mb);
+
+  // setters must keep the joints data in sync
+  PTransformd Xt(RotX(0.3), Vector3d(0.1, 0.2, 0.3));
+  mb.transform(2, Xt);
+  RBInertiad I(2., Vector3d(0.1, 0.2, 0.3), Matrix3d::Identity());
+  mb.body(1, Body(I, mb.body(1).name()));
+  checkJointsData(mb);
+  BOOST_CHECK_EQUAL(mb.jointData(2).Xt, Xt);
+
+  std::vector<PTransformd> Xts(mb.transforms().size(), Xt);
+  mb.sTransforms(Xts);
+  std::vector<Body> bodies = mb.bodies();
+  bodies[3] = Body(I, bodies[3].name());
+  mb.sBodies(bodies);
+  checkJointsData(mb);
+
+  // Joint::Pose and Joint::Motion on the joints data match the Joint methods
+  forwardKinematics(mb, mbc);
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    const JointData & jd = mb.jointData(i);
+    std::vector<double> alpha(static_cast<std::size_t>(jd.dof), 0.5);
+    BOOST_CHECK_EQUAL(Joint::Pose(jd.type, jd.direction, mb.motionSubspace(i), mbc.q[i]), mb.joint(i).pose(mbc.q[i]));
+    BOOST_CHECK_EQUAL(Joint::Motion(jd.type, mb.motionSubspace(i), alpha), mb.joint(i).motion(alpha));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParametersUpdateTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZSarm();
+
+  // each setter only change the stamp of the data it modifies
+  std::uint64_t inertiaStamp = mb.inertiaStamp();
+  std::uint64_t geometryStamp = mb.geometryStamp();
+  BOOST_CHECK_NE(inertiaStamp, 0u);
+  BOOST_CHECK_NE(geometryStamp, 0u);
+
+  RBInertiad I(3., Vector3d(0.3, 0.2, 0.1), Matrix3d::Identity());
+  mb.bodyInertia(2, I);
+  BOOST_CHECK_EQUAL(mb.body(2).inertia(), I);
+  BOOST_CHECK_EQUAL(mb.jointData(2).inertia, I);
+  BOOST_CHECK_GT(mb.inertiaStamp(), inertiaStamp);
+  BOOST_CHECK_EQUAL(mb.geometryStamp(), geometryStamp);
+  BOOST_CHECK_EQUAL(mb.stamp(), mb.inertiaStamp());
+  inertiaStamp = mb.inertiaStamp();
+
+  Vector3d axis = Vector3d(1., 1., 0.).normalized();
+  mb.jointAxis(2, axis);
+  mb.sTransform(3, PTransformd(RotZ(0.2), Vector3d(0., 0.4, 0.)));
+  BOOST_CHECK_EQUAL(mb.inertiaStamp(), inertiaStamp);
+  BOOST_CHECK_GT(mb.geometryStamp(), geometryStamp);
+  BOOST_CHECK_EQUAL(mb.stamp(), mb.geometryStamp());
+
+  // the updated model must match a rebuilt one
+  std::vector<Joint> joints = mb.joints();
+  joints[2] = Joint(Joint::Rev, axis, true, joints[2].name());
+  MultiBody mbRef(mb.bodies(), joints, mb.predecessors(), mb.successors(), mb.parents(), mb.transforms());
+  BOOST_CHECK_EQUAL(mb.joint(2).motionSubspace(), mbRef.joint(2).motionSubspace());
+  BOOST_CHECK_EQUAL(mb.motionSubspaces(), mbRef.motionSubspaces());
+
+  MultiBodyConfig mbcRef(mbRef);
+  mbc.q = {{}, {0.4}, {-0.2}, {0.8}, {1., 0., 0., 0.}};
+  mbcRef.q = mbc.q;
+  forwardKinematics(mb, mbc);
+  forwardKinematics(mbRef, mbcRef);
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    BOOST_CHECK_SMALL((mbc.bodyPosW[i].matrix() - mbcRef.bodyPosW[i].matrix()).norm(), 1e-12);
+  }
+
+  // only Rev, Prism and Cylindrical joints have an axis
+  BOOST_CHECK_THROW(mb.sJointAxis(4, axis), std::domain_error);
+  BOOST_CHECK_THROW(mb.sJointAxis(1, Vector3d(1., 1., 0.)), std::domain_error);
+  BOOST_CHECK_THROW(mb.sJointAxis(5, axis), std::out_of_range);
+  BOOST_CHECK_THROW(mb.sBodyInertia(5, I), std::out_of_range);
+  Joint prism(Joint::Prism, Vector3d::UnitX(), false, "prism");
+  prism.axis(axis);
+  BOOST_CHECK_EQUAL(prism.motionSubspace(), Joint(Joint::Prism, axis, false, "prism").motionSubspace());
+}
+
+BOOST_AUTO_TEST_CASE(ReorderTest)
+{
+  using namespace Eigen;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeTree30Dof(false);
+
+  VectorXd q = VectorXd::Random(mb.nrParams());
+  q.head<4>().normalize();
+  VectorXd alpha = VectorXd::Random(mb.nrDof());
+  VectorXd alphaD = VectorXd::Random(mb.nrDof());
+  vectorToParam(q, mbc.q);
+  mbc.alpha = vectorToDof(mb, alpha);
+  mbc.alphaD = vectorToDof(mb, alphaD);
+  forwardKinematics(mb, mbc);
+  forwardVelocity(mb, mbc);
+  InverseDynamics id(mb);
+  id.inverseDynamics(mb, mbc);
+
+  for(BodyOrder order : {BodyOrder::DepthFirst, BodyOrder::BreadthFirst, BodyOrder::LongestChainFirst})
+  {
+    MultiBody mbr = reorder(mb, order);
+    BOOST_REQUIRE_EQUAL(mbr.nrBodies(), mb.nrBodies());
+    BOOST_CHECK_EQUAL(mbr.nrParams(), mb.nrParams());
+    BOOST_CHECK_EQUAL(mbr.joint(0).name(), mb.joint(0).name());
+
+    std::vector<int> depth(static_cast<std::size_t>(mbr.nrBodies()), 0);
+    for(int i = 0; i < mbr.nrBodies(); ++i)
+    {
+      // parent before children, joint i move body i
+      BOOST_CHECK_LT(mbr.parent(i), i);
+      BOOST_CHECK_EQUAL(mbr.successor(i), i);
+      BOOST_CHECK_EQUAL(mbr.predecessor(i), mbr.parent(i));
+      BOOST_CHECK_EQUAL(mbr.bodyIndexByName(mbr.body(i).name()), i);
+      BOOST_CHECK_EQUAL(mbr.jointIndexByName(mbr.joint(i).name()), i);
+      if(mbr.parent(i) != -1)
+      {
+        depth[i] = depth[mbr.parent(i)] + 1;
+      }
+      if(order == BodyOrder::BreadthFirst && i > 0)
+      {
+        BOOST_CHECK_LE(depth[i - 1], depth[i]);
+      }
+      if(order != BodyOrder::BreadthFirst && i > 0)
+      {
+        // preorder: the previous body is the parent or in the parent subtree
+        int p = i - 1;
+        while(p != -1 && p != mbr.parent(i))
+        {
+          p = mbr.parent(p);
+        }
+        BOOST_CHECK_EQUAL(p, mbr.parent(i));
+      }
+    }
+
+    // map the configuration and check that the algorithms give the same results
+    ConfigConverter conv(mb, mbr, true);
+    MultiBodyConfig mbcr(mbr);
+    mbcr.zero(mbr);
+    conv.convert(mbc, mbcr);
+    forwardKinematics(mbr, mbcr);
+    forwardVelocity(mbr, mbcr);
+    InverseDynamics idr(mbr);
+    idr.inverseDynamics(mbr, mbcr);
+
+    for(int i = 0; i < mb.nrBodies(); ++i)
+    {
+      int ir = mbr.bodyIndexByName(mb.body(i).name());
+      BOOST_CHECK_SMALL((mbc.bodyPosW[i].matrix() - mbcr.bodyPosW[ir].matrix()).norm(), 1e-10);
+      BOOST_CHECK_SMALL((mbc.bodyVelB[i].vector() - mbcr.bodyVelB[ir].vector()).norm(), 1e-10);
+    }
+    BOOST_CHECK_SMALL(
+        (dofToVector(mbr, conv.convertJoint(mbc.jointTorque)) - dofToVector(mbr, mbcr.jointTorque)).norm(), 1e-10);
+
+    VectorXd qr(mbr.nrParams()), alphar(mbr.nrDof()), torque(mb.nrDof());
+    conv.sConvertParam(q, qr);
+    conv.sConvertDof(alpha, alphar);
+    BOOST_CHECK_EQUAL(qr, paramToVector(mbr, mbcr.q));
+    BOOST_CHECK_EQUAL(alphar, dofToVector(mbr, mbcr.alpha));
+    ConfigConverter back(mbr, mb, true);
+    back.convertDof(dofToVector(mbr, mbcr.jointTorque), torque);
+    BOOST_CHECK_SMALL((torque - dofToVector(mb, mbc.jointTorque)).norm(), 1e-10);
+  }
+
+  // XYZSarm: b0 -> b1 -> (b2 -> b3, b4)
+  MultiBody arm;
+  MultiBodyConfig armConfig;
+  MultiBodyGraph armGraph;
+  std::tie(arm, armConfig, armGraph) = makeXYZSarm();
+  auto names = [&arm](const std::vector<int> & order) {
+    std::vector<std::string> res;
+    for(int i : order)
+    {
+      res.push_back(arm.body(i).name());
+    }
+    return res;
+  };
+  BOOST_CHECK(names(bodiesOrder(arm, BodyOrder::DepthFirst))
+              == std::vector<std::string>({"b0", "b1", "b2", "b3", "b4"}));
+  BOOST_CHECK(names(bodiesOrder(arm, BodyOrder::BreadthFirst))
+              == std::vector<std::string>({"b0", "b1", "b2", "b4", "b3"}));
+  // b4 subtree is visited first, (b2, b3) is the longest chain
+  MultiBody armReversed = reorder(arm, std::vector<int>({0, 1, 4, 2, 3}));
+  BOOST_CHECK_EQUAL(armReversed.body(2).name(), "b4");
+  BOOST_CHECK(reorder(armReversed, BodyOrder::LongestChainFirst).body(2).name() == "b2");
+
+  std::vector<int> order = bodiesOrder(mb, BodyOrder::BreadthFirst);
+  BOOST_CHECK_EQUAL(sReorder(mb, order).nrBodies(), mb.nrBodies());
+  std::vector<int> badOrder = order;
+  std::swap(badOrder[0], badOrder[1]);
+  BOOST_CHECK_THROW(sReorder(mb, badOrder), std::domain_error);
+  badOrder.pop_back();
+  BOOST_CHECK_THROW(sReorder(mb, badOrder), std::domain_error);
+  std::unique_ptr<ConfigConverter> conv(ConfigConverter::sConstructor(mb, reorder(mb, order), true));
+  VectorXd small = VectorXd::Zero(3);
+  BOOST_CHECK_THROW(conv->sConvertParam(small, small), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(CompiledMultiBodyTest)
+{
+  using namespace Eigen;
+  using namespace sva;
+  using namespace rbd;
+
+  MultiBody mbArm;
+  MultiBodyConfig mbcArm;
+  MultiBodyGraph mbg;
+  std::tie(mbArm, mbcArm, mbg) = makeXYZSarm();
+
+  //                b4
+  //             j3 |
+  //  Root     j0   |   j1     j2      jf2
+  //  ---- b0 ---- b1 ---- b2 ---- b3 ---- f2
+  //                       | jf0
+  //                       f0 ---- f1 ---- b5
+  //                          jf1     j5 RevX
+  RBInertiad rbi(0.5, Vector3d(0.1, 0.2, 0.), Matrix3d::Identity());
+  mbg.addBody(Body(rbi, "f0"));
+  mbg.addBody(Body(rbi, "f1"));
+  mbg.addBody(Body(rbi, "f2"));
+  mbg.addBody(Body(rbi, "b5"));
+  mbg.addJoint(Joint(Joint::Fixed, true, "jf0"));
+  mbg.addJoint(Joint(Joint::Fixed, true, "jf1"));
+  mbg.addJoint(Joint(Joint::Fixed, true, "jf2"));
+  mbg.addJoint(Joint(Joint::RevX, true, "j5"));
+  PTransformd X1(RotZ(0.3), Vector3d(0.2, 0.1, 0.));
+  PTransformd X2(RotX(-0.4), Vector3d(0., 0.3, 0.1));
+  mbg.linkBodies("b2", X1, "f0", X2, "jf0");
+  mbg.linkBodies("f0", X2, "f1", X1, "jf1");
+  mbg.linkBodies("f1", X1, "b5", PTransformd::Identity(), "j5");
+  mbg.linkBodies("b3", X2, "f2", X1, "jf2");
+
+  MultiBody mb = mbg.makeMultiBody("b0", true);
+  MultiBodyConfig mbc(mb);
+  mbc.zero(mb);
+  mb.addFrame("tool", mb.bodyIndexByName("f1"), X1);
+
+  CompiledMultiBody cmb(mb);
+  const MultiBody & mbf = cmb.multiBody();
+  BOOST_CHECK_EQUAL(cmb.nrFoldedJoints(), 3);
+  BOOST_REQUIRE_EQUAL(mbf.nrBodies(), mb.nrBodies() - 3);
+  BOOST_CHECK_EQUAL(mbf.nrParams(), mb.nrParams());
+  BOOST_CHECK_EQUAL(mbf.nrDof(), mb.nrDof());
+  // the fixed root joint is kept
+  BOOST_CHECK_EQUAL(mbf.joint(0).type(), Joint::Fixed);
+  BOOST_CHECK(cmb.isFolded(cmb.frameIndexByName("f1")));
+  BOOST_CHECK(!cmb.isFolded(cmb.frameIndexByName("b5")));
+  BOOST_CHECK_EQUAL(mbf.body(cmb.frame(cmb.frameIndexByName("f1")).body).name(), "b2");
+  BOOST_CHECK_EQUAL(mbf.body(cmb.frame(cmb.frameIndexByName("f2")).body).name(), "b3");
+
+  // the total mass is kept
+  double mass = 0., massf = 0.;
+  for(const Body & b : mb.bodies())
+  {
+    mass += b.inertia().mass();
+  }
+  for(const Body & b : mbf.bodies())
+  {
+    massf += b.inertia().mass();
+  }
+  BOOST_CHECK_SMALL(mass - massf, 1e-12);
+
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    for(double & q : mbc.q[i])
+    {
+      q = VectorXd::Random(1)(0);
+    }
+    if(mb.joint(i).type() == Joint::Spherical)
+    {
+      Map<Vector4d>(mbc.q[i].data()).normalize();
+    }
+  }
+  mbc.alpha = vectorToDof(mb, VectorXd::Random(mb.nrDof()));
+  mbc.alphaD = vectorToDof(mb, VectorXd::Random(mb.nrDof()));
+  mbc.force[mb.bodyIndexByName("f1")] = ForceVecd(Vector6d::Random());
+  mbc.force[mb.bodyIndexByName("b2")] = ForceVecd(Vector6d::Random());
+  forwardKinematics(mb, mbc);
+  forwardVelocity(mb, mbc);
+  InverseDynamics id(mb);
+  id.inverseDynamics(mb, mbc);
+
+  MultiBodyConfig mbcf(mbf);
+  mbcf.zero(mbf);
+  cmb.sToCompiled(mbc, mbcf);
+  forwardKinematics(mbf, mbcf);
+  forwardVelocity(mbf, mbcf);
+  InverseDynamics idf(mbf);
+  idf.inverseDynamics(mbf, mbcf);
+
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    int fi = cmb.frameIndexByName(mb.body(i).name());
+    BOOST_CHECK_SMALL((mbc.bodyPosW[i].matrix() - cmb.sFramePosW(mbcf, fi).matrix()).norm(), 1e-10);
+    BOOST_CHECK_SMALL((mbc.bodyVelB[i].vector() - cmb.sFrameVelB(mbcf, fi).vector()).norm(), 1e-10);
+  }
+
+  // operational frames are moved on the compiled bodies
+  BOOST_REQUIRE_EQUAL(mbf.nrFrames(), 1);
+  const OperationalFrame & tool = mbf.frame(mbf.frameIndexByName("tool"));
+  BOOST_CHECK_EQUAL(tool.body, mbf.bodyIndexByName("b2"));
+  PTransformd X_0_tool = X1 * mbc.bodyPosW[mb.bodyIndexByName("f1")];
+  BOOST_CHECK_SMALL((X_0_tool.matrix() - (tool.X_b_f * mbcf.bodyPosW[tool.body]).matrix()).norm(), 1e-10);
+
+  MultiBodyConfig mbcBack(mbc);
+  cmb.sFromCompiled(mbcf, mbcBack);
+  BOOST_CHECK_SMALL((dofToVector(mb, mbc.jointTorque) - dofToVector(mb, mbcBack.jointTorque)).norm(), 1e-10);
+
+  BOOST_CHECK_THROW(cmb.sFramePosW(mbcf, mb.nrBodies()), std::domain_error);
+  BOOST_CHECK_THROW(cmb.sToCompiled(mbcf, mbc), std::domain_error);
+}
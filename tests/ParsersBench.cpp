@@ -0,0 +1,93 @@
+/*
+ * Copyright 2012-2020 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <sstream>
+#include <string>
+
+// benchmark
+#include "benchmark/benchmark.h"
+
+// RBDyn parsers
+#include "RBDyn/parsers/binary.h"
+#include "RBDyn/parsers/urdf.h"
+#include "RBDyn/parsers/yaml.h"
+
+/// Generate a binary tree URDF of nrLinks links with visuals, collisions and limits.
+static std::string makeUrdf(int nrLinks)
+{
+  std::ostringstream urdf;
+  urdf.precision(17);
+  urdf << "<robot name=\"generated\">\n";
+  for(int i = 0; i < nrLinks; ++i)
+  {
+    double v = 0.001 * (i + 1);
+    urdf << "  <link name=\"l" << i << "\">\n"
+         << "    <inertial>\n"
+         << "      <origin xyz=\"" << v << " " << -v << " " << 2 * v << "\" rpy=\"" << v << " 0.1 -0.2\" />\n"
+         << "      <mass value=\"" << 1. + v << "\" />\n"
+         << "      <inertia ixx=\"" << 0.1 + v << "\" ixy=\"" << v * 1e-3 << "\" ixz=\"0.0\" iyy=\"" << 0.2 + v
+         << "\" iyz=\"0.0\" izz=\"" << 0.3 + v << "\" />\n"
+         << "    </inertial>\n"
+         << "    <visual>\n"
+         << "      <origin xyz=\"0.1 0.2 0.3\" rpy=\"0.4 0.5 0.6\" />\n"
+         << "      <geometry><mesh filename=\"package://generated/l" << i << ".dae\" scale=\"0.001\" /></geometry>\n"
+         << "    </visual>\n"
+         << "    <collision>\n"
+         << "      <origin xyz=\"" << v << " 0.0 0.0\" />\n"
+         << "      <geometry><box size=\"0.1 " << v << " 0.3\" /></geometry>\n"
+         << "    </collision>\n"
+         << "  </link>\n";
+  }
+  for(int i = 1; i < nrLinks; ++i)
+  {
+    double v = 0.01 * i;
+    urdf << "  <joint name=\"j" << i << "\" type=\"revolute\">\n"
+         << "    <parent link=\"l" << (i - 1) / 2 << "\" />\n"
+         << "    <child link=\"l" << i << "\" />\n"
+         << "    <origin xyz=\"" << v << " 0.05 " << -v << "\" rpy=\"0.0 " << v << " 1.5707963267948966\" />\n"
+         << "    <axis xyz=\"0 " << (i % 2) << " " << ((i + 1) % 2) << "\" />\n"
+         << "    <limit lower=\"" << -1. - v << "\" upper=\"" << 1. + v << "\" velocity=\"3.5\" effort=\"120.5\" />\n"
+         << "    <dynamics damping=\"0.05\" friction=\"0.1\" />\n"
+         << "  </joint>\n";
+  }
+  urdf << "</robot>\n";
+  return urdf.str();
+}
+
+static void BM_FromURDF(benchmark::State & state)
+{
+  std::string urdf = makeUrdf(static_cast<int>(state.range(0)));
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(rbd::parsers::from_urdf(urdf));
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(urdf.size()));
+}
+BENCHMARK(BM_FromURDF)->Arg(50)->Arg(200)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+static void BM_FromYAML(benchmark::State & state)
+{
+  std::string yaml = rbd::parsers::to_yaml(rbd::parsers::from_urdf(makeUrdf(static_cast<int>(state.range(0)))));
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(rbd::parsers::from_yaml(yaml));
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(yaml.size()));
+}
+BENCHMARK(BM_FromYAML)->Arg(50)->Arg(200)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+static void BM_FromBinary(benchmark::State & state)
+{
+  std::string bin = rbd::parsers::to_binary(rbd::parsers::from_urdf(makeUrdf(static_cast<int>(state.range(0)))));
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(rbd::parsers::from_binary(bin));
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bin.size()));
+}
+BENCHMARK(BM_FromBinary)->Arg(50)->Arg(200)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
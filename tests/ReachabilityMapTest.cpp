@@ -0,0 +1,166 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+// boost
+#define BOOST_TEST_MODULE ReachabilityMapTest
+#include <boost/filesystem.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/test/unit_test.hpp>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+// RBDyn
+#include "RBDyn/FK.h"
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/MultiBodyConfig.h"
+#include "RBDyn/MultiBodyGraph.h"
+#include "RBDyn/ReachabilityMap.h"
+
+// arm
+#include "XYZarm.h"
+
+const double PI = boost::math::constants::pi<double>();
+
+BOOST_AUTO_TEST_CASE(VoxelIndexTest)
+{
+  rbd::ReachabilityMap map(Eigen::Vector3d(-1., -2., -3.), Eigen::Vector3d(1., 2., 3.), 0.5);
+  BOOST_CHECK_EQUAL(map.size(), Eigen::Vector3i(4, 8, 12));
+  BOOST_CHECK_EQUAL(map.nrVoxels(), 4 * 8 * 12);
+
+  for(int i = 0; i < map.nrVoxels(); ++i)
+  {
+    BOOST_CHECK_EQUAL(map.index(map.center(i)), i);
+    BOOST_CHECK_EQUAL(map.reachability(i), 0);
+    BOOST_CHECK_EQUAL(map.manipulability(i), 0.f);
+  }
+
+  BOOST_CHECK_EQUAL(map.index(Eigen::Vector3d(-1.1, 0., 0.)), -1);
+  BOOST_CHECK_EQUAL(map.index(Eigen::Vector3d(0., 2.1, 0.)), -1);
+  BOOST_CHECK_EQUAL(map.reachability(Eigen::Vector3d(0., 0., 3.1)), 0);
+  // non finite points (unnormalized quaternion sample...) are outside the grid
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+  BOOST_CHECK_EQUAL(map.index(Eigen::Vector3d(nan, 0., 0.)), -1);
+  BOOST_CHECK_EQUAL(map.index(Eigen::Vector3d(0., 0., nan)), -1);
+  BOOST_CHECK_EQUAL(map.index(Eigen::Vector3d(0., inf, 0.)), -1);
+  BOOST_CHECK_EQUAL(map.index(Eigen::Vector3d(-inf, 0., 0.)), -1);
+  BOOST_CHECK_EQUAL(map.index(Eigen::Vector3d(0., 1e300, 0.)), -1);
+  BOOST_CHECK_EQUAL(map.reachability(Eigen::Vector3d(nan, nan, nan)), 0);
+
+  BOOST_CHECK_THROW(rbd::ReachabilityMap(Eigen::Vector3d::Zero(), Eigen::Vector3d::Ones(), 0.), std::domain_error);
+  BOOST_CHECK_THROW(rbd::ReachabilityMap(Eigen::Vector3d::Ones(), Eigen::Vector3d::Zero(), 0.1), std::domain_error);
+  // number of voxels that overflow an int, in total or along an axis
+  BOOST_CHECK_THROW(rbd::ReachabilityMap(Eigen::Vector3d::Zero(), Eigen::Vector3d::Ones(), 1e-4), std::domain_error);
+  BOOST_CHECK_THROW(rbd::ReachabilityMap(Eigen::Vector3d::Zero(), Eigen::Vector3d(1., 0., 0.), 1e-10),
+                    std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(SampleTest)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZarm();
+
+  std::vector<std::vector<double>> qMin = {{}, {-PI}, {-PI}, {-PI}};
+  std::vector<std::vector<double>> qMax = {{}, {PI}, {PI}, {PI}};
+
+  rbd::ReachabilityMap map1(Eigen::Vector3d(-3., -3., -3.), Eigen::Vector3d(3., 4., 3.), 0.5);
+  rbd::ReachabilityMap map4(map1);
+  map1.sSample(mb, 3, qMin, qMax, 5000, 1, 42);
+  map4.sSample(mb, 3, qMin, qMax, 5000, 4, 42);
+
+  int nrReachable = 0;
+  for(int i = 0; i < map1.nrVoxels(); ++i)
+  {
+    // result must not depend of the number of threads
+    BOOST_CHECK_EQUAL(map1.reachability(i), map4.reachability(i));
+    BOOST_CHECK_EQUAL(map1.manipulability(i), map4.manipulability(i));
+    BOOST_CHECK(map1.manipulability(i) >= 0.f);
+    if(map1.reachability(i) > 0)
+    {
+      ++nrReachable;
+    }
+  }
+  BOOST_CHECK(nrReachable > 0);
+
+  // a folded configuration lies inside the workspace so its neighborhood is reachable
+  mbc.q = {{}, {0.3}, {1.2}, {-0.8}};
+  rbd::forwardKinematics(mb, mbc);
+  BOOST_CHECK(map1.reachability(mbc.bodyPosW[3].translation()) > 0);
+  // points far from the base can't be reached by the arm
+  BOOST_CHECK_EQUAL(map1.reachability(Eigen::Vector3d(2.9, -2.9, 2.9)), 0);
+
+  std::vector<std::vector<double>> badLimits = {{}, {-PI}, {-PI}};
+  BOOST_CHECK_THROW(map1.sSample(mb, 3, badLimits, qMax, 10), std::domain_error);
+  BOOST_CHECK_THROW(map1.sSample(mb, 4, qMin, qMax, 10), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(SolveTest)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZarm();
+
+  mbc.zero(mb);
+  rbd::forwardKinematics(mb, mbc);
+  Eigen::Vector3d ef = mbc.bodyPosW[3].translation();
+
+  rbd::ReachabilityMap map(ef - Eigen::Vector3d::Constant(0.3), ef + Eigen::Vector3d::Constant(0.3), 0.2);
+  map.sSolve(mb, 3, Eigen::Matrix3d::Identity(), Eigen::VectorXd::Zero(mb.nrParams()), 2);
+
+  // the arm has only rotational joints so only the voxel where ef lie can be reached
+  // with the zero configuration orientation
+  BOOST_CHECK_EQUAL(map.reachability(ef), 1);
+  BOOST_CHECK(map.manipulability(ef) > 0.f);
+  BOOST_CHECK_EQUAL(map.reachability(ef + Eigen::Vector3d(0.25, 0., 0.)), 0);
+
+  BOOST_CHECK_THROW(map.sSolve(mb, 3, Eigen::Matrix3d::Identity(), Eigen::VectorXd::Zero(2)), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(SaveLoadTest)
+{
+  rbd::MultiBody mb;
+  rbd::MultiBodyConfig mbc;
+  rbd::MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZarm();
+
+  std::vector<std::vector<double>> qMin = {{}, {-PI}, {-PI}, {-PI}};
+  std::vector<std::vector<double>> qMax = {{}, {PI}, {PI}, {PI}};
+
+  rbd::ReachabilityMap map(Eigen::Vector3d(-3., -3., -3.), Eigen::Vector3d(3., 4., 3.), 0.3);
+  map.sample(mb, 3, qMin, qMax, 2000);
+
+  std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+  map.save(path);
+  rbd::ReachabilityMap loaded = rbd::ReachabilityMap::load(path);
+
+  BOOST_CHECK_EQUAL(loaded.size(), map.size());
+  BOOST_CHECK_EQUAL(loaded.origin(), map.origin());
+  BOOST_CHECK_EQUAL(loaded.resolution(), map.resolution());
+  for(int i = 0; i < map.nrVoxels(); ++i)
+  {
+    BOOST_CHECK_EQUAL(loaded.reachability(i), map.reachability(i));
+    BOOST_CHECK_EQUAL(loaded.manipulability(i), map.manipulability(i));
+  }
+
+  // a truncated file must be rejected
+  {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs << "RBDRMAP";
+  }
+  BOOST_CHECK_THROW(rbd::ReachabilityMap::load(path), std::runtime_error);
+  std::remove(path.c_str());
+
+  BOOST_CHECK_THROW(rbd::ReachabilityMap::load(path), std::runtime_error);
+}
@@ -0,0 +1,335 @@
+/*
+ * Copyright 2012-2019 CNRS-UM LIRMM, CNRS-AIST JRL
+ */
+
+// includes
+// std
+#include <cfloat>
+#include <iostream>
+
+// boost
+#define BOOST_TEST_MODULE ScalarTest
+#include <boost/test/unit_test.hpp>
+
+// Eigen
+#include <Eigen/Core>
+#include <unsupported/Eigen/AutoDiff>
+
+// SpaceVecAlg
+#include <SpaceVecAlg/SpaceVecAlg>
+
+// RBDyn
+#include "RBDyn/CoM.h"
+#include "RBDyn/FA.h"
+#include "RBDyn/FD.h"
+#include "RBDyn/FK.h"
+#include "RBDyn/FV.h"
+#include "RBDyn/FloatKinematics.h"
+#include "RBDyn/ID.h"
+#include "RBDyn/Jacobian.h"
+#include "RBDyn/MultiBody.h"
+#include "RBDyn/MultiBodyConfig.h"
+
+// arm
+#include "CodeGenModels.h"
+#include "XYZarm.h"
+
+/// Random configuration with normalized quaternions.
+void randomConfig(const rbd::MultiBody & mb, rbd::MultiBodyConfig & mbc)
+{
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    Eigen::VectorXd q = Eigen::VectorXd::Random(mb.joint(i).params());
+    if(mb.joint(i).type() == rbd::Joint::Spherical || mb.joint(i).type() == rbd::Joint::Free)
+    {
+      q.head<4>().normalize();
+    }
+    mbc.q[i].assign(q.data(), q.data() + q.size());
+
+    Eigen::VectorXd alpha = Eigen::VectorXd::Random(mb.joint(i).dof());
+    Eigen::VectorXd alphaD = Eigen::VectorXd::Random(mb.joint(i).dof());
+    Eigen::VectorXd torque = Eigen::VectorXd::Random(mb.joint(i).dof());
+    mbc.alpha[i].assign(alpha.data(), alpha.data() + alpha.size());
+    mbc.alphaD[i].assign(alphaD.data(), alphaD.data() + alphaD.size());
+    mbc.jointTorque[i].assign(torque.data(), torque.data() + torque.size());
+  }
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    mbc.force[i] = sva::ForceVecd(Eigen::Vector6d::Random());
+  }
+}
+
+template<typename Derived1, typename Derived2>
+double relativeError(const Eigen::MatrixBase<Derived1> & ref, const Eigen::MatrixBase<Derived2> & val)
+{
+  return (ref - val.template cast<double>()).norm() / std::max(1., ref.norm());
+}
+
+BOOST_AUTO_TEST_CASE(FloatTest)
+{
+  using namespace Eigen;
+  using namespace rbd;
+
+  const double TOL = 1e-4;
+
+  for(const CodeGenModel & model : makeCodeGenModels())
+  {
+    const MultiBody & mb = model.mb;
+    MultiBodyConfig mbc(mb);
+    mbc.zero(mb);
+    randomConfig(mb, mbc);
+
+    MultiBodyConfigT<float> mbcf = mbc.cast<float>();
+
+    forwardKinematics(mb, mbc);
+    forwardVelocity(mb, mbc);
+    forwardAcceleration(mb, mbc);
+    forwardKinematics(mb, mbcf);
+    forwardVelocity(mb, mbcf);
+    forwardAcceleration(mb, mbcf);
+
+    for(int i = 0; i < mb.nrBodies(); ++i)
+    {
+      BOOST_CHECK_SMALL(relativeError(mbc.bodyPosW[i].matrix(), mbcf.bodyPosW[i].matrix()), TOL);
+      BOOST_CHECK_SMALL(relativeError(mbc.bodyVelB[i].vector(), mbcf.bodyVelB[i].vector()), TOL);
+      BOOST_CHECK_SMALL(relativeError(mbc.bodyVelW[i].vector(), mbcf.bodyVelW[i].vector()), TOL);
+      BOOST_CHECK_SMALL(relativeError(mbc.bodyAccB[i].vector(), mbcf.bodyAccB[i].vector()), TOL);
+    }
+
+    BOOST_CHECK_SMALL(relativeError(computeCoM(mb, mbc), computeCoM(mb, mbcf)), TOL);
+    BOOST_CHECK_SMALL(relativeError(computeCoMVelocity(mb, mbc), computeCoMVelocity(mb, mbcf)), TOL);
+    BOOST_CHECK_SMALL(relativeError(computeCoMAcceleration(mb, mbc), computeCoMAcceleration(mb, mbcf)), TOL);
+
+    InverseDynamics id(mb);
+    InverseDynamicsT<float> idf(mb);
+    id.inverseDynamics(mb, mbc);
+    idf.inverseDynamics(mb, mbcf);
+    for(int i = 0; i < mb.nrJoints(); ++i)
+    {
+      for(int j = 0; j < mb.joint(i).dof(); ++j)
+      {
+        double err = std::abs(mbc.jointTorque[i][j] - mbcf.jointTorque[i][j]);
+        BOOST_CHECK_SMALL(err / std::max(1., std::abs(mbc.jointTorque[i][j])), TOL);
+      }
+    }
+
+    ForwardDynamics fd(mb);
+    ForwardDynamicsT<float> fdf(mb);
+    fd.forwardDynamics(mb, mbc);
+    fdf.forwardDynamics(mb, mbcf);
+    BOOST_CHECK_SMALL(relativeError(fd.H(), fdf.H()), TOL);
+    BOOST_CHECK_SMALL(relativeError(fd.C(), fdf.C()), TOL);
+    BOOST_CHECK_SMALL(relativeError(dofToVector(mb, mbc.alphaD), dofToVector(mb, mbcf.cast<double>().alphaD)),
+                      10 * TOL);
+
+    for(const std::string & body : model.jacobianBodies)
+    {
+      Jacobian jac(mb, body);
+      Matrix<float, 6, Dynamic> jacf, fullJacf;
+      MatrixXd fullJac(6, mb.nrDof());
+
+      computeJacobian(jac, mb, mbcf, jacf);
+      BOOST_CHECK_SMALL(relativeError(jac.jacobian(mb, mbc), jacf), TOL);
+      jac.fullJacobian(mb, jac.jacobian(mb, mbc), fullJac);
+      computeFullJacobian(jac, mb, jacf, fullJacf);
+      BOOST_CHECK_SMALL(relativeError(fullJac, fullJacf), TOL);
+
+      computeBodyJacobian(jac, mb, mbcf, jacf);
+      BOOST_CHECK_SMALL(relativeError(jac.bodyJacobian(mb, mbc), jacf), TOL);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DoubleInstantiationTest)
+{
+  using namespace Eigen;
+  using namespace rbd;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZarm();
+  randomConfig(mb, mbc);
+
+  // MultiBodyConfigT<double> and MultiBodyConfig must give the same results
+  MultiBodyConfigT<double> mbcT = mbc;
+  forwardKinematics(mb, mbc);
+  forwardVelocity(mb, mbc);
+  forwardKinematics(mb, mbcT);
+  forwardVelocity(mb, mbcT);
+
+  InverseDynamics id(mb);
+  InverseDynamicsT<double> idT(mb);
+  id.inverseDynamics(mb, mbc);
+  idT.inverseDynamics(mb, mbcT);
+  BOOST_CHECK_EQUAL(dofToVector(mb, mbc.jointTorque), dofToVector(mb, mbcT.jointTorque));
+
+  MultiBodyConfig mbc2(mbcT);
+  BOOST_CHECK_EQUAL(mbc2.bodyPosW.size(), mbc.bodyPosW.size());
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    BOOST_CHECK_EQUAL(mbc2.bodyPosW[i], mbc.bodyPosW[i]);
+    BOOST_CHECK_EQUAL(mbc2.bodyVelB[i], mbc.bodyVelB[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(AutoDiffTest)
+{
+  using namespace Eigen;
+  using namespace rbd;
+
+  typedef AutoDiffScalar<VectorXd> ADScalar;
+
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZarm();
+  randomConfig(mb, mbc);
+  forwardKinematics(mb, mbc);
+
+  // seed the derivative of each generalized position
+  MultiBodyConfigT<ADScalar> mbcAD = mbc.cast<ADScalar>();
+  int pos = 0;
+  for(int i = 0; i < mb.nrJoints(); ++i)
+  {
+    for(ADScalar & q : mbcAD.q[i])
+    {
+      q.derivatives() = VectorXd::Unit(mb.nrParams(), pos++);
+    }
+  }
+  forwardKinematics(mb, mbcAD);
+
+  // d(CoM)/dq must be the CoM jacobian (XYZarm only has revolute joints so dq = alpha)
+  Matrix<ADScalar, 3, 1> com = computeCoM(mb, mbcAD);
+  MatrixXd comJac(3, mb.nrParams());
+  for(int i = 0; i < 3; ++i)
+  {
+    comJac.row(i) = com(i).derivatives().transpose();
+  }
+
+  CoMJacobian comJacobian(mb);
+  BOOST_CHECK_SMALL((comJac - comJacobian.jacobian(mb, mbc)).norm(), 1e-8);
+
+  // d(bodyPosW)/dq must be the translation part of the body jacobian origin
+  Jacobian jac(mb, "b3");
+  const MatrixXd & jacMat = jac.jacobian(mb, mbc);
+  MatrixXd transJac(3, mb.nrParams());
+  for(int i = 0; i < 3; ++i)
+  {
+    transJac.row(i) = mbcAD.bodyPosW[3].translation()(i).derivatives().transpose();
+  }
+  MatrixXd fullJac(6, mb.nrDof());
+  jac.fullJacobian(mb, jacMat, fullJac);
+  BOOST_CHECK_SMALL((transJac - fullJac.bottomRows<3>()).norm(), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(PlanarPoseTest)
+{
+  rbd::Joint j(rbd::Joint::Planar, true, "j");
+  rbd::Joint jb(rbd::Joint::Planar, false, "jb");
+  std::vector<double> q = {0.3, -1.2, 0.7};
+  std::vector<float> qf = {0.3f, -1.2f, 0.7f};
+
+  BOOST_CHECK_SMALL(relativeError(j.pose(q).matrix(), j.pose(qf).matrix()), 1e-6);
+  BOOST_CHECK_SMALL(relativeError(jb.pose(q).matrix(), jb.pose(qf).matrix()), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(FloatKinematicsTest)
+{
+  using namespace Eigen;
+  using namespace rbd;
+
+  const double eps = FLT_EPSILON;
+
+  for(const CodeGenModel & model : makeCodeGenModels())
+  {
+    const MultiBody & mb = model.mb;
+    MultiBodyConfig mbc(mb);
+    mbc.zero(mb);
+    randomConfig(mb, mbc);
+    // the bounds assume q is exactly representable in float
+    for(std::vector<double> & q : mbc.q)
+    {
+      for(double & qi : q)
+      {
+        qi = static_cast<float>(qi);
+      }
+    }
+    forwardKinematics(mb, mbc);
+
+    FloatKinematics fk(mb);
+    fk.forwardKinematics(mb, mbc);
+
+    // joints depth and path length of each body
+    std::vector<int> depth(static_cast<std::size_t>(mb.nrBodies()), 0);
+    std::vector<double> length(static_cast<std::size_t>(mb.nrBodies()), 0.);
+    for(int i = 0; i < mb.nrJoints(); ++i)
+    {
+      int pred = mb.predecessor(i);
+      int succ = mb.successor(i);
+      depth[succ] = (pred == -1 ? 0 : depth[pred]) + 1;
+      length[succ] = (pred == -1 ? 0. : length[pred]) + mb.transform(i).translation().norm();
+      if(mb.joint(i).type() == Joint::Prism)
+      {
+        length[succ] += std::abs(mbc.q[i][0]);
+      }
+    }
+
+    for(int i = 0; i < mb.nrBodies(); ++i)
+    {
+      const FloatKinematics::Transform & X = fk.bodyPosW()[i];
+      Matrix3d R = mbc.bodyPosW[i].rotation().transpose();
+      BOOST_CHECK_SMALL((R - X.leftCols<3>().cast<double>()).cwiseAbs().maxCoeff(), 2 * depth[i] * eps);
+      BOOST_CHECK_SMALL((mbc.bodyPosW[i].translation() - X.col(3).cast<double>()).cwiseAbs().maxCoeff(),
+                        2 * depth[i] * eps * length[i]);
+      BOOST_CHECK_SMALL((FloatKinematics::toPTransform(X).matrix() - mbc.bodyPosW[i].matrix()).norm(), 1e-5);
+    }
+
+    // the same configuration from a paramToVector vector
+    FloatKinematics fk2(mb);
+    fk2.sForwardKinematics(mb, paramToVector(mb, mbc.q).cast<float>());
+    for(int i = 0; i < mb.nrBodies(); ++i)
+    {
+      BOOST_CHECK_EQUAL(fk.bodyPosW()[i], fk2.bodyPosW()[i]);
+    }
+
+    for(const std::string & body : model.jacobianBodies)
+    {
+      Vector3d point = Vector3d::Random();
+      Jacobian jac(mb, body, point);
+      int N = jac.jointsPath().back();
+      const MatrixXd & jacMat = jac.jacobian(mb, mbc);
+      Matrix<float, 6, Dynamic> jacf;
+      fk.sJacobian(mb, jac, jacf);
+
+      BOOST_REQUIRE_EQUAL(jacf.cols(), jacMat.cols());
+      double L = length[N] + point.norm();
+      BOOST_CHECK_SMALL((jacMat.topRows<3>() - jacf.topRows<3>().cast<double>()).cwiseAbs().maxCoeff(),
+                        2 * depth[N] * eps);
+      BOOST_CHECK_SMALL((jacMat.bottomRows<3>() - jacf.bottomRows<3>().cast<double>()).cwiseAbs().maxCoeff(),
+                        2 * depth[N] * eps * L);
+    }
+  }
+
+  // mismatch between the algorithm and the model
+  MultiBody mb;
+  MultiBodyConfig mbc;
+  MultiBodyGraph mbg;
+  std::tie(mb, mbc, mbg) = makeXYZarm();
+  FloatKinematics fk(mb);
+  BOOST_CHECK_THROW(fk.sForwardKinematics(mb, VectorXf::Zero(mb.nrParams() + 1)), std::domain_error);
+  BOOST_CHECK_THROW(fk.sForwardKinematics(makeCodeGenModels().front().mb, mbc), std::domain_error);
+
+  // the model geometry is converted again when it change
+  mbc.q = {{}, {0.3}, {-0.5}, {0.7}};
+  fk.forwardKinematics(mb, mbc);
+  mb.jointAxis(2, Vector3d(0., 1., 1.).normalized());
+  mb.transform(3, sva::PTransformd(sva::RotX(0.4), Vector3d(0.1, 0.5, 0.)));
+  forwardKinematics(mb, mbc);
+  fk.forwardKinematics(mb, mbc);
+  for(int i = 0; i < mb.nrBodies(); ++i)
+  {
+    BOOST_CHECK_SMALL((FloatKinematics::toPTransform(fk.bodyPosW()[i]).matrix() - mbc.bodyPosW[i].matrix()).norm(),
+                      1e-5);
+  }
+}
@@ -10,6 +10,7 @@
 #include <RBDyn/parsers/urdf.h>
 
 #include <iostream>
+#include <sstream>
 
 // Test utilties
 #include "ParsersTestUtils.h"
@@ -88,3 +89,24 @@ BOOST_AUTO_TEST_CASE(outputTest)
     BOOST_CHECK_EQUAL(j1.motionSubspace(), j2.motionSubspace());
   }
 }
+
+BOOST_AUTO_TEST_CASE(streamTest)
+{
+  auto robot = rbd::parsers::from_urdf(XYZSarmUrdf);
+  // strings that need to be escaped
+  robot.name = "XYZ & \"Sarm\" <1>";
+  robot.limits.upper["j0"] = {0.1 + 0.2};
+
+  std::ostringstream out;
+  rbd::parsers::to_urdf(robot, out);
+  BOOST_CHECK_EQUAL(out.str(), rbd::parsers::to_urdf(robot));
+
+  auto robot2 = rbd::parsers::from_urdf(out.str());
+  BOOST_CHECK_EQUAL(robot2.name, robot.name);
+  BOOST_CHECK(robot2.limits.upper.at("j0") == robot.limits.upper.at("j0"));
+  for(int i = 0; i < robot.mb.nrBodies(); ++i)
+  {
+    BOOST_CHECK_EQUAL(robot.mb.body(i).inertia().mass(), robot2.mb.body(i).inertia().mass());
+    BOOST_CHECK_EQUAL(robot.mb.body(i).inertia().momentum(), robot2.mb.body(i).inertia().momentum());
+  }
+}
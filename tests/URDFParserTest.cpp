@@ -8,6 +8,9 @@
 
 // RBDyn URDF parser
 #include <RBDyn/parsers/urdf.h>
+#include <RBDyn/parsers/yaml.h>
+
+#include <clocale>
 
 // Test utilties
 #include "ParsersTestUtils.h"
@@ -79,3 +82,138 @@ BOOST_AUTO_TEST_CASE(visualTest)
                            cppRobot.visual[body.name()].begin()));
   }
 }
+
+BOOST_AUTO_TEST_CASE(deferredGeometryTest)
+{
+  auto eager = rbd::parsers::from_urdf(XYZSarmUrdf);
+  auto deferred = rbd::parsers::from_urdf(XYZSarmUrdf, true, {}, true, "", true, "_spherical",
+                                          rbd::parsers::GeometryLoading::Deferred);
+
+  BOOST_CHECK(deferred.geometry_deferred());
+  BOOST_CHECK(deferred.visual.empty());
+  BOOST_CHECK(deferred.collision.empty());
+
+  deferred.load_geometry();
+  BOOST_CHECK(!deferred.geometry_deferred());
+  BOOST_CHECK_EQUAL(deferred.visual.size(), eager.visual.size());
+  for(const auto & v : eager.visual)
+  {
+    const auto & dv = deferred.visual.at(v.first);
+    BOOST_REQUIRE_EQUAL(dv.size(), v.second.size());
+    BOOST_CHECK(std::equal(dv.begin(), dv.end(), v.second.begin()));
+  }
+  BOOST_CHECK_EQUAL(deferred.collision.size(), eager.collision.size());
+}
+
+BOOST_AUTO_TEST_CASE(actuatorTest)
+{
+  const std::string urdf(
+      R"(<robot name="actuated">
+    <link name="b0" />
+    <link name="b1">
+      <inertial>
+        <mass value="1" />
+        <inertia ixx="0.1" ixy="0.0" ixz="0.0" iyy="0.1" iyz="0.0" izz="0.1" />
+      </inertial>
+    </link>
+    <link name="b2">
+      <inertial>
+        <mass value="1" />
+        <inertia ixx="0.1" ixy="0.0" ixz="0.0" iyy="0.1" iyz="0.0" izz="0.1" />
+      </inertial>
+    </link>
+    <joint name="j0" type="revolute">
+      <parent link="b0" />
+      <child link="b1" />
+      <axis xyz="1 0 0" />
+      <limit lower="-1" upper="1" velocity="10" effort="50" />
+      <dynamics damping="0.5" friction="0.2" armature="0.8" />
+    </joint>
+    <joint name="j1" type="revolute">
+      <parent link="b1" />
+      <child link="b2" />
+      <axis xyz="0 1 0" />
+      <limit lower="-1" upper="1" velocity="10" effort="50" />
+    </joint>
+    <transmission name="t0">
+      <type>transmission_interface/SimpleTransmission</type>
+      <joint name="j0" />
+      <actuator name="m0">
+        <mechanicalReduction>2</mechanicalReduction>
+      </actuator>
+    </transmission>
+  </robot>
+)");
+
+  auto robot = rbd::parsers::from_urdf(urdf);
+  const auto & j0 = robot.mb.joint(robot.mb.jointIndexByName("j0"));
+  const auto & j1 = robot.mb.joint(robot.mb.jointIndexByName("j1"));
+
+  BOOST_CHECK_EQUAL(j0.damping(), 0.5);
+  BOOST_CHECK_EQUAL(j0.friction(), 0.2);
+  BOOST_CHECK_EQUAL(j0.gearRatio(), 2.);
+  BOOST_CHECK_SMALL(j0.rotorInertia() - 0.2, TOL);
+  BOOST_CHECK_SMALL(j0.armature() - 0.8, TOL);
+  BOOST_CHECK(j0.hasActuatorDynamics());
+  BOOST_CHECK(!j1.hasActuatorDynamics());
+
+  // written parameters must be parsed back
+  auto written = rbd::parsers::from_urdf(rbd::parsers::to_urdf(robot));
+  const auto & wj0 = written.mb.joint(written.mb.jointIndexByName("j0"));
+  BOOST_CHECK_EQUAL(wj0.damping(), j0.damping());
+  BOOST_CHECK_EQUAL(wj0.friction(), j0.friction());
+  BOOST_CHECK_SMALL(wj0.armature() - j0.armature(), TOL);
+  BOOST_CHECK(!written.mb.joint(written.mb.jointIndexByName("j1")).hasActuatorDynamics());
+
+  // and kept by a conversion to YAML
+  auto yaml = rbd::parsers::from_yaml(rbd::parsers::to_yaml(robot));
+  const auto & yj0 = yaml.mb.joint(yaml.mb.jointIndexByName("j0"));
+  BOOST_CHECK_EQUAL(yj0.damping(), j0.damping());
+  BOOST_CHECK_EQUAL(yj0.friction(), j0.friction());
+  BOOST_CHECK_SMALL(yj0.armature() - j0.armature(), TOL);
+  BOOST_CHECK(!yaml.mb.joint(yaml.mb.jointIndexByName("j1")).hasActuatorDynamics());
+}
+
+BOOST_AUTO_TEST_CASE(numericTest)
+{
+  const std::string urdf(
+      R"(<robot name="numeric">
+    <link name="b0" />
+    <link name="b1">
+      <inertial>
+        <origin xyz="1e-1 -2.5E-1 +.5" />
+        <mass value=" 2.5 " />
+        <inertia ixx="1" ixy="0" ixz="0" iyy="1" iyz="0" izz="1" />
+      </inertial>
+    </link>
+    <joint name="j0" type="revolute">
+      <parent link="b0" />
+      <child link="b1" />
+      <axis xyz="1 0 0" />
+      <limit lower="-1.5e0 abc 2" upper="abc" velocity="1e" effort="50 " />
+      <dynamics damping="1,5" friction="0x10" />
+    </joint>
+  </robot>
+)");
+
+  // numbers must be read with a period decimal separator whatever the global locale
+  const char * oldLocale = std::setlocale(LC_NUMERIC, nullptr);
+  std::string savedLocale = oldLocale ? oldLocale : "C";
+  std::setlocale(LC_NUMERIC, "fr_FR.UTF-8");
+  auto robot = rbd::parsers::from_urdf(urdf);
+  std::setlocale(LC_NUMERIC, savedLocale.c_str());
+
+  const auto & b1 = robot.mb.body(robot.mb.bodyIndexByName("b1"));
+  BOOST_CHECK_EQUAL(b1.inertia().mass(), 2.5);
+  BOOST_CHECK_SMALL((b1.inertia().momentum() - 2.5 * Eigen::Vector3d(0.1, -0.25, 0.5)).norm(), TOL);
+
+  // same behavior than a stream extraction: stop at the first invalid
+  // character, reject incomplete exponents and hexadecimal numbers
+  const auto & j0 = robot.mb.joint(robot.mb.jointIndexByName("j0"));
+  BOOST_CHECK_EQUAL(j0.damping(), 1.);
+  BOOST_CHECK_EQUAL(j0.friction(), 0.);
+  BOOST_CHECK(robot.limits.lower.at("j0") == std::vector<double>{-1.5});
+  BOOST_CHECK(robot.limits.upper.at("j0").empty());
+  BOOST_CHECK(robot.limits.velocity.at("j0").empty());
+  BOOST_CHECK(robot.limits.torque.at("j0") == std::vector<double>{50.});
+}
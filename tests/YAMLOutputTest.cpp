@@ -9,7 +9,10 @@
 // RBDyn YAML parser
 #include <RBDyn/parsers/yaml.h>
 
+#include <clocale>
 #include <iostream>
+#include <limits>
+#include <sstream>
 
 // Test utilties
 #include "ParsersTestUtils.h"
@@ -88,3 +91,37 @@ BOOST_AUTO_TEST_CASE(outputTest)
     BOOST_CHECK_EQUAL(j1.motionSubspace(), j2.motionSubspace());
   }
 }
+
+BOOST_AUTO_TEST_CASE(streamTest)
+{
+  auto robot = rbd::parsers::from_yaml(XYZSarmYaml);
+  // strings that need to be quoted
+  robot.name = "XYZ: \"Sarm\"";
+  auto & mesh = boost::get<rbd::parsers::Geometry::Mesh>(robot.visual["b0"][0].geometry.data);
+  mesh.filename = "package://meshes/mesh 1.dae";
+  // numbers without a short representation and non finite numbers
+  robot.limits.upper["j0"] = {0.1 + 0.2};
+  robot.limits.lower["j0"] = {-std::numeric_limits<double>::infinity()};
+
+  std::ostringstream out;
+  rbd::parsers::to_yaml(robot, out);
+  BOOST_CHECK_EQUAL(out.str(), rbd::parsers::to_yaml(robot));
+
+  // numbers must be written with a period decimal separator whatever the global locale
+  const char * oldLocale = std::setlocale(LC_NUMERIC, nullptr);
+  std::string savedLocale = oldLocale ? oldLocale : "C";
+  std::setlocale(LC_NUMERIC, "fr_FR.UTF-8");
+  auto yaml = rbd::parsers::to_yaml(robot);
+  std::setlocale(LC_NUMERIC, savedLocale.c_str());
+
+  auto robot2 = rbd::parsers::from_yaml(yaml);
+  BOOST_CHECK_EQUAL(robot2.name, robot.name);
+  BOOST_CHECK(robot2.visual.at("b0")[0] == robot.visual.at("b0")[0]);
+  BOOST_CHECK(robot2.limits.upper.at("j0") == robot.limits.upper.at("j0"));
+  BOOST_CHECK(robot2.limits.lower.at("j0") == robot.limits.lower.at("j0"));
+  for(int i = 0; i < robot.mb.nrBodies(); ++i)
+  {
+    BOOST_CHECK_EQUAL(robot.mb.body(i).inertia().mass(), robot2.mb.body(i).inertia().mass());
+    BOOST_CHECK_EQUAL(robot.mb.body(i).inertia().momentum(), robot2.mb.body(i).inertia().momentum());
+  }
+}
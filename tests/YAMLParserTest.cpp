@@ -78,3 +78,79 @@ BOOST_AUTO_TEST_CASE(visualTest)
                            cppRobot.visual[body.name()].begin()));
   }
 }
+
+BOOST_AUTO_TEST_CASE(deferredGeometryTest)
+{
+  auto eager = rbd::parsers::from_yaml(XYZSarmYaml);
+  auto deferred = rbd::parsers::from_yaml(XYZSarmYaml, true, {}, true, "", true, "_spherical",
+                                          rbd::parsers::GeometryLoading::Deferred);
+
+  BOOST_CHECK(!eager.geometry_deferred());
+  BOOST_CHECK(deferred.geometry_deferred());
+  BOOST_CHECK(deferred.visual.empty());
+  BOOST_CHECK(deferred.collision.empty());
+  BOOST_CHECK_EQUAL(deferred.mb.nrBodies(), eager.mb.nrBodies());
+
+  const auto & visuals = deferred.visuals();
+  BOOST_CHECK(!deferred.geometry_deferred());
+  BOOST_CHECK_EQUAL(visuals.size(), eager.visual.size());
+  for(const auto & v : eager.visual)
+  {
+    const auto & dv = visuals.at(v.first);
+    BOOST_REQUIRE_EQUAL(dv.size(), v.second.size());
+    BOOST_CHECK(std::equal(dv.begin(), dv.end(), v.second.begin()));
+  }
+  BOOST_CHECK_EQUAL(deferred.collisions().size(), eager.collision.size());
+}
+
+BOOST_AUTO_TEST_CASE(streamingTest)
+{
+  const std::string & yaml = XYZSarmYaml;
+  auto robot = rbd::parsers::from_yaml(yaml);
+  auto linksPos = yaml.find("  links:");
+  auto jointsPos = yaml.find("  joints:");
+  auto namePos = yaml.find("  name:");
+
+  // the records that come before anglesInDegrees or the links are kept until they are known
+  std::string reordered = "robot:\n" + yaml.substr(jointsPos) + "\n" + yaml.substr(linksPos, jointsPos - linksPos)
+                          + yaml.substr(namePos, linksPos - namePos);
+  BOOST_CHECK_EQUAL(rbd::parsers::to_yaml(rbd::parsers::from_yaml(reordered)), rbd::parsers::to_yaml(robot));
+
+  // anchors defined outside of the robot element can be used in the records
+  std::string aliased = "xAxis: &x [1, 0, 0]\n" + yaml;
+  for(auto pos = aliased.find("axis: [1, 0, 0]"); pos != std::string::npos; pos = aliased.find("axis: [1, 0, 0]"))
+  {
+    aliased.replace(pos, 15, "axis: *x");
+  }
+  BOOST_CHECK_EQUAL(rbd::parsers::to_yaml(rbd::parsers::from_yaml(aliased)), rbd::parsers::to_yaml(robot));
+
+  BOOST_CHECK_THROW(rbd::parsers::from_yaml("robot:\n  name: r\n"), std::runtime_error);
+  BOOST_CHECK_THROW(rbd::parsers::from_yaml(yaml.substr(0, jointsPos)), std::runtime_error);
+  BOOST_CHECK_THROW(rbd::parsers::from_yaml("other: 1\n"), std::runtime_error);
+  BOOST_CHECK_THROW(rbd::parsers::from_yaml_file("missing_file.yaml"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(actuatorTest)
+{
+  std::string yaml = XYZSarmYaml;
+  const std::string j0End = "        effort: 50\n    - name: j1\n";
+  auto pos = yaml.find(j0End);
+  BOOST_REQUIRE(pos != std::string::npos);
+  yaml.insert(pos + j0End.find('\n') + 1, "      dynamics:\n        damping: 0.5\n        friction: 0.2\n"
+                                          "        armature: 0.8\n");
+
+  auto robot = rbd::parsers::from_yaml(yaml);
+  const auto & j0 = robot.mb.joint(robot.mb.jointIndexByName("j0"));
+  BOOST_CHECK_EQUAL(j0.damping(), 0.5);
+  BOOST_CHECK_EQUAL(j0.friction(), 0.2);
+  BOOST_CHECK_SMALL(j0.armature() - 0.8, TOL);
+  BOOST_CHECK(!robot.mb.joint(robot.mb.jointIndexByName("j1")).hasActuatorDynamics());
+
+  // written parameters must be parsed back
+  auto written = rbd::parsers::from_yaml(rbd::parsers::to_yaml(robot));
+  const auto & wj0 = written.mb.joint(written.mb.jointIndexByName("j0"));
+  BOOST_CHECK_EQUAL(wj0.damping(), j0.damping());
+  BOOST_CHECK_EQUAL(wj0.friction(), j0.friction());
+  BOOST_CHECK_SMALL(wj0.armature() - j0.armature(), TOL);
+  BOOST_CHECK(!written.mb.joint(written.mb.jointIndexByName("j1")).hasActuatorDynamics());
+}